@@ -0,0 +1,418 @@
+#include "HeadlessRunner.h"
+
+#include <cstdio>
+#include <ctime>
+#include <memory>
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTimer>
+
+#include <google/protobuf/util/json_util.h>
+
+#include "Processing/DataBuffer.h"
+#include "Processing/JobFile.h"
+#include "Processing/ShapeGenerator.h"
+#include "Processing/TcpSocketWorker.h"
+#include "grpc/FiveAxisClient.h"
+#include "metrics/MetricsRegistry.h"
+
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+namespace {
+    constexpr int DRAIN_POLL_MS = 20;
+    constexpr int DRAIN_REPORT_MS = 1000;
+
+    QString shapeTypeName(const SceneShape& shape) {
+        switch (shape.shape_case()) {
+        case SceneShape::kLine:
+            return QStringLiteral("line");
+        case SceneShape::kCircle:
+            return QStringLiteral("circle");
+        case SceneShape::kRectangle:
+            return QStringLiteral("rectangle");
+        case SceneShape::kEllipse:
+            return QStringLiteral("ellipse");
+        case SceneShape::SHAPE_NOT_SET:
+            break;
+        }
+        return QStringLiteral("empty");
+    }
+
+    // Time since the kernel started this process, so dynamic loading and static initialisers
+    // count towards startup; starttime in /proc/self/stat is in clock ticks (usually 10 ms)
+    // since boot. Negative where that is not available.
+    double msSinceProcessStart() {
+#ifdef Q_OS_LINUX
+        QFile stat(QStringLiteral("/proc/self/stat"));
+        if (!stat.open(QIODevice::ReadOnly)) {
+            return -1.0;
+        }
+        // The command name may contain spaces; the numbered fields start after its ')'.
+        const QByteArray line = stat.readAll();
+        const QList<QByteArray> fields = line.mid(line.lastIndexOf(')') + 2).split(' ');
+        constexpr int STARTTIME_FIELD = 22 - 3;
+        bool ok = false;
+        const qulonglong startTicks = fields.value(STARTTIME_FIELD).toULongLong(&ok);
+        timespec now{};
+        if (!ok || clock_gettime(CLOCK_BOOTTIME, &now) != 0) {
+            return -1.0;
+        }
+        const double ticksPerSecond = static_cast<double>(sysconf(_SC_CLK_TCK));
+        const double sinceBootMs = now.tv_sec * 1000.0 + now.tv_nsec / 1e6;
+        return sinceBootMs - startTicks * 1000.0 / ticksPerSecond;
+#else
+        return -1.0;
+#endif
+    }
+}
+
+HeadlessRunner::HeadlessRunner(const Options& options, const QElapsedTimer& processClock, QObject* parent)
+    : QObject(parent)
+    , m_options(options)
+    , m_processClock(processClock) {
+    // Shift the clock main() started back to process start.
+    const double sinceStart = msSinceProcessStart();
+    m_startOffsetMs = qMax(0.0, sinceStart - m_processClock.nsecsElapsed() / 1e6);
+}
+
+HeadlessRunner::~HeadlessRunner() {
+    m_streamer.reset();
+    if (m_metrics) {
+        QMetaObject::invokeMethod(m_metrics, [this]() { m_metrics->stopListening(); }, Qt::BlockingQueuedConnection);
+        m_metricsThread.quit();
+        m_metricsThread.wait();
+        delete m_metrics;
+    }
+}
+
+void HeadlessRunner::start() {
+    emitEvent(QStringLiteral("started"), QJsonObject{
+        { QStringLiteral("startup_ms"), processMs() },
+        { QStringLiteral("mode"), m_options.mode == Mode::Local ? QStringLiteral("local") : QStringLiteral("grpc") },
+        { QStringLiteral("job"), m_options.jobPath },
+        });
+    startMetrics();
+    if (!loadJob()) {
+        QCoreApplication::exit(2);
+        return;
+    }
+    m_jobClock.start();
+    if (m_options.mode == Mode::Local) {
+        runLocal();
+    }
+    else {
+        runGrpc();
+    }
+}
+
+void HeadlessRunner::startMetrics() {
+    if (m_options.metricsFile.isEmpty() && m_options.metricsPort == 0) {
+        return;
+    }
+    m_metrics = new MetricsExporter(MetricsRegistry::instance());
+    m_metrics->moveToThread(&m_metricsThread);
+    m_metricsThread.setObjectName(QStringLiteral("MetricsExporter"));
+    m_metricsThread.start();
+    QString error;
+    QMetaObject::invokeMethod(m_metrics, [this, &error]() {
+        if (!m_options.metricsFile.isEmpty()) {
+            m_metrics->exportToFile(m_options.metricsFile, m_options.metricsFormat, m_options.metricsIntervalMs, error);
+        }
+        if (error.isEmpty() && m_options.metricsPort != 0) {
+            m_metrics->listen(m_options.metricsPort, error);
+        }
+        }, Qt::BlockingQueuedConnection);
+    // Metrics are an aid for the cell, not part of the job: report and carry on.
+    if (!error.isEmpty()) {
+        emitEvent(QStringLiteral("warning"), QJsonObject{ { QStringLiteral("message"), QStringLiteral("metrics: %1").arg(error) } });
+    }
+}
+
+bool HeadlessRunner::loadJob() {
+    QElapsedTimer clock;
+    clock.start();
+    if (JobFile::isJobFile(m_options.jobPath)) {
+        QString error;
+        m_jobFile = JobFile::open(m_options.jobPath, error);
+        if (!m_jobFile) {
+            emitEvent(QStringLiteral("error"), QJsonObject{ { QStringLiteral("message"), error } });
+            return false;
+        }
+        const double mapMs = clock.nsecsElapsed() / 1e6;
+        m_jobFile->toJobData(m_job);
+        emitEvent(QStringLiteral("loaded"), QJsonObject{
+            { QStringLiteral("shapes"), m_job.scene().shapes_size() },
+            { QStringLiteral("segments"), m_jobFile->segmentCount() },
+            { QStringLiteral("map_ms"), mapMs },
+            { QStringLiteral("ms"), clock.nsecsElapsed() / 1e6 },
+            });
+        return true;
+    }
+    QFile file(m_options.jobPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        emitEvent(QStringLiteral("error"), QJsonObject{ { QStringLiteral("message"), file.errorString() } });
+        return false;
+    }
+    const QByteArray json = file.readAll();
+    const auto status = google::protobuf::util::JsonStringToMessage(json.toStdString(), &m_job);
+    if (!status.ok()) {
+        emitEvent(QStringLiteral("error"), QJsonObject{
+            { QStringLiteral("message"), QString::fromStdString(std::string(status.message())) } });
+        return false;
+    }
+    emitEvent(QStringLiteral("loaded"), QJsonObject{
+        { QStringLiteral("shapes"), m_job.scene().shapes_size() },
+        { QStringLiteral("ms"), clock.nsecsElapsed() / 1e6 },
+        });
+    return true;
+}
+
+void HeadlessRunner::runLocal() {
+    if (!m_options.streamHost.isEmpty()) {
+        m_buffer = std::make_unique<DataBuffer>();
+        m_streamer = std::make_unique<TcpSocketWorker>(m_options.streamHost, m_options.streamPort, *m_buffer);
+        m_buffer->setStreamer(m_streamer.get());
+    }
+    DataBuffer& buffer = m_buffer ? *m_buffer : DataBuffer::instance();
+    if (m_options.realtime.enabled) {
+        TcpSocketWorker& streamer = m_streamer ? *m_streamer : TcpSocketWorker::instance();
+        streamer.setRealtime(m_options.realtime);
+        QString error;
+        if (!buffer.setRealtimeMemory(true, error)) {
+            emitEvent(QStringLiteral("warning"), QJsonObject{ { QStringLiteral("message"), error } });
+        }
+    }
+
+    if (m_job.freq().freq() > 0) {
+        buffer.applySettings(m_job.freq().freq(), m_job.power());
+    }
+    else if (m_job.power() > 0.0) {
+        buffer.setPowerData(m_job.power());
+    }
+    if (m_job.has_delay()) {
+        emitEvent(QStringLiteral("warning"), QJsonObject{
+            { QStringLiteral("message"), QStringLiteral("local generation uses built-in delays; DelayData ignored") } });
+    }
+
+    const int total = m_job.scene().shapes_size();
+    if (m_jobFile && m_jobFile->segmentCount() > 0) {
+        // Pre-generated frame records go out as-is, straight from the mapped file.
+        buffer.addRecords(reinterpret_cast<const char*>(m_jobFile->segments()), m_jobFile->segmentCount());
+        buffer.forceFill();
+        emitEvent(QStringLiteral("generated"), QJsonObject{
+            { QStringLiteral("segments"), m_jobFile->segmentCount() },
+            { QStringLiteral("ms"), m_jobClock.nsecsElapsed() / 1e6 },
+            });
+        waitForStreamDrain(total, 0);
+        return;
+    }
+    int failed = 0;
+    for (int i = 0; i < total; ++i) {
+        const auto& shape = m_job.scene().shapes(i);
+        QElapsedTimer shapeClock;
+        shapeClock.start();
+        // Anything the local generators would only approximate is reported, not run.
+        const QString skipReason = ShapeGenerator::unsupported(shape);
+        if (!skipReason.isEmpty()) {
+            ++failed;
+            emitEvent(QStringLiteral("skipped"), QJsonObject{
+                { QStringLiteral("index"), i },
+                { QStringLiteral("type"), shapeTypeName(shape) },
+                { QStringLiteral("reason"), skipReason },
+                });
+            continue;
+        }
+        ShapeGenerator::generate(buffer, shape);
+        emitEvent(QStringLiteral("shape"), QJsonObject{
+            { QStringLiteral("index"), i },
+            { QStringLiteral("total"), total },
+            { QStringLiteral("type"), shapeTypeName(shape) },
+            { QStringLiteral("ms"), shapeClock.nsecsElapsed() / 1e6 },
+            });
+    }
+
+    // Push out the partially filled last frame so the stream ends with this job.
+    buffer.forceFill();
+    emitEvent(QStringLiteral("generated"), QJsonObject{ { QStringLiteral("ms"), m_jobClock.nsecsElapsed() / 1e6 } });
+    waitForStreamDrain(total, failed);
+}
+
+void HeadlessRunner::waitForStreamDrain(int shapes, int failed) {
+    DataBuffer& buffer = m_buffer ? *m_buffer : DataBuffer::instance();
+    TcpSocketWorker& streamer = m_streamer ? *m_streamer : TcpSocketWorker::instance();
+    auto* timer = new QTimer(this);
+    auto lastReportMs = std::make_shared<qint64>(m_jobClock.elapsed());
+    connect(timer, &QTimer::timeout, this, [this, timer, lastReportMs, &buffer, &streamer, shapes, failed]() {
+        if (buffer.allFramesSent()) {
+            timer->stop();
+            if (m_options.realtime.enabled) {
+                emitEvent(QStringLiteral("realtime"), QJsonObject{
+                    { QStringLiteral("thread"), streamer.realtimeStatus() },
+                    { QStringLiteral("memory"), buffer.memoryStatus() },
+                    });
+            }
+            finish(shapes, failed);
+            return;
+        }
+        if (m_jobClock.elapsed() - *lastReportMs >= DRAIN_REPORT_MS) {
+            *lastReportMs = m_jobClock.elapsed();
+            emitEvent(QStringLiteral("streaming"), QJsonObject{
+                { QStringLiteral("pending_frames"), buffer.pendingFrames() },
+                { QStringLiteral("frames_written"), streamer.framesWritten() },
+                { QStringLiteral("connected"), streamer.isConnected() },
+                });
+        }
+        });
+    timer->start(DRAIN_POLL_MS);
+}
+
+void HeadlessRunner::runGrpc() {
+    m_client = new FiveAxisClient(this);
+    const QString details = m_client->connectToServer(m_options.endpoint);
+    Q_UNUSED(details);
+    const QString state = m_client->channelStateString();
+    emitEvent(QStringLiteral("connected"), QJsonObject{
+        { QStringLiteral("endpoint"), m_options.endpoint.toString() },
+        { QStringLiteral("state"), state },
+        { QStringLiteral("ms"), m_jobClock.nsecsElapsed() / 1e6 },
+        });
+    if (state != QStringLiteral("READY") && state != QStringLiteral("IDLE")) {
+        emitEvent(QStringLiteral("error"), QJsonObject{ { QStringLiteral("message"), QStringLiteral("controller not reachable") } });
+        QCoreApplication::exit(2);
+        return;
+    }
+
+    auto failures = std::make_shared<int>(0);
+    connect(m_client, &FiveAxisClient::errorReceived, this, [this, failures](const QString& operation, int code, const QString& message) {
+        ++*failures;
+        emitEvent(QStringLiteral("error"), QJsonObject{
+            { QStringLiteral("operation"), operation },
+            { QStringLiteral("code"), code },
+            { QStringLiteral("message"), message },
+            });
+        });
+    connect(m_client, &FiveAxisClient::sceneProgress, this, [this](int done, int total) {
+        emitEvent(QStringLiteral("progress"), QJsonObject{
+            { QStringLiteral("done"), done },
+            { QStringLiteral("total"), total },
+            });
+        });
+    connect(m_client, &FiveAxisClient::sceneFinished, this, [this, failures](int shapes, int failed, double elapsedMs) {
+        Q_UNUSED(elapsedMs);
+        // Shape failures were already counted through errorReceived.
+        Q_UNUSED(failed);
+        finish(shapes, *failures);
+        });
+
+    if (m_job.has_delay()) {
+        m_client->setDelay(m_job.delay());
+    }
+    if (m_job.has_freq()) {
+        m_client->setLaserFreq(m_job.freq());
+    }
+    auto batch = std::make_unique<SceneBatch>();
+    batch->mergeFrom(m_job.scene());
+    batch->finalize();
+    m_client->processScene(std::move(batch));
+}
+
+void HeadlessRunner::finish(int shapes, int failed) {
+    if (m_metrics) {
+        // Leave the final totals in the file rather than the last periodic snapshot.
+        QMetaObject::invokeMethod(m_metrics, [this]() {
+            QString error;
+            m_metrics->writeNow(error);
+            }, Qt::BlockingQueuedConnection);
+    }
+    emitEvent(QStringLiteral("done"), QJsonObject{
+        { QStringLiteral("shapes"), shapes },
+        { QStringLiteral("failed"), failed },
+        { QStringLiteral("job_ms"), m_jobClock.nsecsElapsed() / 1e6 },
+        { QStringLiteral("total_ms"), processMs() },
+        });
+    QCoreApplication::exit(failed == 0 ? 0 : 1);
+}
+
+double HeadlessRunner::processMs() const {
+    return m_startOffsetMs + m_processClock.nsecsElapsed() / 1e6;
+}
+
+void HeadlessRunner::emitEvent(const QString& event, QJsonObject fields) {
+    fields.insert(QStringLiteral("event"), event);
+    fields.insert(QStringLiteral("t_ms"), processMs());
+    const QByteArray line = QJsonDocument(fields).toJson(QJsonDocument::Compact) + '\n';
+    std::fwrite(line.constData(), 1, static_cast<size_t>(line.size()), stdout);
+    std::fflush(stdout);
+}
+
+int runHeadless(int argc, char* argv[], const QElapsedTimer& processClock) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("FiveAxisQt6"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Run a FiveAxis job without the GUI."));
+    parser.addHelpOption();
+    const QCommandLineOption headlessOption(QStringLiteral("headless"), QStringLiteral("Run without the GUI."));
+    const QCommandLineOption modeOption(QStringLiteral("mode"),
+        QStringLiteral("local: generate and stream frames here; grpc: submit to the controller service."),
+        QStringLiteral("local|grpc"), QStringLiteral("local"));
+    const QCommandLineOption endpointOption(QStringLiteral("endpoint"), QStringLiteral("gRPC endpoint."),
+        QStringLiteral("url"), QStringLiteral("grpc://localhost:50051"));
+    const QCommandLineOption streamHostOption(QStringLiteral("stream-host"),
+        QStringLiteral("Frame stream target (default: built-in controller address)."), QStringLiteral("ip"));
+    const QCommandLineOption streamPortOption(QStringLiteral("stream-port"), QStringLiteral("Frame stream port."),
+        QStringLiteral("port"), QStringLiteral("7"));
+    const QCommandLineOption metricsFileOption(QStringLiteral("metrics-file"),
+        QStringLiteral("Rewrite this file with the current metrics while the job runs."), QStringLiteral("path"));
+    const QCommandLineOption metricsFormatOption(QStringLiteral("metrics-format"), QStringLiteral("Metrics file format."),
+        QStringLiteral("json|prometheus"), QStringLiteral("json"));
+    const QCommandLineOption metricsIntervalOption(QStringLiteral("metrics-interval"),
+        QStringLiteral("Metrics file update interval."), QStringLiteral("ms"), QStringLiteral("5000"));
+    const QCommandLineOption metricsPortOption(QStringLiteral("metrics-port"),
+        QStringLiteral("Serve /metrics and /metrics.json on 127.0.0.1 at this port."), QStringLiteral("port"));
+    const QCommandLineOption realtimeOption(QStringLiteral("realtime"),
+        QStringLiteral("Lock the frames in memory and stream under SCHED_FIFO (local mode)."));
+    const QCommandLineOption realtimeCpuOption(QStringLiteral("realtime-cpu"),
+        QStringLiteral("Pin the streaming thread to this core."), QStringLiteral("n"));
+    const QCommandLineOption realtimePriorityOption(QStringLiteral("realtime-priority"),
+        QStringLiteral("SCHED_FIFO priority of the streaming thread."), QStringLiteral("1-99"), QStringLiteral("80"));
+    parser.addOptions({ headlessOption, modeOption, endpointOption, streamHostOption, streamPortOption, metricsFileOption,
+        metricsFormatOption, metricsIntervalOption, metricsPortOption, realtimeOption, realtimeCpuOption,
+        realtimePriorityOption });
+    parser.addPositionalArgument(QStringLiteral("job"), QStringLiteral("Job file (.faxj, or JSON form of JobData)."));
+    parser.process(app);
+
+    const QStringList positional = parser.positionalArguments();
+    const QString mode = parser.value(modeOption);
+    const QString metricsFormat = parser.value(metricsFormatOption);
+    if (positional.size() != 1 || (mode != QStringLiteral("local") && mode != QStringLiteral("grpc"))
+        || (metricsFormat != QStringLiteral("json") && metricsFormat != QStringLiteral("prometheus"))) {
+        std::fputs(qPrintable(parser.helpText()), stderr);
+        return 2;
+    }
+
+    HeadlessRunner::Options options;
+    options.jobPath = positional.first();
+    options.mode = mode == QStringLiteral("grpc") ? HeadlessRunner::Mode::Grpc : HeadlessRunner::Mode::Local;
+    options.endpoint = QUrl(parser.value(endpointOption));
+    options.streamHost = parser.value(streamHostOption);
+    options.streamPort = static_cast<quint16>(parser.value(streamPortOption).toUInt());
+    options.metricsFile = parser.value(metricsFileOption);
+    options.metricsFormat = metricsFormat == QStringLiteral("prometheus") ? MetricsExporter::Format::Prometheus
+        : MetricsExporter::Format::Json;
+    options.metricsIntervalMs = parser.value(metricsIntervalOption).toInt();
+    options.metricsPort = static_cast<quint16>(parser.value(metricsPortOption).toUInt());
+    options.realtime.enabled = parser.isSet(realtimeOption);
+    options.realtime.cpu = parser.isSet(realtimeCpuOption) ? parser.value(realtimeCpuOption).toInt() : -1;
+    options.realtime.priority = parser.value(realtimePriorityOption).toInt();
+
+    HeadlessRunner runner(options, processClock);
+    QTimer::singleShot(0, &runner, &HeadlessRunner::start);
+    return app.exec();
+}
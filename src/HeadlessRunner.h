@@ -0,0 +1,85 @@
+#pragma once
+
+#include <memory>
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QString>
+#include <QThread>
+#include <QUrl>
+
+#include "five_axis.pb.h"
+#include "metrics/MetricsExporter.h"
+#include "Processing/RealtimeMode.h"
+
+class DataBuffer;
+class FiveAxisClient;
+class JobFile;
+class QJsonObject;
+class TcpSocketWorker;
+
+// Unattended job execution without creating a QApplication, windows or an OpenGL context (the
+// binary still links and statically initialises Widgets and VTK):
+//   FiveAxisQt6 --headless [--mode local|grpc] [--endpoint grpc://host:port]
+//               [--stream-host ip] [--stream-port n]
+//               [--metrics-file path [--metrics-format json|prometheus] [--metrics-interval ms]]
+//               [--metrics-port n] [--realtime [--realtime-cpu n] [--realtime-priority n]] job.json
+// The job file is either a binary .faxj job (see JobFile) or the JSON form of JobData. Progress and timings are written
+// to stdout as one JSON object per line, timed from process start; the exit code is non-zero on any failure. Metrics
+// are exported from their own thread, so the file keeps updating and scrapes are answered while generation blocks the
+// main thread. --realtime locks the frames in memory and runs the streaming thread under SCHED_FIFO (see
+// RealtimeOptions) for local jobs.
+class HeadlessRunner : public QObject {
+    Q_OBJECT
+public:
+    enum class Mode {
+        Local,
+        Grpc,
+    };
+
+    struct Options {
+        QString jobPath;
+        Mode mode{ Mode::Local };
+        QUrl endpoint{ QStringLiteral("grpc://localhost:50051") };
+        QString streamHost;
+        quint16 streamPort{ 7 };
+        QString metricsFile;
+        MetricsExporter::Format metricsFormat{ MetricsExporter::Format::Json };
+        int metricsIntervalMs{ 5000 };
+        // 0 leaves the HTTP endpoint off.
+        quint16 metricsPort{ 0 };
+        RealtimeOptions realtime;
+    };
+
+    HeadlessRunner(const Options& options, const QElapsedTimer& processClock, QObject* parent = nullptr);
+    ~HeadlessRunner() override;
+
+public slots:
+    void start();
+
+private:
+    void startMetrics();
+    bool loadJob();
+    void runLocal();
+    void runGrpc();
+    void waitForStreamDrain(int shapes, int failed);
+    void finish(int shapes, int failed);
+    // Milliseconds since the process started, not since main().
+    double processMs() const;
+    void emitEvent(const QString& event, QJsonObject fields);
+
+    Options m_options;
+    QElapsedTimer m_processClock;
+    // Time between process start and m_processClock starting in main(); 0 where unknown.
+    double m_startOffsetMs{};
+    QElapsedTimer m_jobClock;
+    JobData m_job;
+    std::unique_ptr<JobFile> m_jobFile;
+    FiveAxisClient* m_client{};
+    std::unique_ptr<DataBuffer> m_buffer;
+    std::unique_ptr<TcpSocketWorker> m_streamer;
+    QThread m_metricsThread;
+    MetricsExporter* m_metrics{};
+};
+
+int runHeadless(int argc, char* argv[], const QElapsedTimer& processClock);
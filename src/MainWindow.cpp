@@ -1,30 +1,176 @@
 #include "MainWindow.h"
 #include "view/DrawingPanel.h"
+#include "view/FleetPanel.h"
+#include "view/JobQueuePanel.h"
+#include "view/LogView.h"
+#include "view/MetricsPanel.h"
+#include "view/RpcStatsPanel.h"
+#include "view/ToolpathOverlay.h"
+#include "mesh/MeshSlicer.h"
+#include "mesh/SliceBenchmark.h"
+#include "mesh/StlBenchmark.h"
+#include "mesh/StlParser.h"
+#include "Processing/DataBuffer.h"
+#include "Processing/JobCompiler.h"
+#include "Processing/JobCompilerBenchmark.h"
+#include "Processing/RealtimeJitterBenchmark.h"
+#include "Processing/ShmRingBenchmark.h"
+#include "Processing/StopLatencyBenchmark.h"
+#include "Processing/JobFile.h"
+#include "Processing/JobFileBenchmark.h"
+#include "Processing/ShapeGenerator.h"
+#include "Processing/ThreeAxisGenerator.h"
 #include "Processing/TcpSocketWorker.h"
+#include "scene/ShapeStore.h"
+#include "scene/ShapeStoreBenchmark.h"
+#include "metrics/MetricsExporter.h"
+#include "metrics/MetricsRegistry.h"
+#include "metrics/Trace.h"
+#include "metrics/TraceBenchmark.h"
+#include "daemon/DaemonProtocol.h"
+#include "daemon/StreamDaemonClient.h"
+#include "grpc/FleetBenchmark.h"
+#include "grpc/SceneBatchBenchmark.h"
+#include "grpc/SettingsChannelBenchmark.h"
+
+#include <algorithm>
+#include <memory>
 
 #include <QAction>
 #include <QApplication>
 #include <QCheckBox>
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QDir>
 #include <QDockWidget>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileDialog>
+#include <QFileInfo>
 #include <QFormLayout>
 #include <QHBoxLayout>
+#include <QInputDialog>
 #include <QLabel>
 #include <QMenu>
 #include <QMenuBar>
 #include <QPushButton>
+#include <QRandomGenerator>
+#include <QSignalBlocker>
 #include <QStatusBar>
 #include <QTabWidget>
-#include <QTextEdit>
+#include <QTemporaryDir>
+#include <QTemporaryFile>
+#include <QThread>
+#include <QThreadPool>
 #include <QStringList>
 #include <QVBoxLayout>
 
+namespace {
+    // Oldest log entries are evicted beyond this, however long the session runs.
+    constexpr int LOG_CAPACITY = 100000;
+    constexpr int PAN_BENCHMARK_SHAPES = 50000;
+    constexpr int PAN_BENCHMARK_FRAMES = 600;
+    // Shapes added per event-loop pass while the pan benchmark scene is built.
+    constexpr int PAN_BENCHMARK_CHUNK = 2000;
+    constexpr qint64 LOG_BENCHMARK_ENTRIES = 2000000;
+    constexpr int LOG_BENCHMARK_CAPACITY = 1000000;
+    // Drags refresh the job totals at most this often; each refresh rebuilds the scene batch.
+    constexpr int JOB_TOTALS_INTERVAL_MS = 250;
+
+    // Per-shape overrides from the shape store; 0 keeps the value the property tab filled in.
+    template <typename Request>
+    void applyProcessOverrides(Request& request, double speed, int times) {
+        if (speed > 0.0) {
+            request.set_speed(speed);
+        }
+        if (times > 0) {
+            request.set_times(times);
+        }
+    }
+}
+
 MainWindow::MainWindow(QWidget* parent)
     : QMainWindow(parent)
-    , m_client(new FiveAxisClient(this)) {
+    , m_client(new FiveAxisClient(this))
+    , m_fleet(new FleetDispatcher(this))
+    , m_compiler(std::make_shared<JobCompiler>())
+    , m_localStream(std::make_shared<LocalStream>()) {
     buildUi();
 
+    m_jobTotalsTimer.setSingleShot(true);
+    m_jobTotalsTimer.setInterval(JOB_TOTALS_INTERVAL_MS);
+    connect(&m_jobTotalsTimer, &QTimer::timeout, this, &MainWindow::refreshJobTotals);
+
     connect(m_client, &FiveAxisClient::replyReceived, this, &MainWindow::onReply);
     connect(m_client, &FiveAxisClient::errorReceived, this, &MainWindow::onError);
+    connect(m_client, &FiveAxisClient::slowRequest, this, &MainWindow::onSlowRequest);
+    connect(m_client, &FiveAxisClient::sceneFinished, this, [this](int shapes, int failed, double elapsedMs) {
+        m_log->append(failed > 0 ? LogModel::Severity::Warning : LogModel::Severity::Info,
+            tr("[ProcessScene] %1 shapes finished, %2 failed, %3 ms")
+            .arg(shapes).arg(failed).arg(elapsedMs, 0, 'f', 1));
+        });
+    connect(m_client, &FiveAxisClient::settingsSkipped, this, [this](const QString& operation) {
+        m_log->append(tr("[%1] Skipped: machine already has these values").arg(operation));
+        });
+    connect(m_fleet, &FleetDispatcher::replyReceived, this, &MainWindow::onFleetReply);
+    connect(m_fleet, &FleetDispatcher::errorReceived, this, &MainWindow::onFleetError);
+
+    connect(m_daemon, &StreamDaemonClient::statusReceived, this, [this](const QJsonObject& status) {
+        m_daemonStatus->setText(tr("Daemon: %1, %2 frames sent, %3 in ring, %4 jobs queued")
+            .arg(status.value(QStringLiteral("connected")).toBool() ? tr("streaming") : tr("controller offline"))
+            .arg(status.value(QStringLiteral("frames_written")).toInteger())
+            .arg(status.value(QStringLiteral("ring_pending")).toInt())
+            .arg(status.value(QStringLiteral("jobs_queued")).toInt()));
+        });
+    connect(m_daemon, &StreamDaemonClient::jobSubmitted, this, [this](const QString& path, int queued) {
+        if (m_daemonJobFiles.remove(path)) {
+            QFile::remove(path);
+        }
+        m_log->append(tr("Streaming daemon queued %1 (%2 jobs waiting)").arg(QFileInfo(path).fileName()).arg(queued));
+        });
+    connect(m_daemon, &StreamDaemonClient::jobRejected, this, [this](const QString& path, const QString& message) {
+        if (m_daemonJobFiles.remove(path)) {
+            QFile::remove(path);
+        }
+        m_log->append(LogModel::Severity::Error, tr("Streaming daemon rejected %1: %2").arg(QFileInfo(path).fileName(), message));
+        });
+    connect(m_daemon, &StreamDaemonClient::streamInterrupted, this, [this](const QString& command, const QJsonObject& reply) {
+        if (!reply.contains(QStringLiteral("cut"))) {
+            return;
+        }
+        m_log->append(tr("[daemon %1] %2, %3 queued frames dropped, park records out after %4 ms")
+            .arg(command)
+            .arg(reply.value(QStringLiteral("cut")).toBool() ? tr("frame cut") : tr("no frame on the wire"))
+            .arg(reply.value(QStringLiteral("frames_dropped")).toInt())
+            .arg(reply.value(QStringLiteral("park_ms")).toDouble(), 0, 'f', 1));
+        });
+    connect(m_daemon, &StreamDaemonClient::requestFailed, this, [this](const QString& command, const QString& message) {
+        m_log->append(LogModel::Severity::Warning, tr("[daemon %1] %2").arg(command, message));
+        });
+    connect(m_daemon, &StreamDaemonClient::daemonLost, this, [this](int framesQueued, qint64 framesLost) {
+        const QSignalBlocker blocker(m_actionDaemon);
+        m_actionDaemon->setChecked(false);
+        m_daemonStatus->hide();
+        m_log->append(LogModel::Severity::Error,
+            tr("Streaming daemon went away; %1 frames already in its ring are lost, %2 queued frames go out from this process instead")
+            .arg(framesLost)
+            .arg(framesQueued));
+        });
+}
+
+MainWindow::~MainWindow() {
+    if (m_streamThread.joinable()) {
+        // As before, a running stream finishes its job before the process exits; a paused one
+        // never would, so it is aborted.
+        if (m_actionPauseLocal->isChecked()) {
+            {
+                QMutexLocker locker(&m_localStream->mutex);
+                m_localStream->paused = false;
+            }
+            interruptLocalStream(true);
+        }
+        m_streamThread.join();
+    }
 }
 
 void MainWindow::buildUi() {
@@ -32,18 +178,24 @@ void MainWindow::buildUi() {
     resize(1280, 720);
 
     m_splitter = new QSplitter(this);
-    m_projectTree = new QTreeWidget(m_splitter);
-    m_projectTree->setHeaderLabel(QStringLiteral("Objects"));
+    m_projectTree = new QTreeView(m_splitter);
+    m_scenePreview = new DrawingPanel(m_splitter);
+    m_projectModel = new ShapeTreeModel(m_scenePreview->shapeStore(), this);
+    m_projectTree->setModel(m_projectModel);
+    m_projectTree->setUniformRowHeights(true);
+    m_projectTree->setSelectionMode(QAbstractItemView::ExtendedSelection);
     m_projectTree->setContextMenuPolicy(Qt::CustomContextMenu);
-    m_sceneRoot = new QTreeWidgetItem(QStringList(QStringLiteral("SCENE")));
-    m_projectTree->addTopLevelItem(m_sceneRoot);
-    connect(m_projectTree, &QTreeWidget::customContextMenuRequested, this, &MainWindow::showProjectContextMenu);
-    connect(m_projectTree, &QTreeWidget::itemSelectionChanged, this, &MainWindow::onProjectSelectionChanged);
+    m_projectTree->expand(m_projectModel->sceneIndex());
+    connect(m_projectModel, &QAbstractItemModel::modelReset, this, [this]() {
+        m_projectTree->expand(m_projectModel->sceneIndex());
+        });
+    connect(m_projectTree, &QTreeView::customContextMenuRequested, this, &MainWindow::showProjectContextMenu);
+    connect(m_projectTree->selectionModel(), &QItemSelectionModel::selectionChanged, this, &MainWindow::onProjectSelectionChanged);
 
-    m_scenePreview = new DrawingPanel(m_splitter);
     connect(m_scenePreview, &DrawingPanel::shapeCreated, this, &MainWindow::onShapeCreated);
     connect(m_scenePreview, &DrawingPanel::shapeSelected, this, &MainWindow::onShapeSelected);
-    connect(m_scenePreview, &DrawingPanel::shapeMoved, this, &MainWindow::onShapeMoved);
+    connect(m_scenePreview, &DrawingPanel::shapesMoved, this, &MainWindow::onShapesMoved);
+    connect(m_scenePreview, &DrawingPanel::shapesSelected, this, &MainWindow::onShapesSelected);
     connect(m_scenePreview, &DrawingPanel::shapeRemoved, this, &MainWindow::onShapeRemoved);
 
     m_propertyTabs = new QTabWidget(m_splitter);
@@ -59,15 +211,91 @@ void MainWindow::buildUi() {
     m_splitter->setStretchFactor(1, 2);
     setCentralWidget(m_splitter);
 
-    m_log = new QTextEdit(this);
-    m_log->setReadOnly(true);
+    m_log = new LogModel(LOG_CAPACITY, this);
     auto dockLog = new QDockWidget(tr("Processing Log"), this);
-    dockLog->setWidget(m_log);
+    dockLog->setWidget(new LogView(m_log, this));
     addDockWidget(Qt::BottomDockWidgetArea, dockLog);
 
+    auto* fleetPanel = new FleetPanel(m_fleet, this);
+    connect(fleetPanel, &FleetPanel::controllerConnected, this, [this](int index, const QString& details) {
+        m_log->append(tr("Fleet controller %1 connected:\n%2").arg(m_fleet->status(index).name, details));
+        });
+    auto dockFleet = new QDockWidget(tr("Controllers"), this);
+    dockFleet->setWidget(fleetPanel);
+    addDockWidget(Qt::BottomDockWidgetArea, dockFleet);
+    tabifyDockWidget(dockLog, dockFleet);
+
+    auto dockRpc = new QDockWidget(tr("RPC Timing"), this);
+    dockRpc->setWidget(new RpcStatsPanel(&m_client->stats(), this));
+    addDockWidget(Qt::BottomDockWidgetArea, dockRpc);
+    tabifyDockWidget(dockLog, dockRpc);
+
+    m_daemon = new StreamDaemonClient(DataBuffer::instance(), &TcpSocketWorker::instance().frameTap(), this);
+    m_daemonStatus = new QLabel(this);
+    m_daemonStatus->hide();
+    statusBar()->addPermanentWidget(m_daemonStatus);
+    m_jobQueue = new JobQueuePanel(m_daemon, this);
+    auto dockJobs = new QDockWidget(tr("Job Queue"), this);
+    dockJobs->setWidget(m_jobQueue);
+    addDockWidget(Qt::BottomDockWidgetArea, dockJobs);
+    tabifyDockWidget(dockLog, dockJobs);
+
+    m_metricsExporter = new MetricsExporter(MetricsRegistry::instance(), this);
+    auto dockMetrics = new QDockWidget(tr("Metrics"), this);
+    dockMetrics->setWidget(new MetricsPanel(&MetricsRegistry::instance(), m_metricsExporter, this));
+    addDockWidget(Qt::BottomDockWidgetArea, dockMetrics);
+    tabifyDockWidget(dockLog, dockMetrics);
+    dockLog->raise();
+
+    m_modelViewer = new ModelViewerWidget(this);
+    auto dockModel = new QDockWidget(tr("3D Model"), this);
+    dockModel->setWidget(m_modelViewer);
+    addDockWidget(Qt::RightDockWidgetArea, dockModel);
+    // Loads run in the background, so their outcome only reaches the user through these.
+    connect(m_modelViewer, &ModelViewerWidget::modelLoadProgress, this, [this](const QString& filePath, double fraction) {
+        statusBar()->showMessage(tr("Loading %1: %2%").arg(QFileInfo(filePath).fileName()).arg(qRound(fraction * 100)));
+        });
+    connect(m_modelViewer, &ModelViewerWidget::modelLoaded, this, [this](const QString& filePath) {
+        statusBar()->showMessage(tr("Loaded %1").arg(QFileInfo(filePath).fileName()), 3000);
+        });
+    connect(m_modelViewer, &ModelViewerWidget::modelLoadTimed, this,
+        [this](const QString& filePath, double readMs, double displayMs, double maxStallMs, qint64 points) {
+        m_log->append(tr("Loaded model %1: %2 points, read %3 ms, display %4 ms, longest UI stall %5 ms")
+            .arg(filePath)
+            .arg(points)
+            .arg(readMs, 0, 'f', 1)
+            .arg(displayMs, 0, 'f', 1)
+            .arg(maxStallMs, 0, 'f', 1));
+        });
+    connect(m_modelViewer, &ModelViewerWidget::modelLodReady, this,
+        [this](const QString& filePath, const QList<qint64>& levelTriangles, bool fromCache, double buildMs) {
+        QStringList levels;
+        for (const qint64 triangles : levelTriangles) {
+            levels.append(QString::number(triangles));
+        }
+        m_log->append(tr("Model %1: interaction levels of %2 triangles, %3 in %4 ms")
+            .arg(QFileInfo(filePath).fileName())
+            .arg(levels.join(QStringLiteral(" / ")))
+            .arg(fromCache ? tr("from cache") : tr("decimated"))
+            .arg(buildMs, 0, 'f', 1));
+        });
+    connect(m_modelViewer, &ModelViewerWidget::modelLodFailed, this, [this](const QString& filePath, const QString& reason) {
+        m_log->append(LogModel::Severity::Warning, tr("Model %1 interaction levels: %2")
+            .arg(QFileInfo(filePath).fileName(), reason));
+        });
+    connect(m_modelViewer, &ModelViewerWidget::modelLoadFailed, this, [this](const QString& filePath, const QString& reason) {
+        statusBar()->showMessage(tr("Cannot load %1").arg(QFileInfo(filePath).fileName()), 5000);
+        m_log->append(LogModel::Severity::Error, tr("Failed to load model %1: %2").arg(filePath, reason));
+        });
+
     auto fileMenu = menuBar()->addMenu(tr("Connect"));
     auto actionConnect = fileMenu->addAction(tr("Connect gRPC Service"));
     connect(actionConnect, &QAction::triggered, this, &MainWindow::connectToServer);
+    m_actionUseFleet = fileMenu->addAction(tr("Dispatch jobs to controller fleet"));
+    m_actionUseFleet->setCheckable(true);
+    m_actionDaemon = fileMenu->addAction(tr("Stream through daemon"));
+    m_actionDaemon->setCheckable(true);
+    connect(m_actionDaemon, &QAction::toggled, this, &MainWindow::setDaemonStreaming);
 	fileMenu->addSeparator();
 	/*m_actionStartTcp = fileMenu->addAction(tr("Start TCP"));
 	m_actionStopTcp = fileMenu->addAction(tr("Stop TCP"));
@@ -80,6 +308,76 @@ void MainWindow::buildUi() {
     
     connect(actionImport, &QAction::triggered, this, &MainWindow::importModel);
     connect(actionSample, &QAction::triggered, this, &MainWindow::showSampleModel);
+    auto actionLiveToolpath = modelMenu->addAction(tr("Live toolpath while streaming"));
+    actionLiveToolpath->setCheckable(true);
+    connect(actionLiveToolpath, &QAction::toggled, this, &MainWindow::setLiveToolpathVisible);
+    auto actionSlice = modelMenu->addAction(tr("Slice STL into toolpath ..."));
+    connect(actionSlice, &QAction::triggered, this, &MainWindow::sliceModel);
+
+    auto sceneMenu = menuBar()->addMenu(tr("Scene"));
+    auto actionSubmitScene = sceneMenu->addAction(tr("Submit whole scene"));
+    connect(actionSubmitScene, &QAction::triggered, this, &MainWindow::sendScene);
+    auto actionCompileScene = sceneMenu->addAction(tr("Compile scene"));
+    connect(actionCompileScene, &QAction::triggered, this, &MainWindow::compileScene);
+    auto actionRunLocally = sceneMenu->addAction(tr("Run scene locally"));
+    connect(actionRunLocally, &QAction::triggered, this, &MainWindow::runSceneLocally);
+    m_actionToolpath = sceneMenu->addAction(tr("Show generated toolpath"));
+    m_actionToolpath->setCheckable(true);
+    connect(m_actionToolpath, &QAction::toggled, this, &MainWindow::setToolpathOverlayVisible);
+    connect(m_scenePreview->toolpathOverlay(), &ToolpathOverlay::pathReady, this,
+        [this](const QString& id, int samples, double elapsedMs) {
+        statusBar()->showMessage(tr("Toolpath %1: %2 samples in %3 ms").arg(id).arg(samples).arg(elapsedMs, 0, 'f', 1), 3000);
+        });
+    sceneMenu->addSeparator();
+    auto actionOpenJob = sceneMenu->addAction(tr("Open job ..."));
+    connect(actionOpenJob, &QAction::triggered, this, &MainWindow::openJob);
+    auto actionSaveJob = sceneMenu->addAction(tr("Save job ..."));
+    connect(actionSaveJob, &QAction::triggered, this, &MainWindow::saveJob);
+    m_actionPauseLocal = sceneMenu->addAction(tr("Pause local stream"));
+    m_actionPauseLocal->setCheckable(true);
+    connect(m_actionPauseLocal, &QAction::toggled, this, &MainWindow::setLocalStreamPaused);
+    auto actionAbortLocal = sceneMenu->addAction(tr("Abort local stream"));
+    connect(actionAbortLocal, &QAction::triggered, this, &MainWindow::abortLocalStream);
+    auto actionQueueJob = sceneMenu->addAction(tr("Queue job file in daemon ..."));
+    connect(actionQueueJob, &QAction::triggered, this, &MainWindow::queueJobFile);
+    auto actionTransform = sceneMenu->addAction(tr("Transform all shapes ..."));
+    connect(actionTransform, &QAction::triggered, this, &MainWindow::transformShapes);
+
+    auto diagnosticsMenu = menuBar()->addMenu(tr("Diagnostics"));
+    auto actionPanBenchmark = diagnosticsMenu->addAction(tr("Pan benchmark (50k shapes)"));
+    connect(actionPanBenchmark, &QAction::triggered, this, &MainWindow::runPanBenchmark);
+    auto actionStlBenchmark = diagnosticsMenu->addAction(tr("STL reader benchmark ..."));
+    connect(actionStlBenchmark, &QAction::triggered, this, &MainWindow::runStlBenchmark);
+    auto actionSliceBenchmark = diagnosticsMenu->addAction(tr("Slice benchmark ..."));
+    connect(actionSliceBenchmark, &QAction::triggered, this, &MainWindow::runSliceBenchmark);
+    auto actionLogBenchmark = diagnosticsMenu->addAction(tr("Log append benchmark (1M entries)"));
+    connect(actionLogBenchmark, &QAction::triggered, this, &MainWindow::runLogBenchmark);
+    auto actionStoreBenchmark = diagnosticsMenu->addAction(tr("Shape store benchmark (100k shapes)"));
+    connect(actionStoreBenchmark, &QAction::triggered, this, &MainWindow::runShapeStoreBenchmark);
+    auto actionSceneBatchBenchmark = diagnosticsMenu->addAction(tr("Scene export benchmark (100k shapes)"));
+    connect(actionSceneBatchBenchmark, &QAction::triggered, this, &MainWindow::runSceneBatchBenchmark);
+    auto actionJobFileBenchmark = diagnosticsMenu->addAction(tr("Job file round trip (1M shapes)"));
+    connect(actionJobFileBenchmark, &QAction::triggered, this, &MainWindow::runJobFileBenchmark);
+    auto actionPickBenchmark = diagnosticsMenu->addAction(tr("Pick benchmark (100k shapes)"));
+    connect(actionPickBenchmark, &QAction::triggered, this, &MainWindow::runPickBenchmark);
+    auto actionCompileBenchmark = diagnosticsMenu->addAction(tr("Incremental compile benchmark (10k shapes)"));
+    connect(actionCompileBenchmark, &QAction::triggered, this, &MainWindow::runIncrementalCompileBenchmark);
+    auto actionTraceBenchmark = diagnosticsMenu->addAction(tr("Trace overhead benchmark"));
+    connect(actionTraceBenchmark, &QAction::triggered, this, &MainWindow::runTraceBenchmark);
+    auto actionJitterBenchmark = diagnosticsMenu->addAction(tr("Real-time streaming jitter benchmark"));
+    connect(actionJitterBenchmark, &QAction::triggered, this, &MainWindow::runRealtimeJitterBenchmark);
+    auto actionShmBenchmark = diagnosticsMenu->addAction(tr("Shared-memory ring benchmark (200 frames)"));
+    connect(actionShmBenchmark, &QAction::triggered, this, &MainWindow::runShmRingBenchmark);
+    auto actionStopBenchmark = diagnosticsMenu->addAction(tr("Stop latency benchmark (controller simulator)"));
+    connect(actionStopBenchmark, &QAction::triggered, this, &MainWindow::runStopLatencyBenchmark);
+    auto actionSettingsBenchmark = diagnosticsMenu->addAction(tr("Settings coalescing check (100k updates)"));
+    connect(actionSettingsBenchmark, &QAction::triggered, this, &MainWindow::runSettingsChannelBenchmark);
+    auto actionFleetBenchmark = diagnosticsMenu->addAction(tr("Fleet dispatch check (3 controller simulators)"));
+    connect(actionFleetBenchmark, &QAction::triggered, this, &MainWindow::runFleetBenchmark);
+    diagnosticsMenu->addSeparator();
+    m_actionTrace = diagnosticsMenu->addAction(tr("Record pipeline trace"));
+    m_actionTrace->setCheckable(true);
+    connect(m_actionTrace, &QAction::toggled, this, &MainWindow::setTraceRecording);
 
     statusBar()->showMessage(tr("Not connected"));
 }
@@ -93,6 +391,61 @@ void MainWindow::connectToServer() {
 
 void MainWindow::sendLine() {
     LineData request;
+    fillLineFromTab(request);
+    request.set_islast(true);
+
+    if (m_actionUseFleet->isChecked() && m_fleet->controllerCount() > 0) {
+        const int index = m_fleet->dispatchLine(request);
+        m_log->append(tr("Dispatched line process to %1: %2").arg(m_fleet->status(index).name, formatLine(request)));
+        return;
+    }
+    m_client->processLine(request);
+    m_log->append(tr("Submitted line process: %1").arg(formatLine(request)));
+}
+
+void MainWindow::sendCircle() {
+    CircleData request;
+    fillCircleFromTab(request);
+    request.set_islast(true);
+
+    if (m_actionUseFleet->isChecked() && m_fleet->controllerCount() > 0) {
+        const int index = m_fleet->dispatchCircle(request);
+        m_log->append(tr("Dispatched circle/concentric process to %1: %2").arg(m_fleet->status(index).name, formatCircle(request)));
+        return;
+    }
+    m_client->processCircle(request);
+    m_log->append(tr("Submitted circle/concentric process: %1").arg(formatCircle(request)));
+}
+
+void MainWindow::sendRectangle() {
+    RectangleData request;
+    fillRectangleFromTab(request);
+    request.set_islast(true);
+
+    if (m_actionUseFleet->isChecked() && m_fleet->controllerCount() > 0) {
+        const int index = m_fleet->dispatchRectangle(request);
+        m_log->append(tr("Dispatched rectangle process to %1: %2").arg(m_fleet->status(index).name, formatRectangle(request)));
+        return;
+    }
+    m_client->processRectangle(request);
+    m_log->append(tr("Submitted rectangle process: %1").arg(formatRectangle(request)));
+}
+
+void MainWindow::sendEllipse() {
+    EllipseData request;
+    fillEllipseFromTab(request);
+    request.set_islast(true);
+
+    if (m_actionUseFleet->isChecked() && m_fleet->controllerCount() > 0) {
+        const int index = m_fleet->dispatchEllipse(request);
+        m_log->append(tr("Dispatched ellipse process to %1: %2").arg(m_fleet->status(index).name, formatEllipse(request)));
+        return;
+    }
+    m_client->processEllipse(request);
+    m_log->append(tr("Submitted ellipse process: %1").arg(formatEllipse(request)));
+}
+
+void MainWindow::fillLineFromTab(LineData& request) const {
     request.set_speed(m_lineSpeed->value());
     request.set_times(m_lineTimes->value());
     request.set_x1(m_lineX1->value());
@@ -105,14 +458,9 @@ void MainWindow::sendLine() {
     request.set_z2(m_lineZ2->value());
     request.set_a2(m_lineA2->value());
     request.set_b2(m_lineB2->value());
-    request.set_islast(true);
-
-    m_client->processLine(request);
-    m_log->append(tr("Submitted line process: %1").arg(formatLine(request)));
 }
 
-void MainWindow::sendCircle() {
-    CircleData request;
+void MainWindow::fillCircleFromTab(CircleData& request) const {
     request.set_speed(m_circleSpeed->value());
     request.set_times(m_circleTimes->value());
     request.set_x1(m_circleX1->value());
@@ -130,14 +478,9 @@ void MainWindow::sendCircle() {
     request.set_z_interval(m_circleZInterval->value());
     request.set_circle_num_repair(m_circleRepairNum->value());
     request.set_times_repair(m_circleRepairTimes->value());
-    request.set_islast(true);
-
-    m_client->processCircle(request);
-    m_log->append(tr("Submitted circle/concentric process: %1").arg(formatCircle(request)));
 }
 
-void MainWindow::sendRectangle() {
-    RectangleData request;
+void MainWindow::fillRectangleFromTab(RectangleData& request) const {
     request.set_x0(m_rectX0->value());
     request.set_y0(m_rectY0->value());
     request.set_x1(m_rectX1->value());
@@ -155,14 +498,9 @@ void MainWindow::sendRectangle() {
     request.set_times_repair(m_rectRepairTimes->value());
     request.set_x2(m_rectX2->value());
     request.set_y2(m_rectY2->value());
-    request.set_islast(true);
-
-    m_client->processRectangle(request);
-    m_log->append(tr("Submitted rectangle process: %1").arg(formatRectangle(request)));
 }
 
-void MainWindow::sendEllipse() {
-    EllipseData request;
+void MainWindow::fillEllipseFromTab(EllipseData& request) const {
     request.set_speed(m_ellipseSpeed->value());
     request.set_times(m_ellipseTimes->value());
     request.set_x0(m_ellipseX0->value());
@@ -180,30 +518,1370 @@ void MainWindow::sendEllipse() {
     request.set_z_interval(m_ellipseZInterval->value());
     request.set_circle_num_repair(m_ellipseRepairNum->value());
     request.set_times_repair(m_ellipseRepairTimes->value());
-    request.set_islast(true);
-
-    m_client->processEllipse(request);
-    m_log->append(tr("Submitted ellipse process: %1").arg(formatEllipse(request)));
 }
 
-void MainWindow::applyDelay() {
-    DelayData request;
+void MainWindow::fillDelayFromTab(DelayData& request) const {
     request.set_jump_speed(m_jumpSpeed->value());
     request.set_laser_on_delay(m_laserOnDelay->value());
     request.set_laser_off_delay(m_laserOffDelay->value());
     request.set_mark_delay(m_markDelay->value());
     request.set_jump_delay(m_jumpDelay->value());
     request.set_polygon_delay(m_polygonDelay->value());
+}
+
+void MainWindow::loadLineIntoTab(const LineData& request) {
+    m_lineSpeed->setValue(request.speed());
+    m_lineTimes->setValue(request.times());
+    m_lineX1->setValue(request.x1());
+    m_lineY1->setValue(request.y1());
+    m_lineZ1->setValue(request.z1());
+    m_lineA1->setValue(request.a1());
+    m_lineB1->setValue(request.b1());
+    m_lineX2->setValue(request.x2());
+    m_lineY2->setValue(request.y2());
+    m_lineZ2->setValue(request.z2());
+    m_lineA2->setValue(request.a2());
+    m_lineB2->setValue(request.b2());
+}
+
+void MainWindow::loadCircleIntoTab(const CircleData& request) {
+    m_circleSpeed->setValue(request.speed());
+    m_circleTimes->setValue(request.times());
+    m_circleX1->setValue(request.x1());
+    m_circleY1->setValue(request.y1());
+    m_circleX2->setValue(request.x2());
+    m_circleY2->setValue(request.y2());
+    m_circleM->setValue(request.m());
+    m_circleAngle->setValue(request.angle());
+    m_circleTaper->setValue(request.taper());
+    m_circleFilled->setChecked(request.filled());
+    m_circleRMin->setValue(request.r_min());
+    m_circleRInterval->setValue(request.r_interval());
+    m_circleZStart->setValue(request.z_start());
+    m_circleZEnd->setValue(request.z_end());
+    m_circleZInterval->setValue(request.z_interval());
+    m_circleRepairNum->setValue(request.circle_num_repair());
+    m_circleRepairTimes->setValue(request.times_repair());
+}
+
+void MainWindow::loadRectangleIntoTab(const RectangleData& request) {
+    m_rectX0->setValue(request.x0());
+    m_rectY0->setValue(request.y0());
+    m_rectX1->setValue(request.x1());
+    m_rectY1->setValue(request.y1());
+    m_rectTaperA->setValue(request.taper_a_max());
+    m_rectTaperB->setValue(request.taper_b_max());
+    m_rectFeedX->setValue(request.feedspacing_x());
+    m_rectFeedY->setValue(request.feedspacing_y());
+    m_rectSpeed->setValue(request.speed());
+    m_rectZStart->setValue(request.z_start());
+    m_rectZEnd->setValue(request.z_end());
+    m_rectZInterval->setValue(request.z_interval());
+    m_rectTimes->setValue(request.times());
+    m_rectRepairNum->setValue(request.circle_num_repair());
+    m_rectRepairTimes->setValue(request.times_repair());
+    m_rectX2->setValue(request.x2());
+    m_rectY2->setValue(request.y2());
+}
+
+void MainWindow::loadEllipseIntoTab(const EllipseData& request) {
+    m_ellipseSpeed->setValue(request.speed());
+    m_ellipseTimes->setValue(request.times());
+    m_ellipseX0->setValue(request.x0());
+    m_ellipseY0->setValue(request.y0());
+    m_ellipseAMax->setValue(request.a_max());
+    m_ellipseBMax->setValue(request.b_max());
+    m_ellipseAMin->setValue(request.a_min());
+    m_ellipseBMin->setValue(request.b_min());
+    m_ellipseTaperA->setValue(request.taper_a_max());
+    m_ellipseTaperB->setValue(request.taper_b_max());
+    m_ellipseFeedX->setValue(request.feedspacing_x());
+    m_ellipseFeedY->setValue(request.feedspacing_y());
+    m_ellipseZStart->setValue(request.z_start());
+    m_ellipseZEnd->setValue(request.z_end());
+    m_ellipseZInterval->setValue(request.z_interval());
+    m_ellipseRepairNum->setValue(request.circle_num_repair());
+    m_ellipseRepairTimes->setValue(request.times_repair());
+}
+
+void MainWindow::fillLineFromStore(int row, LineData& request) const {
+    const ShapeStore* store = m_scenePreview->shapeStore();
+    fillLineFromTab(request);
+    const QPointF p1 = store->p1(row);
+    const QPointF p2 = store->p2(row);
+    request.set_x1(p1.x());
+    request.set_y1(p1.y());
+    request.set_x2(p2.x());
+    request.set_y2(p2.y());
+    applyProcessOverrides(request, store->speed(row), store->times(row));
+}
+
+void MainWindow::fillCircleFromStore(int row, CircleData& request) const {
+    const ShapeStore* store = m_scenePreview->shapeStore();
+    fillCircleFromTab(request);
+    const QRectF rect = store->bounds(row);
+    const auto center = rect.center();
+    request.set_x1(center.x());
+    request.set_y1(center.y());
+    request.set_x2(center.x() + rect.width() / 2.0);
+    request.set_y2(center.y());
+    applyProcessOverrides(request, store->speed(row), store->times(row));
+}
+
+void MainWindow::fillRectangleFromStore(int row, RectangleData& request) const {
+    const ShapeStore* store = m_scenePreview->shapeStore();
+    fillRectangleFromTab(request);
+    const QRectF rect = store->bounds(row);
+    request.set_x0(rect.left());
+    request.set_y0(rect.top());
+    request.set_x1(rect.right());
+    request.set_y1(rect.bottom());
+    applyProcessOverrides(request, store->speed(row), store->times(row));
+}
+
+void MainWindow::fillEllipseFromStore(int row, EllipseData& request) const {
+    const ShapeStore* store = m_scenePreview->shapeStore();
+    fillEllipseFromTab(request);
+    const QRectF rect = store->bounds(row);
+    const auto center = rect.center();
+    request.set_x0(center.x());
+    request.set_y0(center.y());
+    request.set_a_max(rect.width() / 2.0);
+    request.set_b_max(rect.height() / 2.0);
+    applyProcessOverrides(request, store->speed(row), store->times(row));
+}
+
+int MainWindow::buildSceneBatch(SceneBatch& batch) const {
+    const ShapeStore* store = m_scenePreview->shapeStore();
+    int skipped = 0;
+    for (int row = 0; row < store->size(); ++row) {
+        switch (store->kind(row)) {
+        case ShapeStore::Kind::Line:
+            fillLineFromStore(row, *batch.addLine());
+            break;
+        case ShapeStore::Kind::Circle:
+            fillCircleFromStore(row, *batch.addCircle());
+            break;
+        case ShapeStore::Kind::Rectangle:
+            fillRectangleFromStore(row, *batch.addRectangle());
+            break;
+        case ShapeStore::Kind::Ellipse:
+            fillEllipseFromStore(row, *batch.addEllipse());
+            break;
+        default:
+            ++skipped;
+            break;
+        }
+    }
+    batch.finalize();
+    return skipped;
+}
+
+void MainWindow::sendScene() {
+    QElapsedTimer timer;
+    timer.start();
+
+    auto batch = std::make_unique<SceneBatch>();
+    const int skipped = buildSceneBatch(*batch);
+
+    const int shapes = batch->shapeCount();
+    if (shapes == 0) {
+        m_log->append(LogModel::Severity::Warning, tr("Scene is empty, nothing submitted"));
+        return;
+    }
+    const qint64 buildUs = timer.nsecsElapsed() / 1000;
+    const double arenaKb = batch->arenaBytesAllocated() / 1024.0;
+    m_client->processScene(std::move(batch));
+    m_log->append(tr("Submitted scene: %1 shapes (%2 without a process type skipped), built in %3 ms, arena %4 KB")
+        .arg(shapes)
+        .arg(skipped)
+        .arg(buildUs / 1000.0, 0, 'f', 2)
+        .arg(arenaKb, 0, 'f', 1));
+}
+
+void MainWindow::compileScene() {
+    startCompile(false);
+}
+
+void MainWindow::runSceneLocally() {
+    startCompile(true);
+}
+
+void MainWindow::refreshJobTotals() {
+    if (m_compiler->cacheSize() == 0) {
+        return;
+    }
+    if (m_compileRunning) {
+        m_compileAgain = true;
+        return;
+    }
+    startCompile(false, true);
+}
+
+void MainWindow::startCompile(bool runLocally, bool quiet) {
+    if (m_compileRunning) {
+        m_log->append(LogModel::Severity::Warning, tr("Scene compile already running"));
+        return;
+    }
+    auto batch = std::make_shared<SceneBatch>();
+    const int untyped = buildSceneBatch(*batch);
+    if (batch->shapeCount() == 0) {
+        if (!quiet) {
+            m_log->append(LogModel::Severity::Warning, tr("Scene is empty, nothing compiled"));
+        }
+        return;
+    }
+    const bool viaDaemon = runLocally && m_daemon->isConnected();
+    if (runLocally && !viaDaemon && m_actionPauseLocal->isChecked()) {
+        m_log->append(LogModel::Severity::Warning, tr("Local stream is paused; resume or abort it first"));
+        return;
+    }
+    if (runLocally && !viaDaemon && m_streamThread.joinable()) {
+        m_log->append(LogModel::Severity::Warning, tr("Local stream still running; wait for it or abort it first"));
+        return;
+    }
+    m_compileRunning = true;
+    const int freq = m_freq->value();
+    QThreadPool::globalInstance()->start([this, compiler = m_compiler, batch, untyped, runLocally, quiet, freq,
+        viaDaemon]() {
+        auto result = std::make_shared<JobCompiler::Result>(compiler->compile(batch->scene()));
+        QString daemonJob;
+        QString daemonError;
+        if (viaDaemon && result->records > 0) {
+            // The daemon streams the job from its own mapping, so it survives this window closing.
+            QTemporaryFile file(QDir::temp().filePath(QStringLiteral("fiveaxis-job-XXXXXX.faxj")));
+            file.setAutoRemove(false);
+            if (!file.open()) {
+                daemonError = file.errorString();
+            }
+            else {
+                daemonJob = file.fileName();
+                file.close();
+                JobData job;
+                *job.mutable_scene() = batch->scene();
+                job.mutable_freq()->set_freq(freq);
+                const auto records = result->merged();
+                if (!JobFile::save(daemonJob, job, records.data(), static_cast<qint64>(records.size()), daemonError)) {
+                    QFile::remove(daemonJob);
+                    daemonJob.clear();
+                }
+            }
+        }
+        QMetaObject::invokeMethod(this, [this, result, untyped, runLocally, quiet, freq, viaDaemon, daemonJob,
+            daemonError]() {
+            m_compileRunning = false;
+            if (m_compileAgain) {
+                m_compileAgain = false;
+                refreshJobTotals();
+            }
+            if (quiet) {
+                statusBar()->showMessage(tr("Job: %1 shapes, %2 records (%3 regenerated, %4 moved) in %5 ms, %6 skipped")
+                    .arg(result->shapes.size())
+                    .arg(result->records)
+                    .arg(result->compiled)
+                    .arg(result->reoffset)
+                    .arg(result->ms, 0, 'f', 1)
+                    .arg(result->skipped), 3000);
+                return;
+            }
+            m_log->append(tr("Compiled scene: %1 shapes (%2 generated, %3 re-offset, %4 from cache), %5 records in %6 ms")
+                .arg(result->shapes.size())
+                .arg(result->compiled)
+                .arg(result->reoffset)
+                .arg(result->cached)
+                .arg(result->records)
+                .arg(result->ms, 0, 'f', 1));
+            if (untyped > 0) {
+                m_log->append(LogModel::Severity::Warning, tr("%1 shapes without a process type were not compiled").arg(untyped));
+            }
+            if (result->skipped > 0) {
+                const auto first = std::find_if(result->shapes.begin(), result->shapes.end(), [](const auto& shape) {
+                    return !shape->skipReason.isEmpty();
+                    });
+                m_log->append(LogModel::Severity::Warning, tr("%1 shapes the local generators cannot reproduce were skipped (shape %2: %3)")
+                    .arg(result->skipped)
+                    .arg(first - result->shapes.begin() + 1)
+                    .arg((*first)->skipReason));
+            }
+            if (viaDaemon) {
+                if (!daemonError.isEmpty()) {
+                    m_log->append(LogModel::Severity::Error, tr("Cannot hand the scene to the streaming daemon: %1").arg(daemonError));
+                }
+                else if (!daemonJob.isEmpty()) {
+                    // Removed again once the daemon answers.
+                    m_daemonJobFiles.insert(daemonJob);
+                    m_daemon->submitJob(daemonJob, m_jobQueue->priority());
+                }
+            }
+            else if (runLocally && result->records > 0) {
+                startLocalStream(result, freq);
+            }
+            }, Qt::QueuedConnection);
+        });
+}
+
+void MainWindow::startLocalStream(const std::shared_ptr<const JobCompiler::Result>& result, int freq) {
+    {
+        // Set here rather than by the thread, so an abort before it gets going is not lost.
+        QMutexLocker locker(&m_localStream->mutex);
+        m_localStream->streaming = true;
+    }
+    // A thread of its own: the stream lasts as long as the machine takes to run the job, and
+    // DataBuffer blocks it while both frames are in flight, so it must not hold a pool thread.
+    m_streamThread = std::thread([this, localStream = m_localStream, result, freq]() {
+        trace::setThreadName(QStringLiteral("LocalStream"));
+        QElapsedTimer timer;
+        timer.start();
+        const auto records = result->merged();
+        const bool completed = streamLocally(*localStream, reinterpret_cast<const char*>(records.data()),
+            static_cast<qint64>(records.size()), freq);
+        const double streamMs = timer.nsecsElapsed() / 1e6;
+        QMetaObject::invokeMethod(this, [this, completed, streamMs]() {
+            m_streamThread.join();
+            if (completed) {
+                m_log->append(tr("Streamed compiled scene through the local streamer in %1 ms").arg(streamMs, 0, 'f', 1));
+            }
+            else {
+                m_log->append(LogModel::Severity::Warning, tr("Local stream of the compiled scene aborted after %1 ms").arg(streamMs, 0, 'f', 1));
+            }
+            }, Qt::QueuedConnection);
+        });
+}
+
+bool MainWindow::streamLocally(LocalStream& stream, const char* records, qint64 count, int freq) {
+    DataBuffer& buffer = DataBuffer::instance();
+    TcpSocketWorker& streamer = TcpSocketWorker::instance();
+    constexpr qint64 recordSize = sizeof(jobfile::FrameRecord);
+    const qint64 recordsPerFrame = DataBuffer::frameSize() / recordSize;
+    QMutexLocker locker(&stream.mutex);
+    const int sourceId = ++stream.sourceId;
+    locker.unlock();
+
+    buffer.setFreqData(freq);
+    buffer.setSource(sourceId, 0);
+    qint64 sent = 0;
+    bool filled = false;
+    bool aborted = false;
+    // The job stays current until its last frame has been sent, so an interruption during that
+    // frame still rewinds it instead of losing its tail.
+    while (!filled || !buffer.allFramesSent()) {
+        locker.relock();
+        if (stream.interrupted) {
+            stream.interrupted = false;
+            // The streamer has parked the machine; what was queued behind the cut is dropped.
+            buffer.discardQueued();
+            if (stream.resume >= 0) {
+                sent = qMin(stream.resume, count);
+                stream.resume = -1;
+            }
+            while (stream.paused && !stream.abort) {
+                stream.changed.wait(&stream.mutex);
+            }
+            if (stream.abort) {
+                aborted = true;
+                break;
+            }
+            locker.unlock();
+            // Everything was delivered if the cut came after the last record.
+            filled = sent >= count;
+            if (sent < count) {
+                // discardQueued() forgot what the controller last got.
+                buffer.setFreqData(freq);
+                buffer.setSource(sourceId, sent);
+                buffer.addResumeRecords(records + sent * recordSize);
+            }
+            streamer.resumeStream();
+            continue;
+        }
+        locker.unlock();
+        if (sent < count) {
+            const qint64 n = qMin(recordsPerFrame, count - sent);
+            buffer.addRecords(records + sent * recordSize, n);
+            sent += n;
+        }
+        else if (!filled) {
+            buffer.forceFill();
+            filled = true;
+        }
+        else {
+            QThread::msleep(10);
+        }
+    }
+
+    if (!aborted) {
+        locker.relock();
+    }
+    // An interruption after the last frame went out has nothing left to cut.
+    if (stream.interrupted) {
+        stream.interrupted = false;
+        buffer.discardQueued();
+    }
+    stream.streaming = false;
+    stream.abort = false;
+    buffer.setSource(0, 0);
+    if (aborted) {
+        streamer.resumeStream();
+    }
+    return !aborted;
+}
+
+void MainWindow::interruptLocalStream(bool abort) {
+    LocalStream& stream = *m_localStream;
+    QMutexLocker locker(&stream.mutex);
+    // Blocks for at most one write chunk; the stream thread's writes meanwhile are discarded.
+    const TcpSocketWorker::Interruption interruption = TcpSocketWorker::instance().interrupt();
+    if (stream.streaming) {
+        stream.resume = interruption.sourceId == stream.sourceId ? interruption.resumePosition : -1;
+        stream.interrupted = true;
+        stream.abort = abort;
+        stream.changed.wakeAll();
+    }
+    else {
+        // Nothing is feeding the buffer, so drop what it holds here.
+        DataBuffer::instance().discardQueued();
+        if (abort) {
+            TcpSocketWorker::instance().resumeStream();
+        }
+    }
+    m_log->append(tr("Local stream %1: %2, %3 queued frames dropped, park records out after %4 ms")
+        .arg(abort ? tr("aborted") : tr("paused"))
+        .arg(interruption.cut ? tr("frame cut") : tr("no frame on the wire"))
+        .arg(interruption.framesDropped)
+        .arg(interruption.parkMs, 0, 'f', 1));
+}
+
+void MainWindow::setLocalStreamPaused(bool paused) {
+    if (m_daemon->isConnected()) {
+        const QSignalBlocker blocker(m_actionPauseLocal);
+        m_actionPauseLocal->setChecked(false);
+        m_log->append(LogModel::Severity::Warning, tr("Jobs stream through the daemon; pause them from the job queue"));
+        return;
+    }
+    if (paused) {
+        {
+            QMutexLocker locker(&m_localStream->mutex);
+            m_localStream->paused = true;
+        }
+        interruptLocalStream(false);
+        return;
+    }
+    LocalStream& stream = *m_localStream;
+    QMutexLocker locker(&stream.mutex);
+    stream.paused = false;
+    if (stream.streaming) {
+        // The stream thread resumes from the first record not sent.
+        stream.changed.wakeAll();
+    }
+    else {
+        TcpSocketWorker::instance().resumeStream();
+    }
+    m_log->append(tr("Local stream resumed"));
+}
+
+void MainWindow::abortLocalStream() {
+    if (m_daemon->isConnected()) {
+        m_log->append(LogModel::Severity::Warning, tr("Jobs stream through the daemon; abort them from the job queue"));
+        return;
+    }
+    {
+        QMutexLocker locker(&m_localStream->mutex);
+        m_localStream->paused = false;
+    }
+    const QSignalBlocker blocker(m_actionPauseLocal);
+    m_actionPauseLocal->setChecked(false);
+    interruptLocalStream(true);
+}
+
+void MainWindow::saveJob() {
+    const QString path = QFileDialog::getSaveFileName(this, tr("Save job"), QString(), tr("FiveAxis job (*.faxj)"));
+    if (path.isEmpty()) {
+        return;
+    }
+    QElapsedTimer timer;
+    timer.start();
+
+    SceneBatch batch;
+    const int skipped = buildSceneBatch(batch);
+    JobData job;
+    *job.mutable_scene() = batch.scene();
+    fillDelayFromTab(*job.mutable_delay());
+    job.mutable_freq()->set_freq(m_freq->value());
+
+    QString error;
+    if (!JobFile::save(path, job, nullptr, 0, error)) {
+        m_log->append(LogModel::Severity::Error, tr("Failed to save job %1: %2").arg(path, error));
+        return;
+    }
+    m_log->append(tr("Saved job %1: %2 shapes (%3 skipped), %4 KB in %5 ms")
+        .arg(path)
+        .arg(batch.shapeCount())
+        .arg(skipped)
+        .arg(QFileInfo(path).size() / 1024.0, 0, 'f', 1)
+        .arg(timer.nsecsElapsed() / 1e6, 0, 'f', 2));
+}
+
+void MainWindow::openJob() {
+    const QString path = QFileDialog::getOpenFileName(this, tr("Open job"), QString(), tr("FiveAxis job (*.faxj)"));
+    if (path.isEmpty()) {
+        return;
+    }
+    QElapsedTimer timer;
+    timer.start();
+    QString error;
+    const auto job = JobFile::open(path, error);
+    if (!job) {
+        m_log->append(LogModel::Severity::Error, tr("Failed to open job %1: %2").arg(path, error));
+        return;
+    }
+    const double mapMs = timer.nsecsElapsed() / 1e6;
+
+    const auto& settings = job->settings();
+    m_jumpSpeed->setValue(settings.jumpSpeed);
+    m_laserOnDelay->setValue(settings.laserOnDelay);
+    m_laserOffDelay->setValue(settings.laserOffDelay);
+    m_markDelay->setValue(settings.markDelay);
+    m_jumpDelay->setValue(settings.jumpDelay);
+    m_polygonDelay->setValue(settings.polygonDelay);
+    if (settings.freq > 0) {
+        m_freq->setValue(settings.freq);
+    }
+
+    // The tabs hold one parameter set per shape type, so the first shape of each type fills them.
+    bool tabLoaded[5] = {};
+    m_bulkLoading = true;
+    // The project tree sees the clear and the whole load as one remove and one insert.
+    ShapeStore* store = m_scenePreview->shapeStore();
+    store->beginBatch();
+    m_scenePreview->clearShapes();
+    for (qint64 i = 0; i < job->shapeCount(); ++i) {
+        const auto ref = job->shapeRef(i);
+        const auto typeIndex = static_cast<int>(ref.type);
+        if (!tabLoaded[typeIndex]) {
+            tabLoaded[typeIndex] = true;
+            SceneShape shape;
+            job->shape(i, shape);
+            switch (ref.type) {
+            case jobfile::ShapeType::Line:
+                loadLineIntoTab(shape.line());
+                break;
+            case jobfile::ShapeType::Circle:
+                loadCircleIntoTab(shape.circle());
+                break;
+            case jobfile::ShapeType::Rectangle:
+                loadRectangleIntoTab(shape.rectangle());
+                break;
+            case jobfile::ShapeType::Ellipse:
+                loadEllipseIntoTab(shape.ellipse());
+                break;
+            }
+        }
+        QString id;
+        double speed = 0.0;
+        int times = 0;
+        switch (ref.type) {
+        case jobfile::ShapeType::Line: {
+            const auto& r = job->line(ref.index);
+            id = m_scenePreview->addShape(DrawingView::Mode::Line, QPointF(r.x1, r.y1), QPointF(r.x2, r.y2));
+            speed = r.speed;
+            times = r.times;
+            break;
+        }
+        case jobfile::ShapeType::Circle: {
+            const auto& r = job->circle(ref.index);
+            id = m_scenePreview->addShape(DrawingView::Mode::Circle, QPointF(r.x1, r.y1), QPointF(r.x2, r.y2));
+            speed = r.speed;
+            times = r.times;
+            break;
+        }
+        case jobfile::ShapeType::Rectangle: {
+            const auto& r = job->rectangle(ref.index);
+            id = m_scenePreview->addShape(DrawingView::Mode::Rectangle, QPointF(r.x0, r.y0), QPointF(r.x1, r.y1));
+            speed = r.speed;
+            times = r.times;
+            break;
+        }
+        case jobfile::ShapeType::Ellipse: {
+            const auto& r = job->ellipse(ref.index);
+            id = m_scenePreview->addShape(DrawingView::Mode::Ellipse, QPointF(r.x0 - r.aMax, r.y0 - r.bMax),
+                QPointF(r.x0 + r.aMax, r.y0 + r.bMax));
+            speed = r.speed;
+            times = r.times;
+            break;
+        }
+        }
+        // Keep each shape's own speed and pass count, so saving the job again round-trips them.
+        if (const int row = store->rowOf(id); row >= 0) {
+            store->setProcess(row, speed, times);
+        }
+    }
+    store->endBatch();
+    m_bulkLoading = false;
+    m_log->append(tr("Opened job %1: %2 shapes, %3 pre-generated records; mapped in %4 ms, scene built in %5 ms")
+        .arg(path)
+        .arg(job->shapeCount())
+        .arg(job->segmentCount())
+        .arg(mapMs, 0, 'f', 2)
+        .arg(timer.nsecsElapsed() / 1e6 - mapMs, 0, 'f', 1));
+}
+
+void MainWindow::runPanBenchmark() {
+    if (m_panBenchmarkRunning) {
+        m_log->append(LogModel::Severity::Warning, tr("Pan benchmark already running"));
+        return;
+    }
+    m_panBenchmarkRunning = true;
+
+    // A throwaway view keeps the benchmark scene out of the user's drawing. Painting can only be
+    // measured on this thread, so the run is split into event-loop passes (a chunk of shapes or
+    // one frame each) instead of a worker.
+    auto* dialog = new QDialog(this);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    dialog->setWindowTitle(tr("Pan benchmark"));
+    auto* layout = new QVBoxLayout(dialog);
+    auto* view = new DrawingView(dialog);
+    layout->addWidget(view);
+    dialog->resize(1024, 768);
+    connect(dialog, &QObject::destroyed, this, [this]() {
+        m_panBenchmarkRunning = false;
+        });
+
+    auto* populate = new QTimer(dialog);
+    connect(populate, &QTimer::timeout, view,
+        [this, dialog, view, populate, random = QRandomGenerator(42), added = 0, populateMs = 0.0]() mutable {
+            const DrawingView::Mode modes[] = {
+                DrawingView::Mode::Line, DrawingView::Mode::Circle, DrawingView::Mode::Rectangle, DrawingView::Mode::Ellipse };
+            QElapsedTimer timer;
+            timer.start();
+            for (const int end = qMin(PAN_BENCHMARK_SHAPES, added + PAN_BENCHMARK_CHUNK); added < end; ++added) {
+                const QPointF start(random.bounded(2000.0) - 1000.0, random.bounded(2000.0) - 1000.0);
+                const QPointF size(2.0 + random.bounded(28.0), 2.0 + random.bounded(28.0));
+                view->addShape(modes[added % 4], start, start + size);
+            }
+            populateMs += timer.nsecsElapsed() / 1e6;
+            if (added < PAN_BENCHMARK_SHAPES) {
+                return;
+            }
+            populate->stop();
+            populate->deleteLater();
+            connect(view, &DrawingView::panBenchmarkFinished, this,
+                [this, dialog, populateMs](const DrawingView::PanBenchmarkResult& result) {
+                    m_log->append(tr("Pan benchmark: %1 shapes (built in %2 ms), %3 frames: mean %4 ms, p50 %5 ms, "
+                                     "p95 %6 ms, max %7 ms")
+                        .arg(result.items)
+                        .arg(populateMs, 0, 'f', 1)
+                        .arg(result.frames)
+                        .arg(result.meanMs, 0, 'f', 2)
+                        .arg(result.p50Ms, 0, 'f', 2)
+                        .arg(result.p95Ms, 0, 'f', 2)
+                        .arg(result.maxMs, 0, 'f', 2));
+                    dialog->close();
+                });
+            dialog->show();
+            view->scale(2.0, 2.0);
+            view->startPanBenchmark(PAN_BENCHMARK_FRAMES);
+        });
+    populate->start(0);
+}
+
+void MainWindow::runLogBenchmark() {
+    if (m_logBenchmarkRunning) {
+        m_log->append(LogModel::Severity::Warning, tr("Log benchmark already running"));
+        return;
+    }
+    m_logBenchmarkRunning = true;
+
+    // A separate model, so the benchmark neither floods nor evicts the real log. It measures the
+    // view, so it runs here a batch per event-loop pass rather than on a worker.
+    auto* dialog = new QDialog(this);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    dialog->setWindowTitle(tr("Log append benchmark"));
+    auto* layout = new QVBoxLayout(dialog);
+    auto* model = new LogModel(LOG_BENCHMARK_CAPACITY, dialog);
+    auto* view = new LogView(model, dialog);
+    layout->addWidget(view);
+    dialog->resize(1024, 600);
+    connect(dialog, &QObject::destroyed, this, [this]() {
+        m_logBenchmarkRunning = false;
+        });
+    connect(view, &LogView::appendBenchmarkFinished, this, [this, dialog](const LogView::AppendBenchmarkResult& result) {
+        m_log->append(tr("Log benchmark: %1 entries into a %2 entry ring in %3 ms; append p50 %4 ns, p99 %5 ns while filling, "
+                         "p50 %6 ns, p99 %7 ns while evicting; flush + repaint per 1000 entries p50 %8 ms, p99 %9 ms, max %10 ms")
+            .arg(result.entries)
+            .arg(result.capacity)
+            .arg(result.totalMs, 0, 'f', 0)
+            .arg(result.fillP50Ns, 0, 'f', 0)
+            .arg(result.fillP99Ns, 0, 'f', 0)
+            .arg(result.wrapP50Ns, 0, 'f', 0)
+            .arg(result.wrapP99Ns, 0, 'f', 0)
+            .arg(result.flushP50Ms, 0, 'f', 2)
+            .arg(result.flushP99Ms, 0, 'f', 2)
+            .arg(result.flushMaxMs, 0, 'f', 2));
+        dialog->close();
+        });
+    dialog->show();
+    view->startAppendBenchmark(LOG_BENCHMARK_ENTRIES, 1000);
+}
+
+void MainWindow::transformShapes() {
+    ShapeStore* store = m_scenePreview->shapeStore();
+    if (store->size() == 0) {
+        return;
+    }
+    QDialog dialog(this);
+    dialog.setWindowTitle(tr("Transform all shapes"));
+    auto* layout = new QFormLayout(&dialog);
+    auto* dx = new QDoubleSpinBox(&dialog);
+    auto* dy = new QDoubleSpinBox(&dialog);
+    for (auto* spin : { dx, dy }) {
+        spin->setRange(-100000, 100000);
+        spin->setDecimals(3);
+    }
+    auto* factor = new QDoubleSpinBox(&dialog);
+    factor->setRange(0.001, 1000.0);
+    factor->setDecimals(3);
+    factor->setValue(1.0);
+    auto* buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+    layout->addRow(tr("Move X"), dx);
+    layout->addRow(tr("Move Y"), dy);
+    layout->addRow(tr("Scale (about the scene centre)"), factor);
+    layout->addRow(buttons);
+    connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    if (dialog.exec() != QDialog::Accepted) {
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    const int last = store->size() - 1;
+    if (factor->value() != 1.0) {
+        store->scale(0, last, factor->value(), store->sceneBounds().center());
+    }
+    if (dx->value() != 0.0 || dy->value() != 0.0) {
+        store->translate(0, last, dx->value(), dy->value());
+    }
+    if (m_actionToolpath->isChecked()) {
+        setToolpathOverlayVisible(true);
+    }
+    m_log->append(tr("Transformed %1 shapes in %2 ms").arg(store->size()).arg(timer.nsecsElapsed() / 1e6, 0, 'f', 1));
+}
+
+void MainWindow::runShapeStoreBenchmark() {
+    if (m_shapeStoreBenchmarkRunning) {
+        m_log->append(LogModel::Severity::Warning, tr("Shape store benchmark already running"));
+        return;
+    }
+    m_shapeStoreBenchmarkRunning = true;
+    QThreadPool::globalInstance()->start([this]() {
+        const auto result = ShapeStoreBenchmark::run(100000);
+        QMetaObject::invokeMethod(this, [this, result]() {
+            // QGraphicsScene belongs to the GUI thread, so only the baseline runs here.
+            const auto items = ShapeStoreBenchmark::runItems(result.shapes);
+            m_shapeStoreBenchmarkRunning = false;
+            m_log->append(tr("Shape store benchmark, %1 shapes: append %2 ms, translate %3 ms, scale %4 ms, translate every 10th %5 ms, "
+                             "read geometry %6 ms, scene bounds %7 ms, remove half %8 ms; QGraphicsItems: create %9 ms, "
+                             "moveBy %10 ms, read geometry %11 ms")
+                .arg(result.shapes)
+                .arg(result.appendMs, 0, 'f', 2)
+                .arg(result.translateMs, 0, 'f', 3)
+                .arg(result.scaleMs, 0, 'f', 3)
+                .arg(result.subsetTranslateMs, 0, 'f', 3)
+                .arg(result.readMs, 0, 'f', 3)
+                .arg(result.boundsMs, 0, 'f', 3)
+                .arg(result.removeHalfMs, 0, 'f', 2)
+                .arg(items.createMs, 0, 'f', 2)
+                .arg(items.translateMs, 0, 'f', 3)
+                .arg(items.readMs, 0, 'f', 3));
+            }, Qt::QueuedConnection);
+        });
+}
+
+void MainWindow::runSceneBatchBenchmark() {
+    if (m_sceneBatchBenchmarkRunning) {
+        m_log->append(LogModel::Severity::Warning, tr("Scene export benchmark already running"));
+        return;
+    }
+    m_sceneBatchBenchmarkRunning = true;
+    QThreadPool::globalInstance()->start([this]() {
+        const auto result = SceneBatchBenchmark::run(100000);
+        QMetaObject::invokeMethod(this, [this, result]() {
+            m_sceneBatchBenchmarkRunning = false;
+            const bool complete = result.heapReceived == result.shapes && result.arenaReceived == result.shapes;
+            m_log->append(complete ? LogModel::Severity::Info : LogModel::Severity::Warning,
+                tr("Scene export benchmark, %1 shapes: per-shape messages %2 ms, %3 allocations, %4 KB; "
+                   "arena batch %5 ms, %6 allocations, %7 KB")
+                .arg(result.shapes)
+                .arg(result.heapMs, 0, 'f', 2)
+                .arg(result.heapAllocations)
+                .arg(result.heapBytes / 1024.0, 0, 'f', 1)
+                .arg(result.arenaMs, 0, 'f', 2)
+                .arg(result.arenaAllocations)
+                .arg(result.arenaBytes / 1024.0, 0, 'f', 1));
+            }, Qt::QueuedConnection);
+        });
+}
+
+void MainWindow::runJobFileBenchmark() {
+    if (m_jobFileBenchmarkRunning) {
+        m_log->append(LogModel::Severity::Warning, tr("Job file round trip already running"));
+        return;
+    }
+    m_jobFileBenchmarkRunning = true;
+    QThreadPool::globalInstance()->start([this]() {
+        const auto result = JobFileBenchmark::run();
+        QMetaObject::invokeMethod(this, [this, result]() {
+            m_jobFileBenchmarkRunning = false;
+            if (!result.error.isEmpty()) {
+                m_log->append(LogModel::Severity::Warning, tr("Job file round trip: %1").arg(result.error));
+                return;
+            }
+            m_log->append(tr("Job file round trip, %1 shapes and %2 segments (%3 MB): save %4 ms, open %5 ms, "
+                             "read mapped %6 ms, copy to protobuf %7 ms")
+                .arg(result.shapes)
+                .arg(result.segments)
+                .arg(result.fileBytes / 1e6, 0, 'f', 1)
+                .arg(result.saveMs, 0, 'f', 1)
+                .arg(result.openMs, 0, 'f', 2)
+                .arg(result.readMs, 0, 'f', 1)
+                .arg(result.toJobDataMs, 0, 'f', 1));
+            if (result.roundTrip()) {
+                m_log->append(tr("Job file round trip: every shape, setting and segment matches"));
+            }
+            else {
+                m_log->append(LogModel::Severity::Warning, tr("Job file round trip: %1 shapes differ (first at %2), settings %3, segments %4")
+                    .arg(result.mismatches)
+                    .arg(result.firstMismatch)
+                    .arg(result.settingsMatch ? tr("match") : tr("differ"))
+                    .arg(result.segmentsMatch ? tr("match") : tr("differ")));
+            }
+            }, Qt::QueuedConnection);
+        });
+}
+
+void MainWindow::runPickBenchmark() {
+    if (m_pickBenchmarkRunning) {
+        m_log->append(LogModel::Severity::Warning, tr("Pick benchmark already running"));
+        return;
+    }
+    m_pickBenchmarkRunning = true;
+    QThreadPool::globalInstance()->start([this]() {
+        const auto result = ShapeStoreBenchmark::runPicking(100000, 10000);
+        QMetaObject::invokeMethod(this, [this, result]() {
+            const auto scene = ShapeStoreBenchmark::runScenePicking(result.shapes, result.picks);
+            m_pickBenchmarkRunning = false;
+            m_log->append(tr("Pick benchmark, %1 shapes, %2 picks: R-tree build %3 ms (height %4), pick mean %5 us, p99 %6 us, "
+                             "rubber band %7 us, move 1% %8 ms; QGraphicsScene BSP: build %9 ms, items(point) mean %10 us, p99 %11 us")
+                .arg(result.shapes)
+                .arg(result.picks)
+                .arg(result.buildMs, 0, 'f', 2)
+                .arg(result.height)
+                .arg(result.pickMeanUs, 0, 'f', 2)
+                .arg(result.pickP99Us, 0, 'f', 2)
+                .arg(result.rubberBandUs, 0, 'f', 1)
+                .arg(result.moveMs, 0, 'f', 2)
+                .arg(scene.buildMs, 0, 'f', 2)
+                .arg(scene.pickMeanUs, 0, 'f', 2)
+                .arg(scene.pickP99Us, 0, 'f', 2));
+            }, Qt::QueuedConnection);
+        });
+}
+
+void MainWindow::runIncrementalCompileBenchmark() {
+    if (m_compileBenchmarkRunning) {
+        m_log->append(LogModel::Severity::Warning, tr("Incremental compile benchmark already running"));
+        return;
+    }
+    m_compileBenchmarkRunning = true;
+    QThreadPool::globalInstance()->start([this]() {
+        const auto result = JobCompilerBenchmark::run(10000);
+        QMetaObject::invokeMethod(this, [this, result]() {
+            m_compileBenchmarkRunning = false;
+            m_log->append(tr("Incremental compile benchmark, %1 shapes, %2 records: full compile %3 ms; move %4 shapes %5 ms "
+                             "(%6 generated, %7 re-offset, max deviation %8 counts); edit one shape %9 ms (%10 generated)")
+                .arg(result.shapes)
+                .arg(result.records)
+                .arg(result.fullMs, 0, 'f', 1)
+                .arg(result.moved)
+                .arg(result.moveMs, 0, 'f', 2)
+                .arg(result.moveGenerated)
+                .arg(result.moveReoffset)
+                .arg(result.maxDeviation)
+                .arg(result.editMs, 0, 'f', 2)
+                .arg(result.editGenerated));
+            for (const QString& failure : result.failures) {
+                m_log->append(LogModel::Severity::Warning, tr("Incremental compile check failed: %1").arg(failure));
+            }
+            }, Qt::QueuedConnection);
+        });
+}
+
+void MainWindow::runTraceBenchmark() {
+    if (trace::isEnabled()) {
+        m_log->append(LogModel::Severity::Warning, tr("Stop the pipeline trace before measuring its overhead"));
+        return;
+    }
+    if (m_traceBenchmarkRunning) {
+        m_log->append(LogModel::Severity::Warning, tr("Trace overhead benchmark already running"));
+        return;
+    }
+    // The benchmark starts and stops the trace itself; recording must wait until it is done.
+    m_traceBenchmarkRunning = true;
+    m_actionTrace->setEnabled(false);
+    QThreadPool::globalInstance()->start([this]() {
+        const auto result = TraceBenchmark::run(5);
+        QMetaObject::invokeMethod(this, [this, result]() {
+            m_traceBenchmarkRunning = false;
+            m_actionTrace->setEnabled(true);
+            m_log->append(tr("Trace overhead benchmark, %1 samples, %2 events per round: off %3 ms, on %4 ms, overhead %5%; "
+                             "%6 ns per event, %7 ns per scope while off")
+                .arg(result.samples)
+                .arg(result.eventsPerRound)
+                .arg(result.offMs, 0, 'f', 2)
+                .arg(result.onMs, 0, 'f', 2)
+                .arg(result.overheadPercent, 0, 'f', 2)
+                .arg(result.nsPerEvent, 0, 'f', 1)
+                .arg(result.nsPerDisabledScope, 0, 'f', 2));
+            }, Qt::QueuedConnection);
+        });
+}
+
+void MainWindow::runRealtimeJitterBenchmark() {
+    if (m_jitterBenchmarkRunning) {
+        m_log->append(LogModel::Severity::Warning, tr("Jitter benchmark already running"));
+        return;
+    }
+    // Every core is kept busy for the whole run; keep the GUI thread out of it.
+    m_jitterBenchmarkRunning = true;
+    m_log->append(tr("Jitter benchmark started: 5 s as streaming runs today, 5 s in real-time mode, all cores loaded"));
+    QThreadPool::globalInstance()->start([this]() {
+        RealtimeOptions options;
+        options.enabled = true;
+        options.cpu = QThread::idealThreadCount() - 1;
+        const auto result = RealtimeJitterBenchmark::run(options, 5);
+        QMetaObject::invokeMethod(this, [this, result]() {
+            m_jitterBenchmarkRunning = false;
+            for (const auto* run : { &result.normal, &result.realtime }) {
+                m_log->append(tr("Jitter benchmark (%1), %2 wake-ups every %3 us under %4 busy threads: late by "
+                                 "p50 %5 us, p99 %6 us, p99.9 %7 us, max %8 us; slowest frame pass %9 us")
+                    .arg(run->setup)
+                    .arg(run->wakeups)
+                    .arg(result.periodUs)
+                    .arg(result.loadThreads)
+                    .arg(run->p50Us, 0, 'f', 1)
+                    .arg(run->p99Us, 0, 'f', 1)
+                    .arg(run->p999Us, 0, 'f', 1)
+                    .arg(run->maxUs, 0, 'f', 1)
+                    .arg(run->frameMaxUs, 0, 'f', 1));
+            }
+            for (const QString& warning : result.warnings) {
+                m_log->append(LogModel::Severity::Warning, tr("Real-time mode: %1").arg(warning));
+            }
+            }, Qt::QueuedConnection);
+        });
+}
+
+void MainWindow::runShmRingBenchmark() {
+    if (m_shmBenchmarkRunning) {
+        m_log->append(LogModel::Severity::Warning, tr("Shared-memory ring benchmark already running"));
+        return;
+    }
+    m_shmBenchmarkRunning = true;
+    QThreadPool::globalInstance()->start([this]() {
+        const auto result = ShmRingBenchmark::run(200);
+        QMetaObject::invokeMethod(this, [this, result]() {
+            m_shmBenchmarkRunning = false;
+            m_log->append(tr("Shared-memory ring benchmark, %1 frames (%2 MB): in-process %3 ms (%4 MB/s)")
+                .arg(result.frames)
+                .arg(result.bytes / 1e6, 0, 'f', 1)
+                .arg(result.inProcessMs, 0, 'f', 1)
+                .arg(result.inProcessMBps(), 0, 'f', 0));
+            if (!result.error.isEmpty()) {
+                m_log->append(LogModel::Severity::Warning, tr("Shared-memory ring benchmark: %1").arg(result.error));
+                return;
+            }
+            m_log->append(tr("Shared-memory ring benchmark, through the ring: %1 ms (%2 MB/s)")
+                .arg(result.shmMs, 0, 'f', 1)
+                .arg(result.shmMBps(), 0, 'f', 0));
+            }, Qt::QueuedConnection);
+        });
+}
+
+void MainWindow::runStopLatencyBenchmark() {
+    if (m_stopLatencyBenchmarkRunning) {
+        m_log->append(LogModel::Severity::Warning, tr("Stop latency benchmark already running"));
+        return;
+    }
+    m_stopLatencyBenchmarkRunning = true;
+    QThreadPool::globalInstance()->start([this]() {
+        const auto result = StopLatencyBenchmark::run();
+        QMetaObject::invokeMethod(this, [this, result]() {
+            m_stopLatencyBenchmarkRunning = false;
+            if (!result.error.isEmpty()) {
+                m_log->append(LogModel::Severity::Warning, tr("Stop latency benchmark: %1").arg(result.error));
+                return;
+            }
+            m_log->append(tr("Stop latency benchmark, %1 us/record: stop %2 ms to quiet, interrupt %3 ms (%4, park records out after %5 ms, %6 queued frames dropped)")
+                .arg(result.recordUs)
+                .arg(result.stopQuietMs, 0, 'f', 1)
+                .arg(result.interruptQuietMs, 0, 'f', 1)
+                .arg(result.cut ? tr("frame cut") : tr("no frame cut"))
+                .arg(result.parkMs, 0, 'f', 1)
+                .arg(result.framesDropped));
+            const auto severity = result.resumeExact() ? LogModel::Severity::Info : LogModel::Severity::Warning;
+            m_log->append(severity, tr("Stop latency benchmark: resume at record %1, controller executed %2")
+                .arg(result.resumePosition)
+                .arg(result.recordsExecuted));
+            }, Qt::QueuedConnection);
+        });
+}
+
+void MainWindow::runSettingsChannelBenchmark() {
+    if (m_settingsBenchmarkRunning) {
+        m_log->append(LogModel::Severity::Warning, tr("Settings coalescing check already running"));
+        return;
+    }
+    m_settingsBenchmarkRunning = true;
+    // Runs its own client and event loop, so it must not share the GUI thread.
+    QThreadPool::globalInstance()->start([this]() {
+        const auto result = SettingsChannelBenchmark::run();
+        QMetaObject::invokeMethod(this, [this, result]() {
+            m_settingsBenchmarkRunning = false;
+            m_log->append(result.bounded() ? LogModel::Severity::Info : LogModel::Severity::Warning,
+                tr("Settings coalescing check, %1 updates over %2 jobs: %3 coalesced, %4 settings calls, "
+                   "at most %5 batches pending with %6 jobs waiting (%7) in %8 ms")
+                .arg(result.updates)
+                .arg(result.jobs)
+                .arg(result.coalesced)
+                .arg(result.settingsCalls)
+                .arg(result.maxPending)
+                .arg(result.maxJobBacklog)
+                .arg(result.bounded() ? tr("bounded") : result.drained ? tr("unbounded") : tr("not drained"))
+                .arg(result.ms, 0, 'f', 2));
+            }, Qt::QueuedConnection);
+        });
+}
+
+void MainWindow::runFleetBenchmark() {
+    if (m_fleetBenchmarkRunning) {
+        m_log->append(LogModel::Severity::Warning, tr("Fleet dispatch check already running"));
+        return;
+    }
+    m_fleetBenchmarkRunning = true;
+    QThreadPool::globalInstance()->start([this]() {
+        const auto result = FleetBenchmark::run();
+        QMetaObject::invokeMethod(this, [this, result]() {
+            m_fleetBenchmarkRunning = false;
+            for (const auto& controller : result.controllers) {
+                m_log->append(tr("Fleet dispatch check, %1: %2 jobs assigned, %3 retired, %4 frames streamed, %5 executed")
+                    .arg(controller.name)
+                    .arg(controller.assigned)
+                    .arg(controller.completed)
+                    .arg(controller.framesWritten)
+                    .arg(controller.framesReceived));
+            }
+            if (!result.error.isEmpty()) {
+                m_log->append(LogModel::Severity::Warning, tr("Fleet dispatch check: %1").arg(result.error));
+                return;
+            }
+            const bool ok = result.allCompleted() && result.framesMatch() && result.spread();
+            m_log->append(ok ? LogModel::Severity::Info : LogModel::Severity::Warning,
+                tr("Fleet dispatch check: %1 jobs over %2 controllers in %3 ms (%4, %5, %6)")
+                .arg(result.jobs)
+                .arg(result.controllers.size())
+                .arg(result.elapsedMs, 0, 'f', 1)
+                .arg(result.allCompleted() ? tr("all retired") : tr("jobs missing"))
+                .arg(result.framesMatch() ? tr("frames match") : tr("frames lost"))
+                .arg(result.spread() ? tr("every controller used") : tr("idle controllers")));
+            }, Qt::QueuedConnection);
+        });
+}
+
+void MainWindow::setDaemonStreaming(bool enabled) {
+    if (!enabled) {
+        m_daemon->disconnectFromDaemon();
+        m_daemonStatus->hide();
+        m_jobQueue->reset();
+        m_log->append(tr("Streaming from this process again"));
+        return;
+    }
+    const QString name = QString::fromLatin1(streamdaemon::DEFAULT_NAME);
+    QString error;
+    if (!m_daemon->connectToDaemon(name, error)) {
+        const QSignalBlocker blocker(m_actionDaemon);
+        m_actionDaemon->setChecked(false);
+        m_log->append(LogModel::Severity::Warning,
+            tr("Cannot stream through the daemon (start it with --stream-daemon): %1").arg(error));
+        return;
+    }
+    m_daemonStatus->setText(tr("Daemon: attached"));
+    m_daemonStatus->show();
+    m_log->append(tr("Streaming through daemon %1").arg(name));
+}
+
+void MainWindow::queueJobFile() {
+    if (!m_daemon->isConnected()) {
+        m_log->append(LogModel::Severity::Warning, tr("Connect > Stream through daemon first; jobs queue in the daemon"));
+        return;
+    }
+    const QString path = QFileDialog::getOpenFileName(this, tr("Queue job"), QString(), tr("FiveAxis job (*.faxj)"));
+    if (path.isEmpty()) {
+        return;
+    }
+    m_daemon->submitJob(QFileInfo(path).absoluteFilePath(), m_jobQueue->priority());
+}
+
+void MainWindow::setTraceRecording(bool recording) {
+    if (recording) {
+        trace::start();
+        m_log->append(tr("Recording pipeline trace"));
+        return;
+    }
+    trace::stop();
+    const auto stats = trace::stats();
+    const QString path = QFileDialog::getSaveFileName(this, tr("Save trace"), QStringLiteral("trace.json"),
+        tr("Chrome trace (*.json)"));
+    if (path.isEmpty()) {
+        m_log->append(tr("Pipeline trace discarded (%1 events)").arg(stats.events));
+        return;
+    }
+    const QByteArray json = trace::toJson();
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(json) != json.size()) {
+        m_log->append(LogModel::Severity::Error, tr("Failed to write trace %1: %2").arg(path, file.errorString()));
+        return;
+    }
+    m_log->append(tr("Saved pipeline trace to %1: %2 events from %3 threads, %4 dropped; open it in ui.perfetto.dev")
+        .arg(path)
+        .arg(stats.events)
+        .arg(stats.threads)
+        .arg(stats.dropped));
+    if (stats.dropped > 0) {
+        m_log->append(LogModel::Severity::Warning, tr("Trace buffers filled up; record a shorter trace to keep every event"));
+    }
+}
+
+void MainWindow::runStlBenchmark() {
+    if (m_stlBenchmarkRunning) {
+        m_log->append(LogModel::Severity::Warning, tr("STL benchmark already running"));
+        return;
+    }
+    bool ok = false;
+    const QString sizes = QInputDialog::getText(this, tr("STL reader benchmark"),
+        tr("Synthetic mesh sizes in millions of triangles:"), QLineEdit::Normal, QStringLiteral("1,10,50"), &ok);
+    if (!ok) {
+        return;
+    }
+    QList<qint64> triangleCounts;
+    for (const QString& part : sizes.split(QLatin1Char(','), Qt::SkipEmptyParts)) {
+        const double millions = part.trimmed().toDouble();
+        if (millions > 0.0) {
+            triangleCounts.append(static_cast<qint64>(millions * 1e6));
+        }
+    }
+    if (triangleCounts.isEmpty()) {
+        return;
+    }
+
+    // Meshes of tens of millions of triangles take a while to write and read; keep the GUI free.
+    m_stlBenchmarkRunning = true;
+    m_log->append(tr("STL benchmark started: %1").arg(sizes));
+    QThreadPool::globalInstance()->start([this, triangleCounts]() {
+        QTemporaryDir dir;
+        for (const qint64 triangles : triangleCounts) {
+            const QString path = dir.filePath(QStringLiteral("bench_%1.stl").arg(triangles));
+            StlBenchmark::Result result;
+            if (!StlBenchmark::writeSynthetic(path, triangles, result.error)) {
+                result.triangles = triangles;
+            }
+            else {
+                result = StlBenchmark::run(path);
+            }
+            QFile::remove(path);
+            QMetaObject::invokeMethod(this, [this, result]() {
+                if (!result.error.isEmpty()) {
+                    m_log->append(LogModel::Severity::Error, tr("STL benchmark %1 triangles failed: %2").arg(result.triangles).arg(result.error));
+                    return;
+                }
+                m_log->append(tr("STL benchmark %1 triangles (%2 MB): FastStlReader %3 ms, %4 MB/s, %5 points, "
+                                 "output %6 MB + %7 MB scratch; vtkSTLReader %8 ms, %9 MB/s, %10 points, output %11 MB")
+                    .arg(result.triangles)
+                    .arg(result.fileBytes / 1e6, 0, 'f', 1)
+                    .arg(result.fastMs, 0, 'f', 1)
+                    .arg(result.fastMBps(), 0, 'f', 0)
+                    .arg(result.fastPoints)
+                    .arg(result.fastOutputKb / 1024.0, 0, 'f', 1)
+                    .arg(result.fastWorkingKb / 1024.0, 0, 'f', 1)
+                    .arg(result.vtkMs, 0, 'f', 1)
+                    .arg(result.vtkMBps(), 0, 'f', 0)
+                    .arg(result.vtkPoints)
+                    .arg(result.vtkOutputKb / 1024.0, 0, 'f', 1));
+                }, Qt::QueuedConnection);
+        }
+        QMetaObject::invokeMethod(this, [this]() {
+            m_stlBenchmarkRunning = false;
+            m_log->append(tr("STL benchmark finished"));
+            }, Qt::QueuedConnection);
+        });
+}
+
+void MainWindow::runSliceBenchmark() {
+    if (m_sliceBenchmarkRunning) {
+        m_log->append(LogModel::Severity::Warning, tr("Slice benchmark already running"));
+        return;
+    }
+    bool ok = false;
+    const QString sizes = QInputDialog::getText(this, tr("Slice benchmark"),
+        tr("Sphere sizes in millions of triangles (1000 layers each):"), QLineEdit::Normal, QStringLiteral("1,10"), &ok);
+    if (!ok) {
+        return;
+    }
+    QList<qint64> triangleCounts;
+    for (const QString& part : sizes.split(QLatin1Char(','), Qt::SkipEmptyParts)) {
+        const double millions = part.trimmed().toDouble();
+        if (millions > 0.0) {
+            triangleCounts.append(static_cast<qint64>(millions * 1e6));
+        }
+    }
+    if (triangleCounts.isEmpty()) {
+        return;
+    }
+
+    m_sliceBenchmarkRunning = true;
+    m_log->append(tr("Slice benchmark started: %1").arg(sizes));
+    QThreadPool::globalInstance()->start([this, triangleCounts]() {
+        constexpr int layers = 1000;
+        for (const qint64 triangles : triangleCounts) {
+            const SliceBenchmark::Result result = SliceBenchmark::run(triangles, layers);
+            QMetaObject::invokeMethod(this, [this, result]() {
+                m_log->append(result.failures.isEmpty() ? LogModel::Severity::Info : LogModel::Severity::Warning,
+                    tr("Slice benchmark %1 triangles, %2 layers, %3 segments: bucketing %4 ms, slicing %5 ms, "
+                       "%6 layers/s; %7")
+                    .arg(result.triangles)
+                    .arg(result.layers)
+                    .arg(result.segments)
+                    .arg(result.bucketMs, 0, 'f', 1)
+                    .arg(result.sliceMs, 0, 'f', 1)
+                    .arg(result.layersPerSecond(), 0, 'f', 0)
+                    .arg(result.failures.isEmpty() ? tr("all sections match the analytic solids")
+                                                   : tr("%1 checks failed:\n%2")
+                                                         .arg(result.failures.size())
+                                                         .arg(result.failures.mid(0, 10).join(QLatin1Char('\n')))));
+                }, Qt::QueuedConnection);
+        }
+        QMetaObject::invokeMethod(this, [this]() {
+            m_sliceBenchmarkRunning = false;
+            m_log->append(tr("Slice benchmark finished"));
+            }, Qt::QueuedConnection);
+        });
+}
+
+void MainWindow::sliceModel() {
+    const QString path = QFileDialog::getOpenFileName(this, tr("Slice STL"), QString(), tr("STL files (*.stl)"));
+    if (path.isEmpty()) {
+        return;
+    }
+    // Layers follow the Z range of the rectangle tab, the same fields a layered rectangle uses.
+    const auto heights = MeshSlicer::layerHeights(m_rectZStart->value(), m_rectZEnd->value(), m_rectZInterval->value());
+    const double speed = m_rectSpeed->value();
+    m_log->append(tr("Slicing %1 into %2 layers ...").arg(path).arg(heights.size()));
+    QThreadPool::globalInstance()->start([this, path, heights, speed]() {
+        QElapsedTimer timer;
+        timer.start();
+        StlMesh mesh;
+        QString error;
+        auto layers = std::make_shared<std::vector<SliceLayer>>();
+        MeshSlicer::Stats stats;
+        if (StlParser::parse(path, mesh, error)) {
+            MeshSlicer::slice(mesh, heights, *layers, &stats);
+        }
+        const double totalMs = timer.nsecsElapsed() / 1e6;
+        QMetaObject::invokeMethod(this, [this, path, layers, stats, error, totalMs, speed]() {
+            if (!error.isEmpty()) {
+                m_log->append(LogModel::Severity::Error, tr("Failed to slice %1: %2").arg(path, error));
+                return;
+            }
+            m_log->append(tr("Sliced %1: %2 layers, %3 contours, %4 open chains in %5 ms (slicing %6 ms)")
+                .arg(QFileInfo(path).fileName())
+                .arg(layers->size())
+                .arg(stats.contours)
+                .arg(stats.openChains)
+                .arg(totalMs, 0, 'f', 1)
+                .arg(stats.bucketMs + stats.sliceMs, 0, 'f', 1));
+            if (!m_actionToolpath->isChecked()) {
+                m_actionToolpath->setChecked(true);
+            }
+            m_scenePreview->toolpathOverlay()->setShapePath(QStringLiteral("slice:%1").arg(path),
+                [layers, speed](SampleSink& sink) {
+                for (const SliceLayer& layer : *layers) {
+                    for (const QPolygonF& contour : layer.contours) {
+                        ThreeAxisGenerator::generateContour(sink, contour, layer.z, speed);
+                    }
+                }
+                });
+            }, Qt::QueuedConnection);
+        });
+}
+
+void MainWindow::setToolpathOverlayVisible(bool visible) {
+    auto* overlay = m_scenePreview->toolpathOverlay();
+    overlay->setEnabled(visible);
+    if (!visible) {
+        overlay->clear();
+        return;
+    }
+    for (const QString& id : m_scenePreview->shapeIds()) {
+        updateToolpath(id);
+    }
+}
+
+void MainWindow::updateToolpath(const QString& id) {
+    auto* overlay = m_scenePreview->toolpathOverlay();
+    const ShapeStore* store = m_scenePreview->shapeStore();
+    const int row = store->rowOf(id);
+    if (!overlay->isEnabled() || row < 0) {
+        return;
+    }
+    // The request the compiled job gets for this shape, per-shape overrides included, run
+    // through the same generator.
+    SceneShape shape;
+    switch (store->kind(row)) {
+    case ShapeStore::Kind::Line:
+        fillLineFromStore(row, *shape.mutable_line());
+        break;
+    case ShapeStore::Kind::Circle:
+        fillCircleFromStore(row, *shape.mutable_circle());
+        break;
+    case ShapeStore::Kind::Rectangle:
+        fillRectangleFromStore(row, *shape.mutable_rectangle());
+        break;
+    default:
+        break;
+    }
+    if (!ShapeGenerator::unsupported(shape).isEmpty()) {
+        // Skipped by the compile as well (no local generator, or parameters it cannot reproduce).
+        overlay->removeShape(id);
+        return;
+    }
+    overlay->setShapePath(id, [shape](SampleSink& sink) {
+        ShapeGenerator::generate(sink, shape);
+        });
+}
+
+void MainWindow::applyDelay() {
+    DelayData request;
+    fillDelayFromTab(request);
 
     m_client->setDelay(request);
-    m_log->append(tr("Applied delay parameters: %1").arg(formatDelay(request)));
+    m_log->append(tr("Queued delay parameters: %1 (pending batches: %2)")
+        .arg(formatDelay(request)).arg(m_client->settings().pendingBatches()));
 }
 
 void MainWindow::applyFreq() {
     FreqData request;
     request.set_freq(m_freq->value());
     m_client->setLaserFreq(request);
-    m_log->append(tr("Applied laser frequency: %1").arg(formatFreq(request)));
+    m_log->append(tr("Queued laser frequency: %1 (pending batches: %2)")
+        .arg(formatFreq(request)).arg(m_client->settings().pendingBatches()));
 }
 
 void MainWindow::importModel() {
@@ -221,27 +1899,53 @@ void MainWindow::showSampleModel() {
     m_log->append(tr("refreshed 3d"));
 }
 
+void MainWindow::setLiveToolpathVisible(bool visible) {
+    if (!m_modelViewer) {
+        return;
+    }
+    if (visible) {
+        m_modelViewer->startLiveToolpath(&TcpSocketWorker::instance().frameTap());
+    }
+    else {
+        m_modelViewer->stopLiveToolpath();
+    }
+}
+
 void MainWindow::onReply(const QString& operation, const QString& message) {
     m_log->append(tr("[%1] Success: %2").arg(operation, message));
 }
 
 void MainWindow::onError(const QString& operation, int code, const QString& message) {
-    m_log->append(QStringLiteral("[%1] Error %2: %3").arg(operation, QString::number(code), message));
+    m_log->append(LogModel::Severity::Error, QStringLiteral("[%1] Error %2: %3").arg(operation, QString::number(code), message));
+}
+
+void MainWindow::onSlowRequest(const QString& operation, double totalMs, qint64 requestBytes, qint64 replyBytes) {
+    m_log->append(LogModel::Severity::Warning, tr("[%1] Slow request: %2 ms (request %3 B, reply %4 B)")
+        .arg(operation, QString::number(totalMs, 'f', 1), QString::number(requestBytes), QString::number(replyBytes)));
+}
+
+void MainWindow::onFleetReply(int index, const QString& operation, const QString& message) {
+    m_log->append(tr("[%1/%2] Success: %3").arg(m_fleet->status(index).name, operation, message));
+}
+
+void MainWindow::onFleetError(int index, const QString& operation, int code, const QString& message) {
+    m_log->append(LogModel::Severity::Error, QStringLiteral("[%1/%2] Error %3: %4").arg(m_fleet->status(index).name, operation, QString::number(code), message));
 }
 
 void MainWindow::onShapeCreated(const QString& id, const QString& type) {
-    auto* item = new QTreeWidgetItem(QStringList(id));
-    item->setData(0, Qt::UserRole, id);
-    item->setData(0, Qt::UserRole + 1, type);
-    m_sceneRoot->addChild(item);
-    m_treeItems.insert(id, item);
-    m_sceneRoot->setExpanded(true);
-    m_log->append(tr("Preview: Added %1 (%2)").arg(type, id));
+    updateToolpath(id);
+    if (!m_bulkLoading) {
+        m_log->append(tr("Preview: Added %1 (%2)").arg(type, id));
+    }
 }
 
 void MainWindow::onShapeSelected(const QString& id, const QString& type) {
-    if (auto* item = m_treeItems.value(id, nullptr)) {
-        m_projectTree->setCurrentItem(item);
+    const QModelIndex index = m_projectModel->indexForId(id);
+    if (index.isValid() && m_projectTree->currentIndex() != index) {
+        m_syncingSelection = true;
+        m_projectTree->selectionModel()->setCurrentIndex(index, QItemSelectionModel::ClearAndSelect);
+        m_projectTree->scrollTo(index);
+        m_syncingSelection = false;
     }
     DrawingPanel::ShapeInfo info;
     if (m_scenePreview->shapeInfo(id, info)) {
@@ -279,25 +1983,73 @@ void MainWindow::onShapeSelected(const QString& id, const QString& type) {
     }
 }
 
-void MainWindow::onShapeMoved(const QString& id, const QString& type) {
-    onShapeSelected(id, type);
-    m_log->append(tr("Preview: Moved %1").arg(id));
+void MainWindow::onShapesMoved(const QStringList& ids, const QPointF& delta) {
+    // A move does not change the path shape, so the overlay shifts the samples it already has.
+    auto* overlay = m_scenePreview->toolpathOverlay();
+    for (const QString& id : ids) {
+        if (!overlay->isEnabled() || !overlay->translateShape(id, delta)) {
+            updateToolpath(id);
+        }
+    }
+    // Not restarted while pending, so a long drag still refreshes every interval.
+    if (!m_jobTotalsTimer.isActive()) {
+        m_jobTotalsTimer.start();
+    }
+    if (ids.size() == 1) {
+        DrawingPanel::ShapeInfo info;
+        if (m_scenePreview->shapeInfo(ids.first(), info)) {
+            onShapeSelected(info.id, info.type);
+        }
+        m_log->append(tr("Preview: Moved %1").arg(ids.first()));
+    }
+    else {
+        m_log->append(tr("Preview: Moved %1 shapes").arg(ids.size()));
+    }
+}
+
+void MainWindow::onShapesSelected(const QStringList& ids) {
+    // Rows are merged into ranges, so selecting thousands of shapes is a handful of ranges.
+    const auto* store = m_scenePreview->shapeStore();
+    std::vector<int> rows;
+    rows.reserve(ids.size());
+    for (const QString& id : ids) {
+        if (const int row = store->rowOf(id); row >= 0) {
+            rows.push_back(row);
+        }
+    }
+    std::sort(rows.begin(), rows.end());
+    QItemSelection selection;
+    if (!rows.empty()) {
+        m_projectModel->ensureFetched(rows.back());
+        const QModelIndex scene = m_projectModel->sceneIndex();
+        size_t start = 0;
+        for (size_t i = 1; i <= rows.size(); ++i) {
+            if (i == rows.size() || rows[i] != rows[i - 1] + 1) {
+                selection.select(m_projectModel->index(rows[start], 0, scene), m_projectModel->index(rows[i - 1], 0, scene));
+                start = i;
+            }
+        }
+    }
+    m_syncingSelection = true;
+    m_projectTree->selectionModel()->select(selection, QItemSelectionModel::ClearAndSelect | QItemSelectionModel::Rows);
+    m_syncingSelection = false;
+    m_log->append(tr("Preview: Selected %1 shapes").arg(rows.size()));
 }
 
 void MainWindow::onShapeRemoved(const QString& id, const QString& type) {
     Q_UNUSED(type);
-    if (auto* item = m_treeItems.take(id)) {
-        delete item;
+    m_scenePreview->toolpathOverlay()->removeShape(id);
+    if (!m_bulkLoading) {
+        m_log->append(tr("Preview: Deleted %1").arg(id));
     }
-    m_log->append(tr("Preview: Deleted %1").arg(id));
 }
 
 void MainWindow::showProjectContextMenu(const QPoint& pos) {
-    auto* current = m_projectTree->itemAt(pos);
-    if (!current || current == m_sceneRoot) {
+    const QModelIndex current = m_projectTree->indexAt(pos);
+    if (!m_projectModel->isShape(current)) {
         return;
     }
-    const QString id = current->data(0, Qt::UserRole).toString();
+    const QString id = current.data(ShapeTreeModel::IdRole).toString();
     QMenu menu(this);
     auto* actionSelect = menu.addAction(tr("Move"));
     auto* actionRemove = menu.addAction(tr("Delete"));
@@ -306,7 +2058,22 @@ void MainWindow::showProjectContextMenu(const QPoint& pos) {
         return;
     }
     if (chosen == actionRemove) {
-        m_scenePreview->removeShape(id);
+        // Deletes the whole selection when the clicked shape is part of it.
+        QStringList ids;
+        if (m_projectTree->selectionModel()->isSelected(current)) {
+            for (const QModelIndex& index : m_projectTree->selectionModel()->selectedRows()) {
+                if (m_projectModel->isShape(index)) {
+                    ids.append(index.data(ShapeTreeModel::IdRole).toString());
+                }
+            }
+        }
+        else {
+            ids.append(id);
+        }
+        const ShapeStore::Batch batch(m_scenePreview->shapeStore());
+        for (const QString& removeId : ids) {
+            m_scenePreview->removeShape(removeId);
+        }
     }
     else if (chosen == actionSelect) {
         m_scenePreview->setMode(DrawingView::Mode::Pointer);
@@ -315,13 +2082,27 @@ void MainWindow::showProjectContextMenu(const QPoint& pos) {
 }
 
 void MainWindow::onProjectSelectionChanged() {
-    auto* current = m_projectTree->currentItem();
-    if (!current || current == m_sceneRoot) {
+    if (m_syncingSelection) {
+        return;
+    }
+    QStringList ids;
+    for (const QModelIndex& index : m_projectTree->selectionModel()->selectedRows()) {
+        if (m_projectModel->isShape(index)) {
+            ids.append(index.data(ShapeTreeModel::IdRole).toString());
+        }
+    }
+    if (ids.isEmpty()) {
         return;
     }
-    const QString id = current->data(0, Qt::UserRole).toString();
+    const QModelIndex current = m_projectTree->currentIndex();
+    const QString currentId = m_projectModel->isShape(current) && ids.contains(current.data(ShapeTreeModel::IdRole).toString())
+        ? current.data(ShapeTreeModel::IdRole).toString()
+        : ids.last();
+    // One scene selection update and one shapeSelected for the current shape, however many rows changed.
+    m_syncingSelection = true;
     m_scenePreview->setMode(DrawingView::Mode::Pointer);
-    m_scenePreview->selectShape(id);
+    m_scenePreview->selectShapes(ids, currentId);
+    m_syncingSelection = false;
 }
 
 QWidget* MainWindow::buildLineTab() {
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <memory>
+#include <thread>
+
 #include <QMainWindow>
 #include <QCheckBox>
 #include <QDoubleSpinBox>
@@ -7,20 +10,33 @@
 #include <QGroupBox>
 #include <QPushButton>
 #include <QHash>
+#include <QMutex>
+#include <QSet>
 #include <QSpinBox>
 #include <QSplitter>
 #include <QTabWidget>
-#include <QTreeWidget>
+#include <QTimer>
+#include <QTreeView>
 #include <QUrl>
-#include <QTextEdit>
+#include <QWaitCondition>
 #include "view/ModelViewerWidget.h"
+#include "Processing/JobCompiler.h"
 #include "grpc/FiveAxisClient.h"
+#include "grpc/FleetDispatcher.h"
 #include "view/DrawingPanel.h"
+#include "view/LogModel.h"
+#include "view/ShapeTreeModel.h"
+
+class JobQueuePanel;
+class MetricsExporter;
+class QLabel;
+class StreamDaemonClient;
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
 public:
     explicit MainWindow(QWidget* parent = nullptr);
+    ~MainWindow() override;
 
 private slots:
     void connectToServer();
@@ -28,25 +44,107 @@ private slots:
     void sendCircle();
     void sendRectangle();
     void sendEllipse();
+    void sendScene();
+    void compileScene();
+    void runSceneLocally();
+    void saveJob();
+    void openJob();
+    void runPanBenchmark();
+    void runStlBenchmark();
+    void runSliceBenchmark();
+    void runLogBenchmark();
+    void runShapeStoreBenchmark();
+    void runSceneBatchBenchmark();
+    void runJobFileBenchmark();
+    void runPickBenchmark();
+    void runIncrementalCompileBenchmark();
+    void runTraceBenchmark();
+    void runRealtimeJitterBenchmark();
+    void runShmRingBenchmark();
+    void runStopLatencyBenchmark();
+    void runSettingsChannelBenchmark();
+    void runFleetBenchmark();
+    // Routes frames through the streaming daemon, or back to this process.
+    void setDaemonStreaming(bool enabled);
+    // Pause, resume and abort for this process's own streamer, used while no daemon is attached.
+    void setLocalStreamPaused(bool paused);
+    void abortLocalStream();
+    // Queues a saved .faxj in the daemon, which compiles it itself if it has no frame records.
+    void queueJobFile();
+    // Starts a pipeline trace; stopping offers to save it as Chrome trace JSON.
+    void setTraceRecording(bool recording);
+    void transformShapes();
+    void sliceModel();
+    void setToolpathOverlayVisible(bool visible);
     void applyDelay();
     void applyFreq();
     void onReply(const QString& operation, const QString& message);
     void onError(const QString& operation, int code, const QString& message);
+    void onSlowRequest(const QString& operation, double totalMs, qint64 requestBytes, qint64 replyBytes);
+    void onFleetReply(int index, const QString& operation, const QString& message);
+    void onFleetError(int index, const QString& operation, int code, const QString& message);
     void onShapeCreated(const QString& id, const QString& type);
     void onShapeSelected(const QString& id, const QString& type);
-    void onShapeMoved(const QString& id, const QString& type);
+    void onShapesMoved(const QStringList& ids, const QPointF& delta);
+    void onShapesSelected(const QStringList& ids);
     void onShapeRemoved(const QString& id, const QString& type);
     void showProjectContextMenu(const QPoint& pos);
     void onProjectSelectionChanged();
     void importModel();
     void showSampleModel();
+    void setLiveToolpathVisible(bool visible);
 private:
+    // Handshake between the Scene menu and the stream thread feeding TcpSocketWorker::instance().
+    struct LocalStream {
+        QMutex mutex;
+        QWaitCondition changed;
+        bool streaming{ false };
+        bool interrupted{ false };
+        bool paused{ false };
+        bool abort{ false };
+        int sourceId{ 0 };
+        qint64 resume{ -1 };
+    };
+
+    // Stream thread: feeds count records to the local buffer a frame at a time, settling pauses and
+    // aborts between frames, and returns once they have all been sent; false if aborted. The
+    // caller marks the stream as streaming before the thread starts.
+    static bool streamLocally(LocalStream& stream, const char* records, qint64 count, int freq);
+    // Streams a compiled scene on m_streamThread.
+    void startLocalStream(const std::shared_ptr<const JobCompiler::Result>& result, int freq);
+    void interruptLocalStream(bool abort);
     void buildUi();
     QWidget* buildLineTab();
     QWidget* buildCircleTab();
     QWidget* buildRectangleTab();
     QWidget* buildEllipseTab();
     QWidget* buildSettingsTab();
+    void fillLineFromTab(LineData& request) const;
+    void fillCircleFromTab(CircleData& request) const;
+    void fillRectangleFromTab(RectangleData& request) const;
+    void fillEllipseFromTab(EllipseData& request) const;
+    void fillDelayFromTab(DelayData& request) const;
+    void loadLineIntoTab(const LineData& request);
+    void loadCircleIntoTab(const CircleData& request);
+    void loadRectangleIntoTab(const RectangleData& request);
+    void loadEllipseIntoTab(const EllipseData& request);
+    // Request for one stored shape: geometry from the store, process parameters from the tabs
+    // unless the shape overrides them.
+    void fillLineFromStore(int row, LineData& request) const;
+    void fillCircleFromStore(int row, CircleData& request) const;
+    void fillRectangleFromStore(int row, RectangleData& request) const;
+    void fillEllipseFromStore(int row, EllipseData& request) const;
+    // Geometry from the drawn shapes, process parameters from the tabs; returns shapes skipped.
+    int buildSceneBatch(SceneBatch& batch) const;
+    // Regenerates the overlay path of one drawn shape from the request the compile would make.
+    void updateToolpath(const QString& id);
+    // Compiles the scene on the thread pool, then streams it to the local DataBuffer if asked, or
+    // hands it to the streaming daemon as a job file while connected to one. Shapes the local
+    // generators cannot reproduce are skipped and logged.
+    // A quiet compile only refreshes the job totals in the status bar.
+    void startCompile(bool runLocally, bool quiet = false);
+    // After an edit, recompiles quietly if the scene has been compiled before.
+    void refreshJobTotals();
     QString formatLine(const LineData& request) const;
     QString formatCircle(const CircleData& request) const;
     QString formatRectangle(const RectangleData& request) const;
@@ -55,14 +153,52 @@ private:
     QString formatFreq(const FreqData& request) const;
 
     QSplitter* m_splitter{};
-    QTreeWidget* m_projectTree{};
-    QTreeWidgetItem* m_sceneRoot{};
+    QTreeView* m_projectTree{};
+    ShapeTreeModel* m_projectModel{};
     DrawingPanel* m_scenePreview{};
     ModelViewerWidget* m_modelViewer{};
     QTabWidget* m_propertyTabs{};
-    QTextEdit* m_log{};
+    LogModel* m_log{};
     FiveAxisClient* m_client{};
-    QHash<QString, QTreeWidgetItem*> m_treeItems;
+    FleetDispatcher* m_fleet{};
+    MetricsExporter* m_metricsExporter{};
+    StreamDaemonClient* m_daemon{};
+    QLabel* m_daemonStatus{};
+    JobQueuePanel* m_jobQueue{};
+    // Temporary job files handed to the daemon, removed once it has answered for them.
+    QSet<QString> m_daemonJobFiles;
+    QAction* m_actionUseFleet{};
+    QAction* m_actionDaemon{};
+    QAction* m_actionToolpath{};
+    QAction* m_actionTrace{};
+    QAction* m_actionPauseLocal{};
+    bool m_bulkLoading{ false };
+    // Set while the tree selection follows the drawing, so it is not mirrored back.
+    bool m_syncingSelection{ false };
+    bool m_panBenchmarkRunning{ false };
+    bool m_logBenchmarkRunning{ false };
+    bool m_stlBenchmarkRunning{ false };
+    bool m_sliceBenchmarkRunning{ false };
+    bool m_jitterBenchmarkRunning{ false };
+    bool m_shmBenchmarkRunning{ false };
+    bool m_stopLatencyBenchmarkRunning{ false };
+    bool m_fleetBenchmarkRunning{ false };
+    bool m_jobFileBenchmarkRunning{ false };
+    bool m_pickBenchmarkRunning{ false };
+    bool m_sceneBatchBenchmarkRunning{ false };
+    bool m_shapeStoreBenchmarkRunning{ false };
+    bool m_settingsBenchmarkRunning{ false };
+    bool m_compileBenchmarkRunning{ false };
+    bool m_traceBenchmarkRunning{ false };
+    // Shared with the compile task, which may still be running when the window goes away.
+    std::shared_ptr<JobCompiler> m_compiler;
+    bool m_compileRunning{ false };
+    std::shared_ptr<LocalStream> m_localStream;
+    // Runs streamLocally for one compiled scene; joined once it has reported back.
+    std::thread m_streamThread;
+    // An edit arrived while a compile was running; refresh the totals once it is done.
+    bool m_compileAgain{ false };
+    QTimer m_jobTotalsTimer;
 
     // Line widgets
     QDoubleSpinBox* m_lineSpeed{};
@@ -0,0 +1,175 @@
+#include "ControllerSimulator.h"
+
+#include <memory>
+
+#include <QHostAddress>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QThread>
+#include <QtEndian>
+
+#include "DataBuffer.h"
+#include "metrics/Trace.h"
+
+namespace
+{
+    constexpr int CREDIT_SIZE = 128;
+    constexpr int RECORD_SIZE = 16;
+    constexpr int FLAG_OFFSET = 10;
+    constexpr quint16 FLAG_LASER_ON = 0x00FF;
+    constexpr int RECEIVE_WINDOW = 32 * 1024;
+    constexpr int TICK_US = 1000;
+    constexpr int POLL_MS = 100;
+    constexpr int START_TIMEOUT_MS = 2000;
+}
+
+ControllerSimulator::ControllerSimulator(int recordUs)
+    : m_recordUs(qMax(1, recordUs))
+{
+}
+
+ControllerSimulator::~ControllerSimulator()
+{
+    stop();
+}
+
+bool ControllerSimulator::start(QString &error)
+{
+    m_clock.start();
+    m_thread = std::thread([this]() { run(); });
+    QElapsedTimer waited;
+    waited.start();
+    while (m_port.load() == 0 && waited.elapsed() < START_TIMEOUT_MS)
+    {
+        QThread::msleep(1);
+    }
+    if (m_port.load() > 0)
+    {
+        return true;
+    }
+    stop();
+    error = m_error.isEmpty() ? QStringLiteral("controller simulator did not start listening") : m_error;
+    return false;
+}
+
+void ControllerSimulator::stop()
+{
+    m_stopRequested.store(true);
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+}
+
+quint16 ControllerSimulator::port() const
+{
+    return static_cast<quint16>(qMax(0, m_port.load()));
+}
+
+qint64 ControllerSimulator::nowNs() const
+{
+    return m_clock.nsecsElapsed();
+}
+
+qint64 ControllerSimulator::recordsExecuted() const
+{
+    return m_records.load();
+}
+
+qint64 ControllerSimulator::laserRecordsExecuted() const
+{
+    return m_laserRecords.load();
+}
+
+qint64 ControllerSimulator::lastLaserNs() const
+{
+    return m_lastLaserNs.load();
+}
+
+int ControllerSimulator::framesReceived() const
+{
+    return m_frames.load();
+}
+
+void ControllerSimulator::run()
+{
+    trace::setThreadName(QStringLiteral("ControllerSimulator"));
+    QTcpServer server;
+    if (!server.listen(QHostAddress::LocalHost, 0))
+    {
+        m_error = server.errorString();
+        m_port.store(-1);
+        return;
+    }
+    m_port.store(server.serverPort());
+    while (!m_stopRequested.load())
+    {
+        if (!server.waitForNewConnection(POLL_MS))
+        {
+            continue;
+        }
+        std::unique_ptr<QTcpSocket> socket(server.nextPendingConnection());
+        if (socket)
+        {
+            serve(*socket);
+        }
+    }
+}
+
+void ControllerSimulator::serve(QTcpSocket &socket)
+{
+    // Kept small on both levels, so unread frame bytes back up into the sender.
+    socket.setSocketOption(QAbstractSocket::ReceiveBufferSizeSocketOption, RECEIVE_WINDOW);
+    socket.setReadBufferSize(RECEIVE_WINDOW);
+    const QByteArray credit(CREDIT_SIZE, '\0');
+    const qint64 nsPerRecord = static_cast<qint64>(m_recordUs) * 1000;
+    qint64 frameLeft = DataBuffer::frameSize();
+    QByteArray pending;
+    qint64 paced = m_clock.nsecsElapsed();
+    socket.write(credit);
+    socket.flush();
+    while (!m_stopRequested.load() && socket.state() == QAbstractSocket::ConnectedState)
+    {
+        QThread::usleep(TICK_US);
+        const qint64 now = m_clock.nsecsElapsed();
+        const qint64 due = (now - paced) / nsPerRecord;
+        if (due <= 0)
+        {
+            continue;
+        }
+        socket.waitForReadyRead(0);
+        const qint64 wanted = qMin(due * RECORD_SIZE, frameLeft);
+        pending.append(socket.read(wanted - pending.size()));
+        const qint64 whole = pending.size() / RECORD_SIZE;
+        execute(pending.constData(), whole);
+        frameLeft -= whole * RECORD_SIZE;
+        pending.remove(0, static_cast<int>(whole * RECORD_SIZE));
+        // Time spent waiting for data is idle time, not records that can be caught up on.
+        paced = whole < due ? now : paced + due * nsPerRecord;
+        if (frameLeft == 0)
+        {
+            ++m_frames;
+            frameLeft = DataBuffer::frameSize();
+            socket.write(credit);
+            socket.flush();
+        }
+    }
+}
+
+void ControllerSimulator::execute(const char *records, qint64 count)
+{
+    qint64 laser = 0;
+    for (qint64 i = 0; i < count; ++i)
+    {
+        if (qFromLittleEndian<quint16>(records + i * RECORD_SIZE + FLAG_OFFSET) == FLAG_LASER_ON)
+        {
+            ++laser;
+        }
+    }
+    m_records += count;
+    if (laser > 0)
+    {
+        m_laserRecords += laser;
+        m_lastLaserNs.store(m_clock.nsecsElapsed());
+    }
+}
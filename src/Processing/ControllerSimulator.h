@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+
+#include <QElapsedTimer>
+#include <QString>
+#include <QtGlobal>
+
+class QTcpSocket;
+
+// Local stand-in for the controller's frame port, for measuring the streamer without a machine.
+// It listens on 127.0.0.1, asks for every frame with a 128-byte credit and reads it no faster
+// than it executes it, one record per recordUs, through a small receive window, so the sender is
+// held back by TCP the way the controller holds it back. Laser-on records executed are counted
+// and timestamped on the simulator's clock.
+class ControllerSimulator
+{
+public:
+    explicit ControllerSimulator(int recordUs = 10);
+    ~ControllerSimulator();
+
+    ControllerSimulator(const ControllerSimulator &) = delete;
+    ControllerSimulator &operator=(const ControllerSimulator &) = delete;
+
+    // Listens on an ephemeral port; false with error set if that fails.
+    bool start(QString &error);
+    void stop();
+    quint16 port() const;
+
+    // Nanoseconds since start().
+    qint64 nowNs() const;
+    qint64 recordsExecuted() const;
+    qint64 laserRecordsExecuted() const;
+    // When the last laser-on record was executed, on the nowNs() clock; -1 before the first.
+    qint64 lastLaserNs() const;
+    int framesReceived() const;
+
+private:
+    void run();
+    void serve(QTcpSocket &socket);
+    void execute(const char *records, qint64 count);
+
+    int m_recordUs;
+    QElapsedTimer m_clock;
+    std::thread m_thread;
+    std::atomic<bool> m_stopRequested{false};
+    // 0 until the server listens, -1 if it could not.
+    std::atomic<int> m_port{0};
+    QString m_error;
+    std::atomic<qint64> m_records{0};
+    std::atomic<qint64> m_laserRecords{0};
+    std::atomic<qint64> m_lastLaserNs{-1};
+    std::atomic<int> m_frames{0};
+};
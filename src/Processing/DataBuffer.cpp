@@ -4,13 +4,53 @@
 #include <QMutexLocker>
 #include <QThread>
 #include <QtDebug>
-#include <algorithm>
+#include <QtEndian>
+#include <cstring>
 
 #include "TcpSocketWorker.h"
+#include "metrics/MetricsRegistry.h"
+#include "metrics/Trace.h"
 
 namespace
 {
     constexpr int QUEUE_WAIT_MS = 10;
+    constexpr quint16 PARK_CENTRE = 0x8000;
+    constexpr quint16 FLAG_BEGIN = 0xFF00;
+    constexpr quint16 FLAG_END = 0x1100;
+
+    struct BufferMetrics
+    {
+        MetricsRegistry::Counter &framesFilled;
+        MetricsRegistry::Counter &samples;
+        MetricsRegistry::Counter &queueAnomalies;
+        MetricsRegistry::Histogram &fillUs;
+        MetricsRegistry::Histogram &writeWaitUs;
+        MetricsRegistry::Histogram &readWaitUs;
+        MetricsRegistry::Gauge &readQueueDepth;
+        MetricsRegistry::Gauge &writeQueueDepth;
+    };
+
+    // Shared by every DataBuffer; the headless runner's own buffer reports into the same metrics.
+    BufferMetrics &metrics()
+    {
+        auto &registry = MetricsRegistry::instance();
+        static BufferMetrics bufferMetrics{
+            registry.counter(QStringLiteral("fiveaxis_buffer_frames_filled_total"), QStringLiteral("Frames handed to the streamer")),
+            registry.counter(QStringLiteral("fiveaxis_generator_samples_total"),
+                             QStringLiteral("Samples (or job file records) written into frames")),
+            registry.counter(QStringLiteral("fiveaxis_buffer_queue_anomalies_total"),
+                             QStringLiteral("Frames queued while the queue was already full")),
+            registry.histogram(QStringLiteral("fiveaxis_buffer_frame_fill_us"),
+                               QStringLiteral("First write into a frame to its handoff, microseconds")),
+            registry.histogram(QStringLiteral("fiveaxis_buffer_write_wait_us"),
+                               QStringLiteral("Producer wait for a free frame, microseconds")),
+            registry.histogram(QStringLiteral("fiveaxis_buffer_read_wait_us"),
+                               QStringLiteral("Streamer wait for a filled frame, microseconds")),
+            registry.gauge(QStringLiteral("fiveaxis_buffer_read_queue_depth"), QStringLiteral("Filled frames waiting to be sent")),
+            registry.gauge(QStringLiteral("fiveaxis_buffer_write_queue_depth"), QStringLiteral("Free frames waiting to be filled")),
+        };
+        return bufferMetrics;
+    }
 }
 
 DataBuffer &DataBuffer::instance()
@@ -23,8 +63,6 @@ DataBuffer::DataBuffer()
 {
     for (int i = 0; i < DATA_BUF_NUM; ++i)
     {
-        m_buffers[i].resize(DATA_BUF_SIZE);
-        m_buffers[i].fill(0);
         m_wrQueue.enqueue(i);
     }
     if (!m_wrQueue.isEmpty())
@@ -33,43 +71,192 @@ DataBuffer::DataBuffer()
     }
 }
 
-QByteArray &DataBuffer::buffer(int index)
+void DataBuffer::setStreamer(FrameStreamer *streamer)
+{
+    bool queued = false;
+    {
+        QMutexLocker locker(&m_queueMutex);
+        m_streamer.store(streamer);
+        queued = !m_rdQueue.isEmpty();
+    }
+    // Frames already waiting would otherwise sit there until the producer fills the next one.
+    m_tcpThreadStarted.store(queued);
+    if (queued)
+    {
+        (streamer ? *streamer : TcpSocketWorker::instance()).ensureRunning();
+    }
+}
+
+const char *DataBuffer::frame(int index)
 {
-    return m_buffers[index];
+    return m_frames.frame(index);
+}
+
+bool DataBuffer::setRealtimeMemory(bool enabled, QString &error)
+{
+    QMutexLocker locker(&m_queueMutex);
+    if (m_ptr != 0 || !m_rdQueue.isEmpty() || m_wrQueue.size() != DATA_BUF_NUM - 1)
+    {
+        error = QStringLiteral("frames are in use; change the memory mode between jobs");
+        return false;
+    }
+    return m_frames.allocate(enabled, error);
+}
+
+QString DataBuffer::memoryStatus() const
+{
+    QStringList parts{m_frames.describe()};
+    parts.append(m_frames.warnings());
+    return parts.join(QStringLiteral("; "));
 }
 
 void DataBuffer::addProcessData(quint16 X, quint16 Y, quint16 Z, quint16 A, quint16 B)
 {
+    ++m_samples;
     addData(B, A, Z, Y, X, 0x00FF);
 }
 
 void DataBuffer::addProcessJumpData(quint16 X, quint16 Y, quint16 Z, quint16 A, quint16 B)
 {
+    ++m_samples;
     addData(B, A, Z, Y, X, 0);
 }
 
 void DataBuffer::addProcessBegin()
 {
     handleBegin();
-    addData(0, 0, 0, 0, 0, 0xFF00, 0, 0);
+    addData(0, 0, 0, 0, 0, FLAG_BEGIN, 0, 0);
 }
 
 void DataBuffer::addProcessEnd()
 {
-    addData(0, 0, 0, 0, 0, 0x1100, 0, 0);
+    addData(0, 0, 0, 0, 0, FLAG_END, 0, 0);
+}
+
+void DataBuffer::addRecords(const char *records, qint64 count)
+{
+    // Recorded streams may carry their own settings records.
+    invalidateSettings();
+    m_samples += count;
+    qint64 remaining = count * RECORD_SIZE;
+    while (remaining > 0 && !stale())
+    {
+        if (m_ptr == 0)
+        {
+            m_fillTimer.start();
+        }
+        const qint64 chunk = qMin<qint64>(remaining, DATA_BUF_SIZE - m_ptr);
+        std::memcpy(m_frames.frame(m_wrPtr) + m_ptr, records, static_cast<size_t>(chunk));
+        if (m_sourceId != 0)
+        {
+            SourceMark &mark = m_marks[m_wrPtr];
+            if (mark.id != m_sourceId)
+            {
+                mark = SourceMark{m_sourceId, m_sourceNext, 0, m_ptr};
+            }
+            mark.count += chunk / RECORD_SIZE;
+            m_sourceNext += chunk / RECORD_SIZE;
+        }
+        m_ptr += static_cast<int>(chunk);
+        records += chunk;
+        remaining -= chunk;
+        handleBufferFilled();
+    }
+}
+
+void DataBuffer::setSource(int id, qint64 position)
+{
+    QMutexLocker locker(&m_queueMutex);
+    m_sourceId = id;
+    m_sourceNext = position;
+    m_sourceUnsent = position;
+}
+
+void DataBuffer::addResumeRecords(const char *record)
+{
+    const auto word = [record](int i) { return qFromLittleEndian<quint16>(record + 2 * i); };
+    addData(0, 0, 0, 0, 0, FLAG_BEGIN, 0, 0);
+    addData(word(0), word(1), word(2), word(3), word(4), 0);
+}
+
+QByteArray DataBuffer::parkRecords()
+{
+    const quint16 words[2][8] = {
+        {PARK_CENTRE, PARK_CENTRE, PARK_CENTRE, PARK_CENTRE, PARK_CENTRE, 0, 0, 0},
+        {0, 0, 0, 0, 0, FLAG_END, 0, 0},
+    };
+    QByteArray records(static_cast<int>(sizeof(words)), Qt::Uninitialized);
+    for (int i = 0; i < 16; ++i)
+    {
+        qToLittleEndian<quint16>(words[i / 8][i % 8], records.data() + 2 * i);
+    }
+    return records;
 }
 
 void DataBuffer::setFreqData(int freq)
 {
+    dropInvalidSettings();
+    // The begin sequence parks the head before every job, whether or not the frequency changed.
     handleBegin();
+    if (m_lastFreq != freq)
+    {
+        writeFreqRecords(freq);
+    }
+}
+
+void DataBuffer::setPowerData(double power)
+{
+    dropInvalidSettings();
+    if (m_lastPower == power)
+    {
+        return;
+    }
+    writePowerRecords(power);
+    forceFill();
+}
+
+void DataBuffer::applySettings(int freq, double power)
+{
+    dropInvalidSettings();
+    handleBegin();
+    if (m_lastFreq != freq)
+    {
+        writeFreqRecords(freq);
+    }
+    if (m_lastPower != power)
+    {
+        writePowerRecords(power);
+        forceFill();
+    }
+}
+
+void DataBuffer::invalidateSettings()
+{
+    // The cache itself belongs to the producer; it is dropped on its next settings write.
+    m_settingsInvalid.store(true);
+}
+
+void DataBuffer::dropInvalidSettings()
+{
+    if (m_settingsInvalid.exchange(false))
+    {
+        m_lastFreq.reset();
+        m_lastPower.reset();
+    }
+}
+
+void DataBuffer::writeFreqRecords(int freq)
+{
     const int cnt = 50000 / freq;
     addData(0xAA, 0, 0, 0, 0, 0xAA00, 0, 0);
     addData(static_cast<quint16>(cnt & 0xFFFF), static_cast<quint16>(cnt >> 16));
     addData(0xAA, 0, 0, 0, 0, 0x5500, 0, 0);
+    m_lastFreq = freq;
 }
 
-void DataBuffer::setPowerData(double power)
+void DataBuffer::writePowerRecords(double power)
 {
+    m_lastPower = power;
     if (power > 100.0)
     {
         power = 100.0;
@@ -82,15 +269,17 @@ void DataBuffer::setPowerData(double power)
     {
         addData(p, 0, 0, 0, 0, 0xbb00, 0, 11451);
     }
-    forceFill();
 }
 
 void DataBuffer::forceFill()
 {
-    auto &buf = m_buffers[m_wrPtr];
+    if (stale())
+    {
+        return;
+    }
     if (m_ptr < DATA_BUF_SIZE)
     {
-        std::fill(buf.begin() + m_ptr, buf.end(), 0);
+        std::memset(m_frames.frame(m_wrPtr) + m_ptr, 0, static_cast<size_t>(DATA_BUF_SIZE - m_ptr));
     }
     m_ptr = DATA_BUF_SIZE;
     handleBufferFilled();
@@ -98,22 +287,129 @@ void DataBuffer::forceFill()
 
 int DataBuffer::getWriteBuf()
 {
+    trace::Scope scope("buffer", "getWriteBuf");
+    QElapsedTimer waited;
+    waited.start();
     QMutexLocker locker(&m_queueMutex);
     while (m_wrQueue.isEmpty())
     {
         m_wrAvailable.wait(&m_queueMutex, QUEUE_WAIT_MS);
     }
-    return m_wrQueue.dequeue();
+    const int index = m_wrQueue.dequeue();
+    updateQueueGauges();
+    metrics().writeWaitUs.record(waited.nsecsElapsed() / 1000);
+    return index;
 }
 
 int DataBuffer::getReadBuf()
 {
+    trace::Scope scope("buffer", "getReadBuf");
+    QElapsedTimer waited;
+    waited.start();
     QMutexLocker locker(&m_queueMutex);
     while (m_rdQueue.isEmpty())
     {
         m_rdAvailable.wait(&m_queueMutex, QUEUE_WAIT_MS);
     }
-    return m_rdQueue.dequeue();
+    const int index = m_rdQueue.dequeue();
+    updateQueueGauges();
+    metrics().readWaitUs.record(waited.nsecsElapsed() / 1000);
+    return index;
+}
+
+int DataBuffer::tryGetReadBuf(int timeoutMs)
+{
+    trace::Scope scope("buffer", "tryGetReadBuf");
+    QElapsedTimer waited;
+    waited.start();
+    QMutexLocker locker(&m_queueMutex);
+    if (m_rdQueue.isEmpty())
+    {
+        m_rdAvailable.wait(&m_queueMutex, timeoutMs);
+    }
+    // Timeouts are the streamer idling between jobs, not waits for a frame.
+    if (m_rdQueue.isEmpty())
+    {
+        return -1;
+    }
+    const int index = m_rdQueue.dequeue();
+    updateQueueGauges();
+    metrics().readWaitUs.record(waited.nsecsElapsed() / 1000);
+    return index;
+}
+
+int DataBuffer::pendingFrames()
+{
+    QMutexLocker locker(&m_queueMutex);
+    return m_rdQueue.size();
+}
+
+int DataBuffer::discardQueued()
+{
+    QMutexLocker locker(&m_queueMutex);
+    const int dropped = m_rdQueue.size();
+    while (!m_rdQueue.isEmpty())
+    {
+        m_wrQueue.enqueue(m_rdQueue.dequeue());
+    }
+    m_ptr = 0;
+    m_samples = 0;
+    m_fillTimer.invalidate();
+    m_marks[m_wrPtr] = SourceMark();
+    m_fillEpoch = m_epoch.load();
+    // Whatever was dropped may have carried settings the machine never saw.
+    invalidateSettings();
+    updateQueueGauges();
+    m_wrAvailable.wakeAll();
+    return dropped;
+}
+
+int DataBuffer::interruptQueued()
+{
+    QMutexLocker locker(&m_queueMutex);
+    m_epoch.fetch_add(1);
+    const int dropped = m_rdQueue.size();
+    while (!m_rdQueue.isEmpty())
+    {
+        m_wrQueue.enqueue(m_rdQueue.dequeue());
+    }
+    updateQueueGauges();
+    // A producer blocked on a full queue runs on into its discarded writes, and a streamer
+    // waiting for a frame stops waiting.
+    m_wrAvailable.wakeAll();
+    m_rdAvailable.wakeAll();
+    return dropped;
+}
+
+qint64 DataBuffer::cutFrame(int index, qint64 deliveredBytes)
+{
+    QMutexLocker locker(&m_queueMutex);
+    SourceMark &mark = m_marks[index];
+    if (mark.id == 0 || mark.id != m_sourceId)
+    {
+        return -1;
+    }
+    mark.count = qBound<qint64>(0, (deliveredBytes - mark.offset) / RECORD_SIZE, mark.count);
+    return mark.first + mark.count;
+}
+
+int DataBuffer::sourceId()
+{
+    QMutexLocker locker(&m_queueMutex);
+    return m_sourceId;
+}
+
+qint64 DataBuffer::unsentSource()
+{
+    QMutexLocker locker(&m_queueMutex);
+    return m_sourceId != 0 ? m_sourceUnsent : -1;
+}
+
+bool DataBuffer::allFramesSent()
+{
+    QMutexLocker locker(&m_queueMutex);
+    // The frame currently being filled is held outside both queues.
+    return m_rdQueue.isEmpty() && m_wrQueue.size() == DATA_BUF_NUM - 1;
 }
 
 void DataBuffer::writeEnd(int p)
@@ -122,8 +418,10 @@ void DataBuffer::writeEnd(int p)
     if (m_rdQueue.size() >= DATA_BUF_NUM)
     {
         qWarning() << "读队列异常";
+        metrics().queueAnomalies.add();
     }
     m_rdQueue.enqueue(p);
+    updateQueueGauges();
     m_rdAvailable.wakeOne();
 }
 
@@ -133,16 +431,50 @@ void DataBuffer::readEnd(int p)
     if (m_wrQueue.size() >= DATA_BUF_NUM)
     {
         qWarning() << "写队列异常";
+        metrics().queueAnomalies.add();
+    }
+    const SourceMark &mark = m_marks[p];
+    if (mark.id != 0 && mark.id == m_sourceId)
+    {
+        m_sourceUnsent = mark.first + mark.count;
     }
     m_wrQueue.enqueue(p);
+    updateQueueGauges();
     m_wrAvailable.wakeOne();
 }
 
+void DataBuffer::requeueFront(int p)
+{
+    QMutexLocker locker(&m_queueMutex);
+    m_rdQueue.prepend(p);
+    updateQueueGauges();
+    m_rdAvailable.wakeOne();
+}
+
+void DataBuffer::updateQueueGauges()
+{
+    metrics().readQueueDepth.set(m_rdQueue.size());
+    metrics().writeQueueDepth.set(m_wrQueue.size());
+}
+
+bool DataBuffer::stale() const
+{
+    return m_fillEpoch != m_epoch.load();
+}
+
 void DataBuffer::addData(quint16 arg1, quint16 arg2, quint16 arg3, quint16 arg4, quint16 arg5, quint16 arg6,
                          quint16 arg7, quint16 arg8)
 {
+    if (stale())
+    {
+        return;
+    }
     const quint16 args[8] = {arg1, arg2, arg3, arg4, arg5, arg6, arg7, arg8};
-    auto &buf = m_buffers[m_wrPtr];
+    if (m_ptr == 0)
+    {
+        m_fillTimer.start();
+    }
+    char *buf = m_frames.frame(m_wrPtr);
     for (quint16 value : args)
     {
         if (m_ptr + 2 > DATA_BUF_SIZE)
@@ -166,12 +498,28 @@ void DataBuffer::handleBufferFilled()
         if (!m_tcpThreadStarted.exchange(true))
         {
             qInfo() << "启动 TCP 线程";
-            TcpSocketWorker::instance().ensureRunning();
+            FrameStreamer *streamer = m_streamer.load();
+            (streamer ? *streamer : TcpSocketWorker::instance()).ensureRunning();
         }
         qInfo() << "写入成功，缓冲区:" << m_wrPtr;
-        writeEnd(m_wrPtr);
-        m_wrPtr = getWriteBuf();
+        auto &bufferMetrics = metrics();
+        bufferMetrics.framesFilled.add();
+        bufferMetrics.samples.add(m_samples);
+        m_samples = 0;
+        if (m_fillTimer.isValid())
+        {
+            bufferMetrics.fillUs.record(m_fillTimer.nsecsElapsed() / 1000);
+            m_fillTimer.invalidate();
+        }
+        // A frame filled across an interruption holds records that were meant to follow the
+        // dropped ones; it is reused instead of queued.
+        if (!stale())
+        {
+            writeEnd(m_wrPtr);
+            m_wrPtr = getWriteBuf();
+        }
         m_ptr = 0;
+        m_marks[m_wrPtr] = SourceMark();
     }
 }
 
@@ -179,9 +527,11 @@ void DataBuffer::handleBegin()
 {
     for (int i = 0; i < 2; ++i)
     {
-        addData(0, 0, 0, 0, 0, 0xFF00, 0, 0);
-        addProcessJumpData(0x8000, 0x8000, 0x8000, 0x8000, 0x8000);
-        addData(0, 0, 0, 0, 0, 0x1100, 0, 0);
+        addData(0, 0, 0, 0, 0, FLAG_BEGIN, 0, 0);
+        // Written directly rather than through addProcessJumpData, so the park jump is not
+        // counted as a job sample.
+        addData(PARK_CENTRE, PARK_CENTRE, PARK_CENTRE, PARK_CENTRE, PARK_CENTRE, 0);
+        addData(0, 0, 0, 0, 0, FLAG_END, 0, 0);
         forceFill();
     }
 }
\ No newline at end of file
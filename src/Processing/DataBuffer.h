@@ -1,47 +1,122 @@
 #pragma once
 
-#include <array>
 #include <atomic>
+#include <optional>
 
 #include <QByteArray>
+#include <QElapsedTimer>
 #include <QMutex>
 #include <QQueue>
 #include <QWaitCondition>
 #include <QtGlobal>
 
-class TcpSocketWorker;
+#include "FrameStreamer.h"
+#include "RealtimeMode.h"
+#include "SampleSink.h"
 
-class DataBuffer
+class DataBuffer : public SampleSink
 {
 public:
     static DataBuffer &instance();
 
-    QByteArray &buffer(int index);
+    DataBuffer();
+
+    // Streamer started on the first filled frame; defaults to TcpSocketWorker::instance(). A new
+    // streamer takes over from the next queued frame, so the previous one must have stopped.
+    void setStreamer(FrameStreamer *streamer);
+
+    // Frame behind an index from getReadBuf(); every frame is frameSize() bytes.
+    const char *frame(int index);
+    static constexpr int frameSize()
+    {
+        return DATA_BUF_SIZE;
+    }
+    // Moves the frames to locked, huge-page backed, prefaulted memory (or back to the heap).
+    // Only while no frame is in flight, i.e. before a job starts filling them.
+    bool setRealtimeMemory(bool enabled, QString &error);
+    // E.g. "4.0 MB locked, 4.0 MB on huge pages", followed by anything the system refused.
+    QString memoryStatus() const;
 
-    void addProcessData(quint16 X, quint16 Y, quint16 Z, quint16 A, quint16 B);
-    void addProcessJumpData(quint16 X, quint16 Y, quint16 Z, quint16 A, quint16 B);
-    void addProcessBegin();
-    void addProcessEnd();
+    void addProcessData(quint16 X, quint16 Y, quint16 Z, quint16 A, quint16 B) override;
+    void addProcessJumpData(quint16 X, quint16 Y, quint16 Z, quint16 A, quint16 B) override;
+    void addProcessBegin() override;
+    void addProcessEnd() override;
+    // Appends pre-generated 16-byte frame records (e.g. from a job file) in bulk.
+    void addRecords(const char *records, qint64 count);
+    // Records added from now on are records position, position + 1, ... of source id (e.g. a
+    // job), so an interrupted stream can tell which was the first one not sent; id 0 stops that.
+    void setSource(int id, qint64 position);
+    // Re-enters a process after an interruption: a begin record and a laser-off jump to where
+    // record (the first one not sent) starts, so the next mark does not start from the park spot.
+    void addResumeRecords(const char *record);
+    // Laser-off jump to the centre of the field followed by an end record: what the controller is
+    // given in place of the rest of the stream when it is interrupted.
+    static QByteArray parkRecords();
+    // Settings writes are skipped when the value matches what was last sent to the machine. The
+    // begin (park) sequence setFreqData starts with is always written.
     void setFreqData(int freq);
     void setPowerData(double power);
+    // Begin sequence, then only the changed settings, sharing a single frame flush.
+    void applySettings(int freq, double power);
+    // Any thread, e.g. the streamer on (re)connect: the next settings are written even if unchanged.
+    void invalidateSettings();
     void forceFill();
 
     int getWriteBuf();
     int getReadBuf();
+    int tryGetReadBuf(int timeoutMs);
     void writeEnd(int p);
     void readEnd(int p);
+    // Streamer: puts a frame taken with getReadBuf() back at the head of the queue, unsent, for
+    // whichever streamer runs next.
+    void requeueFront(int p);
+    int pendingFrames();
+    // Producer side: drops the filled frames the streamer has not taken yet and whatever the
+    // current frame holds; returns the filled frames dropped. The frame on the wire still goes out.
+    // Also acknowledges interruptQueued(), after which writes are accepted again.
+    int discardQueued();
+    // Any thread, e.g. the streamer being interrupted: drops the filled frames not taken yet and
+    // ignores every write until the producer calls discardQueued(), so nothing it was in the middle
+    // of is queued after all. Returns the frames dropped.
+    int interruptQueued();
+    // Streamer: frame index was cut after deliveredBytes; its source records past that point count
+    // as not sent. Returns the first of them, or -1 if the frame carried none of the current source.
+    qint64 cutFrame(int index, qint64 deliveredBytes);
+    int sourceId();
+    // First record of the current source not handed back by the streamer yet; -1 without a source.
+    qint64 unsentSource();
+    // True once every filled frame has been handed back by the streamer.
+    bool allFramesSent();
 
 private:
-    DataBuffer();
     void addData(quint16 arg1 = 0, quint16 arg2 = 0, quint16 arg3 = 0, quint16 arg4 = 0,
                  quint16 arg5 = 0, quint16 arg6 = 0, quint16 arg7 = 0, quint16 arg8 = 0);
     void handleBufferFilled();
     void handleBegin();
+    void writeFreqRecords(int freq);
+    void writePowerRecords(double power);
+    // Publishes the queue depths to the metrics registry; called with m_queueMutex held.
+    void updateQueueGauges();
+    // Producer side: an interruption happened that the producer has not acknowledged yet.
+    bool stale() const;
+    // Producer side: forgets the cached settings if invalidateSettings() was called since.
+    void dropInvalidSettings();
 
     static constexpr int DATA_BUF_NUM = 2;
     static constexpr int DATA_BUF_SIZE = 1'600'000;
+    static constexpr int RECORD_SIZE = 16;
+
+    // Where the records of the current source start in one frame.
+    struct SourceMark
+    {
+        int id{0};
+        qint64 first{0};
+        qint64 count{0};
+        int offset{0};
+    };
 
-    std::array<QByteArray, DATA_BUF_NUM> m_buffers{};
+    FramePool m_frames{DATA_BUF_NUM, DATA_BUF_SIZE};
+    SourceMark m_marks[DATA_BUF_NUM];
     QQueue<int> m_wrQueue;
     QQueue<int> m_rdQueue;
     int m_wrPtr{0};
@@ -50,4 +125,19 @@ private:
     QWaitCondition m_wrAvailable;
     QWaitCondition m_rdAvailable;
     std::atomic<bool> m_tcpThreadStarted{false};
+    std::atomic<FrameStreamer *> m_streamer{nullptr};
+    // Bumped by interruptQueued(); the producer writes nothing while its copy is behind.
+    std::atomic<quint64> m_epoch{0};
+    quint64 m_fillEpoch{0};
+    int m_sourceId{0};
+    // Next source record addRecords() writes, and the first one the streamer has not returned.
+    qint64 m_sourceNext{0};
+    qint64 m_sourceUnsent{0};
+    std::optional<int> m_lastFreq;
+    std::optional<double> m_lastPower;
+    std::atomic<bool> m_settingsInvalid{false};
+    // Samples written since the last frame handoff, added to the metrics counter per frame.
+    qint64 m_samples{0};
+    // Runs from the first write into the current frame to its handoff.
+    QElapsedTimer m_fillTimer;
 };
\ No newline at end of file
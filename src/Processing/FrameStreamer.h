@@ -0,0 +1,12 @@
+#pragma once
+
+// Consumer of a DataBuffer's filled frames (getReadBuf/tryGetReadBuf, then readEnd). TcpSocketWorker
+// sends them to the controller; RingFrameSender hands them to the streaming daemon.
+class FrameStreamer
+{
+public:
+    virtual ~FrameStreamer() = default;
+
+    // Starts the consuming thread if it is not running; called when a frame is ready.
+    virtual void ensureRunning() = 0;
+};
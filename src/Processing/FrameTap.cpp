@@ -0,0 +1,120 @@
+#include "FrameTap.h"
+
+#include <cstring>
+
+namespace
+{
+    constexpr quint16 FLAG_LASER_ON = 0x00FF;
+    constexpr quint16 FLAG_JUMP = 0;
+    // Settings markers (frequency start/end, power); a flag-0 record right after one is its payload.
+    constexpr quint16 FLAG_FREQ_BEGIN = 0xAA00;
+    constexpr quint16 FLAG_FREQ_END = 0x5500;
+    constexpr quint16 FLAG_POWER = 0xbb00;
+    constexpr int RECORD_SIZE = 16;
+}
+
+FrameTap::FrameTap(int capacity, int stride)
+    : m_stride(qMax(1, stride))
+{
+    quint64 size = 16;
+    while (size < static_cast<quint64>(capacity))
+    {
+        size <<= 1;
+    }
+    m_ring.resize(size);
+    m_mask = size - 1;
+}
+
+void FrameTap::setEnabled(bool enabled)
+{
+    m_enabled.store(enabled, std::memory_order_release);
+}
+
+bool FrameTap::isEnabled() const
+{
+    return m_enabled.load(std::memory_order_acquire);
+}
+
+void FrameTap::setStride(int stride)
+{
+    m_stride.store(qMax(1, stride), std::memory_order_relaxed);
+}
+
+void FrameTap::offerFrame(const char *data, qint64 size)
+{
+    if (!isEnabled())
+    {
+        return;
+    }
+    const int stride = m_stride.load(std::memory_order_relaxed);
+    const qint64 count = size / RECORD_SIZE;
+    quint16 words[8];
+    for (qint64 i = 0; i < count; ++i)
+    {
+        std::memcpy(words, data + i * RECORD_SIZE, sizeof(words));
+        const bool payload = m_settingsPayload;
+        m_settingsPayload = words[5] == FLAG_FREQ_BEGIN || words[5] == FLAG_FREQ_END || words[5] == FLAG_POWER;
+        // Record layout: B, A, Z, Y, X, flag, 0, 0; settings and control records are skipped, and
+        // so are settings payloads and the all-zero padding that fills out short frames.
+        if (words[5] != FLAG_LASER_ON && words[5] != FLAG_JUMP)
+        {
+            continue;
+        }
+        if (words[5] == FLAG_JUMP && (payload || (words[0] | words[1] | words[2] | words[3] | words[4]) == 0))
+        {
+            continue;
+        }
+        const int on = words[5] == FLAG_LASER_ON ? 1 : 0;
+        if (on == m_lastOn && ++m_sinceLast < stride)
+        {
+            continue;
+        }
+        m_sinceLast = 0;
+        m_lastOn = on;
+        m_offered.fetch_add(1, std::memory_order_relaxed);
+        if (!push({words[4], words[3], words[2], static_cast<quint8>(on), 0}))
+        {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+bool FrameTap::push(const TapPoint &point)
+{
+    const quint64 head = m_head.load(std::memory_order_relaxed);
+    if (head - m_tail.load(std::memory_order_acquire) > m_mask)
+    {
+        return false;
+    }
+    m_ring[head & m_mask] = point;
+    m_head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+int FrameTap::drain(TapPoint *out, int max)
+{
+    const quint64 tail = m_tail.load(std::memory_order_relaxed);
+    const quint64 available = m_head.load(std::memory_order_acquire) - tail;
+    const int n = static_cast<int>(qMin<quint64>(available, static_cast<quint64>(qMax(0, max))));
+    for (int i = 0; i < n; ++i)
+    {
+        out[i] = m_ring[(tail + i) & m_mask];
+    }
+    m_tail.store(tail + n, std::memory_order_release);
+    return n;
+}
+
+void FrameTap::clear()
+{
+    m_tail.store(m_head.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+qint64 FrameTap::dropped() const
+{
+    return m_dropped.load(std::memory_order_relaxed);
+}
+
+qint64 FrameTap::offered() const
+{
+    return m_offered.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include <QtGlobal>
+
+// One decimated toolpath sample in raw device counts, as found in a frame record.
+struct TapPoint
+{
+    quint16 x;
+    quint16 y;
+    quint16 z;
+    quint8 laserOn;
+    quint8 reserved;
+};
+
+// Single-producer/single-consumer ring between the streaming thread and a viewer. The
+// producer keeps every stride-th position record plus every laser on/off change and never
+// blocks: when the consumer falls behind, new samples are dropped and counted instead.
+class FrameTap
+{
+public:
+    explicit FrameTap(int capacity = 1 << 16, int stride = 16);
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const;
+    void setStride(int stride);
+
+    // Producer side: scans one frame of 16-byte records.
+    void offerFrame(const char *data, qint64 size);
+    // Consumer side: moves up to max samples into out and returns how many.
+    int drain(TapPoint *out, int max);
+    void clear();
+
+    qint64 dropped() const;
+    qint64 offered() const;
+
+private:
+    bool push(const TapPoint &point);
+
+    std::vector<TapPoint> m_ring;
+    quint64 m_mask;
+    std::atomic<bool> m_enabled{false};
+    std::atomic<int> m_stride;
+    // Producer-only decimation state.
+    int m_sinceLast{0};
+    int m_lastOn{-1};
+    // The previous record was a settings marker, possibly in the previous frame.
+    bool m_settingsPayload{false};
+    alignas(64) std::atomic<quint64> m_head{0};
+    alignas(64) std::atomic<quint64> m_tail{0};
+    std::atomic<qint64> m_dropped{0};
+    std::atomic<qint64> m_offered{0};
+};
@@ -0,0 +1,306 @@
+#include "JobCompiler.h"
+
+#include <atomic>
+#include <string>
+
+#include <QElapsedTimer>
+#include <QThread>
+#include <QThreadPool>
+
+#include "SampleSink.h"
+#include "ShapeGenerator.h"
+#include "ThreeAxisGenerator.h"
+#include "mesh/Parallel.h"
+
+namespace
+{
+    constexpr quint16 FLAG_LASER_ON = 0x00FF;
+    constexpr quint16 FLAG_JUMP = 0;
+    constexpr quint16 FLAG_BEGIN = 0xFF00;
+    constexpr quint16 FLAG_END = 0x1100;
+    // Shapes vary a lot in cost (a long hatch vs. a short line or a re-offset), so hand out
+    // more tasks than threads to keep every core busy until the end.
+    constexpr int TASKS_PER_THREAD = 8;
+
+    // Writes records with the layout DataBuffer::addData uses (B, A, Z, Y, X, flag, 0, 0). The
+    // begin/end markers are kept; the handshake frames DataBuffer adds on addProcessBegin are a
+    // property of the stream, not of the shape, and are left out as for job file segments.
+    class FrameRecordWriter : public SampleSink
+    {
+    public:
+        explicit FrameRecordWriter(std::vector<jobfile::FrameRecord> &records)
+            : m_records(records)
+        {
+        }
+
+        void addProcessData(quint16 X, quint16 Y, quint16 Z, quint16 A, quint16 B) override
+        {
+            m_records.push_back({{B, A, Z, Y, X, FLAG_LASER_ON, 0, 0}});
+        }
+
+        void addProcessJumpData(quint16 X, quint16 Y, quint16 Z, quint16 A, quint16 B) override
+        {
+            m_records.push_back({{B, A, Z, Y, X, FLAG_JUMP, 0, 0}});
+        }
+
+        void addProcessBegin() override
+        {
+            m_records.push_back({{0, 0, 0, 0, 0, FLAG_BEGIN, 0, 0}});
+        }
+
+        void addProcessEnd() override
+        {
+            m_records.push_back({{0, 0, 0, 0, 0, FLAG_END, 0, 0}});
+        }
+
+    private:
+        std::vector<jobfile::FrameRecord> &m_records;
+    };
+
+    bool isMotion(const jobfile::FrameRecord &record)
+    {
+        return record.words[5] == FLAG_LASER_ON || record.words[5] == FLAG_JUMP;
+    }
+
+    // The point a translation moves the shape by; positions are keyed relative to it.
+    QPointF anchorOf(const SceneShape &shape)
+    {
+        switch (shape.shape_case())
+        {
+        case SceneShape::kLine:
+            return QPointF(shape.line().x1(), shape.line().y1());
+        case SceneShape::kCircle:
+            return QPointF(shape.circle().x1(), shape.circle().y1());
+        case SceneShape::kRectangle:
+            return QPointF(shape.rectangle().x0(), shape.rectangle().y0());
+        case SceneShape::kEllipse:
+            return QPointF(shape.ellipse().x0(), shape.ellipse().y0());
+        default:
+            return QPointF();
+        }
+    }
+
+    // Serialized shape with the anchor moved to the origin and isLast cleared: isLast only
+    // marks the end of a submission and does not change the path.
+    QByteArray cacheKey(const SceneShape &shape, const QPointF &anchor)
+    {
+        SceneShape local(shape);
+        switch (local.shape_case())
+        {
+        case SceneShape::kLine:
+        {
+            auto *line = local.mutable_line();
+            line->set_x1(line->x1() - anchor.x());
+            line->set_y1(line->y1() - anchor.y());
+            line->set_x2(line->x2() - anchor.x());
+            line->set_y2(line->y2() - anchor.y());
+            line->set_islast(false);
+            break;
+        }
+        case SceneShape::kCircle:
+        {
+            auto *circle = local.mutable_circle();
+            circle->set_x1(circle->x1() - anchor.x());
+            circle->set_y1(circle->y1() - anchor.y());
+            circle->set_x2(circle->x2() - anchor.x());
+            circle->set_y2(circle->y2() - anchor.y());
+            circle->set_islast(false);
+            break;
+        }
+        case SceneShape::kRectangle:
+        {
+            auto *rect = local.mutable_rectangle();
+            rect->set_x0(rect->x0() - anchor.x());
+            rect->set_y0(rect->y0() - anchor.y());
+            rect->set_x1(rect->x1() - anchor.x());
+            rect->set_y1(rect->y1() - anchor.y());
+            rect->set_islast(false);
+            break;
+        }
+        case SceneShape::kEllipse:
+        {
+            auto *ellipse = local.mutable_ellipse();
+            ellipse->set_x0(ellipse->x0() - anchor.x());
+            ellipse->set_y0(ellipse->y0() - anchor.y());
+            ellipse->set_islast(false);
+            break;
+        }
+        default:
+            break;
+        }
+        std::string bytes;
+        local.SerializeToString(&bytes);
+        return QByteArray(bytes.data(), static_cast<qsizetype>(bytes.size()));
+    }
+}
+
+std::vector<jobfile::FrameRecord> JobCompiler::Result::merged() const
+{
+    std::vector<jobfile::FrameRecord> all;
+    all.reserve(static_cast<size_t>(records));
+    for (const auto &shape : shapes)
+    {
+        all.insert(all.end(), shape->records.begin(), shape->records.end());
+    }
+    return all;
+}
+
+std::shared_ptr<const JobCompiler::CompiledShape> JobCompiler::compileShape(const SceneShape &shape)
+{
+    auto compiled = std::make_shared<CompiledShape>();
+    FrameRecordWriter writer(compiled->records);
+    // Shapes the local generators would only approximate (arcs, fills, layers, ...) are skipped
+    // and reported rather than compiled into something the controller would not have run.
+    compiled->skipReason = ShapeGenerator::unsupported(shape);
+    if (compiled->skipReason.isEmpty())
+    {
+        compiled->originLeadIn = shape.shape_case() == SceneShape::kRectangle;
+        ShapeGenerator::generate(writer, shape);
+    }
+    compiled->records.shrink_to_fit();
+    compiled->anchor = anchorOf(shape);
+    for (const auto &record : compiled->records)
+    {
+        if (isMotion(record))
+        {
+            compiled->minX = qMin(compiled->minX, record.words[4]);
+            compiled->maxX = qMax(compiled->maxX, record.words[4]);
+            compiled->minY = qMin(compiled->minY, record.words[3]);
+            compiled->maxY = qMax(compiled->maxY, record.words[3]);
+        }
+    }
+    return compiled;
+}
+
+std::shared_ptr<const JobCompiler::CompiledShape>
+JobCompiler::translated(const std::shared_ptr<const CompiledShape> &compiled, const QPointF &anchor)
+{
+    const std::shared_ptr<const CompiledShape> base = compiled->base ? compiled->base : compiled;
+    if (base->originLeadIn)
+    {
+        return nullptr;
+    }
+    if (base->anchor == anchor)
+    {
+        return base;
+    }
+    // The calibration is affine in X/Y at a fixed Z, so a workpiece translation is the same
+    // device-count offset for every sample of the shape.
+    double fromX = base->anchor.x();
+    double fromY = base->anchor.y();
+    double fromZ = 0.0;
+    double toX = anchor.x();
+    double toY = anchor.y();
+    double toZ = 0.0;
+    ThreeAxisGenerator::applyCorrection(fromX, fromY, fromZ);
+    ThreeAxisGenerator::applyCorrection(toX, toY, toZ);
+    const qint64 dx = qRound64(toX - fromX);
+    const qint64 dy = qRound64(toY - fromY);
+
+    const bool hasMotion = base->minX <= base->maxX;
+    if (hasMotion && (base->minX == 0 || base->minY == 0 || base->maxX == 0xFFFF || base->maxY == 0xFFFF ||
+                      base->minX + dx <= 0 || base->minY + dy <= 0 || base->maxX + dx >= 0xFFFF ||
+                      base->maxY + dy >= 0xFFFF))
+    {
+        return nullptr;
+    }
+    auto moved = std::make_shared<CompiledShape>(*base);
+    moved->anchor = anchor;
+    moved->base = base;
+    if (hasMotion)
+    {
+        for (auto &record : moved->records)
+        {
+            if (isMotion(record))
+            {
+                record.words[4] = static_cast<quint16>(record.words[4] + dx);
+                record.words[3] = static_cast<quint16>(record.words[3] + dy);
+            }
+        }
+        moved->minX = static_cast<quint16>(base->minX + dx);
+        moved->maxX = static_cast<quint16>(base->maxX + dx);
+        moved->minY = static_cast<quint16>(base->minY + dy);
+        moved->maxY = static_cast<quint16>(base->maxY + dy);
+    }
+    return moved;
+}
+
+JobCompiler::Result JobCompiler::compile(const SceneData &scene, int threads)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    const int count = scene.shapes_size();
+    Result result;
+    result.shapes.resize(count);
+    std::vector<QByteArray> keys(count);
+    std::vector<QPointF> anchors(count);
+    // Shapes that need work: generation, or re-offsetting the cached entry left in their slot.
+    std::vector<int> work;
+    for (int i = 0; i < count; ++i)
+    {
+        anchors[i] = anchorOf(scene.shapes(i));
+        keys[i] = cacheKey(scene.shapes(i), anchors[i]);
+        result.shapes[i] = m_cache.value(keys[i]);
+        if (result.shapes[i] && result.shapes[i]->anchor == anchors[i])
+        {
+            ++result.cached;
+        }
+        else
+        {
+            work.push_back(i);
+        }
+    }
+
+    // Tasks take contiguous runs of the work list and write only their own slots, so there
+    // is no locking and the result does not depend on completion order.
+    QThreadPool pool;
+    pool.setMaxThreadCount(threads > 0 ? threads : QThread::idealThreadCount());
+    const int workCount = static_cast<int>(work.size());
+    const int tasks = qMin(workCount, pool.maxThreadCount() * TASKS_PER_THREAD);
+    std::atomic<int> generated{0};
+    std::atomic<bool> cancelled{false};
+    mesh::runParallel(pool, tasks, [&](int task) {
+        for (int w = workCount * task / tasks; w < workCount * (task + 1) / tasks; ++w)
+        {
+            auto &slot = result.shapes[work[w]];
+            if (slot)
+            {
+                slot = translated(slot, anchors[work[w]]);
+            }
+            if (!slot)
+            {
+                slot = compileShape(scene.shapes(work[w]));
+                generated.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }, 0.0, 1.0, {}, cancelled);
+    result.compiled = generated.load();
+    result.reoffset = workCount - result.compiled;
+
+    QHash<QByteArray, std::shared_ptr<const CompiledShape>> cache;
+    cache.reserve(count);
+    for (int i = 0; i < count; ++i)
+    {
+        const auto &shape = result.shapes[i];
+        result.records += static_cast<qint64>(shape->records.size());
+        if (!shape->skipReason.isEmpty())
+        {
+            ++result.skipped;
+        }
+        cache.insert(keys[i], shape);
+    }
+    m_cache.swap(cache);
+    result.ms = timer.nsecsElapsed() / 1e6;
+    return result;
+}
+
+void JobCompiler::clearCache()
+{
+    m_cache.clear();
+}
+
+int JobCompiler::cacheSize() const
+{
+    return static_cast<int>(m_cache.size());
+}
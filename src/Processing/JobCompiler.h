@@ -0,0 +1,83 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <QByteArray>
+#include <QHash>
+#include <QPointF>
+#include <QString>
+#include <QtGlobal>
+
+#include "JobFile.h"
+#include "five_axis.pb.h"
+
+// Compiles a whole scene into the 16-byte frame records DataBuffer streams. Shapes that need
+// generating are split into contiguous runs, one pool task per run, and come back in scene
+// order, so the output is the same however the tasks were scheduled. Compiled shapes are cached
+// by their serialized message with the geometry taken relative to the shape's anchor point (line
+// start, circle centre, rectangle corner), so the key covers shape and process parameters but
+// not position. A shape that did not change is reused as-is; one that was only translated gets
+// the records it was generated with re-offset in device counts, which is exact up to one count
+// of rounding however often it moves. Rectangles start with a jump from the workpiece origin
+// whose length depends on where they sit, so a moved rectangle is generated again like every
+// shape with a new key.
+class JobCompiler
+{
+public:
+    struct CompiledShape
+    {
+        std::vector<jobfile::FrameRecord> records;
+        // Empty when the shape compiled; otherwise why it produced no records.
+        QString skipReason;
+        // Workpiece position of the anchor the records are for.
+        QPointF anchor;
+        // The generated shape these records were re-offset from, nullptr for a generated one.
+        // Every move starts from it, so rounding does not build up over repeated moves.
+        std::shared_ptr<const CompiledShape> base;
+        // The records start with a jump from the workpiece origin, which does not move with the
+        // shape; such a shape cannot be re-offset.
+        bool originLeadIn{false};
+        // Device-count range of the motion records; a range touching either end may have been
+        // clamped and cannot be re-offset.
+        quint16 minX{0xFFFF};
+        quint16 minY{0xFFFF};
+        quint16 maxX{0};
+        quint16 maxY{0};
+    };
+
+    struct Result
+    {
+        // Same order as the scene's shapes.
+        std::vector<std::shared_ptr<const CompiledShape>> shapes;
+        qint64 records{0};
+        // Generated from scratch.
+        int compiled{0};
+        // Unchanged since the previous compile.
+        int cached{0};
+        // Moved since the previous compile: cached records shifted, nothing generated.
+        int reoffset{0};
+        int skipped{0};
+        double ms{0.0};
+
+        // All records in scene order, e.g. for JobFile::save.
+        std::vector<jobfile::FrameRecord> merged() const;
+    };
+
+    // One compile at a time per compiler; it may run on any thread. threads <= 0 uses all cores.
+    Result compile(const SceneData &scene, int threads = 0);
+    void clearCache();
+    int cacheSize() const;
+
+    // Generates one shape with ShapeGenerator, as HeadlessRunner's local mode does; a shape it
+    // cannot reproduce exactly gets a skipReason and no records.
+    static std::shared_ptr<const CompiledShape> compileShape(const SceneShape &shape);
+    // The records compiled was generated with, moved so its anchor lands on anchor; nullptr if
+    // that would leave the device range or the shape has an origin lead-in.
+    static std::shared_ptr<const CompiledShape> translated(const std::shared_ptr<const CompiledShape> &compiled,
+                                                           const QPointF &anchor);
+
+private:
+    // Holds exactly the shapes of the last compile, so it never outgrows the scene.
+    QHash<QByteArray, std::shared_ptr<const CompiledShape>> m_cache;
+};
@@ -0,0 +1,191 @@
+#include "JobCompilerBenchmark.h"
+
+#include <cstdlib>
+
+#include <QRandomGenerator>
+
+#include "JobCompiler.h"
+
+namespace
+{
+    // Inside the galvo field with room to move; at Z_OFFSET the Z term of the calibration is zero.
+    constexpr double FIELD_MM = 30.0;
+    constexpr double Z_MM = 4.5;
+    // Fast enough that the scene stays in the tens of megabytes of records.
+    constexpr double SPEED_MM_S = 1000.0;
+    constexpr double MOVE_DX_MM = 0.75;
+    constexpr double MOVE_DY_MM = -0.5;
+    constexpr double RECT_SPACING_MM = 0.1;
+
+    void addShape(SceneData &scene, QRandomGenerator &random, int index)
+    {
+        const double x = random.bounded(FIELD_MM) - FIELD_MM / 2.0;
+        const double y = random.bounded(FIELD_MM) - FIELD_MM / 2.0;
+        const double size = 0.5 + random.bounded(2.5);
+        if (index % 3 == 0)
+        {
+            auto *line = scene.add_shapes()->mutable_line();
+            line->set_speed(SPEED_MM_S);
+            line->set_times(1);
+            line->set_x1(x);
+            line->set_y1(y);
+            line->set_z1(Z_MM);
+            line->set_x2(x + size);
+            line->set_y2(y + size / 2.0);
+            line->set_z2(Z_MM);
+        }
+        else if (index % 3 == 1)
+        {
+            auto *circle = scene.add_shapes()->mutable_circle();
+            circle->set_speed(SPEED_MM_S);
+            circle->set_times(1);
+            circle->set_x1(x);
+            circle->set_y1(y);
+            circle->set_x2(x + size / 2.0);
+            circle->set_y2(y);
+            // Full circles at one Z: what the local generator reproduces.
+            circle->set_angle(360.0);
+            circle->set_z_start(Z_MM);
+            circle->set_z_end(Z_MM);
+        }
+        else
+        {
+            auto *rect = scene.add_shapes()->mutable_rectangle();
+            rect->set_speed(SPEED_MM_S);
+            rect->set_times(1);
+            rect->set_x0(x);
+            rect->set_y0(y);
+            rect->set_x1(x + size / 2.0);
+            rect->set_y1(y + size / 4.0);
+            rect->set_z_start(Z_MM);
+            rect->set_z_end(Z_MM);
+            rect->set_feedspacing_y(RECT_SPACING_MM);
+        }
+    }
+
+    void moveShape(SceneShape &shape, double dx, double dy)
+    {
+        if (shape.has_line())
+        {
+            auto *line = shape.mutable_line();
+            line->set_x1(line->x1() + dx);
+            line->set_y1(line->y1() + dy);
+            line->set_x2(line->x2() + dx);
+            line->set_y2(line->y2() + dy);
+        }
+        else if (shape.has_circle())
+        {
+            auto *circle = shape.mutable_circle();
+            circle->set_x1(circle->x1() + dx);
+            circle->set_y1(circle->y1() + dy);
+            circle->set_x2(circle->x2() + dx);
+            circle->set_y2(circle->y2() + dy);
+        }
+        else if (shape.has_rectangle())
+        {
+            auto *rect = shape.mutable_rectangle();
+            rect->set_x0(rect->x0() + dx);
+            rect->set_y0(rect->y0() + dy);
+            rect->set_x1(rect->x1() + dx);
+            rect->set_y1(rect->y1() + dy);
+        }
+    }
+
+    // Largest X/Y difference between two record lists, or -1 if they are not the same shape.
+    int deviation(const JobCompiler::CompiledShape &a, const JobCompiler::CompiledShape &b)
+    {
+        if (a.records.size() != b.records.size())
+        {
+            return -1;
+        }
+        int worst = 0;
+        for (size_t i = 0; i < a.records.size(); ++i)
+        {
+            const auto &wa = a.records[i].words;
+            const auto &wb = b.records[i].words;
+            if (wa[5] != wb[5] || wa[2] != wb[2])
+            {
+                return -1;
+            }
+            worst = qMax(worst, std::abs(wa[4] - wb[4]));
+            worst = qMax(worst, std::abs(wa[3] - wb[3]));
+        }
+        return worst;
+    }
+}
+
+JobCompilerBenchmark::Result JobCompilerBenchmark::run(int shapes)
+{
+    Result result;
+    result.shapes = shapes;
+
+    SceneData scene;
+    QRandomGenerator random(42);
+    for (int i = 0; i < shapes; ++i)
+    {
+        addShape(scene, random, i);
+    }
+
+    JobCompiler compiler;
+    const auto full = compiler.compile(scene);
+    result.records = full.records;
+    result.fullMs = full.ms;
+    if (full.compiled != shapes)
+    {
+        result.failures.append(QStringLiteral("first compile generated %1 of %2 shapes").arg(full.compiled).arg(shapes));
+    }
+
+    // One contiguous group, as a rubber-band drag moves it.
+    result.moved = qMax(1, shapes / 100);
+    const int first = shapes / 2;
+    // Rectangles carry a lead-in jump from the origin and are generated again when moved.
+    int movedRectangles = 0;
+    for (int i = first; i < first + result.moved; ++i)
+    {
+        moveShape(*scene.mutable_shapes(i), MOVE_DX_MM, MOVE_DY_MM);
+        movedRectangles += scene.shapes(i).has_rectangle() ? 1 : 0;
+    }
+    const auto moved = compiler.compile(scene);
+    result.moveMs = moved.ms;
+    result.moveGenerated = moved.compiled;
+    result.moveReoffset = moved.reoffset;
+    if (moved.compiled != movedRectangles || moved.reoffset != result.moved - movedRectangles ||
+        moved.cached != shapes - result.moved)
+    {
+        result.failures.append(QStringLiteral("move: %1 generated, %2 re-offset, %3 cached; expected %4, %5, %6")
+                                   .arg(moved.compiled)
+                                   .arg(moved.reoffset)
+                                   .arg(moved.cached)
+                                   .arg(movedRectangles)
+                                   .arg(result.moved - movedRectangles)
+                                   .arg(shapes - result.moved));
+    }
+    for (int i = first; i < first + result.moved; ++i)
+    {
+        const int worst = deviation(*moved.shapes[i], *JobCompiler::compileShape(scene.shapes(i)));
+        if (worst < 0 || (scene.shapes(i).has_rectangle() && worst != 0))
+        {
+            result.failures.append(QStringLiteral("shape %1: moved records differ from a fresh compile").arg(i + 1));
+            break;
+        }
+        result.maxDeviation = qMax(result.maxDeviation, worst);
+    }
+    if (result.maxDeviation > 1)
+    {
+        result.failures.append(QStringLiteral("re-offset is off by up to %1 counts").arg(result.maxDeviation));
+    }
+
+    // A parameter change is a new key: that shape, and only that one, is generated again.
+    auto *edited = scene.mutable_shapes(0)->mutable_line();
+    edited->set_speed(edited->speed() * 0.5);
+    const auto edit = compiler.compile(scene);
+    result.editMs = edit.ms;
+    result.editGenerated = edit.compiled;
+    if (edit.compiled != 1 || edit.reoffset != 0)
+    {
+        result.failures.append(QStringLiteral("edit: %1 generated, %2 re-offset; expected 1, 0")
+                                   .arg(edit.compiled)
+                                   .arg(edit.reoffset));
+    }
+    return result;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <QStringList>
+#include <QtGlobal>
+
+// Recompiling a large scene of lines, circles and rectangles after the edits the drawing makes
+// most: moving 1% of the shapes and changing the parameters of one. Counts how many shapes each
+// pass had to generate and checks every moved shape record for record against generating it
+// again at its new position.
+class JobCompilerBenchmark
+{
+public:
+    struct Result
+    {
+        int shapes{0};
+        qint64 records{0};
+        double fullMs{0.0};
+        int moved{0};
+        double moveMs{0.0};
+        int moveGenerated{0};
+        int moveReoffset{0};
+        // Largest X/Y difference, in device counts, between a re-offset and a generated shape.
+        int maxDeviation{0};
+        double editMs{0.0};
+        int editGenerated{0};
+        // One line per failed check; empty when every pass did what it should.
+        QStringList failures;
+    };
+
+    static Result run(int shapes);
+};
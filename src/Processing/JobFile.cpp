@@ -0,0 +1,471 @@
+#include "JobFile.h"
+
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include <QSaveFile>
+
+using namespace jobfile;
+
+static_assert(Q_BYTE_ORDER == Q_LITTLE_ENDIAN, "job files are mapped in place and stored little-endian");
+static_assert(sizeof(FileHeader) == 200, "FileHeader layout changed; bump VERSION");
+static_assert(sizeof(ShapeRef) == 8, "ShapeRef layout changed; bump VERSION");
+static_assert(sizeof(LineRecord) == 96, "LineRecord layout changed; bump VERSION");
+static_assert(sizeof(CircleRecord) == 120, "CircleRecord layout changed; bump VERSION");
+static_assert(sizeof(RectangleRecord) == 128, "RectangleRecord layout changed; bump VERSION");
+static_assert(sizeof(EllipseRecord) == 128, "EllipseRecord layout changed; bump VERSION");
+static_assert(sizeof(FrameRecord) == 16, "FrameRecord must match the DataBuffer record size");
+static_assert(std::is_trivially_copyable_v<FileHeader> && std::is_trivially_copyable_v<CircleRecord>,
+              "job records must stay POD");
+
+namespace
+{
+    constexpr quint64 SECTION_ALIGN = 16;
+
+    quint64 alignUp(quint64 value)
+    {
+        return (value + SECTION_ALIGN - 1) & ~(SECTION_ALIGN - 1);
+    }
+
+    constexpr quint32 RECORD_SIZES[SectionCount] = {
+        sizeof(ShapeRef), sizeof(LineRecord), sizeof(CircleRecord),
+        sizeof(RectangleRecord), sizeof(EllipseRecord), sizeof(FrameRecord),
+    };
+
+    LineRecord toRecord(const LineData &d)
+    {
+        LineRecord r{};
+        r.speed = d.speed();
+        r.x1 = d.x1();
+        r.y1 = d.y1();
+        r.z1 = d.z1();
+        r.a1 = d.a1();
+        r.b1 = d.b1();
+        r.x2 = d.x2();
+        r.y2 = d.y2();
+        r.z2 = d.z2();
+        r.a2 = d.a2();
+        r.b2 = d.b2();
+        r.times = d.times();
+        return r;
+    }
+
+    CircleRecord toRecord(const CircleData &d)
+    {
+        CircleRecord r{};
+        r.speed = d.speed();
+        r.x1 = d.x1();
+        r.y1 = d.y1();
+        r.x2 = d.x2();
+        r.y2 = d.y2();
+        r.angle = d.angle();
+        r.taper = d.taper();
+        r.rMin = d.r_min();
+        r.rInterval = d.r_interval();
+        r.zStart = d.z_start();
+        r.zEnd = d.z_end();
+        r.zInterval = d.z_interval();
+        r.times = d.times();
+        r.m = d.m();
+        r.circleNumRepair = d.circle_num_repair();
+        r.timesRepair = d.times_repair();
+        r.filled = d.filled() ? 1 : 0;
+        return r;
+    }
+
+    RectangleRecord toRecord(const RectangleData &d)
+    {
+        RectangleRecord r{};
+        r.x0 = d.x0();
+        r.y0 = d.y0();
+        r.x1 = d.x1();
+        r.y1 = d.y1();
+        r.x2 = d.x2();
+        r.y2 = d.y2();
+        r.taperAMax = d.taper_a_max();
+        r.taperBMax = d.taper_b_max();
+        r.feedSpacingX = d.feedspacing_x();
+        r.feedSpacingY = d.feedspacing_y();
+        r.speed = d.speed();
+        r.zStart = d.z_start();
+        r.zEnd = d.z_end();
+        r.zInterval = d.z_interval();
+        r.times = d.times();
+        r.circleNumRepair = d.circle_num_repair();
+        r.timesRepair = d.times_repair();
+        return r;
+    }
+
+    EllipseRecord toRecord(const EllipseData &d)
+    {
+        EllipseRecord r{};
+        r.x0 = d.x0();
+        r.y0 = d.y0();
+        r.aMax = d.a_max();
+        r.bMax = d.b_max();
+        r.aMin = d.a_min();
+        r.bMin = d.b_min();
+        r.taperAMax = d.taper_a_max();
+        r.taperBMax = d.taper_b_max();
+        r.feedSpacingX = d.feedspacing_x();
+        r.feedSpacingY = d.feedspacing_y();
+        r.speed = d.speed();
+        r.zStart = d.z_start();
+        r.zEnd = d.z_end();
+        r.zInterval = d.z_interval();
+        r.times = d.times();
+        r.circleNumRepair = d.circle_num_repair();
+        r.timesRepair = d.times_repair();
+        return r;
+    }
+
+    void fromRecord(const LineRecord &r, LineData &d)
+    {
+        d.set_speed(r.speed);
+        d.set_x1(r.x1);
+        d.set_y1(r.y1);
+        d.set_z1(r.z1);
+        d.set_a1(r.a1);
+        d.set_b1(r.b1);
+        d.set_x2(r.x2);
+        d.set_y2(r.y2);
+        d.set_z2(r.z2);
+        d.set_a2(r.a2);
+        d.set_b2(r.b2);
+        d.set_times(r.times);
+    }
+
+    void fromRecord(const CircleRecord &r, CircleData &d)
+    {
+        d.set_speed(r.speed);
+        d.set_x1(r.x1);
+        d.set_y1(r.y1);
+        d.set_x2(r.x2);
+        d.set_y2(r.y2);
+        d.set_angle(r.angle);
+        d.set_taper(r.taper);
+        d.set_r_min(r.rMin);
+        d.set_r_interval(r.rInterval);
+        d.set_z_start(r.zStart);
+        d.set_z_end(r.zEnd);
+        d.set_z_interval(r.zInterval);
+        d.set_times(r.times);
+        d.set_m(r.m);
+        d.set_circle_num_repair(r.circleNumRepair);
+        d.set_times_repair(r.timesRepair);
+        d.set_filled(r.filled != 0);
+    }
+
+    void fromRecord(const RectangleRecord &r, RectangleData &d)
+    {
+        d.set_x0(r.x0);
+        d.set_y0(r.y0);
+        d.set_x1(r.x1);
+        d.set_y1(r.y1);
+        d.set_x2(r.x2);
+        d.set_y2(r.y2);
+        d.set_taper_a_max(r.taperAMax);
+        d.set_taper_b_max(r.taperBMax);
+        d.set_feedspacing_x(r.feedSpacingX);
+        d.set_feedspacing_y(r.feedSpacingY);
+        d.set_speed(r.speed);
+        d.set_z_start(r.zStart);
+        d.set_z_end(r.zEnd);
+        d.set_z_interval(r.zInterval);
+        d.set_times(r.times);
+        d.set_circle_num_repair(r.circleNumRepair);
+        d.set_times_repair(r.timesRepair);
+    }
+
+    void fromRecord(const EllipseRecord &r, EllipseData &d)
+    {
+        d.set_x0(r.x0);
+        d.set_y0(r.y0);
+        d.set_a_max(r.aMax);
+        d.set_b_max(r.bMax);
+        d.set_a_min(r.aMin);
+        d.set_b_min(r.bMin);
+        d.set_taper_a_max(r.taperAMax);
+        d.set_taper_b_max(r.taperBMax);
+        d.set_feedspacing_x(r.feedSpacingX);
+        d.set_feedspacing_y(r.feedSpacingY);
+        d.set_speed(r.speed);
+        d.set_z_start(r.zStart);
+        d.set_z_end(r.zEnd);
+        d.set_z_interval(r.zInterval);
+        d.set_times(r.times);
+        d.set_circle_num_repair(r.circleNumRepair);
+        d.set_times_repair(r.timesRepair);
+    }
+
+    template <typename Record>
+    bool writeSection(QSaveFile &file, const Record *records, quint64 count, quint64 offset)
+    {
+        static const char padding[SECTION_ALIGN] = {};
+        const qint64 gap = static_cast<qint64>(offset) - file.pos();
+        if (gap > 0 && file.write(padding, gap) != gap)
+        {
+            return false;
+        }
+        const qint64 bytes = static_cast<qint64>(count * sizeof(Record));
+        return bytes == 0 || file.write(reinterpret_cast<const char *>(records), bytes) == bytes;
+    }
+}
+
+std::unique_ptr<JobFile> JobFile::open(const QString &path, QString &error)
+{
+    std::unique_ptr<JobFile> job(new JobFile());
+    job->m_file.setFileName(path);
+    if (!job->m_file.open(QIODevice::ReadOnly))
+    {
+        error = job->m_file.errorString();
+        return nullptr;
+    }
+    job->m_size = job->m_file.size();
+    if (job->m_size < static_cast<qint64>(sizeof(FileHeader)))
+    {
+        error = QStringLiteral("file too small for a job header");
+        return nullptr;
+    }
+    job->m_data = job->m_file.map(0, job->m_size);
+    if (!job->m_data)
+    {
+        error = job->m_file.errorString();
+        return nullptr;
+    }
+
+    const auto *header = reinterpret_cast<const FileHeader *>(job->m_data);
+    if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0)
+    {
+        error = QStringLiteral("not a job file");
+        return nullptr;
+    }
+    if (header->version != VERSION || header->headerSize != sizeof(FileHeader) ||
+        header->sectionCount != SectionCount)
+    {
+        error = QStringLiteral("unsupported job file version %1").arg(header->version);
+        return nullptr;
+    }
+    for (int i = 0; i < SectionCount; ++i)
+    {
+        const SectionEntry &entry = header->sections[i];
+        if (entry.recordSize != RECORD_SIZES[i] || entry.offset % SECTION_ALIGN != 0 ||
+            entry.offset > static_cast<quint64>(job->m_size) ||
+            entry.count > (static_cast<quint64>(job->m_size) - entry.offset) / entry.recordSize)
+        {
+            error = QStringLiteral("job file section %1 is corrupt or truncated").arg(i);
+            return nullptr;
+        }
+    }
+    job->m_header = header;
+
+    // Shape references are the only indirection; check them once so accessors can stay unchecked.
+    const quint64 typeCounts[] = {0, header->sections[Lines].count, header->sections[Circles].count,
+                                  header->sections[Rectangles].count, header->sections[Ellipses].count};
+    const ShapeRef *refs = job->section<ShapeRef>(Shapes);
+    for (quint64 i = 0; i < header->sections[Shapes].count; ++i)
+    {
+        const auto type = static_cast<quint8>(refs[i].type);
+        if (type < static_cast<quint8>(ShapeType::Line) || type > static_cast<quint8>(ShapeType::Ellipse) ||
+            refs[i].index >= typeCounts[type])
+        {
+            error = QStringLiteral("job file shape %1 has an invalid reference").arg(i);
+            return nullptr;
+        }
+    }
+    return job;
+}
+
+bool JobFile::isJobFile(const QString &path)
+{
+    QFile file(path);
+    char magic[sizeof(MAGIC)] = {};
+    return file.open(QIODevice::ReadOnly) && file.read(magic, sizeof(magic)) == sizeof(magic) &&
+           std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+bool JobFile::save(const QString &path, const JobData &job, const FrameRecord *segments, qint64 segmentCount,
+                   QString &error)
+{
+    const auto &shapes = job.scene().shapes();
+    std::vector<ShapeRef> refs;
+    std::vector<LineRecord> lines;
+    std::vector<CircleRecord> circles;
+    std::vector<RectangleRecord> rectangles;
+    std::vector<EllipseRecord> ellipses;
+    refs.reserve(shapes.size());
+    for (const auto &shape : shapes)
+    {
+        ShapeRef ref{};
+        switch (shape.shape_case())
+        {
+        case SceneShape::kLine:
+            ref.type = ShapeType::Line;
+            ref.index = static_cast<quint32>(lines.size());
+            lines.push_back(toRecord(shape.line()));
+            break;
+        case SceneShape::kCircle:
+            ref.type = ShapeType::Circle;
+            ref.index = static_cast<quint32>(circles.size());
+            circles.push_back(toRecord(shape.circle()));
+            break;
+        case SceneShape::kRectangle:
+            ref.type = ShapeType::Rectangle;
+            ref.index = static_cast<quint32>(rectangles.size());
+            rectangles.push_back(toRecord(shape.rectangle()));
+            break;
+        case SceneShape::kEllipse:
+            ref.type = ShapeType::Ellipse;
+            ref.index = static_cast<quint32>(ellipses.size());
+            ellipses.push_back(toRecord(shape.ellipse()));
+            break;
+        case SceneShape::SHAPE_NOT_SET:
+            continue;
+        }
+        refs.push_back(ref);
+    }
+
+    FileHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.headerSize = sizeof(FileHeader);
+    header.sectionCount = SectionCount;
+    header.settings.jumpSpeed = job.delay().jump_speed();
+    header.settings.laserOnDelay = job.delay().laser_on_delay();
+    header.settings.laserOffDelay = job.delay().laser_off_delay();
+    header.settings.markDelay = job.delay().mark_delay();
+    header.settings.jumpDelay = job.delay().jump_delay();
+    header.settings.polygonDelay = job.delay().polygon_delay();
+    header.settings.freq = job.freq().freq();
+    header.settings.power = job.power();
+
+    const quint64 counts[SectionCount] = {refs.size(), lines.size(), circles.size(), rectangles.size(),
+                                          ellipses.size(), static_cast<quint64>(qMax<qint64>(0, segmentCount))};
+    quint64 offset = alignUp(sizeof(FileHeader));
+    for (int i = 0; i < SectionCount; ++i)
+    {
+        header.sections[i].offset = offset;
+        header.sections[i].count = counts[i];
+        header.sections[i].recordSize = RECORD_SIZES[i];
+        offset = alignUp(offset + counts[i] * RECORD_SIZES[i]);
+    }
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        error = file.errorString();
+        return false;
+    }
+    const bool ok = file.write(reinterpret_cast<const char *>(&header), sizeof(header)) == sizeof(header) &&
+                    writeSection(file, refs.data(), counts[Shapes], header.sections[Shapes].offset) &&
+                    writeSection(file, lines.data(), counts[Lines], header.sections[Lines].offset) &&
+                    writeSection(file, circles.data(), counts[Circles], header.sections[Circles].offset) &&
+                    writeSection(file, rectangles.data(), counts[Rectangles], header.sections[Rectangles].offset) &&
+                    writeSection(file, ellipses.data(), counts[Ellipses], header.sections[Ellipses].offset) &&
+                    writeSection(file, segments, counts[Segments], header.sections[Segments].offset);
+    if (!ok || !file.commit())
+    {
+        error = file.errorString();
+        return false;
+    }
+    return true;
+}
+
+template <typename Record>
+const Record *JobFile::section(Section section) const
+{
+    return reinterpret_cast<const Record *>(m_data + m_header->sections[section].offset);
+}
+
+const Settings &JobFile::settings() const
+{
+    return m_header->settings;
+}
+
+qint64 JobFile::fileSize() const
+{
+    return m_size;
+}
+
+qint64 JobFile::shapeCount() const
+{
+    return static_cast<qint64>(m_header->sections[Shapes].count);
+}
+
+ShapeRef JobFile::shapeRef(qint64 i) const
+{
+    return section<ShapeRef>(Shapes)[i];
+}
+
+const LineRecord &JobFile::line(quint32 index) const
+{
+    return section<LineRecord>(Lines)[index];
+}
+
+const CircleRecord &JobFile::circle(quint32 index) const
+{
+    return section<CircleRecord>(Circles)[index];
+}
+
+const RectangleRecord &JobFile::rectangle(quint32 index) const
+{
+    return section<RectangleRecord>(Rectangles)[index];
+}
+
+const EllipseRecord &JobFile::ellipse(quint32 index) const
+{
+    return section<EllipseRecord>(Ellipses)[index];
+}
+
+qint64 JobFile::segmentCount() const
+{
+    return static_cast<qint64>(m_header->sections[Segments].count);
+}
+
+const FrameRecord *JobFile::segments() const
+{
+    return section<FrameRecord>(Segments);
+}
+
+void JobFile::shape(qint64 i, SceneShape &shape) const
+{
+    const ShapeRef ref = shapeRef(i);
+    switch (ref.type)
+    {
+    case ShapeType::Line:
+        fromRecord(line(ref.index), *shape.mutable_line());
+        break;
+    case ShapeType::Circle:
+        fromRecord(circle(ref.index), *shape.mutable_circle());
+        break;
+    case ShapeType::Rectangle:
+        fromRecord(rectangle(ref.index), *shape.mutable_rectangle());
+        break;
+    case ShapeType::Ellipse:
+        fromRecord(ellipse(ref.index), *shape.mutable_ellipse());
+        break;
+    }
+}
+
+void JobFile::toJobData(JobData &job) const
+{
+    const Settings &s = settings();
+    auto *delay = job.mutable_delay();
+    delay->set_jump_speed(s.jumpSpeed);
+    delay->set_laser_on_delay(s.laserOnDelay);
+    delay->set_laser_off_delay(s.laserOffDelay);
+    delay->set_mark_delay(s.markDelay);
+    delay->set_jump_delay(s.jumpDelay);
+    delay->set_polygon_delay(s.polygonDelay);
+    job.mutable_freq()->set_freq(s.freq);
+    job.set_power(s.power);
+
+    auto *scene = job.mutable_scene();
+    const qint64 count = shapeCount();
+    scene->mutable_shapes()->Reserve(static_cast<int>(count));
+    for (qint64 i = 0; i < count; ++i)
+    {
+        shape(i, *scene->add_shapes());
+    }
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <memory>
+
+#include <QFile>
+#include <QString>
+#include <QtGlobal>
+
+#include "five_axis.pb.h"
+
+// Binary job file (.faxj): shapes, machine settings and optional pre-generated frame records.
+// All sections hold fixed-size little-endian records at 16-byte aligned offsets, so a mapped
+// file is read in place without parsing:
+//   FileHeader | ShapeRef[shapes] | LineRecord[] | CircleRecord[] | RectangleRecord[]
+//              | EllipseRecord[] | FrameRecord[segments]
+// ShapeRef keeps the original shape order and points into the per-type section.
+namespace jobfile
+{
+    constexpr char MAGIC[4] = {'F', 'A', 'X', 'J'};
+    constexpr quint16 VERSION = 1;
+
+    enum class ShapeType : quint8
+    {
+        Line = 1,
+        Circle = 2,
+        Rectangle = 3,
+        Ellipse = 4,
+    };
+
+    enum Section : int
+    {
+        Shapes,
+        Lines,
+        Circles,
+        Rectangles,
+        Ellipses,
+        Segments,
+        SectionCount,
+    };
+
+    struct SectionEntry
+    {
+        quint64 offset;
+        quint64 count;
+        quint32 recordSize;
+        quint32 reserved;
+    };
+
+    struct Settings
+    {
+        qint32 jumpSpeed;
+        qint32 laserOnDelay;
+        qint32 laserOffDelay;
+        qint32 markDelay;
+        qint32 jumpDelay;
+        qint32 polygonDelay;
+        qint32 freq;
+        quint32 flags;
+        double power;
+    };
+
+    struct FileHeader
+    {
+        char magic[4];
+        quint16 version;
+        quint16 headerSize;
+        quint32 flags;
+        quint32 sectionCount;
+        Settings settings;
+        SectionEntry sections[SectionCount];
+    };
+
+    struct ShapeRef
+    {
+        quint32 index;
+        ShapeType type;
+        quint8 reserved[3];
+    };
+
+    struct LineRecord
+    {
+        double speed;
+        double x1, y1, z1, a1, b1;
+        double x2, y2, z2, a2, b2;
+        qint32 times;
+        qint32 reserved;
+    };
+
+    struct CircleRecord
+    {
+        double speed;
+        double x1, y1, x2, y2;
+        double angle, taper;
+        double rMin, rInterval;
+        double zStart, zEnd, zInterval;
+        qint32 times;
+        qint32 m;
+        qint32 circleNumRepair;
+        qint32 timesRepair;
+        quint8 filled;
+        quint8 reserved[7];
+    };
+
+    struct RectangleRecord
+    {
+        double x0, y0, x1, y1, x2, y2;
+        double taperAMax, taperBMax;
+        double feedSpacingX, feedSpacingY;
+        double speed;
+        double zStart, zEnd, zInterval;
+        qint32 times;
+        qint32 circleNumRepair;
+        qint32 timesRepair;
+        qint32 reserved;
+    };
+
+    struct EllipseRecord
+    {
+        double x0, y0;
+        double aMax, bMax, aMin, bMin;
+        double taperAMax, taperBMax;
+        double feedSpacingX, feedSpacingY;
+        double speed;
+        double zStart, zEnd, zInterval;
+        qint32 times;
+        qint32 circleNumRepair;
+        qint32 timesRepair;
+        qint32 reserved;
+    };
+
+    // One 16-byte record exactly as DataBuffer writes it into a frame.
+    struct FrameRecord
+    {
+        quint16 words[8];
+    };
+}
+
+class JobFile
+{
+public:
+    // Maps the file and validates the header and section bounds; nullptr with error set on failure.
+    static std::unique_ptr<JobFile> open(const QString &path, QString &error);
+    static bool isJobFile(const QString &path);
+    static bool save(const QString &path, const JobData &job, const jobfile::FrameRecord *segments,
+                     qint64 segmentCount, QString &error);
+
+    const jobfile::Settings &settings() const;
+    qint64 fileSize() const;
+
+    qint64 shapeCount() const;
+    jobfile::ShapeRef shapeRef(qint64 i) const;
+    const jobfile::LineRecord &line(quint32 index) const;
+    const jobfile::CircleRecord &circle(quint32 index) const;
+    const jobfile::RectangleRecord &rectangle(quint32 index) const;
+    const jobfile::EllipseRecord &ellipse(quint32 index) const;
+
+    qint64 segmentCount() const;
+    const jobfile::FrameRecord *segments() const;
+
+    // Copies out to protobuf for the gRPC path; mapped access above stays zero-copy.
+    void shape(qint64 i, SceneShape &shape) const;
+    void toJobData(JobData &job) const;
+
+private:
+    JobFile() = default;
+
+    template <typename Record>
+    const Record *section(jobfile::Section section) const;
+
+    QFile m_file;
+    const uchar *m_data{nullptr};
+    qint64 m_size{0};
+    const jobfile::FileHeader *m_header{nullptr};
+};
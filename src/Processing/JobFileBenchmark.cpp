@@ -0,0 +1,195 @@
+#include "JobFileBenchmark.h"
+
+#include <cstring>
+#include <vector>
+
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QTemporaryDir>
+
+#include <google/protobuf/arena.h>
+
+#include "JobFile.h"
+
+namespace
+{
+    // Every scalar field gets a random value, so a parameter the format drops or swaps shows up.
+    // isLast only marks the end of a submission and is not part of a job.
+    void randomize(google::protobuf::Message &message, QRandomGenerator &random)
+    {
+        const auto *descriptor = message.GetDescriptor();
+        const auto *reflection = message.GetReflection();
+        for (int i = 0; i < descriptor->field_count(); ++i)
+        {
+            const auto *field = descriptor->field(i);
+            if (field->lowercase_name() == "islast")
+            {
+                continue;
+            }
+            switch (field->cpp_type())
+            {
+            case google::protobuf::FieldDescriptor::CPPTYPE_DOUBLE:
+                reflection->SetDouble(&message, field, random.bounded(2000.0) - 1000.0);
+                break;
+            case google::protobuf::FieldDescriptor::CPPTYPE_INT32:
+                reflection->SetInt32(&message, field, static_cast<qint32>(random.bounded(1, 1000)));
+                break;
+            case google::protobuf::FieldDescriptor::CPPTYPE_BOOL:
+                reflection->SetBool(&message, field, random.bounded(2) == 1);
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    void buildJob(JobData &job, qint64 shapes, QRandomGenerator &random)
+    {
+        randomize(*job.mutable_delay(), random);
+        job.mutable_freq()->set_freq(static_cast<qint32>(random.bounded(20, 200)));
+        job.set_power(random.bounded(100.0));
+        auto *scene = job.mutable_scene();
+        scene->mutable_shapes()->Reserve(static_cast<int>(shapes));
+        for (qint64 i = 0; i < shapes; ++i)
+        {
+            auto *shape = scene->add_shapes();
+            switch (i % 4)
+            {
+            case 0:
+                randomize(*shape->mutable_line(), random);
+                break;
+            case 1:
+                randomize(*shape->mutable_circle(), random);
+                break;
+            case 2:
+                randomize(*shape->mutable_rectangle(), random);
+                break;
+            default:
+                randomize(*shape->mutable_ellipse(), random);
+                break;
+            }
+        }
+    }
+
+    bool sameMessage(const google::protobuf::Message &a, const google::protobuf::Message &b)
+    {
+        // Only scalar fields, so equal messages serialize to equal bytes.
+        return a.SerializeAsString() == b.SerializeAsString();
+    }
+
+    // Reads every field of every mapped record, as streaming a job straight from the file does.
+    double sumRecords(const JobFile &file)
+    {
+        double sum = 0.0;
+        for (qint64 i = 0; i < file.shapeCount(); ++i)
+        {
+            const jobfile::ShapeRef ref = file.shapeRef(i);
+            switch (ref.type)
+            {
+            case jobfile::ShapeType::Line:
+            {
+                const auto &r = file.line(ref.index);
+                sum += r.x1 + r.y1 + r.x2 + r.y2 + r.speed;
+                break;
+            }
+            case jobfile::ShapeType::Circle:
+            {
+                const auto &r = file.circle(ref.index);
+                sum += r.x1 + r.y1 + r.x2 + r.y2 + r.speed;
+                break;
+            }
+            case jobfile::ShapeType::Rectangle:
+            {
+                const auto &r = file.rectangle(ref.index);
+                sum += r.x0 + r.y0 + r.x1 + r.y1 + r.speed;
+                break;
+            }
+            case jobfile::ShapeType::Ellipse:
+            {
+                const auto &r = file.ellipse(ref.index);
+                sum += r.x0 + r.y0 + r.aMax + r.bMax + r.speed;
+                break;
+            }
+            }
+        }
+        return sum;
+    }
+
+    volatile double g_sink = 0.0;
+}
+
+JobFileBenchmark::Result JobFileBenchmark::run(qint64 shapes, qint64 segments)
+{
+    Result result;
+    result.shapes = shapes;
+    result.segments = segments;
+
+    QTemporaryDir dir;
+    if (!dir.isValid())
+    {
+        result.error = dir.errorString();
+        return result;
+    }
+    const QString path = dir.filePath(QStringLiteral("roundtrip.faxj"));
+
+    QRandomGenerator random(0x6a6f62);
+    google::protobuf::Arena arena;
+    auto *original = google::protobuf::Arena::CreateMessage<JobData>(&arena);
+    buildJob(*original, shapes, random);
+    std::vector<jobfile::FrameRecord> records(static_cast<size_t>(segments));
+    for (auto &record : records)
+    {
+        for (quint16 &word : record.words)
+        {
+            word = static_cast<quint16>(random.bounded(0x10000));
+        }
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    if (!JobFile::save(path, *original, records.data(), segments, result.error))
+    {
+        return result;
+    }
+    result.saveMs = timer.nsecsElapsed() / 1e6;
+
+    timer.restart();
+    const auto file = JobFile::open(path, result.error);
+    if (!file)
+    {
+        return result;
+    }
+    result.openMs = timer.nsecsElapsed() / 1e6;
+    result.fileBytes = file->fileSize();
+
+    timer.restart();
+    g_sink = sumRecords(*file);
+    result.readMs = timer.nsecsElapsed() / 1e6;
+
+    timer.restart();
+    auto *loaded = google::protobuf::Arena::CreateMessage<JobData>(&arena);
+    file->toJobData(*loaded);
+    result.toJobDataMs = timer.nsecsElapsed() / 1e6;
+
+    result.settingsMatch = sameMessage(original->delay(), loaded->delay()) &&
+                           sameMessage(original->freq(), loaded->freq()) && original->power() == loaded->power();
+    const int loadedShapes = loaded->scene().shapes_size();
+    for (qint64 i = 0; i < shapes; ++i)
+    {
+        const int index = static_cast<int>(i);
+        if (index >= loadedShapes || !sameMessage(original->scene().shapes(index), loaded->scene().shapes(index)))
+        {
+            if (result.mismatches++ == 0)
+            {
+                result.firstMismatch = i;
+            }
+        }
+    }
+    if (loadedShapes > shapes)
+    {
+        result.mismatches += loadedShapes - shapes;
+    }
+    result.segmentsMatch = file->segmentCount() == segments &&
+                           std::memcmp(file->segments(), records.data(), records.size() * sizeof(jobfile::FrameRecord)) == 0;
+    return result;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <QString>
+#include <QtGlobal>
+
+// Round trip of a generated job through the .faxj format: a scene of all four shape types with
+// every parameter set to a distinct random value, machine settings and pre-generated frame
+// records are saved, mapped again and compared shape by shape. Times the save, the mapping
+// (open), one pass over every mapped record in place, and the copy back out to protobuf.
+class JobFileBenchmark
+{
+public:
+    struct Result
+    {
+        qint64 shapes{0};
+        qint64 segments{0};
+        qint64 fileBytes{0};
+        double saveMs{0.0};
+        double openMs{0.0};
+        double readMs{0.0};
+        double toJobDataMs{0.0};
+        // Shapes whose parameters differ after the round trip, and the first of them.
+        qint64 mismatches{0};
+        qint64 firstMismatch{-1};
+        bool settingsMatch{false};
+        bool segmentsMatch{false};
+        QString error;
+
+        bool roundTrip() const
+        {
+            return error.isEmpty() && mismatches == 0 && settingsMatch && segmentsMatch;
+        }
+    };
+
+    static Result run(qint64 shapes = 1'000'000, qint64 segments = 100'000);
+};
@@ -0,0 +1,121 @@
+#include "RealtimeJitterBenchmark.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <QThread>
+
+#include "DataBuffer.h"
+#include "metrics/HdrHistogram.h"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr int PERIOD_US = 1000;
+    constexpr int FRAMES = 2;
+    constexpr int CACHE_LINE = 64;
+
+    // Keeps one core busy until stopped; left unpinned so the scheduler spreads the load.
+    void spin(const std::atomic<bool> &stop)
+    {
+        quint64 state = 1;
+        while (!stop.load(std::memory_order_relaxed))
+        {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        }
+        static std::atomic<quint64> sink;
+        sink.store(state, std::memory_order_relaxed);
+    }
+
+    RealtimeJitterBenchmark::Run measure(bool realtimeMode, const RealtimeOptions &options, int seconds, QStringList &warnings)
+    {
+        RealtimeJitterBenchmark::Run run;
+        FramePool pool(FRAMES, DataBuffer::frameSize());
+        if (realtimeMode)
+        {
+            QString error;
+            if (!pool.allocate(true, error))
+            {
+                warnings.append(error);
+            }
+            warnings.append(pool.warnings());
+        }
+
+        HdrHistogram lateNs;
+        qint64 frameMaxNs = 0;
+        QString threadSetup = QStringLiteral("default scheduling");
+        std::thread thread([&]() {
+            if (realtimeMode)
+            {
+                const auto setup = realtime::applyToCurrentThread(options);
+                threadSetup = setup.summary;
+                warnings.append(setup.warnings);
+            }
+            const auto period = std::chrono::microseconds(PERIOD_US);
+            const auto end = Clock::now() + std::chrono::seconds(seconds);
+            auto next = Clock::now() + period;
+            quint64 checksum = 0;
+            int index = 0;
+            while (next < end)
+            {
+                std::this_thread::sleep_until(next);
+                const auto woke = Clock::now();
+                lateNs.record(qMax<qint64>(0, std::chrono::duration_cast<std::chrono::nanoseconds>(woke - next).count()));
+
+                // One read per cache line, as the socket copies the frame out.
+                const char *frame = pool.frame(index);
+                index = (index + 1) % FRAMES;
+                for (int i = 0; i < pool.frameSize(); i += CACHE_LINE)
+                {
+                    checksum += static_cast<unsigned char>(frame[i]);
+                }
+                const auto done = Clock::now();
+                frameMaxNs = qMax<qint64>(frameMaxNs, std::chrono::duration_cast<std::chrono::nanoseconds>(done - woke).count());
+
+                // After an overrun, resume on the next period instead of catching up in a burst.
+                next += period;
+                while (next <= done)
+                {
+                    next += period;
+                }
+            }
+            static std::atomic<quint64> sink;
+            sink.store(checksum, std::memory_order_relaxed);
+        });
+        thread.join();
+
+        run.setup = QStringLiteral("%1, %2").arg(threadSetup, pool.describe());
+        run.wakeups = lateNs.count();
+        run.p50Us = lateNs.valueAtPercentile(50.0) / 1000.0;
+        run.p99Us = lateNs.valueAtPercentile(99.0) / 1000.0;
+        run.p999Us = lateNs.valueAtPercentile(99.9) / 1000.0;
+        run.maxUs = lateNs.max() / 1000.0;
+        run.frameMaxUs = frameMaxNs / 1000.0;
+        return run;
+    }
+}
+
+RealtimeJitterBenchmark::Result RealtimeJitterBenchmark::run(const RealtimeOptions &options, int secondsPerRun)
+{
+    Result result;
+    result.periodUs = PERIOD_US;
+    result.loadThreads = qMax(1, QThread::idealThreadCount());
+
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> load;
+    for (int i = 0; i < result.loadThreads; ++i)
+    {
+        load.emplace_back(spin, std::cref(stop));
+    }
+    result.normal = measure(false, options, secondsPerRun, result.warnings);
+    result.realtime = measure(true, options, secondsPerRun, result.warnings);
+    stop.store(true);
+    for (auto &thread : load)
+    {
+        thread.join();
+    }
+    return result;
+}
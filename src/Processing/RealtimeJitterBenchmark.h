@@ -0,0 +1,40 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QtGlobal>
+
+#include "RealtimeMode.h"
+
+// Wake-up jitter of a streaming-like loop under synthetic CPU load. A thread wakes every
+// millisecond, reads one frame from a DataBuffer-sized pool the way the socket write does and
+// records how late it woke. It runs once as streaming does by default (heap frames, default
+// scheduling) and once in real-time mode, with a busy thread on every core both times.
+class RealtimeJitterBenchmark
+{
+public:
+    struct Run
+    {
+        // What the measuring thread and its frames actually got.
+        QString setup;
+        qint64 wakeups{0};
+        double p50Us{0.0};
+        double p99Us{0.0};
+        double p999Us{0.0};
+        double maxUs{0.0};
+        // Slowest pass over one frame; page faults or a lost core show up here.
+        double frameMaxUs{0.0};
+    };
+
+    struct Result
+    {
+        int loadThreads{0};
+        int periodUs{0};
+        Run normal;
+        Run realtime;
+        // Steps of the real-time mode the system refused.
+        QStringList warnings;
+    };
+
+    static Result run(const RealtimeOptions &options, int secondsPerRun);
+};
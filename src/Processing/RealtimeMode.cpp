@@ -0,0 +1,238 @@
+#include "RealtimeMode.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include <QFile>
+
+#ifdef Q_OS_LINUX
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#endif
+
+namespace
+{
+    constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+    QString errorText(int code)
+    {
+        return QString::fromLocal8Bit(std::strerror(code));
+    }
+
+    QString megabytes(qint64 bytes)
+    {
+        return QStringLiteral("%1 MB").arg(bytes / (1024.0 * 1024.0), 0, 'f', 1);
+    }
+
+#ifdef Q_OS_LINUX
+    // AnonHugePages of the mapping that contains address, from /proc/self/smaps.
+    qint64 anonHugePageBytes(const void *address)
+    {
+        QFile smaps(QStringLiteral("/proc/self/smaps"));
+        if (!smaps.open(QIODevice::ReadOnly))
+        {
+            return 0;
+        }
+        const quint64 target = reinterpret_cast<quintptr>(address);
+        bool inMapping = false;
+        for (QByteArray line = smaps.readLine(); !line.isEmpty(); line = smaps.readLine())
+        {
+            // Mapping headers start with "start-end "; the field lines that follow start with "Name:".
+            const int dash = line.indexOf('-');
+            const int space = line.indexOf(' ');
+            if (dash > 0 && space > dash)
+            {
+                bool startOk = false;
+                bool endOk = false;
+                const quint64 start = line.left(dash).toULongLong(&startOk, 16);
+                const quint64 end = line.mid(dash + 1, space - dash - 1).toULongLong(&endOk, 16);
+                if (startOk && endOk)
+                {
+                    inMapping = target >= start && target < end;
+                    continue;
+                }
+            }
+            if (inMapping && line.startsWith("AnonHugePages:"))
+            {
+                return line.mid(14).trimmed().split(' ').value(0).toLongLong() * 1024;
+            }
+        }
+        return 0;
+    }
+#endif
+}
+
+realtime::ThreadSetup realtime::applyToCurrentThread(const RealtimeOptions &options)
+{
+    ThreadSetup setup;
+#ifdef Q_OS_LINUX
+    QStringList applied;
+    if (options.cpu >= 0 && options.cpu < CPU_SETSIZE)
+    {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(options.cpu, &cpus);
+        const int rc = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        if (rc == 0)
+        {
+            setup.pinned = true;
+            applied.append(QStringLiteral("CPU %1").arg(options.cpu));
+        }
+        else
+        {
+            setup.warnings.append(QStringLiteral("cannot pin to CPU %1: %2").arg(options.cpu).arg(errorText(rc)));
+        }
+    }
+    else if (options.cpu >= 0)
+    {
+        setup.warnings.append(QStringLiteral("CPU %1 is out of range").arg(options.cpu));
+    }
+
+    sched_param param{};
+    param.sched_priority = qBound(sched_get_priority_min(SCHED_FIFO), options.priority, sched_get_priority_max(SCHED_FIFO));
+    const int rc = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (rc == 0)
+    {
+        setup.fifo = true;
+        applied.append(QStringLiteral("SCHED_FIFO %1").arg(param.sched_priority));
+    }
+    else
+    {
+        setup.warnings.append(QStringLiteral("SCHED_FIFO %1 refused: %2 (needs CAP_SYS_NICE or an rtprio limit)")
+                                  .arg(param.sched_priority)
+                                  .arg(errorText(rc)));
+    }
+    setup.summary = applied.isEmpty() ? QStringLiteral("default scheduling") : applied.join(QStringLiteral(", "));
+#else
+    Q_UNUSED(options);
+    setup.summary = QStringLiteral("default scheduling");
+    setup.warnings.append(QStringLiteral("real-time scheduling is only implemented on Linux"));
+#endif
+    return setup;
+}
+
+FramePool::FramePool(int frames, int frameSize)
+    : m_frames(frames)
+    , m_frameSize(frameSize)
+{
+    QString error;
+    allocate(false, error);
+}
+
+FramePool::~FramePool()
+{
+    release();
+}
+
+bool FramePool::allocate(bool realtime, QString &error)
+{
+    release();
+    m_warnings.clear();
+    const size_t bytes = static_cast<size_t>(m_frames) * static_cast<size_t>(m_frameSize);
+#ifdef Q_OS_LINUX
+    if (realtime)
+    {
+        // Whole huge pages, starting on a huge-page boundary: over-map by one and trim both ends.
+        const size_t rounded = (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+        void *raw = mmap(nullptr, rounded + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw != MAP_FAILED)
+        {
+            const quintptr start = reinterpret_cast<quintptr>(raw);
+            const quintptr aligned = (start + HUGE_PAGE_SIZE - 1) & ~quintptr(HUGE_PAGE_SIZE - 1);
+            if (aligned > start)
+            {
+                munmap(raw, aligned - start);
+            }
+            const quintptr tail = start + rounded + HUGE_PAGE_SIZE - (aligned + rounded);
+            if (tail > 0)
+            {
+                munmap(reinterpret_cast<void *>(aligned + rounded), tail);
+            }
+            m_base = reinterpret_cast<char *>(aligned);
+            m_mappedBytes = rounded;
+
+#ifdef MADV_HUGEPAGE
+            // Advised before the first touch so the prefault below already lands on huge pages.
+            if (madvise(m_base, m_mappedBytes, MADV_HUGEPAGE) != 0)
+            {
+                m_warnings.append(QStringLiteral("huge pages not available: %1").arg(errorText(errno)));
+            }
+#else
+            m_warnings.append(QStringLiteral("huge pages not supported by this kernel"));
+#endif
+            std::memset(m_base, 0, m_mappedBytes);
+            if (mlock(m_base, m_mappedBytes) == 0)
+            {
+                m_locked = true;
+            }
+            else
+            {
+                m_warnings.append(QStringLiteral("cannot lock %1: %2 (raise RLIMIT_MEMLOCK, ulimit -l)")
+                                      .arg(megabytes(static_cast<qint64>(m_mappedBytes)), errorText(errno)));
+            }
+            if (hugePageBytes() == 0)
+            {
+                m_warnings.append(QStringLiteral("frames are not on huge pages; check "
+                                                 "/sys/kernel/mm/transparent_hugepage/enabled"));
+            }
+            return true;
+        }
+        error = QStringLiteral("cannot map %1 for the frame pool: %2").arg(megabytes(static_cast<qint64>(bytes)), errorText(errno));
+    }
+#else
+    if (realtime)
+    {
+        error = QStringLiteral("locked frame memory is only implemented on Linux");
+    }
+#endif
+    // Value-initialized, so every page is touched here rather than by the first frame.
+    m_heap = std::make_unique<char[]>(bytes);
+    m_base = m_heap.get();
+    return !realtime;
+}
+
+bool FramePool::isLocked() const
+{
+    return m_locked;
+}
+
+qint64 FramePool::hugePageBytes() const
+{
+#ifdef Q_OS_LINUX
+    return m_mappedBytes > 0 ? anonHugePageBytes(m_base) : 0;
+#else
+    return 0;
+#endif
+}
+
+QString FramePool::describe() const
+{
+    if (m_mappedBytes == 0)
+    {
+        return QStringLiteral("%1 heap").arg(megabytes(static_cast<qint64>(m_frames) * m_frameSize));
+    }
+    return QStringLiteral("%1 %2, %3 on huge pages")
+        .arg(megabytes(static_cast<qint64>(m_mappedBytes)),
+             m_locked ? QStringLiteral("locked") : QStringLiteral("unlocked"),
+             megabytes(hugePageBytes()));
+}
+
+QStringList FramePool::warnings() const
+{
+    return m_warnings;
+}
+
+void FramePool::release()
+{
+#ifdef Q_OS_LINUX
+    if (m_mappedBytes > 0)
+    {
+        munmap(m_base, m_mappedBytes);
+    }
+#endif
+    m_heap.reset();
+    m_base = nullptr;
+    m_mappedBytes = 0;
+    m_locked = false;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <memory>
+
+#include <QString>
+#include <QStringList>
+#include <QtGlobal>
+
+// Optional real-time setup for the frame stream. The streaming thread is pinned to one core and
+// run under SCHED_FIFO, and the frames live in a pool that is locked in RAM, backed by
+// transparent huge pages and prefaulted, so nothing is paged or faulted in mid-job. Every step
+// the system refuses (no CAP_SYS_NICE or rtprio limit, RLIMIT_MEMLOCK too low, THP disabled) is
+// reported and skipped; streaming works the same either way. Implemented for Linux only.
+struct RealtimeOptions
+{
+    bool enabled{false};
+    // Core for the streaming thread; -1 leaves the affinity alone.
+    int cpu{-1};
+    // SCHED_FIFO priority, 1..99.
+    int priority{80};
+};
+
+namespace realtime
+{
+    struct ThreadSetup
+    {
+        bool pinned{false};
+        bool fifo{false};
+        // E.g. "CPU 3, SCHED_FIFO 80"; lists only what was applied.
+        QString summary;
+        QStringList warnings;
+    };
+
+    // Pins and raises the calling thread as far as the system permits.
+    ThreadSetup applyToCurrentThread(const RealtimeOptions &options);
+}
+
+// Fixed set of equally sized frames in one allocation; starts out on the ordinary heap.
+class FramePool
+{
+public:
+    FramePool(int frames, int frameSize);
+    ~FramePool();
+
+    FramePool(const FramePool &) = delete;
+    FramePool &operator=(const FramePool &) = delete;
+
+    // Replaces the frames with zeroed ones, either on the heap or mapped, huge-page advised,
+    // prefaulted and locked. Steps the system refuses end up in warnings(); returns false only
+    // when the real-time memory could not be mapped at all, leaving a heap pool.
+    bool allocate(bool realtime, QString &error);
+
+    char *frame(int index)
+    {
+        return m_base + static_cast<qint64>(index) * m_frameSize;
+    }
+
+    int frameSize() const
+    {
+        return m_frameSize;
+    }
+
+    bool isLocked() const;
+    // Bytes of the pool currently backed by transparent huge pages; 0 when unknown.
+    qint64 hugePageBytes() const;
+    // E.g. "3.2 MB heap" or "4.0 MB locked, 4.0 MB on huge pages".
+    QString describe() const;
+    QStringList warnings() const;
+
+private:
+    void release();
+
+    int m_frames;
+    int m_frameSize;
+    char *m_base{nullptr};
+    std::unique_ptr<char[]> m_heap;
+    size_t m_mappedBytes{0};
+    bool m_locked{false};
+    QStringList m_warnings;
+};
@@ -0,0 +1,96 @@
+#include "RingFrameSender.h"
+
+#include <cstring>
+
+#include <QThread>
+#include <QtDebug>
+
+#include "DataBuffer.h"
+#include "FrameTap.h"
+#include "ShmFrameRing.h"
+#include "metrics/Trace.h"
+
+namespace
+{
+    constexpr int POLL_MS = 100;
+    // A full ring means the daemon is waiting on the controller, which takes frames far slower than this.
+    constexpr int RING_FULL_SLEEP_US = 200;
+}
+
+RingFrameSender::RingFrameSender(ShmFrameRing &ring, DataBuffer &buffer, FrameTap *tap)
+    : m_ring(ring)
+    , m_buffer(buffer)
+    , m_tap(tap)
+{
+}
+
+RingFrameSender::~RingFrameSender()
+{
+    stop();
+}
+
+void RingFrameSender::ensureRunning()
+{
+    if (m_running.load())
+    {
+        return;
+    }
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+    m_stopRequested.store(false);
+    m_running.store(true);
+    m_thread = std::thread([this]() { run(); });
+}
+
+void RingFrameSender::stop()
+{
+    m_stopRequested.store(true);
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+}
+
+qint64 RingFrameSender::framesSent() const
+{
+    return m_framesSent.load();
+}
+
+void RingFrameSender::run()
+{
+    trace::setThreadName(QStringLiteral("RingFrameSender"));
+    while (!m_stopRequested.load())
+    {
+        const int rdPtr = m_buffer.tryGetReadBuf(POLL_MS);
+        if (rdPtr < 0)
+        {
+            continue;
+        }
+        char *slot = m_ring.writeSlot();
+        while (!slot && !m_stopRequested.load())
+        {
+            QThread::usleep(RING_FULL_SLEEP_US);
+            slot = m_ring.writeSlot();
+        }
+        if (!slot)
+        {
+            qWarning() << "Ring full when the sender stopped; the frame stays queued for the next streamer";
+            m_buffer.requeueFront(rdPtr);
+            break;
+        }
+        {
+            trace::Scope scope("ring", "publish");
+            std::memcpy(slot, m_buffer.frame(rdPtr), static_cast<size_t>(DataBuffer::frameSize()));
+            m_ring.publish();
+        }
+        ++m_framesSent;
+        if (m_tap)
+        {
+            m_tap->offerFrame(m_buffer.frame(rdPtr), DataBuffer::frameSize());
+        }
+        m_buffer.readEnd(rdPtr);
+    }
+    m_running.store(false);
+}
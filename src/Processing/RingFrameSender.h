@@ -0,0 +1,40 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+
+#include <QtGlobal>
+
+#include "FrameStreamer.h"
+
+class DataBuffer;
+class FrameTap;
+class ShmFrameRing;
+
+// DataBuffer's streamer when a streaming daemon sends the frames: copies each filled frame
+// into the daemon's shared-memory ring and hands the DataBuffer frame straight back.
+class RingFrameSender : public FrameStreamer
+{
+public:
+    // tap, if given, still sees every frame, so the live toolpath works with the daemon too.
+    RingFrameSender(ShmFrameRing &ring, DataBuffer &buffer, FrameTap *tap = nullptr);
+    ~RingFrameSender() override;
+
+    void ensureRunning() override;
+    // Stops and joins the thread. A frame still waiting for room in the ring goes back to the
+    // head of the DataBuffer queue, so the next streamer sends it.
+    void stop();
+
+    qint64 framesSent() const;
+
+private:
+    void run();
+
+    ShmFrameRing &m_ring;
+    DataBuffer &m_buffer;
+    FrameTap *m_tap;
+    std::thread m_thread;
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_stopRequested{false};
+    std::atomic<qint64> m_framesSent{0};
+};
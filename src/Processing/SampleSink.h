@@ -0,0 +1,15 @@
+#pragma once
+
+#include <QtGlobal>
+
+// Receiver for calibrated galvo samples; DataBuffer streams them, ToolpathRecorder keeps them.
+class SampleSink
+{
+public:
+    virtual ~SampleSink() = default;
+
+    virtual void addProcessData(quint16 X, quint16 Y, quint16 Z, quint16 A, quint16 B) = 0;
+    virtual void addProcessJumpData(quint16 X, quint16 Y, quint16 Z, quint16 A, quint16 B) = 0;
+    virtual void addProcessBegin() = 0;
+    virtual void addProcessEnd() = 0;
+};
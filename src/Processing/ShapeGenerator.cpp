@@ -0,0 +1,169 @@
+#include "ShapeGenerator.h"
+
+#include <QtMath>
+
+#include "SampleSink.h"
+#include "ThreeAxisGenerator.h"
+
+namespace
+{
+    constexpr double EPSILON = 1e-9;
+    constexpr double FULL_CIRCLE_DEG = 360.0;
+    // Feed spacings are entered to three decimals.
+    constexpr double FEED_TOLERANCE = 0.0005;
+
+    bool isSet(double value)
+    {
+        return qAbs(value) > EPSILON;
+    }
+
+    // The generators work at a single Z; the controller runs a layer per interval between start
+    // and end.
+    QString levels(double zStart, double zEnd)
+    {
+        if (isSet(zEnd - zStart))
+        {
+            return QStringLiteral("Z levels %1 to %2").arg(zStart).arg(zEnd);
+        }
+        return QString();
+    }
+
+    QString repair(int circles, int times)
+    {
+        if (circles > 0 || times > 0)
+        {
+            return QStringLiteral("repair passes");
+        }
+        return QString();
+    }
+}
+
+QString ShapeGenerator::unsupported(const LineData &line)
+{
+    if (isSet(line.a1()) || isSet(line.b1()) || isSet(line.a2()) || isSet(line.b2()))
+    {
+        return QStringLiteral("A/B axes");
+    }
+    return QString();
+}
+
+QString ShapeGenerator::unsupported(const CircleData &circle)
+{
+    if (isSet(circle.angle() - FULL_CIRCLE_DEG))
+    {
+        return QStringLiteral("partial arc (%1 degrees)").arg(circle.angle());
+    }
+    if (circle.filled())
+    {
+        return QStringLiteral("concentric fill");
+    }
+    if (isSet(circle.taper()))
+    {
+        return QStringLiteral("taper");
+    }
+    if (const QString reason = levels(circle.z_start(), circle.z_end()); !reason.isEmpty())
+    {
+        return reason;
+    }
+    return repair(circle.circle_num_repair(), circle.times_repair());
+}
+
+QString ShapeGenerator::unsupported(const RectangleData &rect)
+{
+    if (rect.feedspacing_y() <= 0.0 || !isSet(rect.y1() - rect.y0()))
+    {
+        return QStringLiteral("rectangle needs a non-zero height and feed spacing");
+    }
+    // The generator shrinks X in proportion to Y, so its X step follows from the Y spacing.
+    const double xStep = qAbs(rect.x1() - rect.x0()) * rect.feedspacing_y() / qAbs(rect.y1() - rect.y0());
+    if (isSet(rect.feedspacing_x()) && qAbs(rect.feedspacing_x() - xStep) > FEED_TOLERANCE)
+    {
+        return QStringLiteral("X feed spacing %1 (the local generator steps %2)").arg(rect.feedspacing_x()).arg(xStep);
+    }
+    if (isSet(rect.taper_a_max()) || isSet(rect.taper_b_max()))
+    {
+        return QStringLiteral("taper");
+    }
+    if (isSet(rect.x2()) || isSet(rect.y2()))
+    {
+        return QStringLiteral("second corner (X2/Y2)");
+    }
+    if (const QString reason = levels(rect.z_start(), rect.z_end()); !reason.isEmpty())
+    {
+        return reason;
+    }
+    return repair(rect.circle_num_repair(), rect.times_repair());
+}
+
+QString ShapeGenerator::unsupported(const EllipseData &ellipse)
+{
+    Q_UNUSED(ellipse);
+    return QStringLiteral("no local generator for ellipse");
+}
+
+QString ShapeGenerator::unsupported(const SceneShape &shape)
+{
+    switch (shape.shape_case())
+    {
+    case SceneShape::kLine:
+        return unsupported(shape.line());
+    case SceneShape::kCircle:
+        return unsupported(shape.circle());
+    case SceneShape::kRectangle:
+        return unsupported(shape.rectangle());
+    case SceneShape::kEllipse:
+        return unsupported(shape.ellipse());
+    case SceneShape::SHAPE_NOT_SET:
+        break;
+    }
+    return QStringLiteral("empty shape");
+}
+
+void ShapeGenerator::generate(SampleSink &sink, const LineData &line)
+{
+    for (int t = 0; t < qMax(1, line.times()); ++t)
+    {
+        ThreeAxisGenerator::generateLine(sink, line.speed(), true, line.x1(), line.y1(), line.z1(), line.x2(),
+                                         line.y2(), line.z2());
+    }
+}
+
+void ShapeGenerator::generate(SampleSink &sink, const CircleData &circle)
+{
+    for (int t = 0; t < qMax(1, circle.times()); ++t)
+    {
+        ThreeAxisGenerator::generateCircle(sink, circle.x1(), circle.y1(), circle.x2(), circle.y2(),
+                                           circle.z_start(), circle.speed());
+    }
+}
+
+void ShapeGenerator::generate(SampleSink &sink, const RectangleData &rect)
+{
+    for (int t = 0; t < qMax(1, rect.times()); ++t)
+    {
+        ThreeAxisGenerator::generateRectangle(sink, rect.x0(), rect.y0(), rect.z_start(), rect.x1(), rect.y1(),
+                                              rect.z_end(), rect.speed(), rect.feedspacing_y());
+    }
+}
+
+bool ShapeGenerator::generate(SampleSink &sink, const SceneShape &shape)
+{
+    if (!unsupported(shape).isEmpty())
+    {
+        return false;
+    }
+    switch (shape.shape_case())
+    {
+    case SceneShape::kLine:
+        generate(sink, shape.line());
+        return true;
+    case SceneShape::kCircle:
+        generate(sink, shape.circle());
+        return true;
+    case SceneShape::kRectangle:
+        generate(sink, shape.rectangle());
+        return true;
+    default:
+        return false;
+    }
+}
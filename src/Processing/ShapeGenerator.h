@@ -0,0 +1,31 @@
+#pragma once
+
+#include <QString>
+
+#include "five_axis.pb.h"
+
+class SampleSink;
+
+// Runs gRPC shape requests through the three-axis generators for the paths that generate on this
+// machine instead of on the controller: the local compile, fleet streaming and headless runs.
+// Those generators know X/Y/Z lines, full single-level circles and flat concentric rectangles;
+// a request that uses anything else (arcs, fills, tapers, Z layers, repair passes, A/B) cannot
+// be reproduced here and has to be sent to the controller or reported as skipped.
+class ShapeGenerator
+{
+public:
+    // Empty when generate() reproduces the request exactly; otherwise what it cannot reproduce,
+    // e.g. "partial arc (180 degrees)".
+    static QString unsupported(const LineData &line);
+    static QString unsupported(const CircleData &circle);
+    static QString unsupported(const RectangleData &rect);
+    static QString unsupported(const EllipseData &ellipse);
+    static QString unsupported(const SceneShape &shape);
+
+    // Every pass of the request's times; only for requests unsupported() accepts.
+    static void generate(SampleSink &sink, const LineData &line);
+    static void generate(SampleSink &sink, const CircleData &circle);
+    static void generate(SampleSink &sink, const RectangleData &rect);
+    // Returns false, writing nothing, for shapes unsupported() rejects.
+    static bool generate(SampleSink &sink, const SceneShape &shape);
+};
@@ -0,0 +1,178 @@
+#include "ShmFrameRing.h"
+
+#include <atomic>
+#include <new>
+
+namespace
+{
+    constexpr quint32 MAGIC = 0x46415852; // "FAXR"
+    constexpr quint32 VERSION = 1;
+    // Slots start on their own page, clear of the header's cache lines.
+    constexpr qint64 DATA_OFFSET = 4096;
+}
+
+// Both processes map this at different addresses, so it holds no pointers; the atomics
+// must be lock-free to work across processes.
+struct ShmFrameRing::Header
+{
+    quint32 magic;
+    quint32 version;
+    quint32 slots;
+    quint32 frameSize;
+    // Frames published by the writer and released by the reader since the segment was created.
+    alignas(64) std::atomic<quint64> written;
+    alignas(64) std::atomic<quint64> read;
+};
+
+static_assert(std::atomic<quint64>::is_always_lock_free, "ring indices must be lock-free to be shared between processes");
+
+ShmFrameRing::ShmFrameRing(const QString &key)
+{
+    m_memory.setKey(key);
+}
+
+ShmFrameRing::~ShmFrameRing()
+{
+    detach();
+}
+
+bool ShmFrameRing::create(int slots, int frameSize, QString &error)
+{
+    static_assert(sizeof(Header) <= DATA_OFFSET, "ring header must fit before the first slot");
+    detach();
+    const qint64 size = DATA_OFFSET + static_cast<qint64>(slots) * frameSize;
+    if (!m_memory.create(size))
+    {
+        if (m_memory.error() != QSharedMemory::AlreadyExists)
+        {
+            error = QStringLiteral("cannot create frame ring %1: %2").arg(m_memory.key(), m_memory.errorString());
+            return false;
+        }
+        // On Unix the last detach removes a segment whose creator crashed.
+        m_memory.attach();
+        m_memory.detach();
+        if (!m_memory.create(size))
+        {
+            error = QStringLiteral("frame ring %1 is in use by another daemon: %2").arg(m_memory.key(), m_memory.errorString());
+            return false;
+        }
+    }
+    Header *ring = new (m_memory.data()) Header();
+    ring->magic = MAGIC;
+    ring->version = VERSION;
+    ring->slots = static_cast<quint32>(slots);
+    ring->frameSize = static_cast<quint32>(frameSize);
+    ring->written.store(0);
+    ring->read.store(0);
+    return true;
+}
+
+bool ShmFrameRing::attach(int frameSize, QString &error)
+{
+    detach();
+    if (!m_memory.attach())
+    {
+        error = QStringLiteral("no frame ring %1 (is the streaming daemon running?): %2").arg(m_memory.key(), m_memory.errorString());
+        return false;
+    }
+    const Header *ring = header();
+    if (m_memory.size() < DATA_OFFSET || ring->magic != MAGIC || ring->version != VERSION
+        || ring->frameSize != static_cast<quint32>(frameSize)
+        || m_memory.size() < DATA_OFFSET + static_cast<qint64>(ring->slots) * ring->frameSize)
+    {
+        error = QStringLiteral("frame ring %1 does not match this build (%2 byte frames expected)").arg(m_memory.key()).arg(frameSize);
+        m_memory.detach();
+        return false;
+    }
+    return true;
+}
+
+void ShmFrameRing::detach()
+{
+    if (m_memory.isAttached())
+    {
+        m_memory.detach();
+    }
+}
+
+bool ShmFrameRing::isAttached() const
+{
+    return m_memory.isAttached();
+}
+
+int ShmFrameRing::slotCount() const
+{
+    return isAttached() ? static_cast<int>(header()->slots) : 0;
+}
+
+int ShmFrameRing::frameSize() const
+{
+    return isAttached() ? static_cast<int>(header()->frameSize) : 0;
+}
+
+char *ShmFrameRing::writeSlot()
+{
+    Header *ring = header();
+    // Only the writer moves written; acquire on read so the reader is done with the slot.
+    const quint64 written = ring->written.load(std::memory_order_relaxed);
+    if (written - ring->read.load(std::memory_order_acquire) >= ring->slots)
+    {
+        return nullptr;
+    }
+    return slot(written);
+}
+
+void ShmFrameRing::publish()
+{
+    Header *ring = header();
+    ring->written.store(ring->written.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+const char *ShmFrameRing::readSlot()
+{
+    Header *ring = header();
+    const quint64 read = ring->read.load(std::memory_order_relaxed);
+    if (ring->written.load(std::memory_order_acquire) == read)
+    {
+        return nullptr;
+    }
+    return slot(read);
+}
+
+void ShmFrameRing::release()
+{
+    Header *ring = header();
+    ring->read.store(ring->read.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+qint64 ShmFrameRing::discard()
+{
+    Header *ring = header();
+    const quint64 written = ring->written.load(std::memory_order_acquire);
+    const quint64 read = ring->read.load(std::memory_order_relaxed);
+    ring->read.store(written, std::memory_order_release);
+    return static_cast<qint64>(written - read);
+}
+
+qint64 ShmFrameRing::pending() const
+{
+    if (!isAttached())
+    {
+        return 0;
+    }
+    const Header *ring = header();
+    const quint64 read = ring->read.load(std::memory_order_acquire);
+    return static_cast<qint64>(ring->written.load(std::memory_order_acquire) - read);
+}
+
+ShmFrameRing::Header *ShmFrameRing::header() const
+{
+    return static_cast<Header *>(const_cast<void *>(m_memory.constData()));
+}
+
+char *ShmFrameRing::slot(quint64 sequence) const
+{
+    const Header *ring = header();
+    return static_cast<char *>(const_cast<void *>(m_memory.constData())) + DATA_OFFSET
+        + static_cast<qint64>(sequence % ring->slots) * ring->frameSize;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <QSharedMemory>
+#include <QString>
+#include <QtGlobal>
+
+// Single-producer, single-consumer ring of whole frames in shared memory, between the process
+// that generates frames and the streaming daemon that sends them. The daemon creates the
+// segment and holds it for its lifetime, so frames already handed over keep streaming when the
+// writer exits or crashes, and a restarted writer carries on where the last one stopped. The
+// indices are lock-free atomics in the segment header; a slot becomes visible to the reader
+// only once it has been written completely.
+class ShmFrameRing
+{
+public:
+    explicit ShmFrameRing(const QString &key);
+    ~ShmFrameRing();
+
+    ShmFrameRing(const ShmFrameRing &) = delete;
+    ShmFrameRing &operator=(const ShmFrameRing &) = delete;
+
+    // Reader (daemon) side; replaces a segment left behind by a daemon that did not exit cleanly.
+    bool create(int slots, int frameSize, QString &error);
+    // Writer side; fails unless the daemon's segment exists with the same frame size.
+    bool attach(int frameSize, QString &error);
+    void detach();
+    bool isAttached() const;
+
+    int slotCount() const;
+    int frameSize() const;
+
+    // Writer: the next free slot, or nullptr while the ring is full. publish() hands it over.
+    char *writeSlot();
+    void publish();
+    // Reader: the oldest published slot, or nullptr while the ring is empty. release() frees it.
+    const char *readSlot();
+    void release();
+    // Reader: releases every published slot at once; returns how many there were.
+    qint64 discard();
+    // Published and not yet released.
+    qint64 pending() const;
+
+private:
+    struct Header;
+
+    Header *header() const;
+    char *slot(quint64 sequence) const;
+
+    QSharedMemory m_memory;
+};
@@ -0,0 +1,162 @@
+#include "ShmRingBenchmark.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QThread>
+
+#include "DataBuffer.h"
+#include "RingFrameSender.h"
+#include "ShmFrameRing.h"
+
+namespace
+{
+    constexpr int RECORD_SIZE = 16;
+    constexpr int RING_SLOTS = 16;
+    constexpr int POLL_MS = 10;
+
+    // Stands in for TcpSocketWorker: hands every frame straight back and counts it.
+    class DrainStreamer : public FrameStreamer
+    {
+    public:
+        explicit DrainStreamer(DataBuffer &buffer)
+            : m_buffer(buffer)
+        {
+        }
+
+        ~DrainStreamer() override
+        {
+            m_stopRequested.store(true);
+            if (m_thread.joinable())
+            {
+                m_thread.join();
+            }
+        }
+
+        void ensureRunning() override
+        {
+            if (!m_thread.joinable())
+            {
+                m_thread = std::thread([this]() { run(); });
+            }
+        }
+
+        int frames() const
+        {
+            return m_frames.load();
+        }
+
+    private:
+        void run()
+        {
+            while (!m_stopRequested.load())
+            {
+                const int rdPtr = m_buffer.tryGetReadBuf(POLL_MS);
+                if (rdPtr >= 0)
+                {
+                    m_buffer.readEnd(rdPtr);
+                    ++m_frames;
+                }
+            }
+        }
+
+        DataBuffer &m_buffer;
+        std::thread m_thread;
+        std::atomic<bool> m_stopRequested{false};
+        std::atomic<int> m_frames{0};
+    };
+
+    void produce(DataBuffer &buffer, const std::vector<char> &frame, int frames)
+    {
+        for (int i = 0; i < frames; ++i)
+        {
+            buffer.addRecords(frame.data(), DataBuffer::frameSize() / RECORD_SIZE);
+        }
+    }
+
+    void waitFor(const DrainStreamer &streamer, int frames)
+    {
+        while (streamer.frames() < frames)
+        {
+            QThread::usleep(100);
+        }
+    }
+}
+
+ShmRingBenchmark::Result ShmRingBenchmark::run(int frames)
+{
+    Result result;
+    result.frames = frames;
+    result.bytes = static_cast<qint64>(frames) * DataBuffer::frameSize();
+    // Motion records with a changing X, so nothing is all zeros.
+    std::vector<char> frame(static_cast<size_t>(DataBuffer::frameSize()));
+    for (size_t i = 0; i < frame.size(); i += RECORD_SIZE)
+    {
+        const quint16 x = static_cast<quint16>(i / RECORD_SIZE);
+        frame[i + 8] = static_cast<char>(x & 0xFF);
+        frame[i + 9] = static_cast<char>(x >> 8);
+        frame[i + 10] = static_cast<char>(0xFF);
+    }
+
+    {
+        DataBuffer buffer;
+        DrainStreamer drain(buffer);
+        buffer.setStreamer(&drain);
+        QElapsedTimer timer;
+        timer.start();
+        produce(buffer, frame, frames);
+        waitFor(drain, frames);
+        result.inProcessMs = timer.nsecsElapsed() / 1e6;
+    }
+
+    // Unique per run, so a crashed earlier run or a live daemon is never touched.
+    const QString key = QStringLiteral("fiveaxis-ring-benchmark-%1").arg(QCoreApplication::applicationPid());
+    ShmFrameRing daemonRing(key);
+    if (!daemonRing.create(RING_SLOTS, DataBuffer::frameSize(), result.error))
+    {
+        return result;
+    }
+    ShmFrameRing guiRing(key);
+    if (!guiRing.attach(DataBuffer::frameSize(), result.error))
+    {
+        return result;
+    }
+    DataBuffer guiBuffer;
+    DataBuffer daemonBuffer;
+    RingFrameSender sender(guiRing, guiBuffer);
+    DrainStreamer drain(daemonBuffer);
+    guiBuffer.setStreamer(&sender);
+    daemonBuffer.setStreamer(&drain);
+
+    std::atomic<bool> stop{false};
+    // Same loop and idle sleeps as the daemon's feeder, minus the job queue.
+    std::thread feeder([&]() {
+        while (!stop.load())
+        {
+            if (daemonBuffer.pendingFrames() > 0)
+            {
+                QThread::msleep(1);
+                continue;
+            }
+            if (const char *slot = daemonRing.readSlot())
+            {
+                daemonBuffer.addRecords(slot, DataBuffer::frameSize() / RECORD_SIZE);
+                daemonRing.release();
+                continue;
+            }
+            QThread::msleep(1);
+        }
+    });
+    QElapsedTimer timer;
+    timer.start();
+    produce(guiBuffer, frame, frames);
+    waitFor(drain, frames);
+    result.shmMs = timer.nsecsElapsed() / 1e6;
+    stop.store(true);
+    feeder.join();
+    sender.stop();
+    return result;
+}
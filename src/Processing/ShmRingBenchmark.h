@@ -0,0 +1,34 @@
+#pragma once
+
+#include <QString>
+#include <QtGlobal>
+
+// Frame throughput with and without the streaming daemon's shared-memory hop. The same frames
+// are pushed through a DataBuffer into a draining streamer in-process, and then through
+// DataBuffer -> RingFrameSender -> ShmFrameRing -> daemon-side DataBuffer -> draining streamer,
+// as the GUI and daemon do, with both ends in this process but going through the shared segment.
+class ShmRingBenchmark
+{
+public:
+    struct Result
+    {
+        int frames{0};
+        qint64 bytes{0};
+        double inProcessMs{0.0};
+        double shmMs{0.0};
+        // Set when the shared segment could not be created; the shm figures are then empty.
+        QString error;
+
+        double inProcessMBps() const
+        {
+            return inProcessMs > 0.0 ? bytes / 1e3 / inProcessMs : 0.0;
+        }
+
+        double shmMBps() const
+        {
+            return shmMs > 0.0 ? bytes / 1e3 / shmMs : 0.0;
+        }
+    };
+
+    static Result run(int frames);
+};
@@ -0,0 +1,137 @@
+#include "StopLatencyBenchmark.h"
+
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include <QElapsedTimer>
+#include <QThread>
+#include <QtEndian>
+
+#include "ControllerSimulator.h"
+#include "DataBuffer.h"
+#include "TcpSocketWorker.h"
+
+namespace
+{
+    constexpr int RECORD_SIZE = 16;
+    constexpr int SOURCE_ID = 1;
+    constexpr quint16 FLAG_LASER_ON = 0x00FF;
+    // No laser-on record for this long counts as quiet.
+    constexpr qint64 QUIET_NS = 300'000'000;
+    constexpr int TIMEOUT_MS = 10'000;
+
+    // One frame of laser-on records sweeping X, so everything executed after the request counts.
+    std::vector<char> markingFrame()
+    {
+        const qint64 count = DataBuffer::frameSize() / RECORD_SIZE;
+        std::vector<char> records(static_cast<size_t>(DataBuffer::frameSize()), 0);
+        for (qint64 i = 0; i < count; ++i)
+        {
+            char *record = records.data() + i * RECORD_SIZE;
+            qToLittleEndian<quint16>(static_cast<quint16>(i & 0xFFFF), record + 8);
+            qToLittleEndian<quint16>(FLAG_LASER_ON, record + 10);
+        }
+        return records;
+    }
+
+    bool waitUntil(const std::function<bool()> &done)
+    {
+        QElapsedTimer waited;
+        waited.start();
+        while (!done())
+        {
+            if (waited.elapsed() > TIMEOUT_MS)
+            {
+                return false;
+            }
+            QThread::msleep(10);
+        }
+        return true;
+    }
+
+    // Quiet latency in milliseconds, or -1 with result.error set.
+    double measure(int recordUs, bool interrupt, StopLatencyBenchmark::Result &result)
+    {
+        ControllerSimulator controller(recordUs);
+        if (!controller.start(result.error))
+        {
+            return -1.0;
+        }
+        DataBuffer buffer;
+        TcpSocketWorker worker(QStringLiteral("127.0.0.1"), controller.port(), buffer);
+        buffer.setStreamer(&worker);
+
+        const std::vector<char> frame = markingFrame();
+        const qint64 perFrame = DataBuffer::frameSize() / RECORD_SIZE;
+        std::atomic<bool> stopProducing{false};
+        // Stays one frame ahead of the streamer, like the daemon's feeder.
+        std::thread producer([&]() {
+            buffer.setSource(SOURCE_ID, 0);
+            while (!stopProducing.load())
+            {
+                if (buffer.pendingFrames() > 0 || worker.isHeld())
+                {
+                    QThread::msleep(1);
+                    continue;
+                }
+                buffer.addRecords(frame.data(), perFrame);
+            }
+        });
+
+        // Half way through the second frame: one frame on the wire and the next one queued.
+        double quietMs = -1.0;
+        if (!waitUntil([&]() { return controller.recordsExecuted() >= perFrame * 3 / 2; }))
+        {
+            result.error = QStringLiteral("the controller simulator received no frames");
+        }
+        else
+        {
+            const qint64 requestNs = controller.nowNs();
+            if (interrupt)
+            {
+                const auto interruption = worker.interrupt();
+                result.cut = interruption.cut;
+                result.parkMs = interruption.parkMs;
+                result.framesDropped = interruption.framesDropped;
+                result.resumePosition = interruption.sourceId == SOURCE_ID ? interruption.resumePosition : -1;
+            }
+            else
+            {
+                worker.stop();
+            }
+            if (!waitUntil([&]() { return controller.nowNs() - controller.lastLaserNs() > QUIET_NS; }))
+            {
+                result.error = QStringLiteral("the controller simulator never went quiet");
+            }
+            else
+            {
+                quietMs = qMax<qint64>(0, controller.lastLaserNs() - requestNs) / 1e6;
+                if (interrupt)
+                {
+                    result.recordsExecuted = controller.laserRecordsExecuted();
+                }
+            }
+        }
+
+        stopProducing.store(true);
+        producer.join();
+        worker.stop();
+        controller.stop();
+        worker.wait();
+        return quietMs;
+    }
+}
+
+StopLatencyBenchmark::Result StopLatencyBenchmark::run(int recordUs)
+{
+    Result result;
+    result.recordUs = recordUs;
+    result.stopQuietMs = measure(recordUs, false, result);
+    if (result.error.isEmpty())
+    {
+        result.interruptQuietMs = measure(recordUs, true, result);
+    }
+    return result;
+}
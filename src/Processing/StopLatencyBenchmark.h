@@ -0,0 +1,33 @@
+#pragma once
+
+#include <QString>
+#include <QtGlobal>
+
+// Stop-to-quiet latency against the local ControllerSimulator: how long laser-on records keep
+// executing after the stream is told to stop in the middle of a frame. Measured once with
+// TcpSocketWorker::stop(), which lets the frame on the wire finish, and once with interrupt(),
+// which cuts it over to the park records. The second run also checks the resume position it
+// reports against the records the simulator actually executed.
+class StopLatencyBenchmark
+{
+public:
+    struct Result
+    {
+        int recordUs{0};
+        double stopQuietMs{0.0};
+        double interruptQuietMs{0.0};
+        double parkMs{0.0};
+        bool cut{false};
+        int framesDropped{0};
+        qint64 resumePosition{-1};
+        qint64 recordsExecuted{0};
+        QString error;
+
+        bool resumeExact() const
+        {
+            return resumePosition == recordsExecuted;
+        }
+    };
+
+    static Result run(int recordUs = 10);
+};
@@ -1,48 +1,247 @@
 #include "TcpSocketWorker.h"
 
+#include <QElapsedTimer>
 #include <QHostAddress>
+#include <QMutexLocker>
 #include <QTcpSocket>
 #include <QThread>
 #include <QtDebug>
 
 #include "DataBuffer.h"
+#include "metrics/MetricsRegistry.h"
+#include "metrics/Trace.h"
 
 namespace {
     constexpr auto HOST = "192.168.1.10";
     constexpr quint16 PORT = 7;
     constexpr int READ_SIZE = 128;
+    constexpr int POLL_MS = 100;
+    constexpr int RECORD_SIZE = 16;
+    // About 10 ms of records at the controller's pace. With the send buffer kept that small too,
+    // an interruption finds at most a few tens of milliseconds of the old frame ahead of it.
+    constexpr qint64 WRITE_CHUNK = 16 * 1024;
+    constexpr int SEND_BUFFER = 32 * 1024;
+
+    struct StreamMetrics {
+        MetricsRegistry::Counter& bytesWritten;
+        MetricsRegistry::Counter& framesWritten;
+        MetricsRegistry::Counter& reconnects;
+        MetricsRegistry::Gauge& connected;
+        MetricsRegistry::Histogram& creditLatencyUs;
+        MetricsRegistry::Histogram& frameWriteUs;
+        MetricsRegistry::Counter& interrupts;
+        MetricsRegistry::Histogram& interruptParkUs;
+    };
+
+    StreamMetrics& metrics() {
+        auto& registry = MetricsRegistry::instance();
+        static StreamMetrics streamMetrics{
+            registry.counter(QStringLiteral("fiveaxis_tcp_bytes_written_total"), QStringLiteral("Frame bytes written to the controller")),
+            registry.counter(QStringLiteral("fiveaxis_tcp_frames_written_total"), QStringLiteral("Frames written to the controller")),
+            registry.counter(QStringLiteral("fiveaxis_tcp_reconnects_total"), QStringLiteral("Reconnects after a dropped stream")),
+            registry.gauge(QStringLiteral("fiveaxis_tcp_connected"), QStringLiteral("1 while the frame stream is connected")),
+            registry.histogram(QStringLiteral("fiveaxis_tcp_credit_latency_us"),
+                QStringLiteral("End of a frame write to the controller's next credit, microseconds")),
+            registry.histogram(QStringLiteral("fiveaxis_tcp_frame_write_us"), QStringLiteral("Writing one frame to the socket, microseconds")),
+            registry.counter(QStringLiteral("fiveaxis_tcp_interrupts_total"), QStringLiteral("Frames cut short by an interruption")),
+            registry.histogram(QStringLiteral("fiveaxis_tcp_interrupt_park_us"),
+                QStringLiteral("Interruption request to the park records being in the socket, microseconds")),
+        };
+        return streamMetrics;
+    }
+
+    // A frame's worth of park records and zero padding; a cut frame ends with the start of it.
+    const QByteArray& parkTail() {
+        static const QByteArray tail = []() {
+            QByteArray bytes = DataBuffer::parkRecords();
+            bytes.append(QByteArray(DataBuffer::frameSize() - bytes.size(), '\0'));
+            return bytes;
+        }();
+        return tail;
+    }
 }
 
 TcpSocketWorker& TcpSocketWorker::instance() {
-    static TcpSocketWorker worker;
+    static TcpSocketWorker worker(QString::fromUtf8(HOST), PORT, DataBuffer::instance());
     return worker;
 }
 
+TcpSocketWorker::TcpSocketWorker(const QString& host, quint16 port, DataBuffer& buffer)
+    : m_host(host)
+    , m_port(port)
+    , m_buffer(buffer) {
+}
+
+TcpSocketWorker::~TcpSocketWorker() {
+    stop();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
 void TcpSocketWorker::ensureRunning() {
     if (m_running.load()) {
         return;
     }
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
     m_stopRequested.store(false);
+    m_running.store(true);
     m_thread = std::thread([this]() { run(); });
-    m_thread.detach();
 }
 
 void TcpSocketWorker::stop() {
     m_stopRequested.store(true);
 }
 
+void TcpSocketWorker::wait() {
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+TcpSocketWorker::Interruption TcpSocketWorker::interrupt() {
+    trace::Scope scope("tcp", "interrupt");
+    QMutexLocker locker(&m_interruptMutex);
+    m_held.store(true);
+    m_interruptClock.start();
+    m_interruption = Interruption();
+    m_interruption.framesDropped = m_buffer.interruptQueued();
+    if (m_running.load()) {
+        m_interruptPending = true;
+        m_interruptRequested.store(true);
+        while (m_interruptPending && m_running.load()) {
+            m_interruptAnswered.wait(&m_interruptMutex, POLL_MS);
+        }
+    }
+    // Without a streaming thread nothing was on the wire.
+    if (!m_running.load() && m_interruptRequested.exchange(false)) {
+        m_interruptPending = false;
+    }
+    if (m_interruption.sourceId == 0) {
+        m_interruption.sourceId = m_buffer.sourceId();
+        m_interruption.resumePosition = m_buffer.unsentSource();
+    }
+    return m_interruption;
+}
+
+void TcpSocketWorker::resumeStream() {
+    m_held.store(false);
+}
+
+bool TcpSocketWorker::isHeld() const {
+    return m_held.load();
+}
+
+bool TcpSocketWorker::isConnected() const {
+    return m_connected.load();
+}
+
+qint64 TcpSocketWorker::bytesWritten() const {
+    return m_bytesWritten.load();
+}
+
+qint64 TcpSocketWorker::framesWritten() const {
+    return m_framesWritten.load();
+}
+
+int TcpSocketWorker::reconnects() const {
+    return m_reconnects.load();
+}
+
+FrameTap& TcpSocketWorker::frameTap() {
+    return m_tap;
+}
+
+void TcpSocketWorker::setRealtime(const RealtimeOptions& options) {
+    QMutexLocker locker(&m_realtimeMutex);
+    m_realtime = options;
+}
+
+QString TcpSocketWorker::realtimeStatus() const {
+    QMutexLocker locker(&m_realtimeMutex);
+    return m_realtimeStatus;
+}
+
+void TcpSocketWorker::applyRealtime() {
+    QMutexLocker locker(&m_realtimeMutex);
+    m_realtimeStatus.clear();
+    if (!m_realtime.enabled) {
+        return;
+    }
+    const auto setup = realtime::applyToCurrentThread(m_realtime);
+    for (const QString& warning : setup.warnings) {
+        qWarning() << "Real-time mode:" << warning;
+    }
+    m_realtimeStatus = setup.summary;
+}
+
+void TcpSocketWorker::answerInterrupt(bool cut, qint64 cutResume) {
+    if (!m_interruptRequested.load()) {
+        return;
+    }
+    QMutexLocker locker(&m_interruptMutex);
+    if (!m_interruptRequested.exchange(false)) {
+        return;
+    }
+    m_interruption.cut = cut;
+    if (cut) {
+        const qint64 parkNs = m_interruptClock.nsecsElapsed();
+        m_interruption.parkMs = parkNs / 1e6;
+        metrics().interrupts.add();
+        metrics().interruptParkUs.record(parkNs / 1000);
+    }
+    // The controller was expecting the dropped frames and would otherwise be left mid-process.
+    m_parkOwed = !cut && m_interruption.framesDropped > 0;
+    m_interruption.sourceId = m_buffer.sourceId();
+    m_interruption.resumePosition = cutResume >= 0 ? cutResume : m_buffer.unsentSource();
+    m_interruptPending = false;
+    m_interruptAnswered.wakeAll();
+}
+
+qint64 TcpSocketWorker::writeFrame(QTcpSocket& socket, const char* data, qint64 size, int index) {
+    static const qint64 parkSize = DataBuffer::parkRecords().size();
+    const QByteArray& tail = parkTail();
+    qint64 offset = 0;
+    qint64 cutAt = -1;
+    while (offset < size && socket.state() == QAbstractSocket::ConnectedState) {
+        if (cutAt < 0 && index >= 0 && m_interruptRequested.load() && offset % RECORD_SIZE == 0 && size - offset >= parkSize) {
+            cutAt = offset;
+        }
+        const char* source = cutAt < 0 ? data + offset : tail.constData() + (offset - cutAt);
+        const auto written = socket.write(source, qMin(WRITE_CHUNK, size - offset));
+        if (written <= 0) {
+            break;
+        }
+        offset += written;
+        while (socket.bytesToWrite() > 0 && socket.state() == QAbstractSocket::ConnectedState) {
+            socket.waitForBytesWritten(POLL_MS);
+        }
+        if (cutAt >= 0) {
+            answerInterrupt(true, m_buffer.cutFrame(index, cutAt));
+        }
+    }
+    m_bytesWritten += offset;
+    metrics().bytesWritten.add(offset);
+    return cutAt < 0 ? offset : cutAt;
+}
+
 void TcpSocketWorker::run() {
-    m_running.store(true);
+    trace::setThreadName(QStringLiteral("TcpSocketWorker"));
+    applyRealtime();
+    bool firstConnect = true;
     while (!m_stopRequested.load()) {
         QTcpSocket socket;
         socket.setSocketOption(QAbstractSocket::KeepAliveOption, 1);
 
         while (!m_stopRequested.load()) {
-            socket.connectToHost(QHostAddress(QString::fromUtf8(HOST)), PORT);
+            answerInterrupt(false, -1);
+            socket.connectToHost(QHostAddress(m_host), m_port);
             if (socket.waitForConnected(1000)) {
                 break;
             }
-            qWarning() << "TCP Failed" << socket.errorString();
+            qWarning() << "TCP Failed" << m_host << socket.errorString();
             socket.abort();
             QThread::msleep(100);
         }
@@ -50,46 +249,93 @@ void TcpSocketWorker::run() {
         if (m_stopRequested.load()) {
             break;
         }
+        auto& streamMetrics = metrics();
+        if (!firstConnect) {
+            ++m_reconnects;
+            streamMetrics.reconnects.add();
+        }
+        firstConnect = false;
+        socket.setSocketOption(QAbstractSocket::SendBufferSizeSocketOption, SEND_BUFFER);
+        m_connected.store(true);
+        streamMetrics.connected.set(1.0);
+        // A controller that restarted has lost its laser settings; send them again with the next job.
+        m_buffer.invalidateSettings();
+        // The controller asks for the next frame by sending a credit once it has room for it.
+        QElapsedTimer sinceFrame;
 
         while (socket.state() == QAbstractSocket::ConnectedState && !m_stopRequested.load()) {
-            if (!socket.waitForReadyRead(-1)) {
-                break;
+            answerInterrupt(false, -1);
+            if (!socket.waitForReadyRead(POLL_MS)) {
+                continue;
             }
 
             QByteArray inbound;
-            while (inbound.size() < READ_SIZE && socket.state() == QAbstractSocket::ConnectedState) {
-                const auto chunk = socket.read(READ_SIZE - inbound.size());
-                if (!chunk.isEmpty()) {
-                    inbound.append(chunk);
-                }
-                if (inbound.size() >= READ_SIZE) {
-                    break;
-                }
-                if (!socket.waitForReadyRead(1000)) {
-                    break;
+            {
+                trace::Scope scope("tcp", "read");
+                while (inbound.size() < READ_SIZE && socket.state() == QAbstractSocket::ConnectedState) {
+                    const auto chunk = socket.read(READ_SIZE - inbound.size());
+                    if (!chunk.isEmpty()) {
+                        inbound.append(chunk);
+                    }
+                    if (inbound.size() >= READ_SIZE) {
+                        break;
+                    }
+                    if (!socket.waitForReadyRead(1000)) {
+                        break;
+                    }
                 }
             }
+            if (sinceFrame.isValid()) {
+                streamMetrics.creditLatencyUs.record(sinceFrame.nsecsElapsed() / 1000);
+                sinceFrame.invalidate();
+            }
 
-            const int rdPtr = DataBuffer::instance().getReadBuf();
-            auto& buf = DataBuffer::instance().buffer(rdPtr);
-
-            qint64 offset = 0;
-            while (offset < buf.size() && socket.state() == QAbstractSocket::ConnectedState) {
-                const auto written = socket.write(buf.constData() + offset, buf.size() - offset);
-                if (written <= 0) {
-                    break;
-                }
-                offset += written;
-                if (!socket.waitForBytesWritten(-1)) {
-                    break;
+            // A held stream keeps the credit until it is resumed, except for a park frame owed.
+            int rdPtr = -1;
+            while (rdPtr < 0 && !m_stopRequested.load() && !m_parkOwed) {
+                answerInterrupt(false, -1);
+                if (m_held.load()) {
+                    QThread::msleep(1);
+                    continue;
                 }
+                rdPtr = m_buffer.tryGetReadBuf(POLL_MS);
+            }
+            if (m_parkOwed) {
+                trace::Scope scope("tcp", "write park frame");
+                m_parkOwed = false;
+                writeFrame(socket, parkTail().constData(), DataBuffer::frameSize(), -1);
+                sinceFrame.start();
+                continue;
+            }
+            if (rdPtr < 0) {
+                break;
             }
-            socket.flush();
-            DataBuffer::instance().readEnd(rdPtr);
+            const char* frame = m_buffer.frame(rdPtr);
+
+            qint64 sent = 0;
+            QElapsedTimer writeTimer;
+            writeTimer.start();
+            {
+                trace::Scope scope("tcp", "write");
+                sent = writeFrame(socket, frame, DataBuffer::frameSize(), rdPtr);
+            }
+            streamMetrics.frameWriteUs.record(writeTimer.nsecsElapsed() / 1000);
+            sinceFrame.start();
+            ++m_framesWritten;
+            streamMetrics.framesWritten.add();
+            m_tap.offerFrame(frame, sent);
+            m_buffer.readEnd(rdPtr);
+            // Interrupted too close to the end of the frame to cut it: it went out whole.
+            answerInterrupt(false, -1);
         }
 
+        m_connected.store(false);
+        streamMetrics.connected.set(0.0);
         socket.disconnectFromHost();
-        socket.waitForDisconnected(500);
+        if (socket.state() != QAbstractSocket::UnconnectedState) {
+            socket.waitForDisconnected(500);
+        }
     }
+    m_connected.store(false);
     m_running.store(false);
-}
\ No newline at end of file
+}
@@ -3,19 +3,96 @@
 #include <atomic>
 #include <thread>
 
-class TcpSocketWorker
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QString>
+#include <QWaitCondition>
+#include <QtGlobal>
+
+#include "FrameStreamer.h"
+#include "FrameTap.h"
+#include "RealtimeMode.h"
+
+class DataBuffer;
+class QTcpSocket;
+
+class TcpSocketWorker : public FrameStreamer
 {
 public:
+    struct Interruption
+    {
+        // The frame on the wire was cut short; the rest of it went out as park records.
+        bool cut{false};
+        // Filled frames dropped before they were sent. If some were but nothing was cut, a park
+        // frame goes out on the controller's next credit instead.
+        int framesDropped{0};
+        // From the request to the park records being in the socket; 0 if none were written yet.
+        double parkMs{0.0};
+        // DataBuffer::setSource() id at the time and its first record not sent, -1 if unknown.
+        int sourceId{0};
+        qint64 resumePosition{-1};
+    };
+
     static TcpSocketWorker &instance();
 
-    void ensureRunning();
+    TcpSocketWorker(const QString &host, quint16 port, DataBuffer &buffer);
+    ~TcpSocketWorker() override;
+
+    void ensureRunning() override;
     void stop();
+    // Blocks until the thread has exited after stop(); the current frame is finished first.
+    void wait();
+    // Emergency stop within one write chunk rather than one frame: the rest of the frame being
+    // written is replaced by DataBuffer::parkRecords() and zero padding, the queued frames are
+    // dropped, and no frame is taken until resumeStream(). Returns once the park records are in
+    // the socket. The producer calls DataBuffer::discardQueued() before it writes again.
+    Interruption interrupt();
+    void resumeStream();
+    bool isHeld() const;
+
+    bool isConnected() const;
+    qint64 bytesWritten() const;
+    qint64 framesWritten() const;
+    int reconnects() const;
+    // Decimated copy of every frame sent, for live visualization; disabled until a viewer enables it.
+    FrameTap &frameTap();
+    // Pinning and SCHED_FIFO for the streaming thread, applied each time the thread starts.
+    void setRealtime(const RealtimeOptions &options);
+    // What the running thread was granted, e.g. "CPU 3, SCHED_FIFO 80"; empty with the mode off.
+    QString realtimeStatus() const;
 
 private:
-    TcpSocketWorker() = default;
     void run();
+    void applyRealtime();
+    // Streaming thread: hands the result of a pending interrupt() back to its caller.
+    void answerInterrupt(bool cut, qint64 cutResume);
+    // Writes size bytes in chunks no bigger than the send buffer, cutting over to the park tail
+    // if interrupted; returns the bytes of data that went out before the cut.
+    qint64 writeFrame(QTcpSocket &socket, const char *data, qint64 size, int index);
 
+    QString m_host;
+    quint16 m_port;
+    DataBuffer &m_buffer;
     std::thread m_thread;
     std::atomic<bool> m_running{false};
     std::atomic<bool> m_stopRequested{false};
-};
\ No newline at end of file
+    std::atomic<bool> m_connected{false};
+    std::atomic<qint64> m_bytesWritten{0};
+    std::atomic<qint64> m_framesWritten{0};
+    std::atomic<int> m_reconnects{0};
+    FrameTap m_tap;
+    mutable QMutex m_realtimeMutex;
+    RealtimeOptions m_realtime;
+    QString m_realtimeStatus;
+    // Guards the interrupt() handshake with the streaming thread.
+    QMutex m_interruptMutex;
+    QWaitCondition m_interruptAnswered;
+    std::atomic<bool> m_interruptRequested{false};
+    std::atomic<bool> m_held{false};
+    bool m_interruptPending{false};
+    // Streaming thread: frames were dropped while none was on the wire, so the controller is owed
+    // a park frame.
+    bool m_parkOwed{false};
+    Interruption m_interruption;
+    QElapsedTimer m_interruptClock;
+};
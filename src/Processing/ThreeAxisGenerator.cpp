@@ -2,15 +2,30 @@
 
 #include <functional>
 
+#include <QPolygonF>
 #include <QtMath>
 
 #include "DataBuffer.h"
+#include "SampleSink.h"
+#include "metrics/Trace.h"
 
 namespace {
     constexpr double STEP_US = 0.00001; // 10us
     constexpr double PI = 3.14159265358979323846;
 
-    void writeLineSegment(double speed, bool laserOn, double x1, double y1, double z1, double x2, double y2, double z2,
+    // Ŵ/ϵУ
+    constexpr double X_GAIN = 776.991;
+    constexpr double Y_GAIN = 778.062;
+    constexpr double Z_GAIN = 830.0;
+
+    constexpr double X_Z_COEFF = 0.13095395;
+    constexpr double Y_Z_COEFF = 0.1702982;
+    constexpr double ROTATION_DEG = 44.8;
+    constexpr double Z_OFFSET = 4.5;
+    // Contour joints turning less than this are driven through without a polygon delay.
+    constexpr double SHARP_CORNER_DEG = 30.0;
+
+    void writeLineSegment(SampleSink& buffer, double speed, bool laserOn, double x1, double y1, double z1, double x2, double y2, double z2,
         int laserOnDelay, const std::function<void(double&, double&, double&)>& correction,
         const std::function<quint16(double)>& clamp) {
         speed *= 0.001;
@@ -25,7 +40,7 @@ namespace {
             double cy = y1;
             double cz = z1;
             correction(cx, cy, cz);
-            DataBuffer::instance().addProcessJumpData(clamp(cx), clamp(cy), clamp(cz), 0, 0);
+            buffer.addProcessJumpData(clamp(cx), clamp(cy), clamp(cz), 0, 0);
             return;
         }
 
@@ -37,17 +52,27 @@ namespace {
 
             if (laserOn) {
                 if (i * 10 < laserOnDelay) {
-                    DataBuffer::instance().addProcessJumpData(clamp(x), clamp(y), clamp(z), 0, 0);
+                    buffer.addProcessJumpData(clamp(x), clamp(y), clamp(z), 0, 0);
                 }
                 else {
-                    DataBuffer::instance().addProcessData(clamp(x), clamp(y), clamp(z), 0, 0);
+                    buffer.addProcessData(clamp(x), clamp(y), clamp(z), 0, 0);
                 }
             }
             else {
-                DataBuffer::instance().addProcessJumpData(clamp(x), clamp(y), clamp(z), 0, 0);
+                buffer.addProcessJumpData(clamp(x), clamp(y), clamp(z), 0, 0);
             }
         }
     }
+
+    bool isSharpCorner(const QPointF& from, const QPointF& corner, const QPointF& to) {
+        const QPointF in = corner - from;
+        const QPointF out = to - corner;
+        const double lengths = qSqrt(QPointF::dotProduct(in, in) * QPointF::dotProduct(out, out));
+        if (qFuzzyIsNull(lengths)) {
+            return false;
+        }
+        return QPointF::dotProduct(in, out) / lengths < qCos(qDegreesToRadians(SHARP_CORNER_DEG));
+    }
 }
 
 quint16 ThreeAxisGenerator::clampToUint16(double value) {
@@ -61,16 +86,6 @@ quint16 ThreeAxisGenerator::clampToUint16(double value) {
 }
 
 void ThreeAxisGenerator::applyCorrection(double& x, double& y, double& z) {
-    // Ŵ/ϵУ
-    constexpr double X_GAIN = 776.991;
-    constexpr double Y_GAIN = 778.062;
-    constexpr double Z_GAIN = 830.0;
-
-    constexpr double X_Z_COEFF = 0.13095395;
-    constexpr double Y_Z_COEFF = 0.1702982;
-    constexpr double ROTATION_DEG = 44.8;
-    constexpr double Z_OFFSET = 4.5;
-
     z -= Z_OFFSET;
 
     const double zReal = z;
@@ -92,33 +107,62 @@ void ThreeAxisGenerator::applyCorrection(double& x, double& y, double& z) {
     z += 32768.0;
 }
 
-void ThreeAxisGenerator::waitDelay(double x, double y, double z, int delayOn, int delayOff) {
+void ThreeAxisGenerator::invertCorrection(double& x, double& y, double& z) {
+    z -= 32768.0;
+    y -= 32768.0;
+    x = x + z - 32768.0;
+
+    const double rad = qDegreesToRadians(ROTATION_DEG);
+    const double tempX = x;
+    const double tempY = y;
+    x = tempX * qCos(rad) - tempY * qSin(rad);
+    y = tempX * qSin(rad) + tempY * qCos(rad);
+
+    const double zReal = z / Z_GAIN;
+    x = x / X_GAIN + X_Z_COEFF * zReal;
+    y = y / Y_GAIN - Y_Z_COEFF * zReal;
+    z = zReal + Z_OFFSET;
+}
+
+void ThreeAxisGenerator::waitDelay(SampleSink& buffer, double x, double y, double z, int delayOn, int delayOff) {
     const int t = 10;
     applyCorrection(x, y, z);
     int n = delayOn / t;
     int i = 0;
     while (i < n) {
-        DataBuffer::instance().addProcessData(clampToUint16(x), clampToUint16(y), clampToUint16(z), 0, 0);
+        buffer.addProcessData(clampToUint16(x), clampToUint16(y), clampToUint16(z), 0, 0);
         ++i;
     }
     n = delayOff / t;
     i = 0;
     while (i < n) {
-        DataBuffer::instance().addProcessJumpData(clampToUint16(x), clampToUint16(y), clampToUint16(z), 0, 0);
+        buffer.addProcessJumpData(clampToUint16(x), clampToUint16(y), clampToUint16(z), 0, 0);
         ++i;
     }
 }
 
 void ThreeAxisGenerator::generateLine(double speed, bool laserOn, double x1, double y1, double z1, double x2,
     double y2, double z2) {
-    DataBuffer::instance().addProcessBegin();
-    writeLineSegment(speed, laserOn, x1, y1, z1, x2, y2, z2, LASER_ON_DELAY,
+    generateLine(DataBuffer::instance(), speed, laserOn, x1, y1, z1, x2, y2, z2);
+}
+
+void ThreeAxisGenerator::generateLine(SampleSink& buffer, double speed, bool laserOn, double x1, double y1, double z1,
+    double x2, double y2, double z2) {
+    trace::Scope scope("generator", "generateLine");
+    buffer.addProcessBegin();
+    writeLineSegment(buffer, speed, laserOn, x1, y1, z1, x2, y2, z2, LASER_ON_DELAY,
         [](double& x, double& y, double& z) { applyCorrection(x, y, z); },
         [](double v) { return clampToUint16(v); });
-    DataBuffer::instance().addProcessEnd();
+    buffer.addProcessEnd();
 }
 
 void ThreeAxisGenerator::generateCircle(double x0, double y0, double x1, double y1, double z, double speed) {
+    generateCircle(DataBuffer::instance(), x0, y0, x1, y1, z, speed);
+}
+
+void ThreeAxisGenerator::generateCircle(SampleSink& buffer, double x0, double y0, double x1, double y1, double z,
+    double speed) {
+    trace::Scope scope("generator", "generateCircle");
     speed *= 0.001;
 
     double radius = qSqrt(qPow(x1 - x0, 2) + qPow(y1 - y0, 2));
@@ -127,7 +171,7 @@ void ThreeAxisGenerator::generateCircle(double x0, double y0, double x1, double
     const double circumferenceTime = 2 * PI * radius / speed;
     const int nMax = static_cast<int>((circumferenceTime / STEP_US) + 1);
 
-    DataBuffer::instance().addProcessBegin();
+    buffer.addProcessBegin();
 
     for (int n = 0; n < nMax; ++n) {
         const double angleRad = (n * STEP_US * 360 / circumferenceTime) * PI / 180.0;
@@ -137,18 +181,24 @@ void ThreeAxisGenerator::generateCircle(double x0, double y0, double x1, double
         applyCorrection(x, y, zVal);
 
         if (n * 10 < LASER_ON_DELAY) {
-            DataBuffer::instance().addProcessJumpData(clampToUint16(x), clampToUint16(y), clampToUint16(zVal), 0, 0);
+            buffer.addProcessJumpData(clampToUint16(x), clampToUint16(y), clampToUint16(zVal), 0, 0);
         }
         else {
-            DataBuffer::instance().addProcessData(clampToUint16(x), clampToUint16(y), clampToUint16(zVal), 0, 0);
+            buffer.addProcessData(clampToUint16(x), clampToUint16(y), clampToUint16(zVal), 0, 0);
         }
     }
 
-    DataBuffer::instance().addProcessEnd();
+    buffer.addProcessEnd();
 }
 
 void ThreeAxisGenerator::generateRectangle(double x0, double y0, double z0, double x1, double y1, double z1,
     double speed, double yInterval) {
+    generateRectangle(DataBuffer::instance(), x0, y0, z0, x1, y1, z1, speed, yInterval);
+}
+
+void ThreeAxisGenerator::generateRectangle(SampleSink& buffer, double x0, double y0, double z0, double x1, double y1,
+    double z1, double speed, double yInterval) {
+    trace::Scope scope("generator", "generateRectangle");
     const double yLength = qAbs(2 * (y1 - y0));
     const double xLength = qAbs(2 * (x1 - x0));
     const double zLength = qAbs(2 * (z1 - z0));
@@ -161,46 +211,80 @@ void ThreeAxisGenerator::generateRectangle(double x0, double y0, double z0, doub
     const double zInterval = zLength * yInterval / yLength;
     const double num = yLength / yInterval;
 
-    DataBuffer::instance().addProcessBegin();
+    buffer.addProcessBegin();
 
     // Jump 
-    writeLineSegment(JUMP_SPEED, false, 0, 0, 0, xStart, yStart, zStart, LASER_ON_DELAY,
+    writeLineSegment(buffer, JUMP_SPEED, false, 0, 0, 0, xStart, yStart, zStart, LASER_ON_DELAY,
         [](double& x, double& y, double& z) { applyCorrection(x, y, z); },
         [](double v) { return clampToUint16(v); });
-    waitDelay(xStart, yStart, zStart, JUMP_DELAY, 0);
+    waitDelay(buffer, xStart, yStart, zStart, JUMP_DELAY, 0);
 
     for (int i = 0; i < num / 4; ++i) {
-        writeLineSegment(speed, true, xStart + i * xInterval, yStart + i * yInterval, zStart + i * zInterval,
+        writeLineSegment(buffer, speed, true, xStart + i * xInterval, yStart + i * yInterval, zStart + i * zInterval,
             xStart + i * xInterval, y1 - i * yInterval, zStart + i * zInterval, LASER_ON_DELAY,
             [](double& x, double& y, double& z) { applyCorrection(x, y, z); },
             [](double v) { return clampToUint16(v); });
-        waitDelay(xStart + i * xInterval, y1 - i * yInterval, zStart + i * zInterval, POLYGON_DELAY, POLYGON_DELAY);
+        waitDelay(buffer, xStart + i * xInterval, y1 - i * yInterval, zStart + i * zInterval, POLYGON_DELAY, POLYGON_DELAY);
 
-        writeLineSegment(speed, true, xStart + i * xInterval, y1 - i * yInterval, zStart + i * zInterval,
+        writeLineSegment(buffer, speed, true, xStart + i * xInterval, y1 - i * yInterval, zStart + i * zInterval,
             x1 - i * xInterval, y1 - i * yInterval, z1 - i * zInterval, LASER_ON_DELAY,
             [](double& x, double& y, double& z) { applyCorrection(x, y, z); },
             [](double v) { return clampToUint16(v); });
-        waitDelay(x1 - i * xInterval, y1 - i * yInterval, z1 - i * zInterval, POLYGON_DELAY, POLYGON_DELAY);
+        waitDelay(buffer, x1 - i * xInterval, y1 - i * yInterval, z1 - i * zInterval, POLYGON_DELAY, POLYGON_DELAY);
 
-        writeLineSegment(speed, true, x1 - i * xInterval, y1 - i * yInterval, z1 - i * zInterval,
+        writeLineSegment(buffer, speed, true, x1 - i * xInterval, y1 - i * yInterval, z1 - i * zInterval,
             x1 - i * xInterval, yStart + i * yInterval, z1 - i * zInterval, LASER_ON_DELAY,
             [](double& x, double& y, double& z) { applyCorrection(x, y, z); },
             [](double v) { return clampToUint16(v); });
-        waitDelay(x1 - i * xInterval, yStart + i * yInterval, z1 - i * zInterval, POLYGON_DELAY, POLYGON_DELAY);
+        waitDelay(buffer, x1 - i * xInterval, yStart + i * yInterval, z1 - i * zInterval, POLYGON_DELAY, POLYGON_DELAY);
 
-        writeLineSegment(speed, true, x1 - i * xInterval, yStart + i * yInterval, z1 - i * zInterval,
+        writeLineSegment(buffer, speed, true, x1 - i * xInterval, yStart + i * yInterval, z1 - i * zInterval,
             xStart + i * xInterval, yStart + i * yInterval, zStart + i * zInterval, LASER_ON_DELAY,
             [](double& x, double& y, double& z) { applyCorrection(x, y, z); },
             [](double v) { return clampToUint16(v); });
-        waitDelay(xStart + i * xInterval, yStart + i * yInterval, zStart + i * zInterval, POLYGON_DELAY, POLYGON_DELAY);
+        waitDelay(buffer, xStart + i * xInterval, yStart + i * yInterval, zStart + i * zInterval, POLYGON_DELAY, POLYGON_DELAY);
 
-        writeLineSegment(JUMP_SPEED, false, xStart + i * xInterval, yStart + i * yInterval, zStart + i * zInterval,
+        writeLineSegment(buffer, JUMP_SPEED, false, xStart + i * xInterval, yStart + i * yInterval, zStart + i * zInterval,
             xStart + (i + 1) * xInterval, yStart + (i + 1) * yInterval, zStart + (i + 1) * zInterval,
             LASER_ON_DELAY, [](double& x, double& y, double& z) { applyCorrection(x, y, z); },
             [](double v) { return clampToUint16(v); });
-        waitDelay(xStart + (i + 1) * xInterval, yStart + (i + 1) * yInterval, zStart + (i + 1) * zInterval,
+        waitDelay(buffer, xStart + (i + 1) * xInterval, yStart + (i + 1) * yInterval, zStart + (i + 1) * zInterval,
             POLYGON_DELAY, POLYGON_DELAY);
     }
 
-    DataBuffer::instance().addProcessEnd();
-}
\ No newline at end of file
+    buffer.addProcessEnd();
+}
+
+void ThreeAxisGenerator::generateContour(const QPolygonF& contour, double z, double speed) {
+    generateContour(DataBuffer::instance(), contour, z, speed);
+}
+
+void ThreeAxisGenerator::generateContour(SampleSink& buffer, const QPolygonF& contour, double z, double speed) {
+    trace::Scope scope("generator", "generateContour");
+    const int count = contour.size();
+    if (count < 2) {
+        return;
+    }
+
+    buffer.addProcessBegin();
+
+    const QPointF start = contour.first();
+    writeLineSegment(buffer, JUMP_SPEED, false, 0, 0, 0, start.x(), start.y(), z, LASER_ON_DELAY,
+        [](double& x, double& y, double& z) { applyCorrection(x, y, z); },
+        [](double v) { return clampToUint16(v); });
+    waitDelay(buffer, start.x(), start.y(), z, JUMP_DELAY, 0);
+
+    for (int i = 0; i < count; ++i) {
+        const QPointF& from = contour[i];
+        const QPointF& to = contour[(i + 1) % count];
+        // The laser stays on along the contour, so only the first edge waits for it to come on.
+        writeLineSegment(buffer, speed, true, from.x(), from.y(), z, to.x(), to.y(), z, i == 0 ? LASER_ON_DELAY : 0,
+            [](double& x, double& y, double& z) { applyCorrection(x, y, z); },
+            [](double v) { return clampToUint16(v); });
+        if (isSharpCorner(from, to, contour[(i + 2) % count])) {
+            waitDelay(buffer, to.x(), to.y(), z, POLYGON_DELAY, POLYGON_DELAY);
+        }
+    }
+
+    buffer.addProcessEnd();
+}
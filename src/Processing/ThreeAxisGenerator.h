@@ -2,16 +2,32 @@
 
 #include <QtGlobal>
 
+class DataBuffer;
+class QPolygonF;
+class SampleSink;
+
 class ThreeAxisGenerator {
 public:
     // ֱߣֻʹ X/Y/Zʹ A/B
     static void generateLine(double speed, bool laserOn, double x1, double y1, double z1, double x2, double y2, double z2);
+    static void generateLine(SampleSink& buffer, double speed, bool laserOn, double x1, double y1, double z1, double x2, double y2, double z2);
 
     // Բ (x0, y0) ΪԲģ(x1, y1) ΪԲһ㣬Z ̶
     static void generateCircle(double x0, double y0, double x1, double y1, double z, double speed);
+    static void generateCircle(SampleSink& buffer, double x0, double y0, double x1, double y1, double z, double speed);
 
     // ɼ򵥵Σ䣩ɨ裬Z Բֵ
     static void generateRectangle(double x0, double y0, double z0, double x1, double y1, double z1, double speed, double yInterval);
+    static void generateRectangle(SampleSink& buffer, double x0, double y0, double z0, double x1, double y1, double z1, double speed, double yInterval);
+
+    // Closed contour at a fixed Z (last point joins the first), e.g. one sliced mesh layer.
+    static void generateContour(const QPolygonF& contour, double z, double speed);
+    static void generateContour(SampleSink& buffer, const QPolygonF& contour, double z, double speed);
+
+    // Galvo calibration: workpiece coordinates to device counts, before clamping.
+    static void applyCorrection(double& x, double& y, double& z);
+    // Inverse of the galvo calibration: device counts back to workpiece coordinates.
+    static void invertCorrection(double& x, double& y, double& z);
 
 private:
     static constexpr int LASER_ON_DELAY = 100;
@@ -20,6 +36,5 @@ private:
     static constexpr int POLYGON_DELAY = 450;
 
     static quint16 clampToUint16(double value);
-    static void applyCorrection(double& x, double& y, double& z);
-    static void waitDelay(double x, double y, double z, int delayOn, int delayOff);
+    static void waitDelay(SampleSink& buffer, double x, double y, double z, int delayOn, int delayOff);
 };
\ No newline at end of file
@@ -0,0 +1,102 @@
+#include "ToolpathRecorder.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "ThreeAxisGenerator.h"
+
+namespace
+{
+    constexpr quint16 FLAG_LASER_ON = 0x00FF;
+    constexpr quint16 FLAG_JUMP = 0;
+    constexpr double BOUNDS_PAD = 0.001;
+}
+
+int ToolpathSamples::size() const
+{
+    return static_cast<int>(x.size());
+}
+
+ToolpathRecorder::ToolpathRecorder()
+    : m_samples(std::make_shared<ToolpathSamples>())
+{
+}
+
+void ToolpathRecorder::addProcessData(quint16 X, quint16 Y, quint16 Z, quint16 A, quint16 B)
+{
+    Q_UNUSED(A);
+    Q_UNUSED(B);
+    record(X, Y, Z, true);
+}
+
+void ToolpathRecorder::addProcessJumpData(quint16 X, quint16 Y, quint16 Z, quint16 A, quint16 B)
+{
+    Q_UNUSED(A);
+    Q_UNUSED(B);
+    record(X, Y, Z, false);
+}
+
+void ToolpathRecorder::addProcessBegin()
+{
+}
+
+void ToolpathRecorder::addProcessEnd()
+{
+}
+
+void ToolpathRecorder::addRecords(const char *records, qint64 count)
+{
+    quint16 words[8];
+    for (qint64 i = 0; i < count; ++i)
+    {
+        std::memcpy(words, records + i * sizeof(words), sizeof(words));
+        // Record layout: B, A, Z, Y, X, flag, 0, 0.
+        if (words[5] == FLAG_LASER_ON || words[5] == FLAG_JUMP)
+        {
+            record(words[4], words[3], words[2], words[5] == FLAG_LASER_ON);
+        }
+    }
+}
+
+void ToolpathRecorder::record(quint16 X, quint16 Y, quint16 Z, bool laserOn)
+{
+    if (m_hasLast && X == m_lastX && Y == m_lastY && Z == m_lastZ && laserOn == m_lastOn)
+    {
+        return;
+    }
+    m_hasLast = true;
+    m_lastX = X;
+    m_lastY = Y;
+    m_lastZ = Z;
+    m_lastOn = laserOn;
+
+    double x = X;
+    double y = Y;
+    double z = Z;
+    ThreeAxisGenerator::invertCorrection(x, y, z);
+    m_samples->x.push_back(static_cast<float>(x));
+    m_samples->y.push_back(static_cast<float>(y));
+    m_samples->laserOn.push_back(laserOn ? 1 : 0);
+}
+
+std::shared_ptr<const ToolpathSamples> ToolpathRecorder::take()
+{
+    auto samples = std::move(m_samples);
+    m_samples = std::make_shared<ToolpathSamples>();
+    m_hasLast = false;
+
+    const int total = samples->size();
+    // Chunks overlap by one sample so the segment crossing a chunk boundary is not lost.
+    for (int begin = 0; begin < total; begin += CHUNK_SIZE)
+    {
+        const int end = std::min(total, begin + CHUNK_SIZE + 1);
+        const auto [minX, maxX] = std::minmax_element(samples->x.begin() + begin, samples->x.begin() + end);
+        const auto [minY, maxY] = std::minmax_element(samples->y.begin() + begin, samples->y.begin() + end);
+        // Padded so straight horizontal/vertical runs still have an area to intersect with.
+        const QRectF bounds = QRectF(QPointF(*minX, *minY), QPointF(*maxX, *maxY)).adjusted(-BOUNDS_PAD, -BOUNDS_PAD,
+                                                                                        BOUNDS_PAD, BOUNDS_PAD);
+        samples->chunks.push_back({begin, end, bounds});
+        samples->bounds = samples->bounds.united(bounds);
+    }
+    return samples;
+}
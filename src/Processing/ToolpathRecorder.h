@@ -0,0 +1,58 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <QRectF>
+#include <QtGlobal>
+
+#include "SampleSink.h"
+
+// Generated toolpath in workpiece coordinates, split into chunks with bounds so a renderer
+// only walks the samples that can land in the area it draws.
+struct ToolpathSamples
+{
+    struct Chunk
+    {
+        int begin;
+        int end;
+        QRectF bounds;
+    };
+
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<quint8> laserOn;
+    std::vector<Chunk> chunks;
+    QRectF bounds;
+
+    int size() const;
+};
+
+// Keeps the samples ThreeAxisGenerator produces (or decodes DataBuffer frame records) and maps
+// them back through the inverse calibration. Repeated samples, e.g. dwell at corners, collapse.
+class ToolpathRecorder : public SampleSink
+{
+public:
+    ToolpathRecorder();
+
+    void addProcessData(quint16 X, quint16 Y, quint16 Z, quint16 A, quint16 B) override;
+    void addProcessJumpData(quint16 X, quint16 Y, quint16 Z, quint16 A, quint16 B) override;
+    void addProcessBegin() override;
+    void addProcessEnd() override;
+    // Raw 16-byte frame records as written by DataBuffer; settings and control records are skipped.
+    void addRecords(const char *records, qint64 count);
+
+    std::shared_ptr<const ToolpathSamples> take();
+
+private:
+    void record(quint16 X, quint16 Y, quint16 Z, bool laserOn);
+
+    static constexpr int CHUNK_SIZE = 4096;
+
+    std::shared_ptr<ToolpathSamples> m_samples;
+    quint16 m_lastX{0};
+    quint16 m_lastY{0};
+    quint16 m_lastZ{0};
+    bool m_lastOn{false};
+    bool m_hasLast{false};
+};
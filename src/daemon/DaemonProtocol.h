@@ -0,0 +1,44 @@
+#pragma once
+
+#include <QByteArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QString>
+
+// Control channel between StreamDaemon and its clients (StreamDaemonClient in the GUI, scripts
+// through --daemon-request or any Unix socket tool): one compact JSON object per line over a
+// QLocalSocket, which on Linux is the Unix socket <temp dir>/<name>. Replies come in request
+// order. Requests carry "cmd"; every reply carries "ok" and, when that is false, "error".
+//   attach              -> shm, slots, frame_size   become the frame ring's writer (one at a time)
+//   status              -> connected, frames_written, bytes_written, reconnects, ring_pending,
+//                          buffer_pending, ring_frames, writer, realtime, paused, held,
+//                          frames_aborted, jobs [{id, path, priority, state, records, sent}],
+//                          jobs_queued, jobs_finished, jobs_aborted, jobs_failed, last_error,
+//                          last_park_ms
+//   submit {path,       -> id, queued               queue a .faxj job, higher priority first; one
+//           priority}                              without frame records is compiled ahead of
+//                                                  its turn. The daemon maps the file before replying
+//   cancel {id}                                    drop a job that has not started streaming
+//   pause               -> cut, frames_dropped,    cut the frame on the wire over to the park
+//                          park_ms, resume         records, drop the queued frames and hold; resume
+//                                                  is the first job record the controller did not get
+//   resume                                         continue the job from that record
+//   abort {all}         -> cut, frames_dropped,    like pause, but the streaming job is dropped; with
+//                          park_ms, resume,        all, empty the queue too
+//                          cleared
+//   shutdown                                       exit now; frames not yet sent are dropped
+namespace streamdaemon
+{
+    constexpr auto DEFAULT_NAME = "fiveaxis-stream";
+    constexpr int DEFAULT_SLOTS = 16;
+
+    inline QString ringKey(const QString &name)
+    {
+        return name + QStringLiteral("-frames");
+    }
+
+    inline QByteArray encode(const QJsonObject &message)
+    {
+        return QJsonDocument(message).toJson(QJsonDocument::Compact) + '\n';
+    }
+}
@@ -0,0 +1,231 @@
+#include "JobScheduler.h"
+
+#include <algorithm>
+
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QThread>
+#include <QtDebug>
+
+#include "Processing/JobCompiler.h"
+#include "metrics/Trace.h"
+
+namespace {
+    constexpr qint64 PAGE_SIZE = 4096;
+
+    QString stateName(JobScheduler::State state) {
+        switch (state) {
+        case JobScheduler::State::Queued:
+            return QStringLiteral("queued");
+        case JobScheduler::State::Preparing:
+            return QStringLiteral("preparing");
+        case JobScheduler::State::Ready:
+            return QStringLiteral("ready");
+        case JobScheduler::State::Streaming:
+            return QStringLiteral("streaming");
+        }
+        return QString();
+    }
+
+    // Pages in the records of a job file that has them, or compiles the shapes of one that does
+    // not, counting the shapes it had to skip; false with error set when that leaves nothing to
+    // stream.
+    bool load(JobScheduler::Job& job, JobCompiler& compiler, int& skipped, QString& skipReason, QString& error) {
+        const JobFile& file = *job.file;
+        if (file.segmentCount() > 0) {
+            const auto* bytes = reinterpret_cast<const volatile char*>(file.segments());
+            const qint64 size = file.segmentCount() * static_cast<qint64>(sizeof(jobfile::FrameRecord));
+            char touched = 0;
+            for (qint64 offset = 0; offset < size; offset += PAGE_SIZE) {
+                touched ^= bytes[offset];
+            }
+            Q_UNUSED(touched);
+            return true;
+        }
+        JobData data;
+        file.toJobData(data);
+        // One core stays with the streamer, which may be pinned to it under SCHED_FIFO.
+        const auto result = compiler.compile(data.scene(), qMax(1, QThread::idealThreadCount() - 1));
+        job.compiled = result.merged();
+        skipped = result.skipped;
+        const auto first = std::find_if(result.shapes.begin(), result.shapes.end(), [](const auto& shape) {
+            return !shape->skipReason.isEmpty();
+            });
+        if (first != result.shapes.end()) {
+            skipReason = QStringLiteral("shape %1: %2").arg(first - result.shapes.begin() + 1).arg((*first)->skipReason);
+            qWarning() << "Shapes skipped:" << job.path << skipped << skipReason;
+        }
+        if (job.compiled.empty()) {
+            error = QStringLiteral("%1: none of its %2 shapes produced frame records").arg(job.path).arg(file.shapeCount());
+            return false;
+        }
+        return true;
+    }
+}
+
+JobScheduler::JobScheduler() {
+    m_preparer = std::thread([this]() { prepare(); });
+}
+
+JobScheduler::~JobScheduler() {
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopRequested = true;
+        m_wake.wakeAll();
+    }
+    m_preparer.join();
+}
+
+int JobScheduler::submit(const QString& path, int priority, QString& error) {
+    auto file = JobFile::open(path, error);
+    if (!file) {
+        return 0;
+    }
+    if (file->segmentCount() == 0 && file->shapeCount() == 0) {
+        error = QStringLiteral("%1 has neither frame records nor shapes").arg(path);
+        return 0;
+    }
+    auto job = std::make_shared<Job>();
+    job->path = path;
+    job->priority = priority;
+    job->recordCount = file->segmentCount();
+    job->file = std::move(file);
+
+    QMutexLocker locker(&m_mutex);
+    job->id = m_nextId++;
+    const auto position = std::find_if(m_queue.begin(), m_queue.end(), [priority](const auto& queued) {
+        return queued->priority < priority;
+        });
+    m_queue.insert(position, job);
+    m_wake.wakeAll();
+    return job->id;
+}
+
+bool JobScheduler::cancel(int id) {
+    QMutexLocker locker(&m_mutex);
+    const auto job = std::find_if(m_queue.begin(), m_queue.end(), [id](const auto& queued) {
+        return queued->id == id;
+        });
+    if (job == m_queue.end()) {
+        return false;
+    }
+    m_queue.erase(job);
+    m_wake.wakeAll();
+    return true;
+}
+
+int JobScheduler::clear() {
+    QMutexLocker locker(&m_mutex);
+    const int count = static_cast<int>(m_queue.size());
+    m_queue.clear();
+    return count;
+}
+
+std::shared_ptr<JobScheduler::Job> JobScheduler::takeNext() {
+    QMutexLocker locker(&m_mutex);
+    if (m_current || m_queue.empty() || m_queue.front()->state != State::Ready) {
+        return nullptr;
+    }
+    m_current = m_queue.front();
+    m_current->state = State::Streaming;
+    m_queue.erase(m_queue.begin());
+    // The next job in line can be prepared while this one streams.
+    m_wake.wakeAll();
+    return m_current;
+}
+
+void JobScheduler::finish(bool aborted) {
+    QMutexLocker locker(&m_mutex);
+    m_current.reset();
+    ++(aborted ? m_aborted : m_finished);
+}
+
+QJsonArray JobScheduler::describe() const {
+    QMutexLocker locker(&m_mutex);
+    QJsonArray jobs;
+    const auto append = [&jobs](const Job& job) {
+        jobs.append(QJsonObject{
+            { QStringLiteral("id"), job.id },
+            { QStringLiteral("path"), job.path },
+            { QStringLiteral("priority"), job.priority },
+            { QStringLiteral("state"), stateName(job.state) },
+            { QStringLiteral("records"), job.recordCount },
+            { QStringLiteral("sent"), job.recordsSent.load() },
+            { QStringLiteral("skipped"), job.skipped },
+            { QStringLiteral("skip_reason"), job.skipReason },
+            });
+    };
+    if (m_current) {
+        append(*m_current);
+    }
+    for (const auto& job : m_queue) {
+        append(*job);
+    }
+    return jobs;
+}
+
+int JobScheduler::queued() const {
+    QMutexLocker locker(&m_mutex);
+    return static_cast<int>(m_queue.size());
+}
+
+int JobScheduler::finished() const {
+    QMutexLocker locker(&m_mutex);
+    return m_finished;
+}
+
+int JobScheduler::aborted() const {
+    QMutexLocker locker(&m_mutex);
+    return m_aborted;
+}
+
+int JobScheduler::failed() const {
+    QMutexLocker locker(&m_mutex);
+    return m_failed;
+}
+
+QString JobScheduler::lastError() const {
+    QMutexLocker locker(&m_mutex);
+    return m_lastError;
+}
+
+void JobScheduler::prepare() {
+    trace::setThreadName(QStringLiteral("JobPreparer"));
+    JobCompiler compiler;
+    QMutexLocker locker(&m_mutex);
+    while (!m_stopRequested) {
+        if (m_queue.empty() || m_queue.front()->state != State::Queued) {
+            m_wake.wait(&m_mutex);
+            continue;
+        }
+        const std::shared_ptr<Job> job = m_queue.front();
+        job->state = State::Preparing;
+        locker.unlock();
+        QString error;
+        int skipped = 0;
+        QString skipReason;
+        bool loaded = false;
+        {
+            trace::Scope scope("daemon", "prepare job");
+            loaded = load(*job, compiler, skipped, skipReason, error);
+        }
+        locker.relock();
+        job->skipped = skipped;
+        job->skipReason = skipReason;
+        // A job cancelled meanwhile is simply no longer in the queue.
+        if (loaded) {
+            job->records = job->compiled.empty() ? job->file->segments() : job->compiled.data();
+            job->recordCount = job->compiled.empty() ? job->file->segmentCount() : static_cast<qint64>(job->compiled.size());
+            job->state = State::Ready;
+            continue;
+        }
+        const auto position = std::find(m_queue.begin(), m_queue.end(), job);
+        if (position == m_queue.end()) {
+            continue;
+        }
+        m_queue.erase(position);
+        ++m_failed;
+        m_lastError = error;
+        qWarning() << "Job dropped:" << error;
+    }
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <QJsonArray>
+#include <QMutex>
+#include <QString>
+#include <QWaitCondition>
+
+#include "Processing/JobFile.h"
+
+// Job queue of the streaming daemon. Jobs stream highest priority first, in submission order
+// among equals. While one job streams, a preparation thread readies the next one: a job file
+// without frame records is compiled here, one with records has its mapping paged in. The feeder
+// then moves from the end of one job straight into the next instead of waiting on the disk or
+// the generators.
+class JobScheduler {
+public:
+    enum class State {
+        Queued,
+        Preparing,
+        Ready,
+        Streaming,
+    };
+
+    struct Job {
+        int id{ 0 };
+        QString path;
+        int priority{ 0 };
+        State state{ State::Queued };
+        std::unique_ptr<JobFile> file;
+        // Filled by the preparation thread when the file had no frame records of its own.
+        std::vector<jobfile::FrameRecord> compiled;
+        // Shapes of such a file the local generators could not reproduce, and why the first was.
+        int skipped{ 0 };
+        QString skipReason;
+        // Points into the mapping or into compiled once the job is Ready.
+        const jobfile::FrameRecord* records{};
+        qint64 recordCount{ 0 };
+        std::atomic<qint64> recordsSent{ 0 };
+    };
+
+    JobScheduler();
+    ~JobScheduler();
+
+    JobScheduler(const JobScheduler&) = delete;
+    JobScheduler& operator=(const JobScheduler&) = delete;
+
+    // Maps the job file and queues it behind every job of the same or higher priority; the job
+    // id, or 0 with error set.
+    int submit(const QString& path, int priority, QString& error);
+    // Removes a job that has not started streaming.
+    bool cancel(int id);
+    // Removes every job that has not started streaming; returns how many there were.
+    int clear();
+
+    // Feeder side: the first job in line once it is Ready, which then becomes the current job;
+    // nullptr while there is none or it is still being prepared.
+    std::shared_ptr<Job> takeNext();
+    // Feeder side: the current job is done, streamed to the end or aborted.
+    void finish(bool aborted);
+
+    // Current job first, then the queue in streaming order.
+    QJsonArray describe() const;
+    int queued() const;
+    int finished() const;
+    int aborted() const;
+    int failed() const;
+    // Why the last job that could not be prepared was dropped.
+    QString lastError() const;
+
+private:
+    // Preparation thread: readies the first job in line whenever it is still Queued.
+    void prepare();
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_wake;
+    // Kept in streaming order.
+    std::vector<std::shared_ptr<Job>> m_queue;
+    std::shared_ptr<Job> m_current;
+    int m_nextId{ 1 };
+    int m_finished{ 0 };
+    int m_aborted{ 0 };
+    int m_failed{ 0 };
+    QString m_lastError;
+    bool m_stopRequested{ false };
+    std::thread m_preparer;
+};
@@ -0,0 +1,451 @@
+#include "StreamDaemon.h"
+
+#include <cstdio>
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QThread>
+#include <QTimer>
+#include <QtDebug>
+
+#include "Processing/DataBuffer.h"
+#include "Processing/TcpSocketWorker.h"
+#include "metrics/Trace.h"
+
+namespace {
+    // A request is one short JSON line; anything longer is not a client of ours.
+    constexpr qint64 MAX_REQUEST_BYTES = 64 * 1024;
+    constexpr int IDLE_SLEEP_MS = 1;
+    constexpr int REQUEST_TIMEOUT_MS = 5000;
+
+    QJsonObject failure(const QString& message) {
+        return QJsonObject{
+            { QStringLiteral("ok"), false },
+            { QStringLiteral("error"), message },
+        };
+    }
+}
+
+StreamDaemon::StreamDaemon(const Options& options, QObject* parent)
+    : QObject(parent)
+    , m_options(options)
+    , m_ring(streamdaemon::ringKey(options.name)) {
+    if (!m_options.streamHost.isEmpty()) {
+        m_buffer = std::make_unique<DataBuffer>();
+        m_streamer = std::make_unique<TcpSocketWorker>(m_options.streamHost, m_options.streamPort, *m_buffer);
+        m_buffer->setStreamer(m_streamer.get());
+    }
+}
+
+StreamDaemon::~StreamDaemon() {
+    m_stopRequested.store(true);
+    if (m_feeder.joinable()) {
+        m_feeder.join();
+    }
+    streamer().stop();
+    streamer().wait();
+}
+
+bool StreamDaemon::start(QString& error) {
+    // A live daemon answers on the name; a dead one only leaves its socket file behind.
+    QLocalSocket probe;
+    probe.connectToServer(m_options.name);
+    if (probe.waitForConnected(200)) {
+        error = QStringLiteral("a streaming daemon is already running as %1").arg(m_options.name);
+        return false;
+    }
+    if (!m_ring.create(qMax(2, m_options.slots), DataBuffer::frameSize(), error)) {
+        return false;
+    }
+    if (m_options.realtime.enabled) {
+        streamer().setRealtime(m_options.realtime);
+        if (!buffer().setRealtimeMemory(true, error)) {
+            qWarning() << "Real-time mode:" << error;
+            error.clear();
+        }
+        qInfo() << "Frame memory:" << buffer().memoryStatus();
+    }
+
+    QLocalServer::removeServer(m_options.name);
+    m_server = new QLocalServer(this);
+    m_server->setSocketOptions(QLocalServer::UserAccessOption);
+    connect(m_server, &QLocalServer::newConnection, this, &StreamDaemon::onNewConnection);
+    if (!m_server->listen(m_options.name)) {
+        error = QStringLiteral("cannot listen as %1: %2").arg(m_options.name, m_server->errorString());
+        return false;
+    }
+    m_feeder = std::thread([this]() { feed(); });
+    qInfo() << "Streaming daemon listening as" << m_server->fullServerName() << "with" << m_ring.slotCount()
+            << "frame slots";
+    return true;
+}
+
+void StreamDaemon::onNewConnection() {
+    while (QLocalSocket* socket = m_server->nextPendingConnection()) {
+        connect(socket, &QLocalSocket::readyRead, this, [this, socket]() {
+            onReadyRead(socket);
+            });
+        connect(socket, &QLocalSocket::disconnected, this, [this, socket]() {
+            if (m_writer == socket) {
+                // The ring and everything already in it stay; the next writer carries on from here.
+                m_writer = nullptr;
+                qInfo() << "Frame ring writer disconnected," << m_ring.pending() << "frames still queued";
+            }
+            socket->deleteLater();
+            });
+    }
+}
+
+void StreamDaemon::onReadyRead(QLocalSocket* socket) {
+    while (socket->canReadLine()) {
+        const QJsonObject request = QJsonDocument::fromJson(socket->readLine()).object();
+        socket->write(streamdaemon::encode(handle(socket, request)));
+    }
+    if (socket->bytesAvailable() > MAX_REQUEST_BYTES) {
+        socket->abort();
+    }
+}
+
+QJsonObject StreamDaemon::handle(QLocalSocket* socket, const QJsonObject& request) {
+    const QString command = request.value(QStringLiteral("cmd")).toString();
+    if (command == QStringLiteral("attach")) {
+        if (m_writer && m_writer != socket) {
+            return failure(QStringLiteral("another process is writing frames to this daemon"));
+        }
+        m_writer = socket;
+        return QJsonObject{
+            { QStringLiteral("ok"), true },
+            { QStringLiteral("shm"), streamdaemon::ringKey(m_options.name) },
+            { QStringLiteral("slots"), m_ring.slotCount() },
+            { QStringLiteral("frame_size"), m_ring.frameSize() },
+        };
+    }
+    if (command == QStringLiteral("status")) {
+        return status();
+    }
+    if (command == QStringLiteral("submit")) {
+        const QString path = request.value(QStringLiteral("path")).toString();
+        const int priority = request.value(QStringLiteral("priority")).toInt();
+        QString error;
+        const int id = m_scheduler.submit(path, priority, error);
+        if (id == 0) {
+            return failure(error);
+        }
+        qInfo() << "Job" << id << "queued at priority" << priority << ":" << path;
+        return QJsonObject{
+            { QStringLiteral("ok"), true },
+            { QStringLiteral("id"), id },
+            { QStringLiteral("queued"), m_scheduler.queued() },
+        };
+    }
+    if (command == QStringLiteral("cancel")) {
+        const int id = request.value(QStringLiteral("id")).toInt();
+        if (!m_scheduler.cancel(id)) {
+            return failure(QStringLiteral("job %1 is not queued; abort stops the one streaming").arg(id));
+        }
+        qInfo() << "Job" << id << "cancelled";
+        return QJsonObject{ { QStringLiteral("ok"), true } };
+    }
+    if (command == QStringLiteral("pause")) {
+        if (m_paused.exchange(true)) {
+            return QJsonObject{ { QStringLiteral("ok"), true } };
+        }
+        return interruptStream(false);
+    }
+    if (command == QStringLiteral("resume")) {
+        // Resume records only belong where the stream was cut; a running stream has none.
+        if (!m_paused.load()) {
+            return QJsonObject{ { QStringLiteral("ok"), true } };
+        }
+        m_resumeRequested.store(true);
+        qInfo() << "Streaming resumed";
+        return QJsonObject{ { QStringLiteral("ok"), true } };
+    }
+    if (command == QStringLiteral("abort")) {
+        const int cleared = request.value(QStringLiteral("all")).toBool() ? m_scheduler.clear() : 0;
+        QJsonObject reply = interruptStream(true);
+        reply.insert(QStringLiteral("cleared"), cleared);
+        return reply;
+    }
+    if (command == QStringLiteral("shutdown")) {
+        QTimer::singleShot(0, qApp, &QCoreApplication::quit);
+        return QJsonObject{ { QStringLiteral("ok"), true } };
+    }
+    return failure(QStringLiteral("unknown command '%1'").arg(command));
+}
+
+QJsonObject StreamDaemon::status() const {
+    TcpSocketWorker& worker = streamer();
+    QJsonObject reply{
+        { QStringLiteral("ok"), true },
+        { QStringLiteral("connected"), worker.isConnected() },
+        { QStringLiteral("frames_written"), worker.framesWritten() },
+        { QStringLiteral("bytes_written"), worker.bytesWritten() },
+        { QStringLiteral("reconnects"), worker.reconnects() },
+        { QStringLiteral("ring_pending"), m_ring.pending() },
+        { QStringLiteral("buffer_pending"), buffer().pendingFrames() },
+        { QStringLiteral("ring_frames"), m_ringFrames.load() },
+        { QStringLiteral("writer"), m_writer != nullptr },
+        { QStringLiteral("realtime"), worker.realtimeStatus() },
+        { QStringLiteral("paused"), m_paused.load() },
+        { QStringLiteral("held"), worker.isHeld() },
+        { QStringLiteral("frames_aborted"), m_framesAborted.load() },
+        { QStringLiteral("jobs"), m_scheduler.describe() },
+        { QStringLiteral("jobs_queued"), m_scheduler.queued() },
+        { QStringLiteral("jobs_finished"), m_scheduler.finished() },
+        { QStringLiteral("jobs_aborted"), m_scheduler.aborted() },
+        { QStringLiteral("jobs_failed"), m_scheduler.failed() },
+    };
+    if (m_scheduler.failed() > 0) {
+        reply.insert(QStringLiteral("last_error"), m_scheduler.lastError());
+    }
+    QMutexLocker locker(&m_interruptionMutex);
+    reply.insert(QStringLiteral("last_park_ms"), m_interruption.parkMs);
+    return reply;
+}
+
+QJsonObject StreamDaemon::interruptStream(bool abort) {
+    // Blocks for at most one write chunk, while the feeder's writes meanwhile are discarded.
+    const TcpSocketWorker::Interruption interruption = streamer().interrupt();
+    {
+        QMutexLocker locker(&m_interruptionMutex);
+        const int dropped = m_interrupted.load() ? m_interruption.framesDropped : 0;
+        m_interruption = interruption;
+        m_interruption.framesDropped += dropped;
+    }
+    if (abort) {
+        m_abortRequested.store(true);
+    }
+    m_interrupted.store(true);
+    qInfo() << (abort ? "Streaming aborted:" : "Streaming paused:") << (interruption.cut ? "frame cut," : "no frame on the wire,")
+            << interruption.framesDropped << "queued frames dropped, park records out after" << interruption.parkMs << "ms";
+    return QJsonObject{
+        { QStringLiteral("ok"), true },
+        { QStringLiteral("cut"), interruption.cut },
+        { QStringLiteral("frames_dropped"), interruption.framesDropped },
+        { QStringLiteral("park_ms"), interruption.parkMs },
+        { QStringLiteral("resume"), interruption.resumePosition },
+    };
+}
+
+void StreamDaemon::feed() {
+    trace::setThreadName(QStringLiteral("StreamDaemonFeeder"));
+    DataBuffer& frames = buffer();
+    constexpr qint64 recordSize = sizeof(jobfile::FrameRecord);
+    const qint64 recordsPerFrame = DataBuffer::frameSize() / recordSize;
+    std::shared_ptr<JobScheduler::Job> job;
+    while (!m_stopRequested.load()) {
+        if (m_interrupted.exchange(false)) {
+            settleInterruption(job);
+        }
+        if (m_abortRequested.exchange(false)) {
+            abortStreaming(job);
+        }
+        if (m_resumeRequested.exchange(false)) {
+            resumeStreaming(job);
+        }
+        // Keep at most one frame queued behind the one on the wire, so addRecords waits for at most
+        // that frame.
+        if (m_paused.load() || frames.pendingFrames() > 0) {
+            QThread::msleep(IDLE_SLEEP_MS);
+            continue;
+        }
+        if (job && job->recordsSent.load() >= job->recordCount) {
+            // The job stays current until its last frame is off the queue, so an interruption
+            // during that frame still rewinds it instead of losing its tail.
+            if (!frames.allFramesSent()) {
+                QThread::msleep(IDLE_SLEEP_MS);
+                continue;
+            }
+            qInfo() << "Job" << job->id << "streamed:" << job->path;
+            frames.setSource(0, 0);
+            job.reset();
+            m_scheduler.finish(false);
+        }
+        if (!job) {
+            job = m_scheduler.takeNext();
+            if (job) {
+                const auto& settings = job->file->settings();
+                if (settings.freq > 0) {
+                    frames.setFreqData(settings.freq);
+                }
+                if (settings.power > 0.0) {
+                    frames.setPowerData(settings.power);
+                }
+                frames.setSource(job->id, 0);
+            }
+        }
+        if (job) {
+            trace::Scope scope("daemon", "job frame");
+            const qint64 sent = job->recordsSent.load();
+            const qint64 count = qMin(recordsPerFrame, job->recordCount - sent);
+            frames.addRecords(reinterpret_cast<const char*>(job->records + sent), count);
+            job->recordsSent.store(sent + count);
+            if (sent + count >= job->recordCount) {
+                frames.forceFill();
+            }
+            continue;
+        }
+        if (const char* slot = m_ring.readSlot()) {
+            trace::Scope scope("daemon", "ring frame");
+            frames.addRecords(slot, recordsPerFrame);
+            m_ring.release();
+            ++m_ringFrames;
+            continue;
+        }
+        QThread::msleep(IDLE_SLEEP_MS);
+    }
+}
+
+void StreamDaemon::settleInterruption(const std::shared_ptr<JobScheduler::Job>& job) {
+    DataBuffer& frames = buffer();
+    TcpSocketWorker::Interruption interruption;
+    {
+        QMutexLocker locker(&m_interruptionMutex);
+        interruption = m_interruption;
+    }
+    const int dropped = interruption.framesDropped + frames.discardQueued();
+    // Frames dropped for a pause are generated again on resume.
+    if (m_abortRequested.load()) {
+        m_framesAborted += dropped;
+    }
+    if (job && interruption.sourceId == job->id && interruption.resumePosition >= 0) {
+        const qint64 resume = qMin(interruption.resumePosition, job->recordCount);
+        job->recordsSent.store(resume);
+        frames.setSource(job->id, resume);
+    }
+}
+
+void StreamDaemon::abortStreaming(std::shared_ptr<JobScheduler::Job>& job) {
+    // The streamer has already ended the frame on the wire with the park records.
+    const qint64 dropped = m_ring.discard();
+    m_framesAborted += dropped;
+    if (job) {
+        qInfo() << "Job" << job->id << "aborted after" << job->recordsSent.load() << "of" << job->recordCount << "records";
+        buffer().setSource(0, 0);
+        job.reset();
+        m_scheduler.finish(true);
+    }
+    // A paused stream stays paused; nothing is fed until it is resumed.
+    streamer().resumeStream();
+    qInfo() << "Streaming aborted," << dropped << "ring frames dropped";
+}
+
+void StreamDaemon::resumeStreaming(const std::shared_ptr<JobScheduler::Job>& job) {
+    DataBuffer& frames = buffer();
+    const qint64 sent = job ? job->recordsSent.load() : 0;
+    if (job && sent > 0 && sent < job->recordCount) {
+        // The frame carrying the job's settings may have been among those dropped, and
+        // discardQueued() forgot what the controller last got.
+        const auto& settings = job->file->settings();
+        if (settings.freq > 0) {
+            frames.setFreqData(settings.freq);
+        }
+        if (settings.power > 0.0) {
+            frames.setPowerData(settings.power);
+        }
+        frames.setSource(job->id, sent);
+        frames.addResumeRecords(reinterpret_cast<const char*>(job->records + sent));
+        qInfo() << "Job" << job->id << "resumes at record" << sent << "of" << job->recordCount;
+    }
+    streamer().resumeStream();
+    m_paused.store(false);
+}
+
+DataBuffer& StreamDaemon::buffer() const {
+    return m_buffer ? *m_buffer : DataBuffer::instance();
+}
+
+TcpSocketWorker& StreamDaemon::streamer() const {
+    return m_streamer ? *m_streamer : TcpSocketWorker::instance();
+}
+
+int runStreamDaemon(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("FiveAxisQt6"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Stream frames to the controller on behalf of the GUI."));
+    parser.addHelpOption();
+    const QCommandLineOption daemonOption(QStringLiteral("stream-daemon"), QStringLiteral("Run the streaming daemon."));
+    const QCommandLineOption nameOption(QStringLiteral("name"), QStringLiteral("Local socket and frame ring name."),
+        QStringLiteral("name"), QString::fromLatin1(streamdaemon::DEFAULT_NAME));
+    const QCommandLineOption streamHostOption(QStringLiteral("stream-host"),
+        QStringLiteral("Frame stream target (default: built-in controller address)."), QStringLiteral("ip"));
+    const QCommandLineOption streamPortOption(QStringLiteral("stream-port"), QStringLiteral("Frame stream port."),
+        QStringLiteral("port"), QStringLiteral("7"));
+    const QCommandLineOption slotsOption(QStringLiteral("slots"), QStringLiteral("Frames the shared ring holds."),
+        QStringLiteral("n"), QString::number(streamdaemon::DEFAULT_SLOTS));
+    const QCommandLineOption realtimeOption(QStringLiteral("realtime"),
+        QStringLiteral("Lock the frames in memory and stream under SCHED_FIFO."));
+    const QCommandLineOption realtimeCpuOption(QStringLiteral("realtime-cpu"),
+        QStringLiteral("Pin the streaming thread to this core."), QStringLiteral("n"));
+    const QCommandLineOption realtimePriorityOption(QStringLiteral("realtime-priority"),
+        QStringLiteral("SCHED_FIFO priority of the streaming thread."), QStringLiteral("1-99"), QStringLiteral("80"));
+    parser.addOptions({ daemonOption, nameOption, streamHostOption, streamPortOption, slotsOption, realtimeOption,
+        realtimeCpuOption, realtimePriorityOption });
+    parser.process(app);
+
+    StreamDaemon::Options options;
+    options.name = parser.value(nameOption);
+    options.streamHost = parser.value(streamHostOption);
+    options.streamPort = static_cast<quint16>(parser.value(streamPortOption).toUInt());
+    options.slots = parser.value(slotsOption).toInt();
+    options.realtime.enabled = parser.isSet(realtimeOption);
+    options.realtime.cpu = parser.isSet(realtimeCpuOption) ? parser.value(realtimeCpuOption).toInt() : -1;
+    options.realtime.priority = parser.value(realtimePriorityOption).toInt();
+
+    StreamDaemon daemon(options);
+    QString error;
+    if (!daemon.start(error)) {
+        std::fprintf(stderr, "%s\n", qPrintable(error));
+        return 2;
+    }
+    return app.exec();
+}
+
+int runDaemonRequest(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("FiveAxisQt6"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Send one request to the streaming daemon and print its reply."));
+    parser.addHelpOption();
+    const QCommandLineOption requestOption(QStringLiteral("daemon-request"),
+        QStringLiteral("Request as a JSON object, e.g. {\"cmd\":\"status\"}; see DaemonProtocol.h."), QStringLiteral("json"));
+    const QCommandLineOption nameOption(QStringLiteral("name"), QStringLiteral("Local socket name of the daemon."),
+        QStringLiteral("name"), QString::fromLatin1(streamdaemon::DEFAULT_NAME));
+    parser.addOptions({ requestOption, nameOption });
+    parser.process(app);
+
+    QJsonObject request = QJsonDocument::fromJson(parser.value(requestOption).toUtf8()).object();
+    if (!request.contains(QStringLiteral("cmd"))) {
+        std::fprintf(stderr, "--daemon-request needs a JSON object with a \"cmd\"\n");
+        return 2;
+    }
+    // The daemon opens job files from its own working directory.
+    if (request.contains(QStringLiteral("path"))) {
+        request.insert(QStringLiteral("path"), QFileInfo(request.value(QStringLiteral("path")).toString()).absoluteFilePath());
+    }
+
+    QLocalSocket socket;
+    socket.connectToServer(parser.value(nameOption));
+    if (!socket.waitForConnected(REQUEST_TIMEOUT_MS)) {
+        std::fprintf(stderr, "cannot reach streaming daemon %s: %s\n", qPrintable(parser.value(nameOption)),
+            qPrintable(socket.errorString()));
+        return 2;
+    }
+    socket.write(streamdaemon::encode(request));
+    while (!socket.canReadLine()) {
+        if (!socket.waitForReadyRead(REQUEST_TIMEOUT_MS)) {
+            std::fprintf(stderr, "no reply from the streaming daemon: %s\n", qPrintable(socket.errorString()));
+            return 2;
+        }
+    }
+    const QByteArray reply = socket.readLine();
+    std::fwrite(reply.constData(), 1, static_cast<size_t>(reply.size()), stdout);
+    return QJsonDocument::fromJson(reply).object().value(QStringLiteral("ok")).toBool() ? 0 : 1;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include <QJsonObject>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+
+#include "DaemonProtocol.h"
+#include "JobScheduler.h"
+#include "Processing/RealtimeMode.h"
+#include "Processing/ShmFrameRing.h"
+#include "Processing/TcpSocketWorker.h"
+
+class DataBuffer;
+class QLocalServer;
+class QLocalSocket;
+
+// Streaming process that owns the frame queue and the controller connection, so a GUI stall,
+// crash or restart does not take a running job down with it:
+//   FiveAxisQt6 --stream-daemon [--name fiveaxis-stream] [--stream-host ip] [--stream-port n]
+//               [--slots n] [--realtime [--realtime-cpu n] [--realtime-priority n]]
+// Frames come in through a ShmFrameRing written by the GUI, or from .faxj jobs that are submitted
+// by path, queued by priority in a JobScheduler and read by the daemon itself. Control runs over a
+// local socket named after --name, from the GUI or from scripts; see DaemonProtocol.h.
+class StreamDaemon : public QObject {
+    Q_OBJECT
+public:
+    struct Options {
+        QString name{ QString::fromLatin1(streamdaemon::DEFAULT_NAME) };
+        QString streamHost;
+        quint16 streamPort{ 7 };
+        int slots{ streamdaemon::DEFAULT_SLOTS };
+        RealtimeOptions realtime;
+    };
+
+    explicit StreamDaemon(const Options& options, QObject* parent = nullptr);
+    ~StreamDaemon() override;
+
+    // Creates the ring, starts feeding and listens; fails if another daemon has the name.
+    bool start(QString& error);
+
+private:
+    void onNewConnection();
+    void onReadyRead(QLocalSocket* socket);
+    QJsonObject handle(QLocalSocket* socket, const QJsonObject& request);
+    QJsonObject status() const;
+    // Cuts the stream over to the park records for a pause or abort; the feeder settles the rest.
+    QJsonObject interruptStream(bool abort);
+    // Feeder thread: submitted jobs first, then ring frames, one frame at a time.
+    void feed();
+    // Feeder side of an interruption: drops its own discarded writes and rewinds the current job
+    // to the first record the controller did not get.
+    void settleInterruption(const std::shared_ptr<JobScheduler::Job>& job);
+    // Feeder side of an abort: drops the current job and every frame not yet on the wire.
+    void abortStreaming(std::shared_ptr<JobScheduler::Job>& job);
+    // Feeder side of a resume: re-enters the current job where it was cut and releases the stream.
+    void resumeStreaming(const std::shared_ptr<JobScheduler::Job>& job);
+    DataBuffer& buffer() const;
+    TcpSocketWorker& streamer() const;
+
+    Options m_options;
+    ShmFrameRing m_ring;
+    std::unique_ptr<DataBuffer> m_buffer;
+    std::unique_ptr<TcpSocketWorker> m_streamer;
+    QLocalServer* m_server{};
+    // The connection that attached as the ring's writer, if any.
+    QLocalSocket* m_writer{};
+    std::thread m_feeder;
+    std::atomic<bool> m_stopRequested{ false };
+    std::atomic<qint64> m_ringFrames{ 0 };
+    std::atomic<bool> m_paused{ false };
+    std::atomic<bool> m_interrupted{ false };
+    std::atomic<bool> m_abortRequested{ false };
+    std::atomic<bool> m_resumeRequested{ false };
+    std::atomic<qint64> m_framesAborted{ 0 };
+    // Last interruption, for the feeder to settle and for status.
+    mutable QMutex m_interruptionMutex;
+    TcpSocketWorker::Interruption m_interruption;
+    JobScheduler m_scheduler;
+};
+
+int runStreamDaemon(int argc, char* argv[]);
+// One request to a running daemon, for scripts: prints the reply line, exits 0 if it was ok.
+//   FiveAxisQt6 --daemon-request '{"cmd":"submit","path":"part.faxj","priority":5}' [--name n]
+int runDaemonRequest(int argc, char* argv[]);
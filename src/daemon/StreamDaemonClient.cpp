@@ -0,0 +1,184 @@
+#include "StreamDaemonClient.h"
+
+#include <QJsonDocument>
+#include <QLocalSocket>
+
+#include "DaemonProtocol.h"
+#include "Processing/DataBuffer.h"
+#include "Processing/RingFrameSender.h"
+#include "Processing/ShmFrameRing.h"
+#include "Processing/TcpSocketWorker.h"
+
+namespace {
+    constexpr int CONNECT_TIMEOUT_MS = 1000;
+    constexpr int REPLY_TIMEOUT_MS = 2000;
+    constexpr int STATUS_INTERVAL_MS = 1000;
+}
+
+StreamDaemonClient::StreamDaemonClient(DataBuffer& buffer, FrameTap* tap, QObject* parent)
+    : QObject(parent)
+    , m_buffer(buffer)
+    , m_tap(tap)
+    , m_statusTimer(this) {
+    connect(&m_statusTimer, &QTimer::timeout, this, [this]() {
+        send(QJsonObject{ { QStringLiteral("cmd"), QStringLiteral("status") } });
+        });
+}
+
+StreamDaemonClient::~StreamDaemonClient() {
+    disconnectFromDaemon();
+}
+
+bool StreamDaemonClient::connectToDaemon(const QString& name, QString& error) {
+    if (isConnected()) {
+        return true;
+    }
+    if (!m_buffer.allFramesSent()) {
+        error = QStringLiteral("frames are still being streamed; switch to the daemon between jobs");
+        return false;
+    }
+    auto* socket = new QLocalSocket(this);
+    socket->connectToServer(name);
+    if (!socket->waitForConnected(CONNECT_TIMEOUT_MS)) {
+        error = QStringLiteral("cannot reach streaming daemon %1: %2").arg(name, socket->errorString());
+        delete socket;
+        return false;
+    }
+    // Answered synchronously: the ring has to be attached before the first frame is routed to it.
+    socket->write(streamdaemon::encode(QJsonObject{ { QStringLiteral("cmd"), QStringLiteral("attach") } }));
+    while (!socket->canReadLine()) {
+        if (!socket->waitForReadyRead(REPLY_TIMEOUT_MS)) {
+            error = QStringLiteral("streaming daemon %1 did not answer: %2").arg(name, socket->errorString());
+            delete socket;
+            return false;
+        }
+    }
+    const QJsonObject reply = QJsonDocument::fromJson(socket->readLine()).object();
+    if (!reply.value(QStringLiteral("ok")).toBool()) {
+        error = reply.value(QStringLiteral("error")).toString();
+        delete socket;
+        return false;
+    }
+    auto ring = std::make_unique<ShmFrameRing>(reply.value(QStringLiteral("shm")).toString());
+    if (!ring->attach(DataBuffer::frameSize(), error)) {
+        delete socket;
+        return false;
+    }
+
+    m_socket = socket;
+    m_ring = std::move(ring);
+    m_sender = std::make_unique<RingFrameSender>(*m_ring, m_buffer, m_tap);
+    m_buffer.setStreamer(m_sender.get());
+    // The in-process worker may still be polling for frames; it must not take the next one.
+    TcpSocketWorker::instance().stop();
+    TcpSocketWorker::instance().wait();
+
+    connect(m_socket, &QLocalSocket::readyRead, this, &StreamDaemonClient::onReadyRead);
+    connect(m_socket, &QLocalSocket::disconnected, this, &StreamDaemonClient::onDisconnected);
+    m_statusTimer.start(STATUS_INTERVAL_MS);
+    return true;
+}
+
+void StreamDaemonClient::disconnectFromDaemon() {
+    if (!m_socket) {
+        return;
+    }
+    QLocalSocket* socket = m_socket;
+    release();
+    socket->disconnect(this);
+    socket->disconnectFromServer();
+    socket->deleteLater();
+}
+
+bool StreamDaemonClient::isConnected() const {
+    return m_socket != nullptr;
+}
+
+void StreamDaemonClient::submitJob(const QString& path, int priority) {
+    send(QJsonObject{
+        { QStringLiteral("cmd"), QStringLiteral("submit") },
+        { QStringLiteral("path"), path },
+        { QStringLiteral("priority"), priority },
+        });
+}
+
+void StreamDaemonClient::cancelJob(int id) {
+    send(QJsonObject{
+        { QStringLiteral("cmd"), QStringLiteral("cancel") },
+        { QStringLiteral("id"), id },
+        });
+}
+
+void StreamDaemonClient::pause() {
+    send(QJsonObject{ { QStringLiteral("cmd"), QStringLiteral("pause") } });
+}
+
+void StreamDaemonClient::resume() {
+    send(QJsonObject{ { QStringLiteral("cmd"), QStringLiteral("resume") } });
+}
+
+void StreamDaemonClient::abort(bool clearQueue) {
+    send(QJsonObject{
+        { QStringLiteral("cmd"), QStringLiteral("abort") },
+        { QStringLiteral("all"), clearQueue },
+        });
+}
+
+void StreamDaemonClient::send(const QJsonObject& request) {
+    if (!m_socket) {
+        fail(request, QStringLiteral("not connected to a streaming daemon"));
+        return;
+    }
+    m_requests.enqueue(request);
+    m_socket->write(streamdaemon::encode(request));
+}
+
+void StreamDaemonClient::onReadyRead() {
+    while (m_socket && m_socket->canReadLine()) {
+        const QJsonObject reply = QJsonDocument::fromJson(m_socket->readLine()).object();
+        const QJsonObject request = m_requests.isEmpty() ? QJsonObject() : m_requests.dequeue();
+        const QString command = request.value(QStringLiteral("cmd")).toString();
+        if (!reply.value(QStringLiteral("ok")).toBool()) {
+            fail(request, reply.value(QStringLiteral("error")).toString());
+        }
+        else if (command == QStringLiteral("status")) {
+            emit statusReceived(reply);
+        }
+        else if (command == QStringLiteral("submit")) {
+            emit jobSubmitted(request.value(QStringLiteral("path")).toString(), reply.value(QStringLiteral("queued")).toInt());
+        }
+        else if (command == QStringLiteral("pause") || command == QStringLiteral("abort")) {
+            emit streamInterrupted(command, reply);
+        }
+    }
+}
+
+void StreamDaemonClient::fail(const QJsonObject& request, const QString& message) {
+    const QString command = request.value(QStringLiteral("cmd")).toString();
+    if (command == QStringLiteral("submit")) {
+        emit jobRejected(request.value(QStringLiteral("path")).toString(), message);
+        return;
+    }
+    emit requestFailed(command, message);
+}
+
+void StreamDaemonClient::onDisconnected() {
+    QLocalSocket* socket = m_socket;
+    const qint64 lost = m_ring ? m_ring->pending() : 0;
+    release();
+    socket->deleteLater();
+    emit daemonLost(m_buffer.pendingFrames(), lost);
+}
+
+void StreamDaemonClient::release() {
+    m_statusTimer.stop();
+    m_requests.clear();
+    m_socket = nullptr;
+    // Joined before the buffer forgets it, and the buffer forgets it before it is destroyed.
+    if (m_sender) {
+        m_sender->stop();
+    }
+    m_buffer.setStreamer(nullptr);
+    m_sender.reset();
+    m_ring.reset();
+}
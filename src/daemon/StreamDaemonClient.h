@@ -0,0 +1,69 @@
+#pragma once
+
+#include <memory>
+
+#include <QJsonObject>
+#include <QObject>
+#include <QQueue>
+#include <QString>
+#include <QTimer>
+
+class DataBuffer;
+class FrameTap;
+class QLocalSocket;
+class RingFrameSender;
+class ShmFrameRing;
+
+// GUI end of the streaming daemon. While connected, the DataBuffer's frames go into the daemon's
+// shared-memory ring instead of the in-process TcpSocketWorker, compiled jobs can be handed over
+// whole, and the daemon's status is polled once a second.
+class StreamDaemonClient : public QObject {
+    Q_OBJECT
+public:
+    // tap keeps receiving every frame sent, for the live toolpath.
+    explicit StreamDaemonClient(DataBuffer& buffer, FrameTap* tap = nullptr, QObject* parent = nullptr);
+    ~StreamDaemonClient() override;
+
+    // Attaches to the daemon's frame ring and takes over from TcpSocketWorker::instance(). Only
+    // between jobs, while no frame is queued.
+    bool connectToDaemon(const QString& name, QString& error);
+    // Hands streaming back to the in-process worker; the daemon still sends what it already has.
+    void disconnectFromDaemon();
+    bool isConnected() const;
+
+    // Queues a .faxj job, higher priority first; the daemon maps it before answering, so the file
+    // may be removed once jobSubmitted or jobRejected arrives.
+    void submitJob(const QString& path, int priority = 0);
+    // Jobs not yet streaming can be cancelled; abort stops the one that is and drops its frames.
+    void cancelJob(int id);
+    void pause();
+    void resume();
+    void abort(bool clearQueue);
+
+signals:
+    void statusReceived(const QJsonObject& status);
+    void jobSubmitted(const QString& path, int queued);
+    void jobRejected(const QString& path, const QString& message);
+    void requestFailed(const QString& command, const QString& message);
+    // Reply to pause or abort: whether the frame on the wire was cut and how fast it was parked.
+    void streamInterrupted(const QString& command, const QJsonObject& reply);
+    // The daemon went away; frames still queued here go out from this process again, while the
+    // framesLost already published to its ring never reach the controller.
+    void daemonLost(int framesQueued, qint64 framesLost);
+
+private:
+    void send(const QJsonObject& request);
+    void fail(const QJsonObject& request, const QString& message);
+    void onReadyRead();
+    void onDisconnected();
+    void release();
+
+    DataBuffer& m_buffer;
+    FrameTap* m_tap;
+    QLocalSocket* m_socket{};
+    std::unique_ptr<ShmFrameRing> m_ring;
+    std::unique_ptr<RingFrameSender> m_sender;
+    QTimer m_statusTimer;
+    // Replies come back in request order; these are the requests still waiting for one.
+    QQueue<QJsonObject> m_requests;
+};
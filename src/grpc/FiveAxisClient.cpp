@@ -3,11 +3,35 @@
 #include <exception>
 #include <chrono>
 #include <QMetaType>
+#include <google/protobuf/util/message_differencer.h>
 #include <grpcpp/grpcpp.h>
 
+#include "metrics/Trace.h"
+
+namespace {
+    // Servers may report their own handling time so network and server time can be separated.
+    constexpr auto SERVER_TIME_KEY = "x-server-time-us";
+
+    qint64 serverTimeUs(const grpc::ClientContext& context) {
+        for (const auto* metadata : { &context.GetServerTrailingMetadata(), &context.GetServerInitialMetadata() }) {
+            const auto it = metadata->find(SERVER_TIME_KEY);
+            if (it != metadata->end()) {
+                bool ok = false;
+                const qint64 value = QByteArray(it->second.data(), static_cast<int>(it->second.size())).toLongLong(&ok);
+                if (ok) {
+                    return value;
+                }
+            }
+        }
+        return -1;
+    }
+}
+
 FiveAxisClient::FiveAxisClient(QObject* parent)
     : QObject(parent)
-    , m_worker(new FiveAxisWorker()) {
+    , m_stats(std::make_unique<RpcStats>())
+    , m_settings(std::make_unique<SettingsChannel>())
+    , m_worker(new FiveAxisWorker(m_stats.get(), m_settings.get())) {
     qRegisterMetaType<LineData>("LineData");
     qRegisterMetaType<RectangleData>("RectangleData");
     qRegisterMetaType<CircleData>("CircleData");
@@ -15,9 +39,14 @@ FiveAxisClient::FiveAxisClient(QObject* parent)
     qRegisterMetaType<DelayData>("DelayData");
     qRegisterMetaType<FreqData>("FreqData");
 
+    m_workerThread.setObjectName(QStringLiteral("FiveAxisWorker"));
     m_worker->moveToThread(&m_workerThread);
     connect(m_worker, &FiveAxisWorker::replyReceived, this, &FiveAxisClient::replyReceived);
     connect(m_worker, &FiveAxisWorker::errorReceived, this, &FiveAxisClient::errorReceived);
+    connect(m_worker, &FiveAxisWorker::slowRequest, this, &FiveAxisClient::slowRequest);
+    connect(m_worker, &FiveAxisWorker::settingsSkipped, this, &FiveAxisClient::settingsSkipped);
+    connect(m_worker, &FiveAxisWorker::sceneProgress, this, &FiveAxisClient::sceneProgress);
+    connect(m_worker, &FiveAxisWorker::sceneFinished, this, &FiveAxisClient::sceneFinished);
     m_workerThread.start();
 }
 
@@ -49,51 +78,89 @@ QString FiveAxisClient::channelStateString() const {
 }
 
 void FiveAxisClient::processLine(const LineData& request) {
+    m_settings->sealBatch();
     QMetaObject::invokeMethod(
         m_worker,
         "processLine",
         Qt::QueuedConnection,
-        Q_ARG(LineData, request));
+        Q_ARG(LineData, request),
+        Q_ARG(qint64, RpcStats::nowNs()));
 }
 
 void FiveAxisClient::processRectangle(const RectangleData& request) {
+    m_settings->sealBatch();
     QMetaObject::invokeMethod(
         m_worker,
         "processRectangle",
         Qt::QueuedConnection,
-        Q_ARG(RectangleData, request));
+        Q_ARG(RectangleData, request),
+        Q_ARG(qint64, RpcStats::nowNs()));
 }
 
 void FiveAxisClient::processCircle(const CircleData& request) {
+    m_settings->sealBatch();
     QMetaObject::invokeMethod(
         m_worker,
         "processCircle",
         Qt::QueuedConnection,
-        Q_ARG(CircleData, request));
+        Q_ARG(CircleData, request),
+        Q_ARG(qint64, RpcStats::nowNs()));
 }
 
 void FiveAxisClient::processEllipse(const EllipseData& request) {
+    m_settings->sealBatch();
     QMetaObject::invokeMethod(
         m_worker,
         "processEllipse",
         Qt::QueuedConnection,
-        Q_ARG(EllipseData, request));
+        Q_ARG(EllipseData, request),
+        Q_ARG(qint64, RpcStats::nowNs()));
 }
 
 void FiveAxisClient::setDelay(const DelayData& request) {
+    if (m_settings->offerDelay(request)) {
+        queueSettingsFlush();
+    }
+}
+
+void FiveAxisClient::setLaserFreq(const FreqData& request) {
+    if (m_settings->offerFreq(request)) {
+        queueSettingsFlush();
+    }
+}
+
+void FiveAxisClient::processScene(std::unique_ptr<SceneBatch> batch) {
+    m_settings->sealBatch();
+    // The arena-backed batch is moved into the queued call; the worker reads the messages
+    // in place and the whole arena is released when the call object is destroyed.
+    std::shared_ptr<const SceneBatch> owned(std::move(batch));
     QMetaObject::invokeMethod(
         m_worker,
-        "setDelay",
-        Qt::QueuedConnection,
-        Q_ARG(DelayData, request));
+        [worker = m_worker, owned, enqueuedNs = RpcStats::nowNs()]() {
+            worker->processScene(*owned, enqueuedNs);
+        },
+        Qt::QueuedConnection);
 }
 
-void FiveAxisClient::setLaserFreq(const FreqData& request) {
+void FiveAxisClient::queueSettingsFlush() {
     QMetaObject::invokeMethod(
         m_worker,
-        "setLaserFreq",
+        "flushSettings",
         Qt::QueuedConnection,
-        Q_ARG(FreqData, request));
+        Q_ARG(qint64, RpcStats::nowNs()));
+}
+
+RpcStats& FiveAxisClient::stats() const {
+    return *m_stats;
+}
+
+const SettingsChannel& FiveAxisClient::settings() const {
+    return *m_settings;
+}
+
+FiveAxisWorker::FiveAxisWorker(RpcStats* stats, SettingsChannel* settings)
+    : m_stats(stats)
+    , m_settings(settings) {
 }
 
 QString FiveAxisWorker::connectToServer(const QUrl& endpoint) {
@@ -107,6 +174,8 @@ QString FiveAxisWorker::connectToServer(const QUrl& endpoint) {
     const bool connected = m_channel->WaitForConnected(deadline);
     const grpc_connectivity_state finalState = m_channel->GetState(false);
     m_stub = FiveAxis::FiveAxis::NewStub(m_channel);
+    m_machineDelay.reset();
+    m_machineFreq.reset();
 
     return QStringLiteral("Endpoint: %1\n"
         " - Scheme: %2\n"
@@ -133,100 +202,172 @@ QString FiveAxisWorker::channelStateString() const {
     return describeState(m_channel->GetState(false));
 }
 
-void FiveAxisWorker::processLine(const LineData& request) {
+template <typename Request, typename Call>
+bool FiveAxisWorker::callTimed(const QString& operation, const Request& request, qint64 enqueuedNs, Call call,
+    bool emitSuccess) {
+    const qint64 startNs = RpcStats::nowNs();
     if (!m_stub) {
-        emitNotConnected(QStringLiteral("ProcessLine"));
-        return;
+        emitNotConnected(operation);
+        return false;
     }
+    trace::Scope scope("rpc", trace::isEnabled() ? trace::intern(operation) : "");
     try {
+        RpcSample sample;
+        sample.operation = operation;
+        sample.queueWaitUs = (startNs - enqueuedNs) / 1000;
+
+        // Sizing only: gRPC encodes the request inside the call, reusing the cached size.
+        sample.requestBytes = static_cast<qint64>(request.ByteSizeLong());
+        const qint64 serializedNs = RpcStats::nowNs();
+        sample.serializeUs = (serializedNs - startNs) / 1000;
+
         ServerReply reply;
         grpc::ClientContext context;
-        const auto status = m_stub->ProcessLine(&context, request, &reply);
-        handleStatus(QStringLiteral("ProcessLine"), status, reply);
+        const auto status = call(&context, request, &reply);
+        const qint64 doneNs = RpcStats::nowNs();
+
+        const qint64 callUs = (doneNs - serializedNs) / 1000;
+        sample.serverUs = serverTimeUs(context);
+        sample.networkUs = sample.serverUs >= 0 ? qMax<qint64>(0, callUs - sample.serverUs) : callUs;
+        sample.totalUs = (doneNs - enqueuedNs) / 1000;
+        sample.replyBytes = static_cast<qint64>(reply.ByteSizeLong());
+        sample.ok = status.ok();
+        m_stats->record(sample);
+        if (m_stats->isSlow(sample)) {
+            emit slowRequest(operation, sample.totalUs / 1000.0, sample.requestBytes, sample.replyBytes);
+        }
+
+        if (emitSuccess || !status.ok()) {
+            handleStatus(operation, status, reply);
+        }
+        return status.ok();
     }
     catch (const std::exception& ex) {
-        emitException(QStringLiteral("ProcessLine"), ex);
+        emitException(operation, ex);
     }
+    return false;
 }
 
-void FiveAxisWorker::processRectangle(const RectangleData& request) {
-    if (!m_stub) {
-        emitNotConnected(QStringLiteral("ProcessRectangle"));
-        return;
-    }
-    try {
-        ServerReply reply;
-        grpc::ClientContext context;
-        const auto status = m_stub->ProcessRectangle(&context, request, &reply);
-        handleStatus(QStringLiteral("ProcessRectangle"), status, reply);
-    }
-    catch (const std::exception& ex) {
-        emitException(QStringLiteral("ProcessRectangle"), ex);
-    }
+void FiveAxisWorker::processLine(const LineData& request, qint64 enqueuedNs) {
+    callTimed(QStringLiteral("ProcessLine"), request, enqueuedNs,
+        [this](grpc::ClientContext* context, const LineData& r, ServerReply* reply) {
+            return m_stub->ProcessLine(context, r, reply);
+        });
 }
 
-void FiveAxisWorker::processCircle(const CircleData& request) {
-    if (!m_stub) {
-        emitNotConnected(QStringLiteral("ProcessCircle"));
-        return;
-    }
-    try {
-        ServerReply reply;
-        grpc::ClientContext context;
-        const auto status = m_stub->ProcessCircle(&context, request, &reply);
-        handleStatus(QStringLiteral("ProcessCircle"), status, reply);
-    }
-    catch (const std::exception& ex) {
-        emitException(QStringLiteral("ProcessCircle"), ex);
-    }
+void FiveAxisWorker::processRectangle(const RectangleData& request, qint64 enqueuedNs) {
+    callTimed(QStringLiteral("ProcessRectangle"), request, enqueuedNs,
+        [this](grpc::ClientContext* context, const RectangleData& r, ServerReply* reply) {
+            return m_stub->ProcessRectangle(context, r, reply);
+        });
 }
 
-void FiveAxisWorker::processEllipse(const EllipseData& request) {
-    if (!m_stub) {
-        emitNotConnected(QStringLiteral("ProcessEllipse"));
-        return;
-    }
-    try {
-        ServerReply reply;
-        grpc::ClientContext context;
-        const auto status = m_stub->ProcessEllipse(&context, request, &reply);
-        handleStatus(QStringLiteral("ProcessEllipse"), status, reply);
-    }
-    catch (const std::exception& ex) {
-        emitException(QStringLiteral("ProcessEllipse"), ex);
+void FiveAxisWorker::processCircle(const CircleData& request, qint64 enqueuedNs) {
+    callTimed(QStringLiteral("ProcessCircle"), request, enqueuedNs,
+        [this](grpc::ClientContext* context, const CircleData& r, ServerReply* reply) {
+            return m_stub->ProcessCircle(context, r, reply);
+        });
+}
+
+void FiveAxisWorker::processEllipse(const EllipseData& request, qint64 enqueuedNs) {
+    callTimed(QStringLiteral("ProcessEllipse"), request, enqueuedNs,
+        [this](grpc::ClientContext* context, const EllipseData& r, ServerReply* reply) {
+            return m_stub->ProcessEllipse(context, r, reply);
+        });
+}
+
+void FiveAxisWorker::setDelay(const DelayData& request, qint64 enqueuedNs) {
+    const bool ok = callTimed(QStringLiteral("SetDelay"), request, enqueuedNs,
+        [this](grpc::ClientContext* context, const DelayData& r, ServerReply* reply) {
+            return m_stub->SetDelay(context, r, reply);
+        });
+    if (ok) {
+        m_machineDelay = request;
     }
 }
 
-void FiveAxisWorker::setDelay(const DelayData& request) {
-    if (!m_stub) {
-        emitNotConnected(QStringLiteral("SetDelay"));
-        return;
+void FiveAxisWorker::setLaserFreq(const FreqData& request, qint64 enqueuedNs) {
+    const bool ok = callTimed(QStringLiteral("SetLaserFreq"), request, enqueuedNs,
+        [this](grpc::ClientContext* context, const FreqData& r, ServerReply* reply) {
+            return m_stub->SetLaserFreq(context, r, reply);
+        });
+    if (ok) {
+        m_machineFreq = request;
     }
-    try {
-        ServerReply reply;
-        grpc::ClientContext context;
-        const auto status = m_stub->SetDelay(&context, request, &reply);
-        handleStatus(QStringLiteral("SetDelay"), status, reply);
+}
+
+void FiveAxisWorker::flushSettings(qint64 enqueuedNs) {
+    using google::protobuf::util::MessageDifferencer;
+    const auto batch = m_settings->takeBatch();
+    if (batch.delay) {
+        if (m_machineDelay && MessageDifferencer::Equals(*m_machineDelay, *batch.delay)) {
+            emit settingsSkipped(QStringLiteral("SetDelay"));
+        }
+        else {
+            setDelay(*batch.delay, enqueuedNs);
+        }
     }
-    catch (const std::exception& ex) {
-        emitException(QStringLiteral("SetDelay"), ex);
+    if (batch.freq) {
+        if (m_machineFreq && MessageDifferencer::Equals(*m_machineFreq, *batch.freq)) {
+            emit settingsSkipped(QStringLiteral("SetLaserFreq"));
+        }
+        else {
+            setLaserFreq(*batch.freq, enqueuedNs);
+        }
     }
 }
 
-void FiveAxisWorker::setLaserFreq(const FreqData& request) {
+void FiveAxisWorker::processScene(const SceneBatch& batch, qint64 enqueuedNs) {
     if (!m_stub) {
-        emitNotConnected(QStringLiteral("SetLaserFreq"));
+        emitNotConnected(QStringLiteral("ProcessScene"));
         return;
     }
-    try {
-        ServerReply reply;
-        grpc::ClientContext context;
-        const auto status = m_stub->SetLaserFreq(&context, request, &reply);
-        handleStatus(QStringLiteral("SetLaserFreq"), status, reply);
-    }
-    catch (const std::exception& ex) {
-        emitException(QStringLiteral("SetLaserFreq"), ex);
+    trace::Scope scope("rpc", "ProcessScene");
+    const qint64 startNs = RpcStats::nowNs();
+    const int total = batch.shapeCount();
+    const int progressStep = qMax(1, total / 100);
+    int failed = 0;
+    int done = 0;
+    for (const auto& shape : batch.scene().shapes()) {
+        bool ok = true;
+        switch (shape.shape_case()) {
+        case SceneShape::kLine:
+            ok = callTimed(QStringLiteral("ProcessLine"), shape.line(), enqueuedNs,
+                [this](grpc::ClientContext* context, const LineData& r, ServerReply* reply) {
+                    return m_stub->ProcessLine(context, r, reply);
+                }, false);
+            break;
+        case SceneShape::kCircle:
+            ok = callTimed(QStringLiteral("ProcessCircle"), shape.circle(), enqueuedNs,
+                [this](grpc::ClientContext* context, const CircleData& r, ServerReply* reply) {
+                    return m_stub->ProcessCircle(context, r, reply);
+                }, false);
+            break;
+        case SceneShape::kRectangle:
+            ok = callTimed(QStringLiteral("ProcessRectangle"), shape.rectangle(), enqueuedNs,
+                [this](grpc::ClientContext* context, const RectangleData& r, ServerReply* reply) {
+                    return m_stub->ProcessRectangle(context, r, reply);
+                }, false);
+            break;
+        case SceneShape::kEllipse:
+            ok = callTimed(QStringLiteral("ProcessEllipse"), shape.ellipse(), enqueuedNs,
+                [this](grpc::ClientContext* context, const EllipseData& r, ServerReply* reply) {
+                    return m_stub->ProcessEllipse(context, r, reply);
+                }, false);
+            break;
+        case SceneShape::SHAPE_NOT_SET:
+            break;
+        }
+        if (!ok) {
+            ++failed;
+        }
+        if (++done % progressStep == 0 || done == total) {
+            emit sceneProgress(done, total);
+        }
+        // Only the first shape waited in the queue; later ones start as soon as the previous returns.
+        enqueuedNs = RpcStats::nowNs();
     }
+    emit sceneFinished(batch.shapeCount(), failed, (RpcStats::nowNs() - startNs) / 1e6);
 }
 
 void FiveAxisWorker::emitNotConnected(const QString& operation) {
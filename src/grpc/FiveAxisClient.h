@@ -6,9 +6,15 @@
 #include <QString>
 #include <QMetaType>
 
+#include <memory>
+#include <optional>
+
 #include <grpcpp/grpcpp.h>
 
 #include "five_axis.grpc.pb.h"
+#include "RpcStats.h"
+#include "SceneBatch.h"
+#include "SettingsChannel.h"
 
 Q_DECLARE_METATYPE(LineData)
 Q_DECLARE_METATYPE(RectangleData)
@@ -19,27 +25,49 @@ Q_DECLARE_METATYPE(FreqData)
 
 class FiveAxisWorker : public QObject {
     Q_OBJECT
+public:
+    FiveAxisWorker(RpcStats* stats, SettingsChannel* settings);
+
+    // Submits every shape in order; only failures and the final summary are reported.
+    // Invoked through a queued functor because SceneBatch is not a copyable metatype.
+    void processScene(const SceneBatch& batch, qint64 enqueuedNs);
+
 public slots:
     QString connectToServer(const QUrl& endpoint);
     QString channelStateString() const;
-    void processLine(const LineData& request);
-    void processRectangle(const RectangleData& request);
-    void processCircle(const CircleData& request);
-    void processEllipse(const EllipseData& request);
-    void setDelay(const DelayData& request);
-    void setLaserFreq(const FreqData& request);
+    // enqueuedNs is RpcStats::nowNs() taken by FiveAxisClient when the call was queued.
+    void processLine(const LineData& request, qint64 enqueuedNs);
+    void processRectangle(const RectangleData& request, qint64 enqueuedNs);
+    void processCircle(const CircleData& request, qint64 enqueuedNs);
+    void processEllipse(const EllipseData& request, qint64 enqueuedNs);
+    void setDelay(const DelayData& request, qint64 enqueuedNs);
+    void setLaserFreq(const FreqData& request, qint64 enqueuedNs);
+    // Applies the oldest coalesced settings batch, skipping values the machine already has.
+    void flushSettings(qint64 enqueuedNs);
 
 signals:
     void replyReceived(const QString& operation, const QString& message);
     void errorReceived(const QString& operation, int code, const QString& message);
+    void slowRequest(const QString& operation, double totalMs, qint64 requestBytes, qint64 replyBytes);
+    void settingsSkipped(const QString& operation);
+    void sceneProgress(int done, int total);
+    void sceneFinished(int shapes, int failed, double elapsedMs);
 
 private:
+    template <typename Request, typename Call>
+    bool callTimed(const QString& operation, const Request& request, qint64 enqueuedNs, Call call,
+        bool emitSuccess = true);
+
     void emitNotConnected(const QString& operation);
     void emitException(const QString& operation, const std::exception& ex);
     void handleStatus(const QString& operation, const grpc::Status& status, const ServerReply& reply);
 
     QString describeState(grpc_connectivity_state state) const;
 
+    RpcStats* m_stats;
+    SettingsChannel* m_settings;
+    std::optional<DelayData> m_machineDelay;
+    std::optional<FreqData> m_machineFreq;
     std::shared_ptr<grpc::Channel> m_channel;
     std::unique_ptr<FiveAxis::FiveAxis::Stub> m_stub;
 };
@@ -58,12 +86,23 @@ public:
     void processEllipse(const EllipseData& request);
     void setDelay(const DelayData& request);
     void setLaserFreq(const FreqData& request);
+    void processScene(std::unique_ptr<SceneBatch> batch);
+    RpcStats& stats() const;
+    const SettingsChannel& settings() const;
 
 signals:
     void replyReceived(const QString& operation, const QString& message);
     void errorReceived(const QString& operation, int code, const QString& message);
+    void slowRequest(const QString& operation, double totalMs, qint64 requestBytes, qint64 replyBytes);
+    void settingsSkipped(const QString& operation);
+    void sceneProgress(int done, int total);
+    void sceneFinished(int shapes, int failed, double elapsedMs);
 
 private:
+    void queueSettingsFlush();
+
+    std::unique_ptr<RpcStats> m_stats;
+    std::unique_ptr<SettingsChannel> m_settings;
     FiveAxisWorker* m_worker;
     QThread m_workerThread;
 };
\ No newline at end of file
@@ -0,0 +1,149 @@
+#include "FleetBenchmark.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QTimer>
+
+#include "FleetDispatcher.h"
+#include "Processing/ControllerSimulator.h"
+
+namespace {
+    constexpr int POLL_MS = 10;
+    constexpr int TIMEOUT_MS = 30'000;
+    constexpr double LINE_SPEED = 1000.0;
+
+    // Spins an event loop until done() holds, so queued job retirements get delivered.
+    bool waitUntil(const std::function<bool()>& done) {
+        QEventLoop loop;
+        QTimer poll;
+        QElapsedTimer waited;
+        waited.start();
+        bool ok = true;
+        QObject::connect(&poll, &QTimer::timeout, &loop, [&]() {
+            if (done()) {
+                loop.quit();
+            }
+            else if (waited.elapsed() > TIMEOUT_MS) {
+                ok = false;
+                loop.quit();
+            }
+            });
+        poll.start(POLL_MS);
+        loop.exec();
+        return ok;
+    }
+}
+
+bool FleetBenchmark::Result::allCompleted() const {
+    qint64 completed = 0;
+    for (const Controller& controller : controllers) {
+        completed += controller.completed;
+    }
+    return completed == jobs;
+}
+
+bool FleetBenchmark::Result::framesMatch() const {
+    for (const Controller& controller : controllers) {
+        if (controller.framesWritten != controller.framesReceived) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool FleetBenchmark::Result::spread() const {
+    for (const Controller& controller : controllers) {
+        if (controller.assigned == 0) {
+            return false;
+        }
+    }
+    return !controllers.isEmpty();
+}
+
+FleetBenchmark::Result FleetBenchmark::run(int controllers, int jobs, int recordUs) {
+    Result result;
+    result.jobs = jobs;
+
+    std::vector<std::unique_ptr<ControllerSimulator>> simulators;
+    for (int i = 0; i < controllers; ++i) {
+        simulators.push_back(std::make_unique<ControllerSimulator>(recordUs));
+        if (!simulators.back()->start(result.error)) {
+            return result;
+        }
+    }
+
+    {
+        FleetDispatcher fleet;
+        QObject::connect(&fleet, &FleetDispatcher::jobAssigned, &fleet, [&result](int index) {
+            ++result.controllers[index].assigned;
+            });
+        for (int i = 0; i < controllers; ++i) {
+            ControllerConfig config;
+            config.name = QStringLiteral("Simulator %1").arg(i + 1);
+            // Never connected: the simulators only have a frame port.
+            config.endpoint = QUrl(QStringLiteral("grpc://127.0.0.1:1"));
+            config.streamHost = QStringLiteral("127.0.0.1");
+            config.streamPort = simulators[i]->port();
+            fleet.addController(config);
+            Controller controller;
+            controller.name = config.name;
+            result.controllers.append(controller);
+        }
+
+        QElapsedTimer clock;
+        clock.start();
+        for (int i = 0; i < jobs; ++i) {
+            // Different lengths, so assignment goes by estimated finish time rather than round robin.
+            LineData request;
+            request.set_x1(0.0);
+            request.set_y1(i);
+            request.set_x2(5.0 + (i % 4) * 5.0);
+            request.set_y2(i);
+            request.set_speed(LINE_SPEED);
+            request.set_times(1);
+            if (fleet.dispatchLine(request) < 0) {
+                result.error = QStringLiteral("no controller was selected");
+                return result;
+            }
+        }
+
+        const bool retired = waitUntil([&]() {
+            qint64 completed = 0;
+            for (int i = 0; i < controllers; ++i) {
+                completed += fleet.status(i).completed;
+            }
+            return completed >= jobs;
+            });
+        result.elapsedMs = clock.nsecsElapsed() / 1e6;
+        // Sent is not executed yet: the last frames are still being paced through the simulators.
+        const bool executed = retired && waitUntil([&]() {
+            for (int i = 0; i < controllers; ++i) {
+                if (simulators[i]->framesReceived() < fleet.controller(i)->streamer().framesWritten()) {
+                    return false;
+                }
+            }
+            return true;
+            });
+        for (int i = 0; i < controllers; ++i) {
+            Controller& controller = result.controllers[i];
+            controller.completed = fleet.status(i).completed;
+            controller.framesWritten = fleet.controller(i)->streamer().framesWritten();
+            controller.framesReceived = simulators[i]->framesReceived();
+        }
+        if (!retired) {
+            result.error = QStringLiteral("jobs did not retire within %1 s").arg(TIMEOUT_MS / 1000);
+        }
+        else if (!executed) {
+            result.error = QStringLiteral("the simulators did not execute every streamed frame");
+        }
+    }
+
+    for (auto& simulator : simulators) {
+        simulator->stop();
+    }
+    return result;
+}
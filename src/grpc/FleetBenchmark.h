@@ -0,0 +1,33 @@
+#pragma once
+
+#include <QString>
+#include <QVector>
+
+// Dispatches a batch of line jobs across several local ControllerSimulators through a real
+// FleetDispatcher, so assignment, per-controller streaming and job retirement run together
+// without machines. Every controller should get jobs, every job should retire, and each
+// simulator should execute exactly the frames its controller's streamer wrote.
+class FleetBenchmark {
+public:
+    struct Controller {
+        QString name;
+        int assigned{ 0 };
+        qint64 completed{ 0 };
+        qint64 framesWritten{ 0 };
+        int framesReceived{ 0 };
+    };
+
+    struct Result {
+        int jobs{ 0 };
+        double elapsedMs{ 0.0 };
+        QVector<Controller> controllers;
+        QString error;
+
+        bool allCompleted() const;
+        bool framesMatch() const;
+        bool spread() const;
+    };
+
+    // Runs its own event loop; call it from a worker thread.
+    static Result run(int controllers = 3, int jobs = 12, int recordUs = 2);
+};
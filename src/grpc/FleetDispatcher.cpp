@@ -0,0 +1,399 @@
+#include "FleetDispatcher.h"
+
+#include <limits>
+
+#include <QDateTime>
+#include <QtMath>
+
+#include "Processing/DataBuffer.h"
+#include "Processing/SampleSink.h"
+#include "Processing/ShapeGenerator.h"
+#include "Processing/TcpSocketWorker.h"
+#include "metrics/Trace.h"
+
+namespace {
+    constexpr double PI = 3.14159265358979323846;
+    // Fixed per-job cost (RPC round trip, begin/end frames) so tiny jobs still spread out.
+    constexpr double RPC_OVERHEAD_S = 0.05;
+    constexpr int MAX_CONSECUTIVE_FAILURES = 3;
+    constexpr int SAMPLE_INTERVAL_MS = 1000;
+    constexpr double SMOOTHING = 0.3;
+    constexpr int DRAIN_POLL_MS = 10;
+
+    double layerCount(double zStart, double zEnd, double zInterval) {
+        if (zInterval <= 0.0) {
+            return 1.0;
+        }
+        return qFloor(qAbs(zEnd - zStart) / zInterval) + 1.0;
+    }
+
+    double pathSeconds(double length, double speed, int times, double layers) {
+        if (speed <= 0.0) {
+            return 0.0;
+        }
+        return length / speed * qMax(1, times) * layers;
+    }
+}
+
+ControllerConnection::ControllerConnection(const ControllerConfig& config, QObject* parent)
+    : QObject(parent)
+    , m_config(config)
+    , m_client(new FiveAxisClient(this))
+    , m_buffer(std::make_unique<DataBuffer>())
+    , m_streamer(std::make_unique<TcpSocketWorker>(config.streamHost, config.streamPort, *m_buffer)) {
+    m_buffer->setStreamer(m_streamer.get());
+    connect(m_client, &FiveAxisClient::replyReceived, this, &ControllerConnection::onReply);
+    connect(m_client, &FiveAxisClient::errorReceived, this, &ControllerConnection::onError);
+}
+
+ControllerConnection::~ControllerConnection() {
+    {
+        QMutexLocker locker(&m_jobMutex);
+        m_stopGenerator = true;
+        m_streamJobs.clear();
+        m_jobAvailable.wakeAll();
+    }
+    // Unblocks a generator waiting for a free frame and turns the rest of its job into no-ops.
+    m_buffer->interruptQueued();
+    if (m_generator.joinable()) {
+        m_generator.join();
+    }
+    m_streamer.reset();
+}
+
+const ControllerConfig& ControllerConnection::config() const {
+    return m_config;
+}
+
+FiveAxisClient* ControllerConnection::client() const {
+    return m_client;
+}
+
+DataBuffer& ControllerConnection::buffer() {
+    return *m_buffer;
+}
+
+TcpSocketWorker& ControllerConnection::streamer() {
+    return *m_streamer;
+}
+
+QString ControllerConnection::connectToController() {
+    const QString details = m_client->connectToServer(m_config.endpoint);
+    const QString state = m_client->channelStateString();
+    m_healthy = state == QStringLiteral("READY") || state == QStringLiteral("IDLE");
+    m_consecutiveFailures = 0;
+    m_lastError = m_healthy ? QString() : state;
+    emit updated();
+    return details;
+}
+
+void ControllerConnection::enqueue(double estimateSeconds) {
+    m_pending.enqueue(estimateSeconds);
+    m_pendingSeconds += estimateSeconds;
+    emit updated();
+}
+
+bool ControllerConnection::streamsLocally() const {
+    return !m_config.streamHost.isEmpty();
+}
+
+void ControllerConnection::stream(const QString& operation, std::function<void(SampleSink&)> generate) {
+    QMutexLocker locker(&m_jobMutex);
+    m_streamJobs.enqueue(StreamJob{ operation, std::move(generate) });
+    if (!m_generator.joinable()) {
+        m_generator = std::thread([this]() { runGenerator(); });
+    }
+    m_jobAvailable.wakeOne();
+}
+
+void ControllerConnection::runGenerator() {
+    trace::setThreadName(QStringLiteral("FleetGenerator %1").arg(m_config.name));
+    for (;;) {
+        StreamJob job;
+        {
+            QMutexLocker locker(&m_jobMutex);
+            while (m_streamJobs.isEmpty() && !m_stopGenerator) {
+                m_jobAvailable.wait(&m_jobMutex);
+            }
+            if (m_stopGenerator) {
+                return;
+            }
+            job = m_streamJobs.dequeue();
+        }
+        const qint64 framesBefore = m_streamer->framesWritten();
+        job.generate(*m_buffer);
+        // Push out the partially filled last frame so the job does not wait for the next one.
+        m_buffer->forceFill();
+        while (!m_buffer->allFramesSent()) {
+            QMutexLocker locker(&m_jobMutex);
+            if (m_stopGenerator) {
+                return;
+            }
+            m_jobAvailable.wait(&m_jobMutex, DRAIN_POLL_MS);
+        }
+        const QString message = tr("%1 frames streamed to %2:%3").arg(m_streamer->framesWritten() - framesBefore)
+            .arg(m_config.streamHost).arg(m_config.streamPort);
+        QMetaObject::invokeMethod(this, [this, operation = job.operation, message]() {
+            onReply(operation, message);
+            }, Qt::QueuedConnection);
+    }
+}
+
+double ControllerConnection::load() const {
+    return m_pendingSeconds + m_pending.size() * RPC_OVERHEAD_S;
+}
+
+bool ControllerConnection::isHealthy() const {
+    return m_healthy;
+}
+
+ControllerStatus ControllerConnection::status() const {
+    ControllerStatus status;
+    status.name = m_config.name;
+    status.endpoint = m_config.endpoint.toString();
+    status.healthy = m_healthy;
+    status.streamConnected = m_streamer->isConnected();
+    status.queueDepth = m_pending.size();
+    status.pendingSeconds = m_pendingSeconds;
+    status.completed = m_completed;
+    status.failed = m_failed;
+    status.jobsPerMinute = m_jobsPerMinute;
+    status.streamBytesPerSecond = m_bytesPerSecond;
+    status.lastError = m_lastError;
+    return status;
+}
+
+void ControllerConnection::sampleThroughput(double elapsedSeconds) {
+    if (elapsedSeconds <= 0.0) {
+        return;
+    }
+    const qint64 bytes = m_streamer->bytesWritten();
+    const double jobsPerMinute = (m_completed - m_lastCompleted) * 60.0 / elapsedSeconds;
+    const double bytesPerSecond = (bytes - m_lastBytes) / elapsedSeconds;
+    m_jobsPerMinute += SMOOTHING * (jobsPerMinute - m_jobsPerMinute);
+    m_bytesPerSecond += SMOOTHING * (bytesPerSecond - m_bytesPerSecond);
+    m_lastCompleted = m_completed;
+    m_lastBytes = bytes;
+    emit updated();
+}
+
+void ControllerConnection::onReply(const QString& operation, const QString& message) {
+    ++m_completed;
+    m_healthy = true;
+    m_consecutiveFailures = 0;
+    finishFront();
+    emit replyReceived(operation, message);
+    emit updated();
+}
+
+void ControllerConnection::onError(const QString& operation, int code, const QString& message) {
+    ++m_failed;
+    m_lastError = message;
+    if (code == -1 || code == grpc::StatusCode::UNAVAILABLE || ++m_consecutiveFailures >= MAX_CONSECUTIVE_FAILURES) {
+        m_healthy = false;
+    }
+    finishFront();
+    emit errorReceived(operation, code, message);
+    emit updated();
+}
+
+void ControllerConnection::finishFront() {
+    // The worker thread runs RPCs strictly in submission order, so replies retire the queue head.
+    if (m_pending.isEmpty()) {
+        return;
+    }
+    m_pendingSeconds = qMax(0.0, m_pendingSeconds - m_pending.dequeue());
+}
+
+FleetDispatcher::FleetDispatcher(QObject* parent)
+    : QObject(parent) {
+    m_sampleTimer.setInterval(SAMPLE_INTERVAL_MS);
+    connect(&m_sampleTimer, &QTimer::timeout, this, &FleetDispatcher::sampleThroughput);
+}
+
+int FleetDispatcher::addController(const ControllerConfig& config) {
+    auto* controller = new ControllerConnection(config, this);
+    const int index = static_cast<int>(m_controllers.size());
+    m_controllers.push_back(controller);
+
+    connect(controller, &ControllerConnection::updated, this, [this, index]() {
+        emit controllerUpdated(index);
+        });
+    connect(controller, &ControllerConnection::replyReceived, this, [this, index](const QString& operation, const QString& message) {
+        emit replyReceived(index, operation, message);
+        });
+    connect(controller, &ControllerConnection::errorReceived, this, [this, index](const QString& operation, int code, const QString& message) {
+        emit errorReceived(index, operation, code, message);
+        });
+
+    if (!m_sampleTimer.isActive()) {
+        m_lastSampleMs = QDateTime::currentMSecsSinceEpoch();
+        m_sampleTimer.start();
+    }
+    emit controllerAdded(index);
+    return index;
+}
+
+int FleetDispatcher::controllerCount() const {
+    return static_cast<int>(m_controllers.size());
+}
+
+ControllerConnection* FleetDispatcher::controller(int index) const {
+    if (index < 0 || index >= controllerCount()) {
+        return nullptr;
+    }
+    return m_controllers[index];
+}
+
+ControllerStatus FleetDispatcher::status(int index) const {
+    if (auto* connection = controller(index)) {
+        return connection->status();
+    }
+    return ControllerStatus{};
+}
+
+QString FleetDispatcher::connectController(int index) {
+    if (auto* connection = controller(index)) {
+        return connection->connectToController();
+    }
+    return QString();
+}
+
+int FleetDispatcher::selectController(double estimateSeconds) const {
+    int best = -1;
+    double bestFinish = std::numeric_limits<double>::max();
+    bool bestHealthy = false;
+    for (int i = 0; i < controllerCount(); ++i) {
+        const auto* connection = m_controllers[i];
+        const bool healthy = connection->isHealthy();
+        const double finish = connection->load() + estimateSeconds;
+        // A healthy controller always beats an unhealthy one; unhealthy ones only catch jobs
+        // when nothing else is available, so a fleet that is still connecting stays usable.
+        if (best < 0 || (healthy && !bestHealthy) || (healthy == bestHealthy && finish < bestFinish)) {
+            best = i;
+            bestFinish = finish;
+            bestHealthy = healthy;
+        }
+    }
+    return best;
+}
+
+int FleetDispatcher::dispatchLine(const LineData& request) {
+    const double estimate = estimateSeconds(request);
+    const int index = selectController(estimate);
+    if (index < 0) {
+        return index;
+    }
+    m_controllers[index]->enqueue(estimate);
+    if (m_controllers[index]->streamsLocally() && ShapeGenerator::unsupported(request).isEmpty()) {
+        m_controllers[index]->stream(QStringLiteral("ProcessLine"), [request](SampleSink& sink) {
+            ShapeGenerator::generate(sink, request);
+            });
+    }
+    else {
+        m_controllers[index]->client()->processLine(request);
+    }
+    emit jobAssigned(index, QStringLiteral("ProcessLine"), estimate);
+    return index;
+}
+
+int FleetDispatcher::dispatchCircle(const CircleData& request) {
+    const double estimate = estimateSeconds(request);
+    const int index = selectController(estimate);
+    if (index < 0) {
+        return index;
+    }
+    m_controllers[index]->enqueue(estimate);
+    if (m_controllers[index]->streamsLocally() && ShapeGenerator::unsupported(request).isEmpty()) {
+        m_controllers[index]->stream(QStringLiteral("ProcessCircle"), [request](SampleSink& sink) {
+            ShapeGenerator::generate(sink, request);
+            });
+    }
+    else {
+        m_controllers[index]->client()->processCircle(request);
+    }
+    emit jobAssigned(index, QStringLiteral("ProcessCircle"), estimate);
+    return index;
+}
+
+int FleetDispatcher::dispatchRectangle(const RectangleData& request) {
+    const double estimate = estimateSeconds(request);
+    const int index = selectController(estimate);
+    if (index < 0) {
+        return index;
+    }
+    m_controllers[index]->enqueue(estimate);
+    if (m_controllers[index]->streamsLocally() && ShapeGenerator::unsupported(request).isEmpty()) {
+        m_controllers[index]->stream(QStringLiteral("ProcessRectangle"), [request](SampleSink& sink) {
+            ShapeGenerator::generate(sink, request);
+            });
+    }
+    else {
+        m_controllers[index]->client()->processRectangle(request);
+    }
+    emit jobAssigned(index, QStringLiteral("ProcessRectangle"), estimate);
+    return index;
+}
+
+int FleetDispatcher::dispatchEllipse(const EllipseData& request) {
+    const double estimate = estimateSeconds(request);
+    const int index = selectController(estimate);
+    if (index < 0) {
+        return index;
+    }
+    m_controllers[index]->enqueue(estimate);
+    m_controllers[index]->client()->processEllipse(request);
+    emit jobAssigned(index, QStringLiteral("ProcessEllipse"), estimate);
+    return index;
+}
+
+double FleetDispatcher::estimateSeconds(const LineData& request) {
+    const double length = qSqrt(qPow(request.x2() - request.x1(), 2) + qPow(request.y2() - request.y1(), 2) +
+        qPow(request.z2() - request.z1(), 2));
+    return pathSeconds(length, request.speed(), request.times(), 1.0);
+}
+
+double FleetDispatcher::estimateSeconds(const CircleData& request) {
+    const double radius = qSqrt(qPow(request.x2() - request.x1(), 2) + qPow(request.y2() - request.y1(), 2));
+    double length = 2 * PI * radius * qMax(0.0, request.angle()) / 360.0;
+    if (request.filled() && request.r_interval() > 0.0) {
+        length = 0.0;
+        for (double r = radius; r >= request.r_min(); r -= request.r_interval()) {
+            length += 2 * PI * r;
+        }
+    }
+    return pathSeconds(length, request.speed(), request.times(),
+        layerCount(request.z_start(), request.z_end(), request.z_interval()));
+}
+
+double FleetDispatcher::estimateSeconds(const RectangleData& request) {
+    const double width = qAbs(request.x1() - request.x0());
+    const double height = qAbs(request.y1() - request.y0());
+    double length = 2 * (width + height);
+    if (request.feedspacing_y() > 0.0) {
+        length += width * height / request.feedspacing_y();
+    }
+    return pathSeconds(length, request.speed(), request.times(),
+        layerCount(request.z_start(), request.z_end(), request.z_interval()));
+}
+
+double FleetDispatcher::estimateSeconds(const EllipseData& request) {
+    const double a = qAbs(request.a_max());
+    const double b = qAbs(request.b_max());
+    // Ramanujan's perimeter approximation plus the fill area swept at the feed spacing.
+    double length = PI * (3 * (a + b) - qSqrt((3 * a + b) * (a + 3 * b)));
+    if (request.feedspacing_y() > 0.0) {
+        length += PI * (a * b - qAbs(request.a_min() * request.b_min())) / request.feedspacing_y();
+    }
+    return pathSeconds(length, request.speed(), request.times(),
+        layerCount(request.z_start(), request.z_end(), request.z_interval()));
+}
+
+void FleetDispatcher::sampleThroughput() {
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const double elapsed = (now - m_lastSampleMs) / 1000.0;
+    m_lastSampleMs = now;
+    for (auto* connection : m_controllers) {
+        connection->sampleThroughput(elapsed);
+    }
+}
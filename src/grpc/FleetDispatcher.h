@@ -0,0 +1,147 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <QMutex>
+#include <QObject>
+#include <QQueue>
+#include <QString>
+#include <QTimer>
+#include <QUrl>
+#include <QWaitCondition>
+
+#include "FiveAxisClient.h"
+
+class DataBuffer;
+class SampleSink;
+class TcpSocketWorker;
+
+struct ControllerConfig {
+    QString name;
+    QUrl endpoint;
+    // Frame port of the machine, opt-in; empty sends every job over gRPC.
+    QString streamHost;
+    quint16 streamPort{ 7 };
+};
+
+struct ControllerStatus {
+    QString name;
+    QString endpoint;
+    bool healthy{ false };
+    bool streamConnected{ false };
+    int queueDepth{ 0 };
+    double pendingSeconds{ 0.0 };
+    qint64 completed{ 0 };
+    qint64 failed{ 0 };
+    double jobsPerMinute{ 0.0 };
+    double streamBytesPerSecond{ 0.0 };
+    QString lastError;
+};
+
+// One machine: its own gRPC channel (via FiveAxisClient), frame buffer and stream socket.
+class ControllerConnection : public QObject {
+    Q_OBJECT
+public:
+    explicit ControllerConnection(const ControllerConfig& config, QObject* parent = nullptr);
+    ~ControllerConnection() override;
+
+    const ControllerConfig& config() const;
+    FiveAxisClient* client() const;
+    DataBuffer& buffer();
+    TcpSocketWorker& streamer();
+
+    QString connectToController();
+    void enqueue(double estimateSeconds);
+    bool streamsLocally() const;
+    // Runs generate into this controller's buffer on its generator thread and streams the frames
+    // over its socket; the job is retired once its last frame has been sent.
+    void stream(const QString& operation, std::function<void(SampleSink&)> generate);
+    double load() const;
+    bool isHealthy() const;
+    ControllerStatus status() const;
+    void sampleThroughput(double elapsedSeconds);
+
+signals:
+    void updated();
+    void replyReceived(const QString& operation, const QString& message);
+    void errorReceived(const QString& operation, int code, const QString& message);
+
+private slots:
+    void onReply(const QString& operation, const QString& message);
+    void onError(const QString& operation, int code, const QString& message);
+
+private:
+    struct StreamJob {
+        QString operation;
+        std::function<void(SampleSink&)> generate;
+    };
+
+    void finishFront();
+    void runGenerator();
+
+    ControllerConfig m_config;
+    FiveAxisClient* m_client{};
+    std::unique_ptr<DataBuffer> m_buffer;
+    std::unique_ptr<TcpSocketWorker> m_streamer;
+    std::thread m_generator;
+    QMutex m_jobMutex;
+    QWaitCondition m_jobAvailable;
+    QQueue<StreamJob> m_streamJobs;
+    bool m_stopGenerator{ false };
+    QQueue<double> m_pending;
+    double m_pendingSeconds{ 0.0 };
+    bool m_healthy{ false };
+    int m_consecutiveFailures{ 0 };
+    qint64 m_completed{ 0 };
+    qint64 m_failed{ 0 };
+    qint64 m_lastCompleted{ 0 };
+    qint64 m_lastBytes{ 0 };
+    double m_jobsPerMinute{ 0.0 };
+    double m_bytesPerSecond{ 0.0 };
+    QString m_lastError;
+};
+
+class FleetDispatcher : public QObject {
+    Q_OBJECT
+public:
+    explicit FleetDispatcher(QObject* parent = nullptr);
+
+    int addController(const ControllerConfig& config);
+    int controllerCount() const;
+    ControllerConnection* controller(int index) const;
+    ControllerStatus status(int index) const;
+    QString connectController(int index);
+
+    // Picks the controller that would finish the job first; -1 when the fleet is empty.
+    int selectController(double estimateSeconds) const;
+
+    // Controllers with a stream host get the lines, circles and rectangles ShapeGenerator
+    // reproduces exactly generated here and streamed over their frame socket; every other job
+    // (arcs, fills, layers, tapers, ellipses, ...) goes to the controller over gRPC.
+    int dispatchLine(const LineData& request);
+    int dispatchCircle(const CircleData& request);
+    int dispatchRectangle(const RectangleData& request);
+    int dispatchEllipse(const EllipseData& request);
+
+    static double estimateSeconds(const LineData& request);
+    static double estimateSeconds(const CircleData& request);
+    static double estimateSeconds(const RectangleData& request);
+    static double estimateSeconds(const EllipseData& request);
+
+signals:
+    void controllerAdded(int index);
+    void controllerUpdated(int index);
+    void jobAssigned(int index, const QString& operation, double estimateSeconds);
+    void replyReceived(int index, const QString& operation, const QString& message);
+    void errorReceived(int index, const QString& operation, int code, const QString& message);
+
+private:
+    void sampleThroughput();
+
+    std::vector<ControllerConnection*> m_controllers;
+    QTimer m_sampleTimer;
+    qint64 m_lastSampleMs{ 0 };
+};
@@ -0,0 +1,148 @@
+#include "RpcStats.h"
+
+#include <chrono>
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QStringList>
+
+namespace {
+    LatencySummary summarize(const HdrHistogram& histogram) {
+        LatencySummary summary;
+        summary.count = histogram.count();
+        summary.mean = histogram.mean();
+        summary.p50 = histogram.valueAtPercentile(50.0);
+        summary.p90 = histogram.valueAtPercentile(90.0);
+        summary.p99 = histogram.valueAtPercentile(99.0);
+        summary.p999 = histogram.valueAtPercentile(99.9);
+        summary.max = histogram.max();
+        return summary;
+    }
+
+    QJsonObject toJsonObject(const LatencySummary& summary) {
+        return QJsonObject{
+            { QStringLiteral("count"), summary.count },
+            { QStringLiteral("mean_us"), summary.mean },
+            { QStringLiteral("p50_us"), summary.p50 },
+            { QStringLiteral("p90_us"), summary.p90 },
+            { QStringLiteral("p99_us"), summary.p99 },
+            { QStringLiteral("p999_us"), summary.p999 },
+            { QStringLiteral("max_us"), summary.max },
+        };
+    }
+}
+
+qint64 RpcStats::nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void RpcStats::record(const RpcSample& sample) {
+    QMutexLocker locker(&m_mutex);
+    auto& stats = m_operations[sample.operation];
+    stats.queueWait.record(sample.queueWaitUs);
+    stats.serialize.record(sample.serializeUs);
+    stats.network.record(sample.networkUs);
+    if (sample.serverUs >= 0) {
+        stats.server.record(sample.serverUs);
+    }
+    stats.total.record(sample.totalUs);
+    stats.requestBytes += sample.requestBytes;
+    stats.replyBytes += sample.replyBytes;
+    if (!sample.ok) {
+        ++stats.errors;
+    }
+}
+
+void RpcStats::reset() {
+    QMutexLocker locker(&m_mutex);
+    m_operations.clear();
+}
+
+QVector<RpcOperationSummary> RpcStats::summaries() const {
+    QMutexLocker locker(&m_mutex);
+    QVector<RpcOperationSummary> result;
+    result.reserve(m_operations.size());
+    for (auto it = m_operations.cbegin(); it != m_operations.cend(); ++it) {
+        RpcOperationSummary summary;
+        summary.operation = it.key();
+        summary.calls = it->total.count();
+        summary.errors = it->errors;
+        summary.requestBytes = it->requestBytes;
+        summary.replyBytes = it->replyBytes;
+        summary.queueWait = summarize(it->queueWait);
+        summary.serialize = summarize(it->serialize);
+        summary.network = summarize(it->network);
+        summary.server = summarize(it->server);
+        summary.total = summarize(it->total);
+        result.append(summary);
+    }
+    return result;
+}
+
+void RpcStats::setSlowThresholdUs(qint64 thresholdUs) {
+    m_slowThresholdUs.store(thresholdUs);
+}
+
+qint64 RpcStats::slowThresholdUs() const {
+    return m_slowThresholdUs.load();
+}
+
+bool RpcStats::isSlow(const RpcSample& sample) const {
+    const qint64 threshold = m_slowThresholdUs.load();
+    return threshold > 0 && sample.totalUs >= threshold;
+}
+
+QString RpcStats::toCsv() const {
+    QStringList lines{ QStringLiteral(
+        "operation,phase,count,errors,request_bytes,reply_bytes,mean_us,p50_us,p90_us,p99_us,p999_us,max_us") };
+    for (const auto& summary : summaries()) {
+        const std::pair<const char*, const LatencySummary*> phases[] = {
+            { "queue", &summary.queueWait },
+            { "serialize", &summary.serialize },
+            { "network", &summary.network },
+            { "server", &summary.server },
+            { "total", &summary.total },
+        };
+        for (const auto& [phase, latency] : phases) {
+            lines << QStringLiteral("%1,%2,%3,%4,%5,%6,%7,%8,%9,%10,%11,%12")
+                .arg(summary.operation, QString::fromLatin1(phase))
+                .arg(latency->count)
+                .arg(summary.errors)
+                .arg(summary.requestBytes)
+                .arg(summary.replyBytes)
+                .arg(latency->mean, 0, 'f', 1)
+                .arg(latency->p50)
+                .arg(latency->p90)
+                .arg(latency->p99)
+                .arg(latency->p999)
+                .arg(latency->max);
+        }
+    }
+    return lines.join(QLatin1Char('\n')) + QLatin1Char('\n');
+}
+
+QByteArray RpcStats::toJson() const {
+    QJsonArray operations;
+    for (const auto& summary : summaries()) {
+        operations.append(QJsonObject{
+            { QStringLiteral("operation"), summary.operation },
+            { QStringLiteral("calls"), summary.calls },
+            { QStringLiteral("errors"), summary.errors },
+            { QStringLiteral("request_bytes"), summary.requestBytes },
+            { QStringLiteral("reply_bytes"), summary.replyBytes },
+            { QStringLiteral("queue"), toJsonObject(summary.queueWait) },
+            { QStringLiteral("serialize"), toJsonObject(summary.serialize) },
+            { QStringLiteral("network"), toJsonObject(summary.network) },
+            { QStringLiteral("server"), toJsonObject(summary.server) },
+            { QStringLiteral("total"), toJsonObject(summary.total) },
+            });
+    }
+    const QJsonObject root{
+        { QStringLiteral("slow_threshold_us"), slowThresholdUs() },
+        { QStringLiteral("operations"), operations },
+    };
+    return QJsonDocument(root).toJson(QJsonDocument::Indented);
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+
+#include <QByteArray>
+#include <QMap>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+#include "metrics/HdrHistogram.h"
+
+// Timing of one RPC issued by FiveAxisWorker. All durations are microseconds.
+struct RpcSample {
+    QString operation;
+    qint64 queueWaitUs{ 0 };   // FiveAxisClient::invokeMethod -> worker slot entry
+    qint64 serializeUs{ 0 };   // request sizing; the encoding itself is part of the call
+    qint64 networkUs{ 0 };     // call time not accounted for by the server
+    qint64 serverUs{ -1 };     // from the "x-server-time-us" response metadata, -1 if absent
+    qint64 totalUs{ 0 };       // enqueue -> reply
+    qint64 requestBytes{ 0 };
+    qint64 replyBytes{ 0 };
+    bool ok{ true };
+};
+
+struct LatencySummary {
+    qint64 count{ 0 };
+    double mean{ 0.0 };
+    qint64 p50{ 0 };
+    qint64 p90{ 0 };
+    qint64 p99{ 0 };
+    qint64 p999{ 0 };
+    qint64 max{ 0 };
+};
+
+struct RpcOperationSummary {
+    QString operation;
+    qint64 calls{ 0 };
+    qint64 errors{ 0 };
+    qint64 requestBytes{ 0 };
+    qint64 replyBytes{ 0 };
+    LatencySummary queueWait;
+    LatencySummary serialize;
+    LatencySummary network;
+    LatencySummary server;
+    LatencySummary total;
+};
+
+// Per-operation latency histograms. Written by the gRPC worker thread, read from the GUI.
+class RpcStats {
+public:
+    static qint64 nowNs();
+
+    void record(const RpcSample& sample);
+    void reset();
+    QVector<RpcOperationSummary> summaries() const;
+
+    void setSlowThresholdUs(qint64 thresholdUs);
+    qint64 slowThresholdUs() const;
+    bool isSlow(const RpcSample& sample) const;
+
+    QString toCsv() const;
+    QByteArray toJson() const;
+
+private:
+    struct OperationStats {
+        HdrHistogram queueWait;
+        HdrHistogram serialize;
+        HdrHistogram network;
+        HdrHistogram server;
+        HdrHistogram total;
+        qint64 errors{ 0 };
+        qint64 requestBytes{ 0 };
+        qint64 replyBytes{ 0 };
+    };
+
+    mutable QMutex m_mutex;
+    QMap<QString, OperationStats> m_operations;
+    std::atomic<qint64> m_slowThresholdUs{ 200'000 };
+};
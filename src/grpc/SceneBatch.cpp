@@ -0,0 +1,74 @@
+#include "SceneBatch.h"
+
+namespace {
+    google::protobuf::ArenaOptions arenaOptions() {
+        google::protobuf::ArenaOptions options;
+        options.start_block_size = 64 * 1024;
+        options.max_block_size = 4 * 1024 * 1024;
+        return options;
+    }
+}
+
+SceneBatch::SceneBatch()
+    : m_arena(arenaOptions())
+    , m_scene(google::protobuf::Arena::CreateMessage<SceneData>(&m_arena)) {
+}
+
+LineData* SceneBatch::addLine() {
+    return m_scene->add_shapes()->mutable_line();
+}
+
+CircleData* SceneBatch::addCircle() {
+    return m_scene->add_shapes()->mutable_circle();
+}
+
+RectangleData* SceneBatch::addRectangle() {
+    return m_scene->add_shapes()->mutable_rectangle();
+}
+
+EllipseData* SceneBatch::addEllipse() {
+    return m_scene->add_shapes()->mutable_ellipse();
+}
+
+void SceneBatch::mergeFrom(const SceneData& scene) {
+    m_scene->MergeFrom(scene);
+}
+
+void SceneBatch::finalize() {
+    if (m_scene->shapes_size() == 0) {
+        return;
+    }
+    auto* last = m_scene->mutable_shapes(m_scene->shapes_size() - 1);
+    switch (last->shape_case()) {
+    case SceneShape::kLine:
+        last->mutable_line()->set_islast(true);
+        break;
+    case SceneShape::kCircle:
+        last->mutable_circle()->set_islast(true);
+        break;
+    case SceneShape::kRectangle:
+        last->mutable_rectangle()->set_islast(true);
+        break;
+    case SceneShape::kEllipse:
+        last->mutable_ellipse()->set_islast(true);
+        break;
+    case SceneShape::SHAPE_NOT_SET:
+        break;
+    }
+}
+
+const SceneData& SceneBatch::scene() const {
+    return *m_scene;
+}
+
+int SceneBatch::shapeCount() const {
+    return m_scene->shapes_size();
+}
+
+std::size_t SceneBatch::arenaBytesUsed() const {
+    return static_cast<std::size_t>(m_arena.SpaceUsed());
+}
+
+std::size_t SceneBatch::arenaBytesAllocated() const {
+    return static_cast<std::size_t>(m_arena.SpaceAllocated());
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+
+#include <google/protobuf/arena.h>
+
+#include <QtGlobal>
+
+#include "five_axis.pb.h"
+
+// A whole-scene submission whose messages all live in one protobuf arena: shapes are
+// built in place, handed to the worker thread by pointer and freed in one go.
+// Move the owning std::unique_ptr; the batch itself is neither copyable nor movable.
+class SceneBatch {
+public:
+    SceneBatch();
+    SceneBatch(const SceneBatch&) = delete;
+    SceneBatch& operator=(const SceneBatch&) = delete;
+
+    LineData* addLine();
+    CircleData* addCircle();
+    RectangleData* addRectangle();
+    EllipseData* addEllipse();
+    // Copies an already parsed scene (e.g. from a job file) into the arena.
+    void mergeFrom(const SceneData& scene);
+
+    // Marks the final shape with isLast so the controller knows the scene is complete.
+    void finalize();
+
+    const SceneData& scene() const;
+    int shapeCount() const;
+    std::size_t arenaBytesUsed() const;
+    std::size_t arenaBytesAllocated() const;
+
+private:
+    google::protobuf::Arena m_arena;
+    SceneData* m_scene;
+};
@@ -0,0 +1,134 @@
+#include "SceneBatchBenchmark.h"
+
+#include <atomic>
+#include <memory>
+
+#include <QElapsedTimer>
+#include <QSemaphore>
+#include <QThread>
+
+#include "FiveAxisClient.h"
+#include "metrics/AllocationCounter.h"
+
+namespace {
+    constexpr int DELIVERY_TIMEOUT_MS = 60000;
+
+    volatile double g_sink = 0.0;
+
+    void fillLine(LineData& line, int index) {
+        line.set_speed(100.0);
+        line.set_times(1);
+        line.set_x1(index % 1000);
+        line.set_y1(index / 1000);
+        line.set_x2(index % 1000 + 0.5);
+        line.set_y2(index / 1000 + 0.5);
+    }
+
+    void fillCircle(CircleData& circle, int index) {
+        circle.set_speed(100.0);
+        circle.set_times(1);
+        circle.set_x1(index % 1000);
+        circle.set_y1(index / 1000);
+        circle.set_x2(index % 1000 + 0.25);
+        circle.set_y2(index / 1000);
+        circle.set_angle(360.0);
+    }
+
+    // What the worker does with a request before issuing its RPC, so the scene is really walked.
+    double consume(const LineData& line) {
+        return line.x1() + line.y2();
+    }
+
+    double consume(const CircleData& circle) {
+        return circle.x1() + circle.y2();
+    }
+}
+
+SceneBatchBenchmark::Result SceneBatchBenchmark::run(int shapes) {
+    Result result;
+    result.shapes = shapes;
+    qRegisterMetaType<LineData>("LineData");
+    qRegisterMetaType<CircleData>("CircleData");
+
+    RpcStats stats;
+    SettingsChannel settings;
+    FiveAxisWorker worker(&stats, &settings);
+    QThread workerThread;
+    workerThread.setObjectName(QStringLiteral("SceneBatchBenchmark"));
+    worker.moveToThread(&workerThread);
+    workerThread.start();
+
+    // Each per-shape call ends in one "not connected" error, emitted on the worker thread.
+    std::atomic<int> heapReceived{ 0 };
+    QSemaphore delivered;
+    QObject::connect(&worker, &FiveAxisWorker::errorReceived, &worker,
+        [&](const QString& operation) {
+            if (operation != QStringLiteral("ProcessScene") && ++heapReceived == shapes) {
+                delivered.release();
+            }
+        }, Qt::DirectConnection);
+
+    // Old path: a heap request per shape, copied into the queued call's argument storage.
+    QElapsedTimer timer;
+    timer.start();
+    {
+        AllocationCounter counter;
+        for (int i = 0; i < shapes; ++i) {
+            if (i % 2 == 0) {
+                auto request = std::make_unique<LineData>();
+                fillLine(*request, i);
+                QMetaObject::invokeMethod(&worker, "processLine", Qt::QueuedConnection,
+                    Q_ARG(LineData, *request), Q_ARG(qint64, RpcStats::nowNs()));
+            }
+            else {
+                auto request = std::make_unique<CircleData>();
+                fillCircle(*request, i);
+                QMetaObject::invokeMethod(&worker, "processCircle", Qt::QueuedConnection,
+                    Q_ARG(CircleData, *request), Q_ARG(qint64, RpcStats::nowNs()));
+            }
+        }
+        result.heapAllocations = counter.allocations();
+        result.heapBytes = counter.bytes();
+    }
+    delivered.tryAcquire(1, DELIVERY_TIMEOUT_MS);
+    result.heapMs = timer.nsecsElapsed() / 1e6;
+    result.heapReceived = heapReceived.load();
+
+    // Arena path: shapes built in place, the batch moved to the worker and freed there in one go.
+    timer.restart();
+    {
+        AllocationCounter counter;
+        auto batch = std::make_unique<SceneBatch>();
+        for (int i = 0; i < shapes; ++i) {
+            if (i % 2 == 0) {
+                fillLine(*batch->addLine(), i);
+            }
+            else {
+                fillCircle(*batch->addCircle(), i);
+            }
+        }
+        batch->finalize();
+        // Same hand-off as FiveAxisClient::processScene, with the walk the worker does first.
+        std::shared_ptr<const SceneBatch> owned(std::move(batch));
+        QMetaObject::invokeMethod(&worker,
+            [&worker, &result, &delivered, owned, enqueuedNs = RpcStats::nowNs()]() {
+                double sum = 0.0;
+                for (const SceneShape& shape : owned->scene().shapes()) {
+                    sum += shape.has_line() ? consume(shape.line()) : consume(shape.circle());
+                    ++result.arenaReceived;
+                }
+                g_sink = sum;
+                worker.processScene(*owned, enqueuedNs);
+                delivered.release();
+            },
+            Qt::QueuedConnection);
+        result.arenaAllocations = counter.allocations();
+        result.arenaBytes = counter.bytes();
+    }
+    delivered.tryAcquire(1, DELIVERY_TIMEOUT_MS);
+    result.arenaMs = timer.nsecsElapsed() / 1e6;
+
+    workerThread.quit();
+    workerThread.wait();
+    return result;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <QtGlobal>
+
+// Builds a scene of alternating lines and circles and hands it to a FiveAxisWorker thread the two
+// ways FiveAxisClient does: the old per-shape path, a heap message per shape copied into a queued
+// processLine / processCircle call (Q_ARG), and a SceneBatch whose arena is moved to the worker
+// whole in one queued functor. The worker is not connected, so its RPCs fail at once and the
+// hand-off is what gets timed. Allocations are counted with AllocationCounter on the submitting
+// thread: the messages, the argument copies and the queued call events.
+class SceneBatchBenchmark {
+public:
+    struct Result {
+        int shapes{ 0 };
+        double heapMs{ 0.0 };
+        qint64 heapAllocations{ 0 };
+        qint64 heapBytes{ 0 };
+        double arenaMs{ 0.0 };
+        qint64 arenaAllocations{ 0 };
+        qint64 arenaBytes{ 0 };
+        // Shapes the worker thread saw on each path; both should equal shapes.
+        int heapReceived{ 0 };
+        int arenaReceived{ 0 };
+    };
+
+    static Result run(int shapes = 100000);
+};
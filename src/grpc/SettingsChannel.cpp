@@ -0,0 +1,61 @@
+#include "SettingsChannel.h"
+
+#include <QMutexLocker>
+
+bool SettingsChannel::offerDelay(const DelayData& request) {
+    QMutexLocker locker(&m_mutex);
+    bool opened = false;
+    auto& batch = openBatch(opened);
+    if (batch.delay) {
+        ++m_coalesced;
+    }
+    batch.delay = request;
+    return opened;
+}
+
+bool SettingsChannel::offerFreq(const FreqData& request) {
+    QMutexLocker locker(&m_mutex);
+    bool opened = false;
+    auto& batch = openBatch(opened);
+    if (batch.freq) {
+        ++m_coalesced;
+    }
+    batch.freq = request;
+    return opened;
+}
+
+void SettingsChannel::sealBatch() {
+    QMutexLocker locker(&m_mutex);
+    m_sealed = true;
+}
+
+SettingsChannel::Batch SettingsChannel::takeBatch() {
+    QMutexLocker locker(&m_mutex);
+    if (m_batches.isEmpty()) {
+        return Batch{};
+    }
+    if (m_batches.size() == 1) {
+        // The batch is being applied now; later updates must not merge into it.
+        m_sealed = true;
+    }
+    return m_batches.dequeue();
+}
+
+int SettingsChannel::pendingBatches() const {
+    QMutexLocker locker(&m_mutex);
+    return m_batches.size();
+}
+
+qint64 SettingsChannel::coalescedUpdates() const {
+    QMutexLocker locker(&m_mutex);
+    return m_coalesced;
+}
+
+SettingsChannel::Batch& SettingsChannel::openBatch(bool& opened) {
+    opened = m_sealed || m_batches.isEmpty();
+    if (opened) {
+        m_batches.enqueue(Batch{});
+        m_sealed = false;
+    }
+    return m_batches.last();
+}
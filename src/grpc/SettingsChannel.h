@@ -0,0 +1,39 @@
+#pragma once
+
+#include <optional>
+
+#include <QMutex>
+#include <QQueue>
+
+#include "five_axis.pb.h"
+
+// Coalesces SetDelay / SetLaserFreq updates between job submissions. Every update made
+// while no job has been queued since the last one lands in the same batch, overwriting
+// older values, so a burst of tuning collapses into one flush. Queuing a job seals the
+// open batch; settings made afterwards start a new batch that is applied after that job.
+class SettingsChannel {
+public:
+    struct Batch {
+        std::optional<DelayData> delay;
+        std::optional<FreqData> freq;
+    };
+
+    // GUI side. Return true when a new batch was opened and a flush must be scheduled.
+    bool offerDelay(const DelayData& request);
+    bool offerFreq(const FreqData& request);
+    void sealBatch();
+
+    // Worker side: oldest batch, one per scheduled flush.
+    Batch takeBatch();
+
+    int pendingBatches() const;
+    qint64 coalescedUpdates() const;
+
+private:
+    Batch& openBatch(bool& opened);
+
+    mutable QMutex m_mutex;
+    QQueue<Batch> m_batches;
+    bool m_sealed{ true };
+    qint64 m_coalesced{ 0 };
+};
@@ -0,0 +1,71 @@
+#include "SettingsChannelBenchmark.h"
+
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QTimer>
+
+#include "FiveAxisClient.h"
+
+namespace {
+    constexpr int DRAIN_TIMEOUT_MS = 30000;
+}
+
+SettingsChannelBenchmark::Result SettingsChannelBenchmark::run(int jobs, int updatesPerJob) {
+    Result result;
+    result.jobs = jobs;
+    FiveAxisClient client;
+    QEventLoop loop;
+    int jobsRun = 0;
+
+    // Worker replies are queued back to this thread; every call fails with "not connected".
+    QObject::connect(&client, &FiveAxisClient::errorReceived, &client,
+        [&](const QString& operation, int, const QString&) {
+            if (operation == QStringLiteral("ProcessLine")) {
+                if (++jobsRun == jobs) {
+                    loop.quit();
+                }
+            }
+            else {
+                ++result.settingsCalls;
+            }
+        });
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int job = 0; job < jobs; ++job) {
+        for (int update = 0; update < updatesPerJob; ++update) {
+            if (update % 2 == 0) {
+                DelayData delay;
+                delay.set_laser_on_delay(update);
+                client.setDelay(delay);
+            }
+            else {
+                FreqData freq;
+                freq.set_freq(20 + update % 50);
+                client.setLaserFreq(freq);
+            }
+            ++result.updates;
+            // Replies arrive late, so this backlog is an upper bound on the worker's.
+            const int pending = client.settings().pendingBatches();
+            const int backlog = job - jobsRun;
+            result.maxPending = qMax(result.maxPending, pending);
+            result.maxJobBacklog = qMax(result.maxJobBacklog, backlog);
+            if (pending > backlog + 1) {
+                ++result.violations;
+            }
+        }
+        // Queuing the job seals the batch its settings went into.
+        LineData line;
+        line.set_x2(job);
+        client.processLine(line);
+        loop.processEvents();
+    }
+    if (jobsRun < jobs) {
+        QTimer::singleShot(DRAIN_TIMEOUT_MS, &loop, &QEventLoop::quit);
+        loop.exec();
+    }
+    result.ms = timer.nsecsElapsed() / 1e6;
+    result.drained = jobsRun == jobs && client.settings().pendingBatches() == 0;
+    result.coalesced = client.settings().coalescedUpdates();
+    return result;
+}
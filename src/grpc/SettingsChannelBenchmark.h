@@ -0,0 +1,33 @@
+#pragma once
+
+#include <QtGlobal>
+
+// Bursty tuning through a real FiveAxisClient: every job submission is preceded by a burst of
+// SetDelay / SetLaserFreq updates, which go through the client's SettingsChannel and its queued
+// flushes to the FiveAxisWorker thread like the GUI's do. The client is not connected, so each
+// RPC fails at once and the worker's pace is that of the hand-off itself. However far the worker
+// falls behind, the pending batches must never exceed the jobs it has not run yet plus one.
+class SettingsChannelBenchmark {
+public:
+    struct Result {
+        int jobs{ 0 };
+        qint64 updates{ 0 };
+        qint64 coalesced{ 0 };
+        // SetDelay / SetLaserFreq calls that reached the worker.
+        int settingsCalls{ 0 };
+        int maxPending{ 0 };
+        int maxJobBacklog{ 0 };
+        // Samples where more batches were pending than the job backlog allows.
+        int violations{ 0 };
+        // The worker ran every job and took every batch before the timeout.
+        bool drained{ false };
+        double ms{ 0.0 };
+
+        bool bounded() const {
+            return violations == 0 && drained;
+        }
+    };
+
+    // Creates its own client and worker thread; call from a thread that may run an event loop.
+    static Result run(int jobs = 1000, int updatesPerJob = 100);
+};
@@ -1,9 +1,34 @@
+#include <cstring>
+
 #include <QApplication>
+#include <QElapsedTimer>
 
+#include "HeadlessRunner.h"
 #include "MainWindow.h"
+#include "daemon/StreamDaemon.h"
 
 int main(int argc, char *argv[])
 {
+    QElapsedTimer processClock;
+    processClock.start();
+
+    // Decide before any QApplication exists so headless runs never touch widgets or OpenGL.
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--headless") == 0)
+        {
+            return runHeadless(argc, argv, processClock);
+        }
+        if (std::strcmp(argv[i], "--stream-daemon") == 0)
+        {
+            return runStreamDaemon(argc, argv);
+        }
+        if (std::strcmp(argv[i], "--daemon-request") == 0)
+        {
+            return runDaemonRequest(argc, argv);
+        }
+    }
+
     QApplication app(argc, argv);
 
     MainWindow window;
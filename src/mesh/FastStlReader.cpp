@@ -0,0 +1,91 @@
+#include "FastStlReader.h"
+
+#include <cstring>
+#include <limits>
+
+#include <vtkCellArray.h>
+#include <vtkFloatArray.h>
+#include <vtkInformationVector.h>
+#include <vtkObjectFactory.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkTypeInt32Array.h>
+
+vtkStandardNewMacro(FastStlReader);
+
+FastStlReader::FastStlReader() {
+    SetNumberOfInputPorts(0);
+}
+
+void FastStlReader::setFileName(const QString& filePath) {
+    if (m_fileName != filePath) {
+        m_fileName = filePath;
+        Modified();
+    }
+}
+
+void FastStlReader::setWeldTolerance(double tolerance) {
+    if (m_options.weldTolerance != tolerance) {
+        m_options.weldTolerance = tolerance;
+        Modified();
+    }
+}
+
+const QString& FastStlReader::lastError() const {
+    return m_lastError;
+}
+
+const StlMesh& FastStlReader::lastMesh() const {
+    return m_lastMesh;
+}
+
+vtkSmartPointer<vtkPolyData> FastStlReader::toPolyData(StlMesh& mesh) {
+    auto coordinates = vtkSmartPointer<vtkFloatArray>::New();
+    coordinates->SetNumberOfComponents(3);
+    coordinates->SetNumberOfTuples(mesh.vertexCount());
+    std::memcpy(coordinates->GetPointer(0), mesh.points.data(), mesh.points.size() * sizeof(float));
+    std::vector<float>().swap(mesh.points);
+    auto points = vtkSmartPointer<vtkPoints>::New();
+    points->SetData(coordinates);
+
+    // StlParser caps the corner count at INT32_MAX, so 32-bit cell storage always fits.
+    const vtkIdType triangles = mesh.triangleCount();
+    auto offsets = vtkSmartPointer<vtkTypeInt32Array>::New();
+    offsets->SetNumberOfValues(triangles + 1);
+    qint32* offset = offsets->GetPointer(0);
+    for (vtkIdType i = 0; i <= triangles; ++i) {
+        offset[i] = static_cast<qint32>(i * 3);
+    }
+    auto connectivity = vtkSmartPointer<vtkTypeInt32Array>::New();
+    connectivity->SetNumberOfValues(triangles * 3);
+    std::memcpy(connectivity->GetPointer(0), mesh.triangles.data(), mesh.triangles.size() * sizeof(qint32));
+    std::vector<qint32>().swap(mesh.triangles);
+    auto cells = vtkSmartPointer<vtkCellArray>::New();
+    cells->SetData(offsets, connectivity);
+
+    auto polyData = vtkSmartPointer<vtkPolyData>::New();
+    polyData->SetPoints(points);
+    polyData->SetPolys(cells);
+    return polyData;
+}
+
+int FastStlReader::RequestData(vtkInformation* request, vtkInformationVector** inputVector,
+    vtkInformationVector* outputVector) {
+    Q_UNUSED(request);
+    Q_UNUSED(inputVector);
+    m_lastError.clear();
+    StlMesh mesh;
+    const bool ok = StlParser::parse(m_fileName, mesh, m_lastError, m_options, [this](double fraction) {
+        UpdateProgress(fraction);
+        return !GetAbortExecute();
+        });
+    if (!ok) {
+        if (!GetAbortExecute()) {
+            vtkErrorMacro(<< "cannot read " << m_fileName.toStdString() << ": " << m_lastError.toStdString());
+        }
+        return 0;
+    }
+    vtkPolyData::GetData(outputVector)->ShallowCopy(toPolyData(mesh));
+    m_lastMesh = std::move(mesh);
+    return 1;
+}
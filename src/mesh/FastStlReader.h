@@ -0,0 +1,42 @@
+#pragma once
+
+#include <QString>
+
+#include <vtkPolyDataAlgorithm.h>
+#include <vtkSmartPointer.h>
+
+#include "mesh/StlParser.h"
+
+// Drop-in replacement for vtkSTLReader built on StlParser: reads binary and ASCII STL through
+// a mapped file on all cores and outputs indexed triangles (shared vertices, 32-bit cell
+// storage) instead of triangle soup. Reports ProgressEvent and honours AbortExecute.
+class FastStlReader : public vtkPolyDataAlgorithm {
+public:
+    static FastStlReader* New();
+    vtkTypeMacro(FastStlReader, vtkPolyDataAlgorithm);
+
+    void setFileName(const QString& filePath);
+    void setWeldTolerance(double tolerance);
+    const QString& lastError() const;
+    // Counters from the last successful read.
+    const StlMesh& lastMesh() const;
+
+    // Moves the mesh into a vtkPolyData; mesh.points and mesh.triangles are released.
+    static vtkSmartPointer<vtkPolyData> toPolyData(StlMesh& mesh);
+
+protected:
+    FastStlReader();
+    ~FastStlReader() override = default;
+
+    int RequestData(vtkInformation* request, vtkInformationVector** inputVector,
+        vtkInformationVector* outputVector) override;
+
+private:
+    FastStlReader(const FastStlReader&) = delete;
+    void operator=(const FastStlReader&) = delete;
+
+    QString m_fileName;
+    StlParser::Options m_options;
+    QString m_lastError;
+    StlMesh m_lastMesh;
+};
@@ -0,0 +1,151 @@
+#include "MeshLod.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QStandardPaths>
+
+#include <vtkCallbackCommand.h>
+#include <vtkCellArray.h>
+#include <vtkCommand.h>
+#include <vtkNew.h>
+#include <vtkPolyData.h>
+#include <vtkQuadricDecimation.h>
+#include <vtkSTLWriter.h>
+#include <vtkTriangleFilter.h>
+
+#include "mesh/FastStlReader.h"
+#include "mesh/StlParser.h"
+
+namespace {
+    // Fractions of the full triangle count; each level is decimated from the one before it.
+    constexpr double LEVEL_KEEP[] = { 0.25, 0.08, 0.02 };
+    constexpr qint64 MIN_LEVEL_TRIANGLES = 20000;
+    // Bump when the decimation settings change so stale cache entries are not picked up.
+    constexpr int CACHE_VERSION = 1;
+    constexpr qint64 HASH_BLOCK = 64 * 1024 * 1024;
+
+    void abortOnCancel(vtkObject* caller, unsigned long eventId, void* clientData, void* callData) {
+        Q_UNUSED(eventId);
+        Q_UNUSED(callData);
+        if (static_cast<const std::atomic<bool>*>(clientData)->load()) {
+            static_cast<vtkAlgorithm*>(caller)->SetAbortExecute(1);
+        }
+    }
+
+    QString levelPath(const QByteArray& key, double keep) {
+        return QDir(MeshLod::cacheDirectory()).filePath(QStringLiteral("%1_v%2_%3.stl")
+            .arg(QString::fromLatin1(key)).arg(CACHE_VERSION).arg(qRound(keep * 1000)));
+    }
+
+    vtkSmartPointer<vtkPolyData> readLevel(const QString& path) {
+        StlMesh mesh;
+        QString error;
+        if (!StlParser::parse(path, mesh, error)) {
+            return nullptr;
+        }
+        return FastStlReader::toPolyData(mesh);
+    }
+
+    bool writeLevel(const QString& path, vtkPolyData* level) {
+        // Write next to the final name and rename, so a crash never leaves a truncated entry.
+        const QString temporary = path + QStringLiteral(".part");
+        auto writer = vtkSmartPointer<vtkSTLWriter>::New();
+        writer->SetInputData(level);
+        writer->SetFileTypeToBinary();
+        writer->SetFileName(QFile::encodeName(temporary).constData());
+        if (writer->Write() != 1) {
+            QFile::remove(temporary);
+            return false;
+        }
+        QFile::remove(path);
+        return QFile::rename(temporary, path);
+    }
+}
+
+QString MeshLod::cacheDirectory() {
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).filePath(QStringLiteral("mesh-lod"));
+}
+
+QByteArray MeshLod::fileKey(const QString& path, QString& error) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = file.errorString();
+        return {};
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    const qint64 size = file.size();
+    if (const uchar* data = file.map(0, size)) {
+        for (qint64 offset = 0; offset < size; offset += HASH_BLOCK) {
+            hash.addData(QByteArrayView(data + offset, qMin(HASH_BLOCK, size - offset)));
+        }
+    }
+    else if (!hash.addData(&file)) {
+        error = file.errorString();
+        return {};
+    }
+    return hash.result().toHex();
+}
+
+MeshLod::Result MeshLod::build(const QString& sourcePath, vtkPolyData* full, const std::atomic<bool>& cancel) {
+    Result result;
+    const qint64 triangles = full->GetNumberOfPolys();
+    if (triangles < MIN_TRIANGLES) {
+        return result;
+    }
+    const QByteArray key = fileKey(sourcePath, result.error);
+    if (key.isEmpty()) {
+        return result;
+    }
+    QDir().mkpath(cacheDirectory());
+
+    // Quadric decimation only takes triangles; OBJ files may carry quads or larger polygons.
+    vtkSmartPointer<vtkPolyData> previous = vtkSmartPointer<vtkPolyData>::New();
+    previous->ShallowCopy(full);
+    if (full->GetPolys()->IsHomogeneous() != 3) {
+        auto triangulate = vtkSmartPointer<vtkTriangleFilter>::New();
+        triangulate->SetInputData(previous);
+        triangulate->Update();
+        previous = vtkSmartPointer<vtkPolyData>::New();
+        previous->ShallowCopy(triangulate->GetOutput());
+    }
+
+    vtkNew<vtkCallbackCommand> observer;
+    observer->SetCallback(&abortOnCancel);
+    observer->SetClientData(const_cast<std::atomic<bool>*>(&cancel));
+
+    double previousKeep = 1.0;
+    bool decimated = false;
+    for (const double keep : LEVEL_KEEP) {
+        if (triangles * keep < MIN_LEVEL_TRIANGLES || cancel.load()) {
+            break;
+        }
+        const QString path = levelPath(key, keep);
+        vtkSmartPointer<vtkPolyData> level = readLevel(path);
+        if (!level) {
+            auto decimate = vtkSmartPointer<vtkQuadricDecimation>::New();
+            decimate->SetInputData(previous);
+            decimate->SetTargetReduction(1.0 - keep / previousKeep);
+            decimate->VolumePreservationOn();
+            decimate->AddObserver(vtkCommand::ProgressEvent, observer);
+            decimate->Update();
+            if (cancel.load()) {
+                break;
+            }
+            level = vtkSmartPointer<vtkPolyData>::New();
+            level->ShallowCopy(decimate->GetOutput());
+            if (!writeLevel(path, level)) {
+                result.error = QStringLiteral("cannot write %1").arg(path);
+            }
+            decimated = true;
+        }
+        result.levels.push_back(level);
+        previous = level;
+        previousKeep = keep;
+    }
+    if (cancel.load()) {
+        result.levels.clear();
+    }
+    result.fromCache = !result.levels.empty() && !decimated;
+    return result;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include <QByteArray>
+#include <QString>
+
+#include <vtkSmartPointer.h>
+
+class vtkPolyData;
+
+// Coarser versions of a mesh for interactive rendering, built with quadric decimation and
+// cached on disk as binary STL under the file's content hash, so re-opening the same part
+// reads the levels back instead of decimating again.
+class MeshLod {
+public:
+    using Levels = std::vector<vtkSmartPointer<vtkPolyData>>;
+
+    // Meshes with fewer triangles render fast enough on their own.
+    static constexpr qint64 MIN_TRIANGLES = 200000;
+
+    struct Result {
+        Levels levels;  // finest first, full resolution excluded
+        bool fromCache{ false };
+        QString error;
+    };
+
+    // Runs on a worker thread; returns no levels when cancelled or when full is too small.
+    static Result build(const QString& sourcePath, vtkPolyData* full, const std::atomic<bool>& cancel);
+
+    static QString cacheDirectory();
+    // Hex SHA-1 of the file contents.
+    static QByteArray fileKey(const QString& path, QString& error);
+};
@@ -0,0 +1,279 @@
+#include "MeshSlicer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <unordered_map>
+
+#include <QElapsedTimer>
+#include <QThread>
+#include <QThreadPool>
+
+#include "mesh/StlParser.h"
+
+namespace {
+    using mesh::runParallel;
+
+    constexpr qint64 MIN_CHUNK_TRIANGLES = 1 << 16;
+    constexpr int LAYERS_PER_TASK = 4;
+
+    struct Segment {
+        quint64 startEdge;
+        quint64 endEdge;
+        QPointF start;
+    };
+
+    quint64 edgeKey(qint32 a, qint32 b) {
+        const auto lo = static_cast<quint64>(static_cast<quint32>(qMin(a, b)));
+        const auto hi = static_cast<quint64>(static_cast<quint32>(qMax(a, b)));
+        return (lo << 32) | hi;
+    }
+
+    // Always interpolates from the vertex below to the one above, so the two triangles
+    // sharing an edge compute bit-identical points.
+    QPointF crossing(const float* points, qint32 below, qint32 above, double z) {
+        const float* p = points + below * 3;
+        const float* q = points + above * 3;
+        const double t = (z - p[2]) / (static_cast<double>(q[2]) - p[2]);
+        return QPointF(p[0] + t * (q[0] - p[0]), p[1] + t * (q[1] - p[1]));
+    }
+
+    void intersect(const StlMesh& mesh, const quint32* bucket, qint64 count, double z, std::vector<Segment>& segments) {
+        const float* points = mesh.points.data();
+        for (qint64 i = 0; i < count; ++i) {
+            const qint32* v = mesh.triangles.data() + static_cast<qint64>(bucket[i]) * 3;
+            qint32 upBelow = -1;
+            qint32 upAbove = -1;
+            qint32 downAbove = -1;
+            qint32 downBelow = -1;
+            for (int k = 0; k < 3; ++k) {
+                const qint32 from = v[k];
+                const qint32 to = v[(k + 1) % 3];
+                const bool fromAbove = points[from * 3 + 2] >= z;
+                const bool toAbove = points[to * 3 + 2] >= z;
+                if (!fromAbove && toAbove) {
+                    upBelow = from;
+                    upAbove = to;
+                }
+                else if (fromAbove && !toAbove) {
+                    downAbove = from;
+                    downBelow = to;
+                }
+            }
+            if (upBelow < 0 || downBelow < 0) {
+                continue;
+            }
+            // Seen from +Z with outward normals, the cut runs from the falling edge to the rising
+            // one, which makes outer boundaries counter-clockwise.
+            segments.push_back(Segment{ edgeKey(downAbove, downBelow), edgeKey(upBelow, upAbove),
+                crossing(points, downBelow, downAbove, z) });
+        }
+    }
+
+    void stitch(const std::vector<Segment>& segments, SliceLayer& layer) {
+        std::unordered_map<quint64, qint32> byStart;
+        byStart.reserve(segments.size());
+        for (size_t i = 0; i < segments.size(); ++i) {
+            byStart.emplace(segments[i].startEdge, static_cast<qint32>(i));
+        }
+        const auto next = [&](size_t i) {
+            const auto it = byStart.find(segments[i].endEdge);
+            return it == byStart.end() ? -1 : it->second;
+        };
+        std::vector<char> hasPredecessor(segments.size(), 0);
+        for (size_t i = 0; i < segments.size(); ++i) {
+            const qint32 n = next(i);
+            if (n >= 0) {
+                hasPredecessor[n] = 1;
+            }
+        }
+
+        std::vector<char> visited(segments.size(), 0);
+        const auto walk = [&](size_t first) {
+            QPolygonF contour;
+            qint32 current = static_cast<qint32>(first);
+            bool closed = false;
+            while (current >= 0 && !visited[current]) {
+                visited[current] = 1;
+                // Cuts through a vertex on the layer give zero-length segments; keep one point.
+                const QPointF& point = segments[current].start;
+                if (contour.isEmpty() || contour.last() != point) {
+                    contour.append(point);
+                }
+                current = next(current);
+                closed = current == static_cast<qint32>(first);
+            }
+            if (!closed) {
+                ++layer.openChains;
+                return;
+            }
+            if (contour.size() > 1 && contour.first() == contour.last()) {
+                contour.removeLast();
+            }
+            if (contour.size() >= 3) {
+                layer.contours.append(contour);
+            }
+        };
+        // Open chains first from their heads, so each is counted once; whatever is left is loops.
+        for (size_t i = 0; i < segments.size(); ++i) {
+            if (!hasPredecessor[i] && !visited[i]) {
+                walk(i);
+            }
+        }
+        for (size_t i = 0; i < segments.size(); ++i) {
+            if (!visited[i]) {
+                walk(i);
+            }
+        }
+    }
+}
+
+std::vector<double> MeshSlicer::layerHeights(double zStart, double zEnd, double zInterval) {
+    std::vector<double> heights;
+    const double step = std::abs(zInterval);
+    if (step <= 0.0) {
+        heights.push_back(zStart);
+        return heights;
+    }
+    // Allow a little slack so rounding does not drop the final layer.
+    const auto count = static_cast<qint64>(std::floor(std::abs(zEnd - zStart) / step + 1e-9)) + 1;
+    const double direction = zEnd >= zStart ? 1.0 : -1.0;
+    heights.reserve(static_cast<size_t>(count));
+    for (qint64 i = 0; i < count; ++i) {
+        heights.push_back(zStart + direction * step * i);
+    }
+    return heights;
+}
+
+double MeshSlicer::signedArea(const QPolygonF& contour) {
+    double area = 0.0;
+    for (int i = 0, n = contour.size(); i < n; ++i) {
+        const QPointF& a = contour[i];
+        const QPointF& b = contour[(i + 1) % n];
+        area += a.x() * b.y() - b.x() * a.y();
+    }
+    return area / 2.0;
+}
+
+bool MeshSlicer::slice(const StlMesh& mesh, const std::vector<double>& heights, std::vector<SliceLayer>& layers,
+    Stats* stats, const mesh::Progress& progress, int threads) {
+    QElapsedTimer timer;
+    timer.start();
+    layers.assign(heights.size(), SliceLayer());
+    const qint64 layerCount = static_cast<qint64>(heights.size());
+    const qint64 triangleCount = mesh.triangleCount();
+    if (layerCount == 0 || triangleCount == 0) {
+        return true;
+    }
+
+    // Work on ascending heights; order[i] is the caller's index of sorted layer i.
+    std::vector<qint64> order(static_cast<size_t>(layerCount));
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](qint64 a, qint64 b) { return heights[a] < heights[b]; });
+    std::vector<double> sorted(static_cast<size_t>(layerCount));
+    for (qint64 i = 0; i < layerCount; ++i) {
+        sorted[i] = heights[order[i]];
+        layers[order[i]].z = sorted[i];
+    }
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(threads > 0 ? threads : QThread::idealThreadCount());
+    std::atomic<bool> cancelled{ false };
+
+    // 1. Counting sort of triangles into every layer they cross (zmin < z <= zmax).
+    const int chunks = static_cast<int>(qBound<qint64>(1, triangleCount / MIN_CHUNK_TRIANGLES,
+        pool.maxThreadCount() * 2));
+    std::vector<qint64> chunkBegin(chunks + 1);
+    for (int c = 0; c <= chunks; ++c) {
+        chunkBegin[c] = triangleCount * c / chunks;
+    }
+    std::vector<qint32> firstLayer(static_cast<size_t>(triangleCount));
+    std::vector<qint32> lastLayer(static_cast<size_t>(triangleCount));
+    std::vector<std::vector<qint64>> chunkCounts(chunks);
+    const auto count = [&](int c) {
+        std::vector<qint64>& counts = chunkCounts[c];
+        counts.assign(static_cast<size_t>(layerCount + 1), 0);
+        const float* points = mesh.points.data();
+        for (qint64 t = chunkBegin[c]; t < chunkBegin[c + 1]; ++t) {
+            const qint32* v = mesh.triangles.data() + t * 3;
+            const float z0 = points[v[0] * 3 + 2];
+            const float z1 = points[v[1] * 3 + 2];
+            const float z2 = points[v[2] * 3 + 2];
+            const double zMin = std::min({ z0, z1, z2 });
+            const double zMax = std::max({ z0, z1, z2 });
+            const auto first = static_cast<qint32>(std::upper_bound(sorted.begin(), sorted.end(), zMin) - sorted.begin());
+            const auto last = static_cast<qint32>(std::upper_bound(sorted.begin(), sorted.end(), zMax) - sorted.begin()) - 1;
+            firstLayer[t] = first;
+            lastLayer[t] = last;
+            if (first <= last) {
+                ++counts[first];
+                --counts[last + 1];
+            }
+        }
+        for (qint64 l = 1; l <= layerCount; ++l) {
+            counts[l] += counts[l - 1];
+        }
+    };
+    if (!runParallel(pool, chunks, count, 0.0, 0.1, progress, cancelled)) {
+        return false;
+    }
+
+    // Each chunk writes its slice of every bucket at a fixed cursor, so buckets stay in triangle order.
+    std::vector<qint64> bucketBegin(static_cast<size_t>(layerCount + 1), 0);
+    for (qint64 l = 0; l < layerCount; ++l) {
+        qint64 offset = bucketBegin[l];
+        for (int c = 0; c < chunks; ++c) {
+            const qint64 n = chunkCounts[c][l];
+            chunkCounts[c][l] = offset;
+            offset += n;
+        }
+        bucketBegin[l + 1] = offset;
+    }
+    std::vector<quint32> buckets(static_cast<size_t>(bucketBegin[layerCount]));
+    const auto fill = [&](int c) {
+        std::vector<qint64>& cursor = chunkCounts[c];
+        for (qint64 t = chunkBegin[c]; t < chunkBegin[c + 1]; ++t) {
+            for (qint32 l = firstLayer[t]; l <= lastLayer[t]; ++l) {
+                buckets[cursor[l]++] = static_cast<quint32>(t);
+            }
+        }
+    };
+    if (!runParallel(pool, chunks, fill, 0.1, 0.2, progress, cancelled)) {
+        return false;
+    }
+    std::vector<qint32>().swap(firstLayer);
+    std::vector<qint32>().swap(lastLayer);
+    std::vector<std::vector<qint64>>().swap(chunkCounts);
+    const double bucketMs = timer.nsecsElapsed() / 1e6;
+
+    // 2. Intersect and stitch layers in parallel; each task reuses one segment buffer.
+    const int tasks = static_cast<int>((layerCount + LAYERS_PER_TASK - 1) / LAYERS_PER_TASK);
+    const auto sliceLayers = [&](int task) {
+        std::vector<Segment> segments;
+        const qint64 end = qMin(layerCount, static_cast<qint64>(task + 1) * LAYERS_PER_TASK);
+        for (qint64 l = static_cast<qint64>(task) * LAYERS_PER_TASK; l < end; ++l) {
+            if (cancelled.load(std::memory_order_relaxed)) {
+                return;
+            }
+            segments.clear();
+            intersect(mesh, buckets.data() + bucketBegin[l], bucketBegin[l + 1] - bucketBegin[l], sorted[l], segments);
+            stitch(segments, layers[order[l]]);
+        }
+    };
+    if (!runParallel(pool, tasks, sliceLayers, 0.2, 1.0, progress, cancelled)) {
+        return false;
+    }
+
+    if (stats) {
+        stats->segments = bucketBegin[layerCount];
+        stats->contours = 0;
+        stats->openChains = 0;
+        for (const SliceLayer& layer : layers) {
+            stats->contours += layer.contours.size();
+            stats->openChains += layer.openChains;
+        }
+        stats->bucketMs = bucketMs;
+        stats->sliceMs = timer.nsecsElapsed() / 1e6 - bucketMs;
+    }
+    return true;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vector>
+
+#include <QList>
+#include <QPolygonF>
+
+#include "mesh/Parallel.h"
+
+struct StlMesh;
+
+struct SliceLayer {
+    double z{ 0.0 };
+    // Closed, without repeating the first point; outer boundaries counter-clockwise, holes clockwise.
+    QList<QPolygonF> contours;
+    // Chains that did not close, i.e. the mesh is not watertight at this height.
+    int openChains{ 0 };
+};
+
+// Cuts an indexed mesh into Z layers for the contour generator. Triangles are bucketed per
+// layer with a parallel counting sort, layers are intersected in parallel, and segments are
+// stitched through a hash map keyed on the mesh edge they cross, so stitching is exact and
+// never compares floating-point coordinates. A vertex lying exactly on a layer counts as
+// above it, which keeps the cut consistent across neighbouring triangles.
+class MeshSlicer {
+public:
+    struct Stats {
+        qint64 segments{ 0 };
+        qint64 contours{ 0 };
+        qint64 openChains{ 0 };
+        double bucketMs{ 0.0 };
+        double sliceMs{ 0.0 };
+    };
+
+    // Heights from zStart towards zEnd in steps of |zInterval|, both ends included.
+    static std::vector<double> layerHeights(double zStart, double zEnd, double zInterval);
+
+    // Layers come back in the order of heights; false when cancelled through progress.
+    static bool slice(const StlMesh& mesh, const std::vector<double>& heights, std::vector<SliceLayer>& layers,
+        Stats* stats = nullptr, const mesh::Progress& progress = {}, int threads = 0);
+
+    static double signedArea(const QPolygonF& contour);
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+
+#include <QThreadPool>
+
+namespace mesh {
+    // Called from the coordinating thread with a fraction in [0, 1]; returning false cancels.
+    using Progress = std::function<bool(double)>;
+
+    // Runs task(0..count-1) on the pool and reports progress from the calling thread until
+    // all are done. Tasks are expected to poll cancelled in their inner loops.
+    template <typename Task>
+    bool runParallel(QThreadPool& pool, int count, const Task& task, double from, double to, const Progress& progress,
+        std::atomic<bool>& cancelled) {
+        constexpr int PROGRESS_POLL_MS = 30;
+        std::atomic<int> done{ 0 };
+        for (int i = 0; i < count; ++i) {
+            pool.start([&task, &done, &cancelled, i]() {
+                if (!cancelled.load(std::memory_order_relaxed)) {
+                    task(i);
+                }
+                done.fetch_add(1);
+                });
+        }
+        while (!pool.waitForDone(PROGRESS_POLL_MS)) {
+            if (progress && !progress(from + (to - from) * done.load() / count)) {
+                cancelled.store(true);
+            }
+        }
+        if (progress && !cancelled.load() && !progress(to)) {
+            cancelled.store(true);
+        }
+        return !cancelled.load();
+    }
+}
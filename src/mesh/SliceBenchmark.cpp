@@ -0,0 +1,216 @@
+#include "SliceBenchmark.h"
+
+#include <cmath>
+
+#include "mesh/MeshSlicer.h"
+#include "mesh/StlParser.h"
+
+namespace {
+    constexpr double PI = 3.14159265358979323846;
+    // Sphere layers closer to the poles than this are left out of the area check, where the
+    // faceting error relative to the small true area grows without bound.
+    constexpr double SPHERE_CHECK_RANGE = 0.8;
+
+    void addVertex(StlMesh& mesh, double x, double y, double z) {
+        mesh.points.push_back(static_cast<float>(x));
+        mesh.points.push_back(static_cast<float>(y));
+        mesh.points.push_back(static_cast<float>(z));
+    }
+
+    void addTriangle(StlMesh& mesh, qint32 a, qint32 b, qint32 c) {
+        mesh.triangles.push_back(a);
+        mesh.triangles.push_back(b);
+        mesh.triangles.push_back(c);
+    }
+
+    // Quad a-b-c-d, counter-clockwise seen from outside.
+    void addQuad(StlMesh& mesh, qint32 a, qint32 b, qint32 c, qint32 d) {
+        addTriangle(mesh, a, b, c);
+        addTriangle(mesh, a, c, d);
+    }
+
+    void finish(StlMesh& mesh) {
+        mesh.sourceTriangles = mesh.triangleCount();
+    }
+
+    // Area of the regular polygon a tessellated circle of this radius degenerates to.
+    double polygonArea(double radius, int sides) {
+        return 0.5 * sides * radius * radius * std::sin(2.0 * PI / sides);
+    }
+
+    void check(QStringList& failures, bool ok, const QString& what) {
+        if (!ok) {
+            failures.append(what);
+        }
+    }
+
+    // Sphere cross-sections lie between the inscribed polygon of the ring below and the
+    // circle itself; both bound the area from the true value down.
+    void checkSphereLayer(QStringList& failures, const SliceLayer& layer, double radius, int rings, int sectors) {
+        const double trueRadius = std::sqrt(qMax(0.0, radius * radius - layer.z * layer.z));
+        const double ringStep = PI / rings;
+        const double chordDepth = 1.0 - std::cos(ringStep / 2.0);
+        const double lower = polygonArea(trueRadius, sectors) * (1.0 - 4.0 * chordDepth * radius / qMax(trueRadius, 1e-12));
+        const double upper = PI * trueRadius * trueRadius;
+        const QString where = QStringLiteral("sphere z=%1").arg(layer.z);
+        check(failures, layer.contours.size() == 1 && layer.openChains == 0,
+            QStringLiteral("%1: %2 contours, %3 open chains").arg(where).arg(layer.contours.size()).arg(layer.openChains));
+        if (layer.contours.size() == 1) {
+            const double area = MeshSlicer::signedArea(layer.contours.first());
+            check(failures, area >= lower * (1.0 - 1e-6) && area <= upper * (1.0 + 1e-6),
+                QStringLiteral("%1: area %2 outside [%3, %4]").arg(where).arg(area).arg(lower).arg(upper));
+        }
+    }
+}
+
+StlMesh SliceBenchmark::makeBox(double halfSize) {
+    StlMesh mesh;
+    const double h = halfSize;
+    for (int i = 0; i < 8; ++i) {
+        addVertex(mesh, (i & 1) ? h : -h, (i & 2) ? h : -h, (i & 4) ? h : -h);
+    }
+    addQuad(mesh, 0, 2, 3, 1);  // -Z
+    addQuad(mesh, 4, 5, 7, 6);  // +Z
+    addQuad(mesh, 0, 1, 5, 4);  // -Y
+    addQuad(mesh, 2, 6, 7, 3);  // +Y
+    addQuad(mesh, 0, 4, 6, 2);  // -X
+    addQuad(mesh, 1, 3, 7, 5);  // +X
+    finish(mesh);
+    return mesh;
+}
+
+StlMesh SliceBenchmark::makeSphere(double radius, int rings, int sectors) {
+    StlMesh mesh;
+    addVertex(mesh, 0.0, 0.0, -radius);
+    for (int r = 1; r < rings; ++r) {
+        const double polar = PI * r / rings;
+        const double z = -radius * std::cos(polar);
+        const double ringRadius = radius * std::sin(polar);
+        for (int s = 0; s < sectors; ++s) {
+            const double azimuth = 2.0 * PI * s / sectors;
+            addVertex(mesh, ringRadius * std::cos(azimuth), ringRadius * std::sin(azimuth), z);
+        }
+    }
+    addVertex(mesh, 0.0, 0.0, radius);
+    const auto ring = [sectors](int r, int s) {
+        return static_cast<qint32>(1 + (r - 1) * sectors + (s % sectors));
+    };
+    const auto top = static_cast<qint32>(mesh.vertexCount() - 1);
+    for (int s = 0; s < sectors; ++s) {
+        addTriangle(mesh, 0, ring(1, s + 1), ring(1, s));
+        for (int r = 1; r < rings - 1; ++r) {
+            addQuad(mesh, ring(r, s), ring(r, s + 1), ring(r + 1, s + 1), ring(r + 1, s));
+        }
+        addTriangle(mesh, top, ring(rings - 1, s), ring(rings - 1, s + 1));
+    }
+    finish(mesh);
+    return mesh;
+}
+
+StlMesh SliceBenchmark::makeTorus(double majorRadius, double minorRadius, int majorSegments, int minorSegments) {
+    StlMesh mesh;
+    for (int u = 0; u < majorSegments; ++u) {
+        const double a = 2.0 * PI * u / majorSegments;
+        for (int v = 0; v < minorSegments; ++v) {
+            const double b = 2.0 * PI * v / minorSegments;
+            const double r = majorRadius + minorRadius * std::cos(b);
+            addVertex(mesh, r * std::cos(a), r * std::sin(a), minorRadius * std::sin(b));
+        }
+    }
+    const auto at = [majorSegments, minorSegments](int u, int v) {
+        return static_cast<qint32>((u % majorSegments) * minorSegments + (v % minorSegments));
+    };
+    for (int u = 0; u < majorSegments; ++u) {
+        for (int v = 0; v < minorSegments; ++v) {
+            addQuad(mesh, at(u, v), at(u + 1, v), at(u + 1, v + 1), at(u, v + 1));
+        }
+    }
+    finish(mesh);
+    return mesh;
+}
+
+QStringList SliceBenchmark::verifyAnalyticSolids() {
+    QStringList failures;
+    std::vector<SliceLayer> layers;
+
+    // Box: every section is the full square. A vertex on the layer counts as above it, so the
+    // layer through the top face still cuts the sides and the one through the bottom face does not.
+    const StlMesh box = makeBox(1.0);
+    MeshSlicer::slice(box, MeshSlicer::layerHeights(-1.0, 1.0, 0.25), layers);
+    for (const SliceLayer& layer : layers) {
+        const bool inside = layer.z > -1.0;
+        const QString where = QStringLiteral("box z=%1").arg(layer.z);
+        check(failures, layer.openChains == 0, QStringLiteral("%1: open chains").arg(where));
+        check(failures, layer.contours.size() == (inside ? 1 : 0),
+            QStringLiteral("%1: %2 contours").arg(where).arg(layer.contours.size()));
+        if (inside && layer.contours.size() == 1) {
+            const double area = MeshSlicer::signedArea(layer.contours.first());
+            check(failures, std::abs(area - 4.0) < 1e-9, QStringLiteral("%1: area %2, expected 4").arg(where).arg(area));
+        }
+    }
+
+    // Sphere, including the layers near the poles for topology.
+    const int rings = 64;
+    const int sectors = 128;
+    const StlMesh sphere = makeSphere(10.0, rings, sectors);
+    MeshSlicer::slice(sphere, MeshSlicer::layerHeights(-9.95, 9.95, 0.1), layers);
+    for (const SliceLayer& layer : layers) {
+        if (std::abs(layer.z) <= SPHERE_CHECK_RANGE * 10.0) {
+            checkSphereLayer(failures, layer, 10.0, rings, sectors);
+        }
+        else {
+            check(failures, layer.contours.size() == 1 && layer.openChains == 0,
+                QStringLiteral("sphere z=%1: %2 contours").arg(layer.z).arg(layer.contours.size()));
+        }
+    }
+
+    // Torus through its equator: outer boundary counter-clockwise, hole clockwise.
+    const int majorSegments = 256;
+    const StlMesh torus = makeTorus(3.0, 1.0, majorSegments, 64);
+    MeshSlicer::slice(torus, { 0.0 }, layers);
+    const SliceLayer& equator = layers.front();
+    check(failures, equator.contours.size() == 2 && equator.openChains == 0,
+        QStringLiteral("torus z=0: %1 contours, %2 open chains").arg(equator.contours.size()).arg(equator.openChains));
+    if (equator.contours.size() == 2) {
+        double outer = MeshSlicer::signedArea(equator.contours[0]);
+        double inner = MeshSlicer::signedArea(equator.contours[1]);
+        if (outer < inner) {
+            std::swap(outer, inner);
+        }
+        const double expectedOuter = polygonArea(4.0, majorSegments);
+        const double expectedInner = -polygonArea(2.0, majorSegments);
+        check(failures, std::abs(outer - expectedOuter) < 1e-4 * expectedOuter,
+            QStringLiteral("torus outer area %1, expected %2").arg(outer).arg(expectedOuter));
+        check(failures, std::abs(inner - expectedInner) < 1e-4 * -expectedInner,
+            QStringLiteral("torus hole area %1, expected %2").arg(inner).arg(expectedInner));
+    }
+    return failures;
+}
+
+SliceBenchmark::Result SliceBenchmark::run(qint64 triangles, int layers) {
+    Result result;
+    // A UV sphere has 2 * sectors * (rings - 1) triangles; keep sectors = 2 * rings.
+    const int rings = qMax(8, static_cast<int>(std::sqrt(triangles / 4.0)) + 1);
+    const int sectors = 2 * rings;
+    const double radius = 50.0;
+    const StlMesh sphere = makeSphere(radius, rings, sectors);
+    result.triangles = sphere.triangleCount();
+
+    const double step = 2.0 * radius / (layers + 1);
+    const auto heights = MeshSlicer::layerHeights(-radius + step, radius - step, step);
+    std::vector<SliceLayer> sliced;
+    MeshSlicer::Stats stats;
+    MeshSlicer::slice(sphere, heights, sliced, &stats);
+    result.layers = static_cast<qint64>(sliced.size());
+    result.segments = stats.segments;
+    result.bucketMs = stats.bucketMs;
+    result.sliceMs = stats.sliceMs;
+
+    for (const SliceLayer& layer : sliced) {
+        if (std::abs(layer.z) <= SPHERE_CHECK_RANGE * radius) {
+            checkSphereLayer(result.failures, layer, radius, rings, sectors);
+        }
+    }
+    result.failures += verifyAnalyticSolids();
+    return result;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <QStringList>
+#include <QtGlobal>
+
+struct StlMesh;
+
+// Slicing throughput on a finely tessellated sphere, plus correctness checks against solids
+// whose cross-sections are known in closed form (box, sphere, torus with its hole).
+class SliceBenchmark {
+public:
+    struct Result {
+        qint64 triangles{ 0 };
+        qint64 layers{ 0 };
+        qint64 segments{ 0 };
+        double bucketMs{ 0.0 };
+        double sliceMs{ 0.0 };
+        // One line per failed check; empty when every layer matched.
+        QStringList failures;
+
+        double layersPerSecond() const {
+            const double ms = bucketMs + sliceMs;
+            return ms > 0.0 ? layers * 1000.0 / ms : 0.0;
+        }
+    };
+
+    static Result run(qint64 triangles, int layers);
+    static QStringList verifyAnalyticSolids();
+
+    // Indexed, outward-facing meshes centred on the origin.
+    static StlMesh makeBox(double halfSize);
+    static StlMesh makeSphere(double radius, int rings, int sectors);
+    static StlMesh makeTorus(double majorRadius, double minorRadius, int majorSegments, int minorSegments);
+};
@@ -0,0 +1,105 @@
+#include "StlBenchmark.h"
+
+#include <cmath>
+#include <cstring>
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+
+#include <vtkPolyData.h>
+#include <vtkSTLReader.h>
+#include <vtkSmartPointer.h>
+
+#include "mesh/FastStlReader.h"
+
+namespace {
+    constexpr int RECORD_SIZE = 50;
+    constexpr int RECORDS_PER_WRITE = 1 << 16;
+
+    void gridPoint(qint64 column, qint64 row, float* out) {
+        out[0] = static_cast<float>(column);
+        out[1] = static_cast<float>(row);
+        out[2] = static_cast<float>(std::sin(column * 0.05) * std::cos(row * 0.05) * 10.0);
+    }
+
+    void putTriangle(char* record, const float* a, const float* b, const float* c) {
+        std::memset(record, 0, RECORD_SIZE);
+        std::memcpy(record + 12, a, 12);
+        std::memcpy(record + 24, b, 12);
+        std::memcpy(record + 36, c, 12);
+    }
+}
+
+bool StlBenchmark::writeSynthetic(const QString& path, qint64 triangles, QString& error) {
+    if (triangles <= 0 || triangles > 0xFFFFFFFFLL) {
+        error = QStringLiteral("triangle count out of range: %1").arg(triangles);
+        return false;
+    }
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        error = file.errorString();
+        return false;
+    }
+    char header[84] = "FiveAxisQt6 synthetic benchmark mesh";
+    const auto count = static_cast<quint32>(triangles);
+    std::memcpy(header + 80, &count, sizeof(count));
+    file.write(header, sizeof(header));
+
+    const auto columns = static_cast<qint64>(std::ceil(std::sqrt(triangles / 2.0)));
+    QByteArray block(RECORDS_PER_WRITE * RECORD_SIZE, Qt::Uninitialized);
+    int pending = 0;
+    qint64 written = 0;
+    for (qint64 quad = 0; written < triangles; ++quad) {
+        const qint64 column = quad % columns;
+        const qint64 row = quad / columns;
+        float a[3], b[3], c[3], d[3];
+        gridPoint(column, row, a);
+        gridPoint(column + 1, row, b);
+        gridPoint(column + 1, row + 1, c);
+        gridPoint(column, row + 1, d);
+        putTriangle(block.data() + pending++ * RECORD_SIZE, a, b, c);
+        if (++written < triangles) {
+            putTriangle(block.data() + pending++ * RECORD_SIZE, a, c, d);
+            ++written;
+        }
+        if (pending >= RECORDS_PER_WRITE - 1 || written == triangles) {
+            if (file.write(block.constData(), pending * RECORD_SIZE) != pending * RECORD_SIZE) {
+                error = file.errorString();
+                return false;
+            }
+            pending = 0;
+        }
+    }
+    return true;
+}
+
+StlBenchmark::Result StlBenchmark::run(const QString& path) {
+    Result result;
+    result.fileBytes = QFileInfo(path).size();
+
+    QElapsedTimer timer;
+    timer.start();
+    auto fast = vtkSmartPointer<FastStlReader>::New();
+    fast->setFileName(path);
+    fast->Update();
+    result.fastMs = timer.nsecsElapsed() / 1e6;
+    if (!fast->lastError().isEmpty()) {
+        result.error = fast->lastError();
+        return result;
+    }
+    result.triangles = fast->lastMesh().sourceTriangles;
+    result.fastPoints = fast->GetOutput()->GetNumberOfPoints();
+    result.fastOutputKb = static_cast<qint64>(fast->GetOutput()->GetActualMemorySize());
+    result.fastWorkingKb = fast->lastMesh().workingBytes / 1024;
+    fast = nullptr;
+
+    timer.restart();
+    auto reference = vtkSmartPointer<vtkSTLReader>::New();
+    reference->SetFileName(path.toLocal8Bit().constData());
+    reference->Update();
+    result.vtkMs = timer.nsecsElapsed() / 1e6;
+    result.vtkPoints = reference->GetOutput()->GetNumberOfPoints();
+    result.vtkOutputKb = static_cast<qint64>(reference->GetOutput()->GetActualMemorySize());
+    return result;
+}
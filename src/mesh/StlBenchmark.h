@@ -0,0 +1,29 @@
+#pragma once
+
+#include <QString>
+#include <QtGlobal>
+
+// Compares FastStlReader with vtkSTLReader on the same file. Memory is the size of the
+// resulting vtkPolyData (GetActualMemorySize) plus, for FastStlReader, its peak scratch use.
+class StlBenchmark {
+public:
+    struct Result {
+        qint64 triangles{ 0 };
+        qint64 fileBytes{ 0 };
+        double vtkMs{ 0.0 };
+        qint64 vtkPoints{ 0 };
+        qint64 vtkOutputKb{ 0 };
+        double fastMs{ 0.0 };
+        qint64 fastPoints{ 0 };
+        qint64 fastOutputKb{ 0 };
+        qint64 fastWorkingKb{ 0 };
+        QString error;
+
+        double vtkMBps() const { return vtkMs > 0.0 ? fileBytes / 1e3 / vtkMs : 0.0; }
+        double fastMBps() const { return fastMs > 0.0 ? fileBytes / 1e3 / fastMs : 0.0; }
+    };
+
+    // Writes a binary STL height field of exactly `triangles` faces, so most vertices are shared by six.
+    static bool writeSynthetic(const QString& path, qint64 triangles, QString& error);
+    static Result run(const QString& path);
+};
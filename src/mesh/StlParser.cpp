@@ -0,0 +1,457 @@
+#include "StlParser.h"
+
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <string_view>
+
+#include <QFile>
+#include <QThread>
+#include <QThreadPool>
+
+#include "mesh/Parallel.h"
+
+static_assert(Q_BYTE_ORDER == Q_LITTLE_ENDIAN, "binary STL floats are read in place and stored little-endian");
+
+namespace {
+    using mesh::runParallel;
+
+    constexpr qint64 BINARY_HEADER = 84;
+    constexpr qint64 BINARY_RECORD = 50;
+    constexpr qint64 MIN_CHUNK_TRIANGLES = 1 << 16;
+    constexpr qint64 MIN_ASCII_RANGE = 1 << 20;
+    constexpr qint64 CANCEL_CHECK_MASK = 4095;
+    constexpr std::string_view FACET_END = "endfacet";
+    constexpr std::string_view VERTEX = "vertex";
+
+    struct Key {
+        qint64 v[3];
+        bool operator==(const Key& other) const {
+            return v[0] == other.v[0] && v[1] == other.v[1] && v[2] == other.v[2];
+        }
+    };
+
+    struct Vertex {
+        float p[3];
+        quint64 hash;
+    };
+
+    quint64 mix(quint64 x) {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebULL;
+        x ^= x >> 31;
+        return x;
+    }
+
+    // Maps a position to the key two corners must share to be welded.
+    class Welder {
+    public:
+        explicit Welder(double tolerance)
+            : m_scale(tolerance > 0.0 ? 1.0 / tolerance : 0.0) {
+        }
+
+        Key key(const float* p) const {
+            Key key;
+            for (int i = 0; i < 3; ++i) {
+                if (m_scale > 0.0) {
+                    key.v[i] = static_cast<qint64>(std::floor(p[i] * m_scale));
+                }
+                else {
+                    // Adding +0 turns -0 into +0 so both weld together.
+                    const float value = p[i] + 0.0f;
+                    quint32 bits;
+                    std::memcpy(&bits, &value, sizeof(bits));
+                    key.v[i] = bits;
+                }
+            }
+            return key;
+        }
+
+        static quint64 hash(const Key& key) {
+            return mix(mix(mix(static_cast<quint64>(key.v[0])) ^ static_cast<quint64>(key.v[1]))
+                ^ static_cast<quint64>(key.v[2]));
+        }
+
+    private:
+        double m_scale;
+    };
+
+    // Open-addressing set over a vertex list; slots hold index + 1 so zero means empty.
+    class VertexTable {
+    public:
+        VertexTable(const Welder& welder, std::vector<Vertex>& vertices, size_t expected)
+            : m_welder(welder)
+            , m_vertices(vertices) {
+            size_t capacity = 16;
+            while (capacity < expected * 2) {
+                capacity <<= 1;
+            }
+            m_slots.assign(capacity, 0);
+        }
+
+        quint32 insert(const float* p, quint64 hash, const Key& key) {
+            size_t i = hash & (m_slots.size() - 1);
+            while (const quint32 slot = m_slots[i]) {
+                const Vertex& v = m_vertices[slot - 1];
+                if (v.hash == hash && m_welder.key(v.p) == key) {
+                    return slot - 1;
+                }
+                i = (i + 1) & (m_slots.size() - 1);
+            }
+            const auto index = static_cast<quint32>(m_vertices.size());
+            m_vertices.push_back(Vertex{ { p[0], p[1], p[2] }, hash });
+            m_slots[i] = index + 1;
+            if (m_vertices.size() * 2 > m_slots.size()) {
+                grow();
+            }
+            return index;
+        }
+
+        qint64 bytes() const {
+            return static_cast<qint64>(m_slots.capacity() * sizeof(quint32));
+        }
+
+    private:
+        void grow() {
+            std::vector<quint32> slots(m_slots.size() * 2, 0);
+            const size_t mask = slots.size() - 1;
+            for (size_t index = 0; index < m_vertices.size(); ++index) {
+                size_t i = m_vertices[index].hash & mask;
+                while (slots[i]) {
+                    i = (i + 1) & mask;
+                }
+                slots[i] = static_cast<quint32>(index + 1);
+            }
+            m_slots.swap(slots);
+        }
+
+        const Welder& m_welder;
+        std::vector<Vertex>& m_vertices;
+        std::vector<quint32> m_slots;
+    };
+
+    struct BinaryCorners {
+        const uchar* data;
+        void get(qint64 corner, float* out) const {
+            const qint64 triangle = corner / 3;
+            std::memcpy(out, data + BINARY_HEADER + triangle * BINARY_RECORD + 12 + (corner - triangle * 3) * 12,
+                3 * sizeof(float));
+        }
+    };
+
+    struct FloatCorners {
+        const float* data;
+        void get(qint64 corner, float* out) const {
+            std::memcpy(out, data + corner * 3, 3 * sizeof(float));
+        }
+    };
+
+    int partitionBits(int threads) {
+        int bits = 0;
+        while ((1 << bits) < threads * 2) {
+            ++bits;
+        }
+        return bits;
+    }
+
+    template <typename Corners>
+    bool weld(const Corners& corners, qint64 triangleCount, StlMesh& mesh, QString& error, const Welder& welder,
+        QThreadPool& pool, double from, const StlParser::Progress& progress, std::atomic<bool>& cancelled) {
+        const int threads = pool.maxThreadCount();
+        const int chunks = static_cast<int>(qBound<qint64>(1, (triangleCount + MIN_CHUNK_TRIANGLES - 1) / MIN_CHUNK_TRIANGLES,
+            threads * 4));
+        std::vector<qint64> chunkBegin(chunks + 1);
+        for (int c = 0; c <= chunks; ++c) {
+            chunkBegin[c] = triangleCount * c / chunks;
+        }
+        const double span = 1.0 - from;
+
+        // 1. Parse and weld each chunk on its own; corners get chunk-local vertex indices.
+        mesh.triangles.resize(static_cast<size_t>(triangleCount * 3));
+        std::vector<std::vector<Vertex>> chunkVertices(chunks);
+        std::vector<qint64> chunkTableBytes(chunks, 0);
+        const auto weldChunk = [&](int c) {
+            const qint64 begin = chunkBegin[c] * 3;
+            const qint64 end = chunkBegin[c + 1] * 3;
+            std::vector<Vertex>& vertices = chunkVertices[c];
+            vertices.reserve(static_cast<size_t>((end - begin) / 4));
+            VertexTable table(welder, vertices, static_cast<size_t>((end - begin) / 4));
+            for (qint64 corner = begin; corner < end; ++corner) {
+                if ((corner & CANCEL_CHECK_MASK) == 0 && cancelled.load(std::memory_order_relaxed)) {
+                    return;
+                }
+                float p[3];
+                corners.get(corner, p);
+                const Key key = welder.key(p);
+                mesh.triangles[corner] = static_cast<qint32>(table.insert(p, Welder::hash(key), key));
+            }
+            chunkTableBytes[c] = table.bytes();
+        };
+        if (!runParallel(pool, chunks, weldChunk, from, from + span * 0.6, progress, cancelled)) {
+            return false;
+        }
+
+        // 2. Merge chunk vertices by hash partition; equal keys always land in the same partition.
+        const int bits = partitionBits(threads);
+        const int partitions = 1 << bits;
+        const auto partitionOf = [bits](quint64 hash) {
+            return bits == 0 ? 0 : static_cast<int>(hash >> (64 - bits));
+        };
+        qint64 localTotal = 0;
+        std::vector<std::vector<quint32>> remap(chunks);
+        for (int c = 0; c < chunks; ++c) {
+            localTotal += static_cast<qint64>(chunkVertices[c].size());
+            remap[c].resize(chunkVertices[c].size());
+        }
+        std::vector<std::vector<Vertex>> partitionVertices(partitions);
+        std::vector<qint64> partitionTableBytes(partitions, 0);
+        const auto mergePartition = [&](int p) {
+            std::vector<Vertex>& vertices = partitionVertices[p];
+            VertexTable table(welder, vertices, static_cast<size_t>(localTotal / partitions));
+            for (int c = 0; c < chunks; ++c) {
+                if (cancelled.load(std::memory_order_relaxed)) {
+                    return;
+                }
+                const std::vector<Vertex>& local = chunkVertices[c];
+                for (size_t j = 0; j < local.size(); ++j) {
+                    if (partitionOf(local[j].hash) == p) {
+                        remap[c][j] = table.insert(local[j].p, local[j].hash, welder.key(local[j].p));
+                    }
+                }
+            }
+            partitionTableBytes[p] = table.bytes();
+        };
+        if (!runParallel(pool, partitions, mergePartition, from + span * 0.6, from + span * 0.85, progress, cancelled)) {
+            return false;
+        }
+
+        std::vector<qint64> partitionOffset(partitions + 1, 0);
+        for (int p = 0; p < partitions; ++p) {
+            partitionOffset[p + 1] = partitionOffset[p] + static_cast<qint64>(partitionVertices[p].size());
+        }
+        const qint64 vertexCount = partitionOffset[partitions];
+        if (vertexCount > std::numeric_limits<qint32>::max()) {
+            error = QStringLiteral("too many vertices (%1)").arg(vertexCount);
+            return false;
+        }
+
+        // On top of whatever the caller already holds (the ASCII corner list).
+        qint64 working = mesh.workingBytes;
+        for (int c = 0; c < chunks; ++c) {
+            working += static_cast<qint64>(chunkVertices[c].capacity() * sizeof(Vertex)
+                + remap[c].capacity() * sizeof(quint32)) + chunkTableBytes[c];
+        }
+        for (int p = 0; p < partitions; ++p) {
+            working += static_cast<qint64>(partitionVertices[p].capacity() * sizeof(Vertex)) + partitionTableBytes[p];
+        }
+        mesh.workingBytes = working;
+
+        // 3. Copy out the points and rewrite each chunk's corners to global indices,
+        //    compacting away faces that welding made degenerate.
+        mesh.points.resize(static_cast<size_t>(vertexCount * 3));
+        std::vector<qint64> kept(chunks, 0);
+        const auto finish = [&](int task) {
+            if (task < partitions) {
+                float* out = mesh.points.data() + partitionOffset[task] * 3;
+                for (const Vertex& v : partitionVertices[task]) {
+                    *out++ = v.p[0];
+                    *out++ = v.p[1];
+                    *out++ = v.p[2];
+                }
+                return;
+            }
+            const int c = task - partitions;
+            std::vector<quint32>& global = remap[c];
+            for (size_t j = 0; j < global.size(); ++j) {
+                global[j] += static_cast<quint32>(partitionOffset[partitionOf(chunkVertices[c][j].hash)]);
+            }
+            qint32* tri = mesh.triangles.data();
+            qint64 write = chunkBegin[c] * 3;
+            for (qint64 read = chunkBegin[c] * 3; read < chunkBegin[c + 1] * 3; read += 3) {
+                const auto a = static_cast<qint32>(global[tri[read]]);
+                const auto b = static_cast<qint32>(global[tri[read + 1]]);
+                const auto d = static_cast<qint32>(global[tri[read + 2]]);
+                if (a == b || b == d || a == d) {
+                    continue;
+                }
+                tri[write++] = a;
+                tri[write++] = b;
+                tri[write++] = d;
+            }
+            kept[c] = write - chunkBegin[c] * 3;
+        };
+        if (!runParallel(pool, partitions + chunks, finish, from + span * 0.85, 1.0, progress, cancelled)) {
+            return false;
+        }
+
+        qint64 write = 0;
+        for (int c = 0; c < chunks; ++c) {
+            if (write != chunkBegin[c] * 3) {
+                std::memmove(mesh.triangles.data() + write, mesh.triangles.data() + chunkBegin[c] * 3,
+                    static_cast<size_t>(kept[c]) * sizeof(qint32));
+            }
+            write += kept[c];
+        }
+        mesh.triangles.resize(static_cast<size_t>(write));
+        mesh.triangles.shrink_to_fit();
+        mesh.degenerateTriangles = triangleCount - write / 3;
+        return true;
+    }
+
+    const char* skipSpace(const char* p, const char* end) {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) {
+            ++p;
+        }
+        return p;
+    }
+
+    // Parses every "vertex x y z" in text; false on a malformed coordinate.
+    bool parseAsciiRange(std::string_view text, std::vector<float>& corners, const std::atomic<bool>& cancelled) {
+        size_t pos = 0;
+        qint64 count = 0;
+        while ((pos = text.find(VERTEX, pos)) != std::string_view::npos) {
+            if ((++count & CANCEL_CHECK_MASK) == 0 && cancelled.load(std::memory_order_relaxed)) {
+                return true;
+            }
+            const char* p = text.data() + pos + VERTEX.size();
+            const char* end = text.data() + text.size();
+            for (int i = 0; i < 3; ++i) {
+                p = skipSpace(p, end);
+                if (p < end && *p == '+') {
+                    ++p;
+                }
+                float value = 0.0f;
+                const auto result = std::from_chars(p, end, value);
+                if (result.ec != std::errc()) {
+                    return false;
+                }
+                corners.push_back(value);
+                p = result.ptr;
+            }
+            pos = static_cast<size_t>(p - text.data());
+        }
+        return true;
+    }
+
+    bool parseAscii(std::string_view text, std::vector<float>& corners, QString& error, QThreadPool& pool,
+        const StlParser::Progress& progress, std::atomic<bool>& cancelled) {
+        // Split on facet boundaries so each range holds whole facets; skip the "solid name" line.
+        const int ranges = static_cast<int>(qBound<qint64>(1, static_cast<qint64>(text.size()) / MIN_ASCII_RANGE,
+            pool.maxThreadCount() * 4));
+        std::vector<size_t> start(ranges + 1);
+        const size_t firstLine = text.find('\n');
+        start[0] = firstLine == std::string_view::npos ? text.size() : firstLine + 1;
+        for (int r = 1; r < ranges; ++r) {
+            const size_t hint = qMax(start[r - 1], text.size() * r / ranges);
+            const size_t found = text.find(FACET_END, hint);
+            start[r] = found == std::string_view::npos ? text.size() : found + FACET_END.size();
+        }
+        start[ranges] = text.size();
+
+        std::vector<std::vector<float>> parts(ranges);
+        std::vector<char> failed(ranges, 0);
+        const auto parseRange = [&](int r) {
+            const std::string_view range = text.substr(start[r], start[r + 1] - start[r]);
+            parts[r].reserve(range.size() / 40);
+            failed[r] = parseAsciiRange(range, parts[r], cancelled) ? 0 : 1;
+        };
+        if (!runParallel(pool, ranges, parseRange, 0.0, 0.3, progress, cancelled)) {
+            return false;
+        }
+
+        size_t total = 0;
+        for (int r = 0; r < ranges; ++r) {
+            if (failed[r] || parts[r].size() % 9 != 0) {
+                error = QStringLiteral("malformed ASCII STL near byte %1").arg(start[r]);
+                return false;
+            }
+            total += parts[r].size();
+        }
+        corners.reserve(total);
+        for (auto& part : parts) {
+            corners.insert(corners.end(), part.begin(), part.end());
+            std::vector<float>().swap(part);
+        }
+        return true;
+    }
+}
+
+bool StlParser::parse(const QString& path, StlMesh& mesh, QString& error, const Progress& progress) {
+    return parse(path, mesh, error, Options(), progress);
+}
+
+bool StlParser::parse(const QString& path, StlMesh& mesh, QString& error, const Options& options,
+    const Progress& progress) {
+    mesh = StlMesh();
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = file.errorString();
+        return false;
+    }
+    const qint64 size = file.size();
+    if (size < BINARY_HEADER) {
+        error = QStringLiteral("file too small for STL (%1 bytes)").arg(size);
+        return false;
+    }
+    const uchar* data = file.map(0, size);
+    if (!data) {
+        error = file.errorString();
+        return false;
+    }
+    mesh.sourceBytes = size;
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(options.threads > 0 ? options.threads : QThread::idealThreadCount());
+    std::atomic<bool> cancelled{ false };
+    const Welder welder(options.weldTolerance);
+
+    quint32 declared = 0;
+    std::memcpy(&declared, data + 80, sizeof(declared));
+    // Some exporters start binary headers with "solid" too, so the size check comes first.
+    if (BINARY_HEADER + static_cast<qint64>(declared) * BINARY_RECORD == size) {
+        if (static_cast<qint64>(declared) * 3 > std::numeric_limits<qint32>::max()) {
+            error = QStringLiteral("too many triangles (%1)").arg(declared);
+            return false;
+        }
+        mesh.binary = true;
+        mesh.sourceTriangles = declared;
+        if (!weld(BinaryCorners{ data }, declared, mesh, error, welder, pool, 0.0, progress, cancelled)) {
+            if (error.isEmpty()) {
+                error = QStringLiteral("cancelled");
+            }
+            return false;
+        }
+        return true;
+    }
+
+    const std::string_view text(reinterpret_cast<const char*>(data), static_cast<size_t>(size));
+    if (text.substr(0, 5) != "solid") {
+        error = QStringLiteral("binary STL declares %1 triangles but holds %2 bytes").arg(declared).arg(size);
+        return false;
+    }
+    std::vector<float> corners;
+    if (!parseAscii(text, corners, error, pool, progress, cancelled)) {
+        if (error.isEmpty()) {
+            error = QStringLiteral("cancelled");
+        }
+        return false;
+    }
+    const qint64 triangles = static_cast<qint64>(corners.size() / 9);
+    if (triangles * 3 > std::numeric_limits<qint32>::max()) {
+        error = QStringLiteral("too many triangles (%1)").arg(triangles);
+        return false;
+    }
+    mesh.sourceTriangles = triangles;
+    mesh.workingBytes = static_cast<qint64>(corners.capacity() * sizeof(float));
+    if (!weld(FloatCorners{ corners.data() }, triangles, mesh, error, welder, pool, 0.3, progress, cancelled)) {
+        if (error.isEmpty()) {
+            error = QStringLiteral("cancelled");
+        }
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vector>
+
+#include <QString>
+#include <QtGlobal>
+
+#include "mesh/Parallel.h"
+
+// Indexed triangle mesh: points holds x,y,z per vertex, triangles three vertex indices per face.
+struct StlMesh {
+    std::vector<float> points;
+    std::vector<qint32> triangles;
+    bool binary{ false };
+    qint64 sourceTriangles{ 0 };
+    // Faces dropped because welding collapsed two of their corners.
+    qint64 degenerateTriangles{ 0 };
+    qint64 sourceBytes{ 0 };
+    // Largest amount of scratch memory held at once on top of the mapped file and the result.
+    qint64 workingBytes{ 0 };
+
+    qint64 vertexCount() const { return static_cast<qint64>(points.size() / 3); }
+    qint64 triangleCount() const { return static_cast<qint64>(triangles.size() / 3); }
+};
+
+// Reads binary and ASCII STL from a memory-mapped file. Triangles are parsed in parallel
+// chunks, each chunk welds its corners through a local hash table, and the chunk-local
+// vertices are then merged in parallel by hash partition, so no stage shares a table
+// between threads. Welding is exact (bitwise, with -0 == 0) unless a tolerance is given,
+// in which case corners falling into the same tolerance-sized grid cell are merged.
+class StlParser {
+public:
+    using Progress = mesh::Progress;
+
+    struct Options {
+        double weldTolerance{ 0.0 };
+        int threads{ 0 };  // 0: QThread::idealThreadCount()
+    };
+
+    static bool parse(const QString& path, StlMesh& mesh, QString& error, const Options& options,
+        const Progress& progress = {});
+    static bool parse(const QString& path, StlMesh& mesh, QString& error, const Progress& progress = {});
+};
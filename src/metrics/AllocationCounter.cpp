@@ -0,0 +1,81 @@
+#include "AllocationCounter.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    thread_local AllocationCounter *t_counter = nullptr;
+
+    void *allocate(std::size_t size)
+    {
+        AllocationCounter::record(size);
+        if (void *block = std::malloc(size == 0 ? 1 : size))
+        {
+            return block;
+        }
+        throw std::bad_alloc();
+    }
+}
+
+AllocationCounter::AllocationCounter()
+    : m_outer(t_counter)
+{
+    t_counter = this;
+}
+
+AllocationCounter::~AllocationCounter()
+{
+    t_counter = m_outer;
+}
+
+qint64 AllocationCounter::allocations() const
+{
+    return m_allocations;
+}
+
+qint64 AllocationCounter::bytes() const
+{
+    return m_bytes;
+}
+
+void AllocationCounter::record(std::size_t size)
+{
+    if (AllocationCounter *counter = t_counter)
+    {
+        ++counter->m_allocations;
+        counter->m_bytes += static_cast<qint64>(size);
+    }
+}
+
+// The plain and sized forms; the nothrow forms forward to these, and the aligned forms keep the
+// library's own allocator and are not counted.
+void *operator new(std::size_t size)
+{
+    return allocate(size);
+}
+
+void *operator new[](std::size_t size)
+{
+    return allocate(size);
+}
+
+void operator delete(void *block) noexcept
+{
+    std::free(block);
+}
+
+void operator delete[](void *block) noexcept
+{
+    std::free(block);
+}
+
+void operator delete(void *block, std::size_t) noexcept
+{
+    std::free(block);
+}
+
+void operator delete[](void *block, std::size_t) noexcept
+{
+    std::free(block);
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+
+#include <QtGlobal>
+
+// Counts the operator new calls the current thread makes while the counter is alive, through
+// the replacement operator new in AllocationCounter.cpp. Allocations on other threads are not
+// seen. Counters nest; only the innermost one of a thread counts. Outside a counter the hook
+// costs one thread-local test per allocation.
+class AllocationCounter
+{
+public:
+    AllocationCounter();
+    ~AllocationCounter();
+    AllocationCounter(const AllocationCounter &) = delete;
+    AllocationCounter &operator=(const AllocationCounter &) = delete;
+
+    qint64 allocations() const;
+    qint64 bytes() const;
+
+    // Called by the operator new replacement.
+    static void record(std::size_t size);
+
+private:
+    AllocationCounter *m_outer;
+    qint64 m_allocations{0};
+    qint64 m_bytes{0};
+};
@@ -0,0 +1,110 @@
+#include "HdrHistogram.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+HdrHistogram::HdrHistogram(qint64 highestTrackable)
+    : m_highestTrackable(std::max<qint64>(highestTrackable, SUB_BUCKET_MASK))
+{
+    m_counts.resize(static_cast<size_t>(countsIndexFor(m_highestTrackable)) + 1, 0);
+}
+
+void HdrHistogram::record(qint64 value)
+{
+    value = std::clamp<qint64>(value, 0, m_highestTrackable);
+    ++m_counts[countsIndexFor(value)];
+    if (m_total == 0 || value < m_min)
+    {
+        m_min = value;
+    }
+    m_max = std::max(m_max, value);
+    m_sum += static_cast<double>(value);
+    ++m_total;
+}
+
+void HdrHistogram::merge(const HdrHistogram &other)
+{
+    if (other.m_total == 0)
+    {
+        return;
+    }
+    const size_t shared = std::min(m_counts.size(), other.m_counts.size());
+    for (size_t i = 0; i < shared; ++i)
+    {
+        m_counts[i] += other.m_counts[i];
+    }
+    m_min = m_total == 0 ? other.m_min : std::min(m_min, other.m_min);
+    m_max = std::max(m_max, other.m_max);
+    m_sum += other.m_sum;
+    m_total += other.m_total;
+}
+
+void HdrHistogram::reset()
+{
+    std::fill(m_counts.begin(), m_counts.end(), 0);
+    m_total = 0;
+    m_min = 0;
+    m_max = 0;
+    m_sum = 0.0;
+}
+
+qint64 HdrHistogram::count() const
+{
+    return m_total;
+}
+
+qint64 HdrHistogram::min() const
+{
+    return m_min;
+}
+
+qint64 HdrHistogram::max() const
+{
+    return m_max;
+}
+
+double HdrHistogram::mean() const
+{
+    return m_total == 0 ? 0.0 : m_sum / static_cast<double>(m_total);
+}
+
+qint64 HdrHistogram::valueAtPercentile(double percentile) const
+{
+    if (m_total == 0)
+    {
+        return 0;
+    }
+    percentile = std::clamp(percentile, 0.0, 100.0);
+    const auto target = std::max<qint64>(1, static_cast<qint64>(std::ceil(percentile / 100.0 * m_total)));
+    qint64 seen = 0;
+    for (size_t i = 0; i < m_counts.size(); ++i)
+    {
+        seen += m_counts[i];
+        if (seen >= target)
+        {
+            return std::min(highestEquivalentValue(static_cast<int>(i)), m_max);
+        }
+    }
+    return m_max;
+}
+
+int HdrHistogram::countsIndexFor(qint64 value) const
+{
+    const int bucket = 64 - std::countl_zero(static_cast<quint64>(value | SUB_BUCKET_MASK)) -
+                       (SUB_BUCKET_HALF_MAGNITUDE + 1);
+    const auto subBucket = static_cast<int>(value >> bucket);
+    return ((bucket + 1) << SUB_BUCKET_HALF_MAGNITUDE) + (subBucket - SUB_BUCKET_HALF_COUNT);
+}
+
+qint64 HdrHistogram::highestEquivalentValue(int index) const
+{
+    int bucket = (index >> SUB_BUCKET_HALF_MAGNITUDE) - 1;
+    int subBucket = (index & (SUB_BUCKET_HALF_COUNT - 1)) + SUB_BUCKET_HALF_COUNT;
+    if (bucket < 0)
+    {
+        subBucket -= SUB_BUCKET_HALF_COUNT;
+        bucket = 0;
+    }
+    return (qint64(subBucket) << bucket) + (qint64(1) << bucket) - 1;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <vector>
+
+#include <QtGlobal>
+
+// High dynamic range histogram (Gil Tene's HdrHistogram layout): log2 buckets split into
+// linear sub-buckets, so every recorded value keeps ~2 significant digits of precision
+// from 1 up to highestTrackable with a fixed, small footprint.
+class HdrHistogram
+{
+public:
+    explicit HdrHistogram(qint64 highestTrackable = qint64(1) << 36);
+
+    void record(qint64 value);
+    void merge(const HdrHistogram &other);
+    void reset();
+
+    qint64 count() const;
+    qint64 min() const;
+    qint64 max() const;
+    double mean() const;
+    qint64 valueAtPercentile(double percentile) const;
+
+private:
+    int countsIndexFor(qint64 value) const;
+    qint64 highestEquivalentValue(int index) const;
+
+    static constexpr int SUB_BUCKET_HALF_MAGNITUDE = 7;
+    static constexpr int SUB_BUCKET_HALF_COUNT = 1 << SUB_BUCKET_HALF_MAGNITUDE;
+    static constexpr qint64 SUB_BUCKET_MASK = (qint64(SUB_BUCKET_HALF_COUNT) << 1) - 1;
+
+    qint64 m_highestTrackable;
+    std::vector<qint64> m_counts;
+    qint64 m_total{0};
+    qint64 m_min{0};
+    qint64 m_max{0};
+    double m_sum{0.0};
+};
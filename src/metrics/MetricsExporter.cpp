@@ -0,0 +1,177 @@
+#include "MetricsExporter.h"
+
+#include <QHostAddress>
+#include <QSaveFile>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+#include "MetricsRegistry.h"
+
+namespace
+{
+    // A scrape request is one short line plus headers; anything longer is not a scraper.
+    constexpr int MAX_REQUEST_BYTES = 8192;
+
+    QByteArray httpResponse(const QByteArray &status, const QByteArray &contentType, const QByteArray &body)
+    {
+        QByteArray response("HTTP/1.1 ");
+        response.append(status).append("\r\nContent-Type: ").append(contentType);
+        response.append("\r\nContent-Length: ").append(QByteArray::number(body.size()));
+        response.append("\r\nConnection: close\r\n\r\n").append(body);
+        return response;
+    }
+}
+
+MetricsExporter::MetricsExporter(MetricsRegistry &registry, QObject *parent)
+    : QObject(parent)
+    , m_registry(registry)
+    , m_timer(this)
+{
+    connect(&m_timer, &QTimer::timeout, this, [this]() {
+        QString error;
+        if (!writeNow(error))
+        {
+            emit exportFailed(error);
+        }
+    });
+}
+
+MetricsExporter::~MetricsExporter()
+{
+    stopListening();
+}
+
+bool MetricsExporter::exportToFile(const QString &path, Format format, int intervalMs, QString &error)
+{
+    m_path = path;
+    m_format = format;
+    if (!writeNow(error))
+    {
+        m_path.clear();
+        return false;
+    }
+    m_timer.start(qMax(100, intervalMs));
+    return true;
+}
+
+void MetricsExporter::stopFileExport()
+{
+    m_timer.stop();
+    m_path.clear();
+}
+
+bool MetricsExporter::isExportingToFile() const
+{
+    return m_timer.isActive();
+}
+
+QString MetricsExporter::filePath() const
+{
+    return m_path;
+}
+
+bool MetricsExporter::writeNow(QString &error)
+{
+    if (m_path.isEmpty())
+    {
+        return true;
+    }
+    QSaveFile file(m_path);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        error = QStringLiteral("cannot open %1: %2").arg(m_path, file.errorString());
+        return false;
+    }
+    file.write(render(m_format));
+    if (!file.commit())
+    {
+        error = QStringLiteral("cannot write %1: %2").arg(m_path, file.errorString());
+        return false;
+    }
+    return true;
+}
+
+bool MetricsExporter::listen(quint16 port, QString &error)
+{
+    stopListening();
+    m_server = new QTcpServer(this);
+    connect(m_server, &QTcpServer::newConnection, this, &MetricsExporter::onNewConnection);
+    if (!m_server->listen(QHostAddress::LocalHost, port))
+    {
+        error = QStringLiteral("cannot listen on 127.0.0.1:%1: %2").arg(port).arg(m_server->errorString());
+        delete m_server;
+        m_server = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void MetricsExporter::stopListening()
+{
+    if (m_server)
+    {
+        m_server->close();
+        delete m_server;
+        m_server = nullptr;
+    }
+}
+
+bool MetricsExporter::isListening() const
+{
+    return m_server && m_server->isListening();
+}
+
+quint16 MetricsExporter::port() const
+{
+    return m_server ? m_server->serverPort() : 0;
+}
+
+void MetricsExporter::onNewConnection()
+{
+    while (QTcpSocket *socket = m_server->nextPendingConnection())
+    {
+        connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() {
+            respond(socket);
+        });
+    }
+}
+
+void MetricsExporter::respond(QTcpSocket *socket)
+{
+    // Headers may arrive in several segments; answer once the blank line is in.
+    if (!socket->peek(MAX_REQUEST_BYTES).contains("\r\n\r\n"))
+    {
+        if (socket->bytesAvailable() >= MAX_REQUEST_BYTES)
+        {
+            socket->write(httpResponse("431 Request Header Fields Too Large", "text/plain", QByteArray()));
+            socket->disconnectFromHost();
+        }
+        return;
+    }
+    const QList<QByteArray> requestLine = socket->readLine().trimmed().split(' ');
+    socket->readAll();
+    const QByteArray path = requestLine.size() >= 2 ? requestLine[1] : QByteArray();
+    if (requestLine.value(0) != "GET")
+    {
+        socket->write(httpResponse("405 Method Not Allowed", "text/plain", "GET only\n"));
+    }
+    else if (path == "/metrics")
+    {
+        socket->write(httpResponse("200 OK", "text/plain; version=0.0.4; charset=utf-8", render(Format::Prometheus)));
+    }
+    else if (path == "/metrics.json")
+    {
+        socket->write(httpResponse("200 OK", "application/json", render(Format::Json)));
+    }
+    else
+    {
+        socket->write(httpResponse("404 Not Found", "text/plain", "Try /metrics or /metrics.json\n"));
+    }
+    socket->disconnectFromHost();
+}
+
+QByteArray MetricsExporter::render(Format format) const
+{
+    return format == Format::Prometheus ? m_registry.toPrometheus() : m_registry.toJson();
+}
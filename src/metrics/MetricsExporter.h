@@ -0,0 +1,54 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+class MetricsRegistry;
+class QTcpServer;
+class QTcpSocket;
+
+// Publishes a MetricsRegistry for unattended cells: rewrites a file periodically (JSON or
+// Prometheus text, replaced atomically so readers never see half a file) and/or answers
+// HTTP scrapes on localhost: GET /metrics is Prometheus text, GET /metrics.json is JSON.
+class MetricsExporter : public QObject
+{
+    Q_OBJECT
+public:
+    enum class Format
+    {
+        Json,
+        Prometheus,
+    };
+
+    // May be moved to another thread; the timer and server follow it.
+    explicit MetricsExporter(MetricsRegistry &registry, QObject *parent = nullptr);
+    ~MetricsExporter() override;
+
+    // Writes now and then every intervalMs until stopped; later failures emit exportFailed.
+    bool exportToFile(const QString &path, Format format, int intervalMs, QString &error);
+    void stopFileExport();
+    bool isExportingToFile() const;
+    QString filePath() const;
+    bool writeNow(QString &error);
+
+    // Binds 127.0.0.1 only; the metrics are not meant for the shop network.
+    bool listen(quint16 port, QString &error);
+    void stopListening();
+    bool isListening() const;
+    quint16 port() const;
+
+signals:
+    void exportFailed(const QString &message);
+
+private:
+    void onNewConnection();
+    void respond(QTcpSocket *socket);
+    QByteArray render(Format format) const;
+
+    MetricsRegistry &m_registry;
+    QTimer m_timer;
+    QString m_path;
+    Format m_format{Format::Json};
+    QTcpServer *m_server{nullptr};
+};
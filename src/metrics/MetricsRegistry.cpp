@@ -0,0 +1,196 @@
+#include "MetricsRegistry.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QtDebug>
+
+namespace
+{
+    QString typeName(MetricsRegistry::Type type)
+    {
+        switch (type)
+        {
+        case MetricsRegistry::Type::Counter:
+            return QStringLiteral("counter");
+        case MetricsRegistry::Type::Gauge:
+            return QStringLiteral("gauge");
+        case MetricsRegistry::Type::Histogram:
+            return QStringLiteral("histogram");
+        }
+        return QString();
+    }
+
+    QByteArray number(double value)
+    {
+        return QByteArray::number(value, 'g', 15);
+    }
+}
+
+void MetricsRegistry::Histogram::record(qint64 value)
+{
+    QMutexLocker locker(&m_mutex);
+    m_histogram.record(value);
+}
+
+HdrHistogram MetricsRegistry::Histogram::snapshot() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_histogram;
+}
+
+MetricsRegistry &MetricsRegistry::instance()
+{
+    // Never destroyed: TcpSocketWorker::instance() is created first and so torn down later, and
+    // its stream thread still records until that teardown joins it.
+    static auto *registry = new MetricsRegistry;
+    return *registry;
+}
+
+MetricsRegistry::Entry &MetricsRegistry::entry(const QString &name, const QString &help, Type type)
+{
+    QMutexLocker locker(&m_mutex);
+    auto it = m_entries.find(name);
+    if (it == m_entries.end())
+    {
+        it = m_entries.emplace(name, Entry{type, help, nullptr, nullptr, nullptr}).first;
+    }
+    else if (it->second.type != type)
+    {
+        // Still hand out a usable metric; only the registered type is reported.
+        qWarning() << "Metric" << name << "registered as" << typeName(it->second.type) << "and" << typeName(type);
+    }
+    Entry &found = it->second;
+    switch (type)
+    {
+    case Type::Counter:
+        if (!found.counter)
+        {
+            found.counter = std::make_unique<Counter>();
+        }
+        break;
+    case Type::Gauge:
+        if (!found.gauge)
+        {
+            found.gauge = std::make_unique<Gauge>();
+        }
+        break;
+    case Type::Histogram:
+        if (!found.histogram)
+        {
+            found.histogram = std::make_unique<Histogram>();
+        }
+        break;
+    }
+    return found;
+}
+
+MetricsRegistry::Counter &MetricsRegistry::counter(const QString &name, const QString &help)
+{
+    return *entry(name, help, Type::Counter).counter;
+}
+
+MetricsRegistry::Gauge &MetricsRegistry::gauge(const QString &name, const QString &help)
+{
+    return *entry(name, help, Type::Gauge).gauge;
+}
+
+MetricsRegistry::Histogram &MetricsRegistry::histogram(const QString &name, const QString &help)
+{
+    return *entry(name, help, Type::Histogram).histogram;
+}
+
+std::vector<MetricsRegistry::Sample> MetricsRegistry::snapshot() const
+{
+    QMutexLocker locker(&m_mutex);
+    std::vector<Sample> samples;
+    samples.reserve(m_entries.size());
+    for (const auto &[name, entry] : m_entries)
+    {
+        Sample sample;
+        sample.name = name;
+        sample.help = entry.help;
+        sample.type = entry.type;
+        switch (entry.type)
+        {
+        case Type::Counter:
+            sample.value = static_cast<double>(entry.counter->value());
+            break;
+        case Type::Gauge:
+            sample.value = entry.gauge->value();
+            break;
+        case Type::Histogram:
+        {
+            const HdrHistogram histogram = entry.histogram->snapshot();
+            sample.value = static_cast<double>(histogram.count());
+            sample.sum = histogram.mean() * static_cast<double>(histogram.count());
+            sample.p50 = histogram.valueAtPercentile(50.0);
+            sample.p90 = histogram.valueAtPercentile(90.0);
+            sample.p99 = histogram.valueAtPercentile(99.0);
+            sample.max = histogram.max();
+            break;
+        }
+        }
+        samples.push_back(sample);
+    }
+    return samples;
+}
+
+QByteArray MetricsRegistry::toJson() const
+{
+    QJsonArray metrics;
+    for (const auto &sample : snapshot())
+    {
+        QJsonObject object{
+            {QStringLiteral("name"), sample.name},
+            {QStringLiteral("type"), typeName(sample.type)},
+            {QStringLiteral("help"), sample.help},
+        };
+        if (sample.type == Type::Histogram)
+        {
+            object.insert(QStringLiteral("count"), sample.value);
+            object.insert(QStringLiteral("sum"), sample.sum);
+            object.insert(QStringLiteral("p50"), sample.p50);
+            object.insert(QStringLiteral("p90"), sample.p90);
+            object.insert(QStringLiteral("p99"), sample.p99);
+            object.insert(QStringLiteral("max"), sample.max);
+        }
+        else
+        {
+            object.insert(QStringLiteral("value"), sample.value);
+        }
+        metrics.append(object);
+    }
+    return QJsonDocument(QJsonObject{{QStringLiteral("metrics"), metrics}}).toJson(QJsonDocument::Indented);
+}
+
+QByteArray MetricsRegistry::toPrometheus() const
+{
+    QByteArray out;
+    for (const auto &sample : snapshot())
+    {
+        const QByteArray name = sample.name.toUtf8();
+        QByteArray help = sample.help.toUtf8();
+        help.replace('\\', "\\\\").replace('\n', "\\n");
+        out.append("# HELP ").append(name).append(' ').append(help).append('\n');
+        switch (sample.type)
+        {
+        case Type::Counter:
+        case Type::Gauge:
+            out.append("# TYPE ").append(name).append(sample.type == Type::Counter ? " counter\n" : " gauge\n");
+            out.append(name).append(' ').append(number(sample.value)).append('\n');
+            break;
+        case Type::Histogram:
+            out.append("# TYPE ").append(name).append(" summary\n");
+            out.append(name).append("{quantile=\"0.5\"} ").append(QByteArray::number(sample.p50)).append('\n');
+            out.append(name).append("{quantile=\"0.9\"} ").append(QByteArray::number(sample.p90)).append('\n');
+            out.append(name).append("{quantile=\"0.99\"} ").append(QByteArray::number(sample.p99)).append('\n');
+            out.append(name).append("{quantile=\"1\"} ").append(QByteArray::number(sample.max)).append('\n');
+            out.append(name).append("_sum ").append(number(sample.sum)).append('\n');
+            out.append(name).append("_count ").append(number(sample.value)).append('\n');
+            break;
+        }
+    }
+    return out;
+}
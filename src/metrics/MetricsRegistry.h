@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <QByteArray>
+#include <QMutex>
+#include <QString>
+#include <QtGlobal>
+
+#include "HdrHistogram.h"
+
+// Process-wide counters, gauges and latency histograms, looked up by name once and then
+// updated without touching the registry again. Counters and gauges are single atomics;
+// a histogram takes its own lock per record, so feed it per frame or per call, not per
+// sample. Snapshots can be taken from any thread, e.g. by the dashboard or an exporter.
+class MetricsRegistry
+{
+public:
+    enum class Type
+    {
+        Counter,
+        Gauge,
+        Histogram,
+    };
+
+    class Counter
+    {
+    public:
+        void add(qint64 n = 1)
+        {
+            m_value.fetch_add(n, std::memory_order_relaxed);
+        }
+
+        qint64 value() const
+        {
+            return m_value.load(std::memory_order_relaxed);
+        }
+
+    private:
+        std::atomic<qint64> m_value{0};
+    };
+
+    class Gauge
+    {
+    public:
+        void set(double value)
+        {
+            m_value.store(value, std::memory_order_relaxed);
+        }
+
+        double value() const
+        {
+            return m_value.load(std::memory_order_relaxed);
+        }
+
+    private:
+        std::atomic<double> m_value{0.0};
+    };
+
+    class Histogram
+    {
+    public:
+        void record(qint64 value);
+        HdrHistogram snapshot() const;
+
+    private:
+        mutable QMutex m_mutex;
+        HdrHistogram m_histogram;
+    };
+
+    struct Sample
+    {
+        QString name;
+        QString help;
+        Type type{Type::Counter};
+        // Counter total or gauge value; for histograms the number of values recorded.
+        double value{0.0};
+        // Histograms only.
+        double sum{0.0};
+        qint64 p50{0};
+        qint64 p90{0};
+        qint64 p99{0};
+        qint64 max{0};
+    };
+
+    static MetricsRegistry &instance();
+
+    // Returns the existing metric when name is already registered; references stay valid for
+    // the life of the registry. Names follow Prometheus rules (snake case, _total, _us units).
+    Counter &counter(const QString &name, const QString &help);
+    Gauge &gauge(const QString &name, const QString &help);
+    Histogram &histogram(const QString &name, const QString &help);
+
+    // Sorted by name.
+    std::vector<Sample> snapshot() const;
+    QByteArray toJson() const;
+    // Prometheus text exposition format 0.0.4; histograms are exported as summaries.
+    QByteArray toPrometheus() const;
+
+private:
+    struct Entry
+    {
+        Type type;
+        QString help;
+        std::unique_ptr<Counter> counter;
+        std::unique_ptr<Gauge> gauge;
+        std::unique_ptr<Histogram> histogram;
+    };
+
+    Entry &entry(const QString &name, const QString &help, Type type);
+
+    mutable QMutex m_mutex;
+    std::map<QString, Entry> m_entries;
+};
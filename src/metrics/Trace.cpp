@@ -0,0 +1,330 @@
+#include "Trace.h"
+
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+
+namespace trace
+{
+    std::atomic<bool> g_enabled{false};
+}
+
+namespace
+{
+    constexpr int CHUNK_EVENTS = 4096;
+    // 1M events (32 MB) per thread and trace; later events are counted as dropped.
+    constexpr int MAX_CHUNKS = 256;
+
+    struct Event
+    {
+        const char *category;
+        const char *name;
+        qint64 beginNs;
+        qint64 durationNs;
+    };
+
+    // Only the owning thread writes events and count; readers see the first count events.
+    // A chunk is full before the writer moves on, so readers stop at the first partial one.
+    struct Chunk
+    {
+        Event events[CHUNK_EVENTS];
+        std::atomic<int> count{0};
+        std::atomic<Chunk *> next{nullptr};
+    };
+
+    struct ThreadBuffer
+    {
+        std::unique_ptr<Chunk> head{std::make_unique<Chunk>()};
+        // Events belong to the trace with this generation; older ones are ignored.
+        std::atomic<quint64> generation{0};
+        std::atomic<bool> owned{true};
+        // Writer-only state.
+        Chunk *current{nullptr};
+        int used{0};
+        int chunks{1};
+        // Guarded by the registry mutex.
+        int tid{0};
+        QString name;
+
+        ~ThreadBuffer()
+        {
+            Chunk *chunk = head->next.load();
+            while (chunk)
+            {
+                Chunk *next = chunk->next.load();
+                delete chunk;
+                chunk = next;
+            }
+        }
+    };
+
+    struct Registry
+    {
+        QMutex mutex;
+        std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+        std::deque<QByteArray> internedNames;
+        QHash<QString, const char *> interned;
+        std::atomic<quint64> generation{1};
+        std::atomic<qint64> dropped{0};
+        qint64 startNs{0};
+        int nextTid{1};
+    };
+
+    // Never destroyed: threads may still record while static objects are torn down.
+    Registry &registry()
+    {
+        static auto *instance = new Registry;
+        return *instance;
+    }
+
+    // Hands the buffer back when its thread exits, so pool threads coming and going reuse them.
+    struct BufferHandle
+    {
+        ThreadBuffer *buffer{nullptr};
+
+        ~BufferHandle()
+        {
+            if (buffer)
+            {
+                buffer->owned.store(false, std::memory_order_release);
+            }
+        }
+    };
+
+    thread_local BufferHandle t_handle;
+
+    QString defaultThreadName(int tid)
+    {
+        const QString name = QThread::currentThread()->objectName();
+        return name.isEmpty() ? QStringLiteral("Thread %1").arg(tid) : name;
+    }
+
+    ThreadBuffer &threadBuffer()
+    {
+        if (t_handle.buffer)
+        {
+            return *t_handle.buffer;
+        }
+        Registry &reg = registry();
+        QMutexLocker locker(&reg.mutex);
+        const quint64 generation = reg.generation.load();
+        ThreadBuffer *buffer = nullptr;
+        for (const auto &candidate : reg.buffers)
+        {
+            // Only buffers of exited threads whose events are no longer part of the trace.
+            if (!candidate->owned.load(std::memory_order_acquire) && candidate->generation.load() != generation)
+            {
+                buffer = candidate.get();
+                buffer->owned.store(true);
+                break;
+            }
+        }
+        if (!buffer)
+        {
+            reg.buffers.push_back(std::make_unique<ThreadBuffer>());
+            buffer = reg.buffers.back().get();
+        }
+        buffer->tid = reg.nextTid++;
+        buffer->name = defaultThreadName(buffer->tid);
+        buffer->generation.store(0);
+        t_handle.buffer = buffer;
+        return *buffer;
+    }
+
+    void append(ThreadBuffer &buffer, const Event &event)
+    {
+        Registry &reg = registry();
+        const quint64 generation = reg.generation.load(std::memory_order_acquire);
+        if (buffer.generation.load(std::memory_order_relaxed) != generation)
+        {
+            buffer.current = buffer.head.get();
+            buffer.used = 0;
+            buffer.head->count.store(0, std::memory_order_relaxed);
+            buffer.generation.store(generation, std::memory_order_release);
+        }
+        Chunk *chunk = buffer.current;
+        if (!chunk)
+        {
+            reg.dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        chunk->events[buffer.used] = event;
+        const int count = ++buffer.used;
+        if (count == CHUNK_EVENTS)
+        {
+            // Make the next chunk empty before this one is published as full.
+            Chunk *next = chunk->next.load(std::memory_order_relaxed);
+            if (!next && buffer.chunks < MAX_CHUNKS)
+            {
+                next = new Chunk;
+                chunk->next.store(next, std::memory_order_release);
+                ++buffer.chunks;
+            }
+            if (next)
+            {
+                next->count.store(0, std::memory_order_relaxed);
+            }
+            buffer.current = next;
+            buffer.used = 0;
+        }
+        chunk->count.store(count, std::memory_order_release);
+    }
+
+    template <typename Visit>
+    void forEachEvent(const ThreadBuffer &buffer, Visit visit)
+    {
+        const Chunk *chunk = buffer.head.get();
+        while (chunk)
+        {
+            const int count = chunk->count.load(std::memory_order_acquire);
+            for (int i = 0; i < count; ++i)
+            {
+                visit(chunk->events[i]);
+            }
+            if (count < CHUNK_EVENTS)
+            {
+                break;
+            }
+            chunk = chunk->next.load(std::memory_order_acquire);
+        }
+    }
+
+    void appendJsonString(QByteArray &out, const QByteArray &text)
+    {
+        out.append('"');
+        for (const char c : text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                out.append('\\');
+                out.append(c);
+            }
+            else if (static_cast<unsigned char>(c) < 0x20)
+            {
+                out.append(' ');
+            }
+            else
+            {
+                out.append(c);
+            }
+        }
+        out.append('"');
+    }
+
+    QByteArray microseconds(qint64 ns)
+    {
+        return QByteArray::number(ns / 1000.0, 'f', 3);
+    }
+}
+
+namespace trace
+{
+    void start()
+    {
+        Registry &reg = registry();
+        QMutexLocker locker(&reg.mutex);
+        reg.startNs = nowNs();
+        reg.dropped.store(0);
+        reg.generation.fetch_add(1, std::memory_order_release);
+        g_enabled.store(true);
+    }
+
+    void stop()
+    {
+        g_enabled.store(false);
+    }
+
+    Stats stats()
+    {
+        Registry &reg = registry();
+        QMutexLocker locker(&reg.mutex);
+        const quint64 generation = reg.generation.load();
+        Stats result;
+        result.dropped = reg.dropped.load();
+        for (const auto &buffer : reg.buffers)
+        {
+            if (buffer->generation.load(std::memory_order_acquire) != generation)
+            {
+                continue;
+            }
+            ++result.threads;
+            forEachEvent(*buffer, [&result](const Event &) {
+                ++result.events;
+            });
+        }
+        return result;
+    }
+
+    QByteArray toJson()
+    {
+        Registry &reg = registry();
+        QMutexLocker locker(&reg.mutex);
+        const quint64 generation = reg.generation.load();
+        // Written by hand rather than through QJsonDocument: a trace easily has millions of events.
+        QByteArray out("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+        bool first = true;
+        for (const auto &buffer : reg.buffers)
+        {
+            if (buffer->generation.load(std::memory_order_acquire) != generation)
+            {
+                continue;
+            }
+            const QByteArray tid = QByteArray::number(buffer->tid);
+            out.append(first ? "" : ",");
+            first = false;
+            out.append("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":").append(tid).append(",\"args\":{\"name\":");
+            appendJsonString(out, buffer->name.toUtf8());
+            out.append("}}");
+            forEachEvent(*buffer, [&out, &tid, &reg](const Event &event) {
+                out.append(",{\"name\":");
+                appendJsonString(out, event.name);
+                out.append(",\"cat\":");
+                appendJsonString(out, event.category);
+                out.append(",\"ph\":\"X\",\"ts\":").append(microseconds(event.beginNs - reg.startNs));
+                out.append(",\"dur\":").append(microseconds(event.durationNs));
+                out.append(",\"pid\":1,\"tid\":").append(tid).append('}');
+            });
+        }
+        out.append("]}");
+        return out;
+    }
+
+    void setThreadName(const QString &name)
+    {
+        ThreadBuffer &buffer = threadBuffer();
+        QMutexLocker locker(&registry().mutex);
+        buffer.name = name;
+    }
+
+    const char *intern(const QString &name)
+    {
+        Registry &reg = registry();
+        QMutexLocker locker(&reg.mutex);
+        if (const char *existing = reg.interned.value(name))
+        {
+            return existing;
+        }
+        reg.internedNames.push_back(name.toUtf8());
+        const char *copy = reg.internedNames.back().constData();
+        reg.interned.insert(name, copy);
+        return copy;
+    }
+
+    qint64 nowNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    void record(const char *category, const char *name, qint64 beginNs, qint64 endNs)
+    {
+        append(threadBuffer(), Event{category, name, beginNs, endNs - beginNs});
+    }
+}
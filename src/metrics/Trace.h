@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+
+// Scoped trace events in Chrome trace-event format (chrome://tracing, ui.perfetto.dev). Each
+// thread appends complete events to its own buffer without locking; the writer publishes an
+// event with a release store of its count, so toJson can read every buffer while the threads
+// keep recording. Names and categories must outlive the trace: string literals, or intern().
+// When tracing is off a scope costs one relaxed atomic load.
+namespace trace
+{
+    struct Stats
+    {
+        qint64 events{0};
+        // Events not kept because a thread's buffer was full.
+        qint64 dropped{0};
+        int threads{0};
+    };
+
+    extern std::atomic<bool> g_enabled;
+
+    inline bool isEnabled()
+    {
+        return g_enabled.load(std::memory_order_relaxed);
+    }
+
+    // Starting discards the events of the previous trace.
+    void start();
+    void stop();
+    Stats stats();
+    // Events recorded since the last start, with thread names, as Chrome trace JSON.
+    QByteArray toJson();
+
+    // Shown for the calling thread's events; defaults to the QThread object name.
+    void setThreadName(const QString &name);
+    // A stable copy of name for events whose name is only known at run time (RPC operations).
+    const char *intern(const QString &name);
+
+    qint64 nowNs();
+    void record(const char *category, const char *name, qint64 beginNs, qint64 endNs);
+
+    class Scope
+    {
+    public:
+        Scope(const char *category, const char *name)
+            : m_category(category)
+            , m_name(name)
+            , m_beginNs(isEnabled() ? nowNs() : -1)
+        {
+        }
+
+        ~Scope()
+        {
+            if (m_beginNs >= 0)
+            {
+                record(m_category, m_name, m_beginNs, nowNs());
+            }
+        }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        const char *m_category;
+        const char *m_name;
+        qint64 m_beginNs;
+    };
+}
@@ -0,0 +1,103 @@
+#include "TraceBenchmark.h"
+
+#include <QElapsedTimer>
+
+#include "Processing/SampleSink.h"
+#include "Processing/ThreeAxisGenerator.h"
+#include "Trace.h"
+
+namespace
+{
+    constexpr int RECTANGLES = 50;
+    constexpr int LINES = 5000;
+    constexpr double SPEED_MM_S = 100.0;
+    constexpr int SCOPES = 1'000'000;
+
+    class CountingSink : public SampleSink
+    {
+    public:
+        void addProcessData(quint16 X, quint16 Y, quint16 Z, quint16 A, quint16 B) override
+        {
+            m_checksum += X ^ Y ^ Z ^ A ^ B;
+            ++m_samples;
+        }
+
+        void addProcessJumpData(quint16 X, quint16 Y, quint16 Z, quint16 A, quint16 B) override
+        {
+            m_checksum += X ^ Y ^ Z ^ A ^ B;
+            ++m_samples;
+        }
+
+        void addProcessBegin() override
+        {
+        }
+
+        void addProcessEnd() override
+        {
+        }
+
+        qint64 samples() const
+        {
+            return m_samples;
+        }
+
+    private:
+        qint64 m_samples{0};
+        quint64 m_checksum{0};
+    };
+
+    double generateMs(qint64 &samples)
+    {
+        CountingSink sink;
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < RECTANGLES; ++i)
+        {
+            const double x = -10.0 + (i % 10) * 2.0;
+            const double y = -10.0 + (i / 10) * 2.0;
+            ThreeAxisGenerator::generateRectangle(sink, x, y, 4.5, x + 1.5, y + 1.5, 4.5, SPEED_MM_S, 0.05);
+        }
+        for (int i = 0; i < LINES; ++i)
+        {
+            const double x = -10.0 + (i % 100) * 0.2;
+            const double y = -10.0 + (i / 100) * 0.4;
+            ThreeAxisGenerator::generateLine(sink, SPEED_MM_S, true, x, y, 4.5, x + 1.0, y + 0.5, 4.5);
+        }
+        samples = sink.samples();
+        return timer.nsecsElapsed() / 1e6;
+    }
+
+    double scopeNs()
+    {
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < SCOPES; ++i)
+        {
+            trace::Scope scope("benchmark", "scope");
+        }
+        return static_cast<double>(timer.nsecsElapsed()) / SCOPES;
+    }
+}
+
+TraceBenchmark::Result TraceBenchmark::run(int rounds)
+{
+    Result result;
+    result.offMs = 1e300;
+    result.onMs = 1e300;
+    trace::stop();
+    result.nsPerDisabledScope = scopeNs();
+    // Interleaved so clock changes and other load hit both modes alike.
+    for (int round = 0; round < rounds; ++round)
+    {
+        trace::stop();
+        result.offMs = qMin(result.offMs, generateMs(result.samples));
+        trace::start();
+        result.onMs = qMin(result.onMs, generateMs(result.samples));
+        result.eventsPerRound = trace::stats().events;
+    }
+    trace::start();
+    result.nsPerEvent = scopeNs();
+    trace::stop();
+    result.overheadPercent = result.offMs > 0.0 ? (result.onMs - result.offMs) * 100.0 / result.offMs : 0.0;
+    return result;
+}
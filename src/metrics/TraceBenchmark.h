@@ -0,0 +1,24 @@
+#pragma once
+
+#include <QtGlobal>
+
+// Cost of tracing on the generator: the same mix of hatched rectangles and 1 mm lines is
+// generated into a counting sink with tracing off and on, best of several rounds each, and
+// a tight loop of empty scopes gives the cost of one event. Discards the current trace.
+class TraceBenchmark
+{
+public:
+    struct Result
+    {
+        qint64 samples{0};
+        qint64 eventsPerRound{0};
+        double offMs{0.0};
+        double onMs{0.0};
+        double overheadPercent{0.0};
+        double nsPerEvent{0.0};
+        // Same loop with tracing off: the price every instrumented call always pays.
+        double nsPerDisabledScope{0.0};
+    };
+
+    static Result run(int rounds);
+};
@@ -0,0 +1,372 @@
+#include "RTree.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+RTree::Box RTree::Box::united(const Box& other) const {
+    return { std::min(minX, other.minX), std::min(minY, other.minY), std::max(maxX, other.maxX),
+        std::max(maxY, other.maxY) };
+}
+
+RTree::RTree() = default;
+
+void RTree::clear() {
+    m_nodes.clear();
+    m_freeNodes.clear();
+    m_root = -1;
+    m_size = 0;
+}
+
+qint64 RTree::size() const {
+    return m_size;
+}
+
+int RTree::height() const {
+    if (m_root < 0) {
+        return 0;
+    }
+    int levels = 1;
+    for (int node = m_root; !m_nodes[node].leaf; node = static_cast<int>(m_nodes[node].children[0])) {
+        ++levels;
+    }
+    return levels;
+}
+
+int RTree::allocateNode(bool leaf) {
+    int index;
+    if (!m_freeNodes.empty()) {
+        index = m_freeNodes.back();
+        m_freeNodes.pop_back();
+        m_nodes[index] = Node();
+    }
+    else {
+        index = static_cast<int>(m_nodes.size());
+        m_nodes.emplace_back();
+    }
+    m_nodes[index].leaf = leaf;
+    return index;
+}
+
+void RTree::freeNode(int node) {
+    m_nodes[node].count = 0;
+    m_freeNodes.push_back(node);
+}
+
+RTree::Box RTree::nodeBox(int node) const {
+    const Node& n = m_nodes[node];
+    if (n.count == 0) {
+        return {};
+    }
+    Box box = n.boxes[0];
+    for (int i = 1; i < n.count; ++i) {
+        box = box.united(n.boxes[i]);
+    }
+    return box;
+}
+
+int RTree::slotInParent(int node) const {
+    const Node& parent = m_nodes[m_nodes[node].parent];
+    for (int i = 0; i < parent.count; ++i) {
+        if (parent.children[i] == static_cast<quint32>(node)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int RTree::chooseLeaf(const Box& box) const {
+    int node = m_root;
+    while (!m_nodes[node].leaf) {
+        const Node& n = m_nodes[node];
+        int best = 0;
+        double bestGrowth = std::numeric_limits<double>::max();
+        double bestArea = std::numeric_limits<double>::max();
+        for (int i = 0; i < n.count; ++i) {
+            const double area = n.boxes[i].area();
+            const double growth = n.boxes[i].united(box).area() - area;
+            if (growth < bestGrowth || (growth == bestGrowth && area < bestArea)) {
+                best = i;
+                bestGrowth = growth;
+                bestArea = area;
+            }
+        }
+        node = static_cast<int>(n.children[best]);
+    }
+    return node;
+}
+
+void RTree::insert(quint32 key, const Box& box) {
+    if (m_root < 0) {
+        m_root = allocateNode(true);
+    }
+    insertAt(chooseLeaf(box), key, box);
+    ++m_size;
+}
+
+void RTree::insertAt(int node, quint32 child, const Box& box) {
+    {
+        Node& n = m_nodes[node];
+        n.boxes[n.count] = box;
+        n.children[n.count] = child;
+        ++n.count;
+        if (!n.leaf) {
+            m_nodes[child].parent = node;
+        }
+        if (n.count <= MAX_ENTRIES) {
+            adjustUpwards(node);
+            return;
+        }
+    }
+    // allocateNode may grow m_nodes, so no Node reference is held across it.
+    const int sibling = split(node);
+    if (node == m_root) {
+        const int root = allocateNode(false);
+        Node& r = m_nodes[root];
+        r.count = 2;
+        r.boxes[0] = nodeBox(node);
+        r.children[0] = static_cast<quint32>(node);
+        r.boxes[1] = nodeBox(sibling);
+        r.children[1] = static_cast<quint32>(sibling);
+        m_nodes[node].parent = root;
+        m_nodes[sibling].parent = root;
+        m_root = root;
+        return;
+    }
+    const int parent = m_nodes[node].parent;
+    m_nodes[parent].boxes[slotInParent(node)] = nodeBox(node);
+    insertAt(parent, static_cast<quint32>(sibling), nodeBox(sibling));
+}
+
+int RTree::split(int node) {
+    const bool leaf = m_nodes[node].leaf;
+    const int sibling = allocateNode(leaf);
+    Node& a = m_nodes[node];
+    Node& b = m_nodes[sibling];
+
+    constexpr int total = MAX_ENTRIES + 1;
+    Box boxes[total];
+    quint32 children[total];
+    std::copy(a.boxes, a.boxes + total, boxes);
+    std::copy(a.children, a.children + total, children);
+
+    // Quadratic split: seed with the pair that would waste the most area together.
+    int seedA = 0;
+    int seedB = 1;
+    double worst = std::numeric_limits<double>::lowest();
+    for (int i = 0; i < total; ++i) {
+        for (int j = i + 1; j < total; ++j) {
+            const double waste = boxes[i].united(boxes[j]).area() - boxes[i].area() - boxes[j].area();
+            if (waste > worst) {
+                worst = waste;
+                seedA = i;
+                seedB = j;
+            }
+        }
+    }
+    bool assigned[total] = {};
+    a.count = 0;
+    b.count = 0;
+    auto assign = [&](Node& target, Box& cover, int i) {
+        target.boxes[target.count] = boxes[i];
+        target.children[target.count] = children[i];
+        ++target.count;
+        cover = target.count == 1 ? boxes[i] : cover.united(boxes[i]);
+        assigned[i] = true;
+    };
+    Box coverA;
+    Box coverB;
+    assign(a, coverA, seedA);
+    assign(b, coverB, seedB);
+
+    for (int remaining = total - 2; remaining > 0; --remaining) {
+        // Give the rest to a group that could otherwise not reach the minimum fill.
+        if (a.count + remaining == MIN_ENTRIES || b.count + remaining == MIN_ENTRIES) {
+            Node& target = a.count < b.count ? a : b;
+            Box& cover = a.count < b.count ? coverA : coverB;
+            for (int i = 0; i < total; ++i) {
+                if (!assigned[i]) {
+                    assign(target, cover, i);
+                }
+            }
+            break;
+        }
+        // Next, the entry with the strongest preference for one group.
+        int pick = -1;
+        double pickGrowthA = 0.0;
+        double pickGrowthB = 0.0;
+        double strongest = -1.0;
+        for (int i = 0; i < total; ++i) {
+            if (assigned[i]) {
+                continue;
+            }
+            const double growthA = coverA.united(boxes[i]).area() - coverA.area();
+            const double growthB = coverB.united(boxes[i]).area() - coverB.area();
+            if (std::abs(growthA - growthB) > strongest) {
+                strongest = std::abs(growthA - growthB);
+                pick = i;
+                pickGrowthA = growthA;
+                pickGrowthB = growthB;
+            }
+        }
+        bool toA = pickGrowthA < pickGrowthB;
+        if (pickGrowthA == pickGrowthB) {
+            toA = coverA.area() != coverB.area() ? coverA.area() < coverB.area() : a.count <= b.count;
+        }
+        if (toA) {
+            assign(a, coverA, pick);
+        }
+        else {
+            assign(b, coverB, pick);
+        }
+    }
+
+    if (!leaf) {
+        for (int i = 0; i < b.count; ++i) {
+            m_nodes[b.children[i]].parent = sibling;
+        }
+        for (int i = 0; i < a.count; ++i) {
+            m_nodes[a.children[i]].parent = node;
+        }
+    }
+    return sibling;
+}
+
+void RTree::adjustUpwards(int node) {
+    while (node != m_root) {
+        const int parent = m_nodes[node].parent;
+        m_nodes[parent].boxes[slotInParent(node)] = nodeBox(node);
+        node = parent;
+    }
+}
+
+int RTree::findLeaf(int node, quint32 key, const Box& box, int& slot) const {
+    const Node& n = m_nodes[node];
+    for (int i = 0; i < n.count; ++i) {
+        if (n.leaf) {
+            if (n.children[i] == key) {
+                slot = i;
+                return node;
+            }
+        }
+        else if (n.boxes[i].contains(box)) {
+            const int found = findLeaf(static_cast<int>(n.children[i]), key, box, slot);
+            if (found >= 0) {
+                return found;
+            }
+        }
+    }
+    return -1;
+}
+
+bool RTree::remove(quint32 key, const Box& box) {
+    if (m_size == 0) {
+        return false;
+    }
+    int slot = -1;
+    const int leaf = findLeaf(m_root, key, box, slot);
+    if (leaf < 0) {
+        return false;
+    }
+    Node& n = m_nodes[leaf];
+    --n.count;
+    n.boxes[slot] = n.boxes[n.count];
+    n.children[slot] = n.children[n.count];
+    --m_size;
+    condense(leaf);
+    return true;
+}
+
+void RTree::collectEntries(int node, std::vector<Entry>& out) {
+    const Node& n = m_nodes[node];
+    for (int i = 0; i < n.count; ++i) {
+        if (n.leaf) {
+            out.push_back({ n.children[i], n.boxes[i] });
+        }
+        else {
+            collectEntries(static_cast<int>(n.children[i]), out);
+        }
+    }
+    freeNode(node);
+}
+
+void RTree::condense(int leaf) {
+    // Underfull nodes are dissolved on the way up and their entries inserted again.
+    std::vector<Entry> orphans;
+    int node = leaf;
+    while (node != m_root) {
+        const int parent = m_nodes[node].parent;
+        const int slot = slotInParent(node);
+        Node& p = m_nodes[parent];
+        if (m_nodes[node].count < MIN_ENTRIES) {
+            --p.count;
+            p.boxes[slot] = p.boxes[p.count];
+            p.children[slot] = p.children[p.count];
+            collectEntries(node, orphans);
+        }
+        else {
+            p.boxes[slot] = nodeBox(node);
+        }
+        node = parent;
+    }
+    while (!m_nodes[m_root].leaf && m_nodes[m_root].count == 1) {
+        const int old = m_root;
+        m_root = static_cast<int>(m_nodes[old].children[0]);
+        m_nodes[m_root].parent = -1;
+        freeNode(old);
+    }
+    if (m_nodes[m_root].count == 0) {
+        m_nodes[m_root].leaf = true;
+    }
+    for (const Entry& entry : orphans) {
+        insertAt(chooseLeaf(entry.box), entry.key, entry.box);
+    }
+}
+
+std::vector<RTree::Entry> RTree::packLevel(std::vector<Entry>& entries, bool leaves) {
+    // Sort-tile-recursive: vertical slices by centre x, then runs of MAX_ENTRIES by centre y.
+    const size_t count = entries.size();
+    const size_t nodes = (count + MAX_ENTRIES - 1) / MAX_ENTRIES;
+    const size_t slices = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(nodes))));
+    const size_t sliceSize = slices * MAX_ENTRIES;
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return a.box.minX + a.box.maxX < b.box.minX + b.box.maxX;
+        });
+    std::vector<Entry> upper;
+    upper.reserve(nodes);
+    for (size_t sliceStart = 0; sliceStart < count; sliceStart += sliceSize) {
+        const auto sliceEnd = entries.begin() + static_cast<qint64>(std::min(count, sliceStart + sliceSize));
+        std::sort(entries.begin() + static_cast<qint64>(sliceStart), sliceEnd, [](const Entry& a, const Entry& b) {
+            return a.box.minY + a.box.maxY < b.box.minY + b.box.maxY;
+            });
+        for (auto it = entries.begin() + static_cast<qint64>(sliceStart); it < sliceEnd;) {
+            const int node = allocateNode(leaves);
+            Node& n = m_nodes[node];
+            for (; it < sliceEnd && n.count < MAX_ENTRIES; ++it) {
+                n.boxes[n.count] = it->box;
+                n.children[n.count] = it->key;
+                ++n.count;
+                if (!leaves) {
+                    m_nodes[it->key].parent = node;
+                }
+            }
+            upper.push_back({ static_cast<quint32>(node), nodeBox(node) });
+        }
+    }
+    return upper;
+}
+
+void RTree::bulkLoad(std::vector<Entry> entries) {
+    clear();
+    if (entries.empty()) {
+        return;
+    }
+    m_size = static_cast<qint64>(entries.size());
+    m_nodes.reserve(entries.size() / (MAX_ENTRIES - 2) + 16);
+    std::vector<Entry> level = packLevel(entries, true);
+    while (level.size() > 1) {
+        level = packLevel(level, false);
+    }
+    m_root = static_cast<int>(level.front().key);
+    m_nodes[m_root].parent = -1;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <vector>
+
+#include <QtGlobal>
+
+// 2D R-tree of (key, box) entries: Guttman's insertion with quadratic split, deletion with
+// condense-and-reinsert, and sort-tile-recursive packing for building from many entries at
+// once. Nodes live in one vector and refer to each other by index, so the tree is a few
+// flat allocations however many entries it holds.
+class RTree {
+public:
+    struct Box {
+        double minX{ 0.0 };
+        double minY{ 0.0 };
+        double maxX{ 0.0 };
+        double maxY{ 0.0 };
+
+        bool intersects(const Box& other) const {
+            return minX <= other.maxX && other.minX <= maxX && minY <= other.maxY && other.minY <= maxY;
+        }
+        bool contains(const Box& other) const {
+            return minX <= other.minX && other.maxX <= maxX && minY <= other.minY && other.maxY <= maxY;
+        }
+        double area() const { return (maxX - minX) * (maxY - minY); }
+        Box united(const Box& other) const;
+    };
+
+    struct Entry {
+        quint32 key;
+        Box box;
+    };
+
+    static constexpr int MAX_ENTRIES = 16;
+    static constexpr int MIN_ENTRIES = MAX_ENTRIES * 2 / 5;
+
+    RTree();
+
+    void clear();
+    void insert(quint32 key, const Box& box);
+    // box must be the one the key was inserted with; false if no such entry exists.
+    bool remove(quint32 key, const Box& box);
+    // Replaces the contents; packs the entries bottom-up instead of inserting one by one.
+    void bulkLoad(std::vector<Entry> entries);
+
+    qint64 size() const;
+    int height() const;
+
+    // Calls visit(key, box) for every entry intersecting box; visit returns false to stop.
+    template <typename Visit>
+    void query(const Box& box, Visit&& visit) const;
+
+private:
+    struct Node {
+        bool leaf{ true };
+        int count{ 0 };
+        int parent{ -1 };
+        // One slot more than MAX_ENTRIES, so an overflowing node can be split in place.
+        Box boxes[MAX_ENTRIES + 1];
+        // Child node index for inner nodes, entry key for leaves.
+        quint32 children[MAX_ENTRIES + 1];
+    };
+
+    int allocateNode(bool leaf);
+    void freeNode(int node);
+    Box nodeBox(int node) const;
+    int slotInParent(int node) const;
+    int chooseLeaf(const Box& box) const;
+    void insertAt(int node, quint32 child, const Box& box);
+    int split(int node);
+    void adjustUpwards(int node);
+    int findLeaf(int node, quint32 key, const Box& box, int& slot) const;
+    void collectEntries(int node, std::vector<Entry>& out);
+    void condense(int leaf);
+    // Groups one level of entries into nodes; returns the entries for the level above.
+    std::vector<Entry> packLevel(std::vector<Entry>& entries, bool leaves);
+
+    std::vector<Node> m_nodes;
+    std::vector<int> m_freeNodes;
+    int m_root{ -1 };
+    qint64 m_size{ 0 };
+};
+
+template <typename Visit>
+void RTree::query(const Box& box, Visit&& visit) const {
+    if (m_size == 0) {
+        return;
+    }
+    // Depth-first; each level pushes at most MAX_ENTRIES children.
+    int stack[MAX_ENTRIES * 32];
+    int depth = 0;
+    stack[depth++] = m_root;
+    while (depth > 0) {
+        const Node& node = m_nodes[stack[--depth]];
+        for (int i = 0; i < node.count; ++i) {
+            if (!node.boxes[i].intersects(box)) {
+                continue;
+            }
+            if (node.leaf) {
+                if (!visit(node.children[i], node.boxes[i])) {
+                    return;
+                }
+            }
+            else {
+                stack[depth++] = static_cast<int>(node.children[i]);
+            }
+        }
+    }
+}
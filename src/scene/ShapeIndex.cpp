@@ -0,0 +1,241 @@
+#include "ShapeIndex.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "scene/ShapeStore.h"
+
+namespace {
+    // Rectangle3D items draw a second rect this far up and to the right of the stored one.
+    constexpr double RECT3D_OFFSET = 8.0;
+    // Batches touching more rows than this (and more than a quarter of the store) are
+    // re-packed instead of applied entry by entry.
+    constexpr int REBUILD_MIN_ROWS = 4096;
+
+    double segmentDistance(const QPointF& p, const QPointF& a, const QPointF& b) {
+        const QPointF ab = b - a;
+        const double lengthSquared = QPointF::dotProduct(ab, ab);
+        double t = 0.0;
+        if (lengthSquared > 0.0) {
+            t = std::clamp(QPointF::dotProduct(p - a, ab) / lengthSquared, 0.0, 1.0);
+        }
+        const QPointF d = p - (a + ab * t);
+        return std::hypot(d.x(), d.y());
+    }
+}
+
+ShapeIndex::ShapeIndex(ShapeStore* store, QObject* parent)
+    : QObject(parent)
+    , m_store(store) {
+    connect(m_store, &ShapeStore::rowsAppended, this, &ShapeIndex::onRowsAppended);
+    connect(m_store, &ShapeStore::rowsAboutToBeRemoved, this, &ShapeIndex::onRowsAboutToBeRemoved);
+    connect(m_store, &ShapeStore::reset, this, &ShapeIndex::rebuild);
+    connect(m_store, &ShapeStore::geometryChanged, this, &ShapeIndex::onGeometryChanged);
+    rebuild();
+}
+
+qint64 ShapeIndex::size() const {
+    return m_tree.size();
+}
+
+int ShapeIndex::height() const {
+    return m_tree.height();
+}
+
+RTree::Box ShapeIndex::rowBox(int row) const {
+    const QRectF bounds = m_store->bounds(row);
+    RTree::Box box{ bounds.left(), bounds.top(), bounds.right(), bounds.bottom() };
+    if (m_store->kind(row) == ShapeStore::Kind::Rectangle3D) {
+        box.minY -= RECT3D_OFFSET;
+        box.maxX += RECT3D_OFFSET;
+    }
+    return box;
+}
+
+bool ShapeIndex::isLarge(int rows) const {
+    return rows > REBUILD_MIN_ROWS && rows > m_store->size() / 4;
+}
+
+void ShapeIndex::rebuild() {
+    m_slots.clear();
+    m_slotIds.clear();
+    m_slotBoxes.clear();
+    m_freeSlots.clear();
+    std::vector<RTree::Entry> entries;
+    entries.reserve(m_store->size());
+    m_slots.reserve(m_store->size());
+    for (int row = 0; row < m_store->size(); ++row) {
+        const QString& id = m_store->id(row);
+        // Skips rows removed in an open batch; their removal is announced later.
+        if (m_store->rowOf(id) != row) {
+            continue;
+        }
+        const auto slot = static_cast<quint32>(m_slotIds.size());
+        const RTree::Box box = rowBox(row);
+        m_slots.insert(id, slot);
+        m_slotIds.push_back(id);
+        m_slotBoxes.push_back(box);
+        entries.push_back({ slot, box });
+    }
+    m_tree.bulkLoad(std::move(entries));
+}
+
+void ShapeIndex::insertRow(int row) {
+    const QString& id = m_store->id(row);
+    if (m_slots.contains(id)) {
+        updateRow(row);
+        return;
+    }
+    quint32 slot;
+    if (!m_freeSlots.empty()) {
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    }
+    else {
+        slot = static_cast<quint32>(m_slotIds.size());
+        m_slotIds.emplace_back();
+        m_slotBoxes.emplace_back();
+    }
+    m_slots.insert(id, slot);
+    m_slotIds[slot] = id;
+    m_slotBoxes[slot] = rowBox(row);
+    m_tree.insert(slot, m_slotBoxes[slot]);
+}
+
+void ShapeIndex::removeId(const QString& id) {
+    const auto it = m_slots.find(id);
+    if (it == m_slots.end()) {
+        return;
+    }
+    const quint32 slot = it.value();
+    m_slots.erase(it);
+    m_tree.remove(slot, m_slotBoxes[slot]);
+    m_slotIds[slot].clear();
+    m_freeSlots.push_back(slot);
+}
+
+void ShapeIndex::updateRow(int row) {
+    const auto it = m_slots.constFind(m_store->id(row));
+    if (it == m_slots.cend()) {
+        return;
+    }
+    const quint32 slot = it.value();
+    const RTree::Box box = rowBox(row);
+    m_tree.remove(slot, m_slotBoxes[slot]);
+    m_slotBoxes[slot] = box;
+    m_tree.insert(slot, box);
+}
+
+void ShapeIndex::onRowsAppended(int first, int last) {
+    if (isLarge(last - first + 1)) {
+        rebuild();
+        return;
+    }
+    for (int row = first; row <= last; ++row) {
+        insertRow(row);
+    }
+}
+
+void ShapeIndex::onRowsAboutToBeRemoved(int first, int last) {
+    for (int row = first; row <= last; ++row) {
+        removeId(m_store->id(row));
+    }
+}
+
+void ShapeIndex::onGeometryChanged(int first, int last) {
+    if (isLarge(last - first + 1)) {
+        rebuild();
+        return;
+    }
+    for (int row = first; row <= last; ++row) {
+        updateRow(row);
+    }
+}
+
+QString ShapeIndex::pick(const QPointF& pos, double tolerance) const {
+    const RTree::Box probe{ pos.x() - tolerance, pos.y() - tolerance, pos.x() + tolerance, pos.y() + tolerance };
+    int topRow = -1;
+    m_tree.query(probe, [&](quint32 slot, const RTree::Box& box) {
+        const int row = m_store->rowOf(m_slotIds[slot]);
+        if (row <= topRow) {
+            return true;
+        }
+        bool hit = false;
+        switch (m_store->kind(row)) {
+        case ShapeStore::Kind::Line:
+            hit = segmentDistance(pos, m_store->p1(row), m_store->p2(row)) <= tolerance;
+            break;
+        case ShapeStore::Kind::Circle:
+        case ShapeStore::Kind::Ellipse: {
+            const QRectF bounds = m_store->bounds(row);
+            const double a = bounds.width() / 2.0 + tolerance;
+            const double b = bounds.height() / 2.0 + tolerance;
+            const double dx = (pos.x() - bounds.center().x()) / a;
+            const double dy = (pos.y() - bounds.center().y()) / b;
+            hit = dx * dx + dy * dy <= 1.0;
+            break;
+        }
+        case ShapeStore::Kind::Rectangle:
+        case ShapeStore::Kind::Rectangle3D:
+            // The probe already intersects the (tolerance-free) box.
+            hit = box.intersects(probe);
+            break;
+        }
+        if (hit) {
+            topRow = row;
+        }
+        return true;
+        });
+    return topRow >= 0 ? m_store->id(topRow) : QString();
+}
+
+QStringList ShapeIndex::intersecting(const QRectF& rect) const {
+    const QRectF normalized = rect.normalized();
+    const RTree::Box probe{ normalized.left(), normalized.top(), normalized.right(), normalized.bottom() };
+    QStringList ids;
+    m_tree.query(probe, [&](quint32 slot, const RTree::Box&) {
+        ids.append(m_slotIds[slot]);
+        return true;
+        });
+    return ids;
+}
+
+bool ShapeIndex::snap(const QPointF& pos, double radius, QPointF& snapped) const {
+    const RTree::Box probe{ pos.x() - radius, pos.y() - radius, pos.x() + radius, pos.y() + radius };
+    double best = radius;
+    bool found = false;
+    auto consider = [&](const QPointF& candidate) {
+        const double distance = std::hypot(candidate.x() - pos.x(), candidate.y() - pos.y());
+        if (distance <= best) {
+            best = distance;
+            snapped = candidate;
+            found = true;
+        }
+    };
+    m_tree.query(probe, [&](quint32 slot, const RTree::Box&) {
+        const int row = m_store->rowOf(m_slotIds[slot]);
+        if (m_store->kind(row) == ShapeStore::Kind::Line) {
+            consider(m_store->p1(row));
+            consider(m_store->p2(row));
+            consider((m_store->p1(row) + m_store->p2(row)) / 2.0);
+            return true;
+        }
+        const QRectF bounds = m_store->bounds(row);
+        consider(bounds.center());
+        if (m_store->kind(row) == ShapeStore::Kind::Circle || m_store->kind(row) == ShapeStore::Kind::Ellipse) {
+            // Quadrant points of the outline.
+            consider(QPointF(bounds.left(), bounds.center().y()));
+            consider(QPointF(bounds.right(), bounds.center().y()));
+            consider(QPointF(bounds.center().x(), bounds.top()));
+            consider(QPointF(bounds.center().x(), bounds.bottom()));
+        }
+        else {
+            consider(bounds.topLeft());
+            consider(bounds.topRight());
+            consider(bounds.bottomLeft());
+            consider(bounds.bottomRight());
+        }
+        return true;
+        });
+    return found;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+
+#include <QHash>
+#include <QObject>
+#include <QPointF>
+#include <QRectF>
+#include <QStringList>
+
+#include "scene/RTree.h"
+
+class ShapeStore;
+
+// R-tree over the scene bounds of every shape in a ShapeStore, kept in step with the store's
+// row signals. Entries are keyed by a slot per shape id that survives row compaction, so
+// removing shapes never renumbers the tree. Large batches (bulk loads, whole-scene
+// transforms) rebuild it by packing instead of updating entries one by one.
+class ShapeIndex : public QObject {
+    Q_OBJECT
+public:
+    explicit ShapeIndex(ShapeStore* store, QObject* parent = nullptr);
+
+    // Topmost (most recently created) shape under pos, within tolerance of its outline for
+    // lines and of its area for everything else; empty if there is none.
+    QString pick(const QPointF& pos, double tolerance) const;
+    // Shapes whose bounds intersect rect, in no particular order.
+    QStringList intersecting(const QRectF& rect) const;
+    // Nearest end point, corner, midpoint or centre within radius of pos.
+    bool snap(const QPointF& pos, double radius, QPointF& snapped) const;
+
+    qint64 size() const;
+    int height() const;
+    void rebuild();
+
+private:
+    RTree::Box rowBox(int row) const;
+    // Updates the entry instead if the id is already indexed (e.g. by a rebuild mid-batch).
+    void insertRow(int row);
+    void removeId(const QString& id);
+    void updateRow(int row);
+    bool isLarge(int rows) const;
+    void onRowsAppended(int first, int last);
+    void onRowsAboutToBeRemoved(int first, int last);
+    void onGeometryChanged(int first, int last);
+
+    ShapeStore* m_store;
+    RTree m_tree;
+    QHash<QString, quint32> m_slots;
+    // Per slot: the shape id and the box it is filed under in the tree.
+    std::vector<QString> m_slotIds;
+    std::vector<RTree::Box> m_slotBoxes;
+    std::vector<quint32> m_freeSlots;
+};
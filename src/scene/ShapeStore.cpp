@@ -0,0 +1,354 @@
+#include "ShapeStore.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace {
+    // Beyond this many separate removed ranges one reset is cheaper for attached views than
+    // a remove signal per range.
+    constexpr int MAX_REMOVE_RANGES = 64;
+
+    const QString KIND_NAMES[] = {
+        QStringLiteral("Line"),
+        QStringLiteral("Circle"),
+        QStringLiteral("Rectangle"),
+        QStringLiteral("Ellipse"),
+        QStringLiteral("Rectangle3D"),
+    };
+}
+
+ShapeStore::Batch::Batch(ShapeStore* store)
+    : m_store(store) {
+    m_store->beginBatch();
+}
+
+ShapeStore::Batch::~Batch() {
+    m_store->endBatch();
+}
+
+ShapeStore::ShapeStore(QObject* parent)
+    : QObject(parent) {
+}
+
+const QString& ShapeStore::kindName(Kind kind) {
+    return KIND_NAMES[static_cast<int>(kind)];
+}
+
+bool ShapeStore::kindFromName(const QString& name, Kind& kind) {
+    for (int i = 0; i < static_cast<int>(std::size(KIND_NAMES)); ++i) {
+        if (KIND_NAMES[i] == name) {
+            kind = static_cast<Kind>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename Function>
+void ShapeStore::forEachColumn(Function function) {
+    function(m_ids);
+    function(m_kinds);
+    function(m_x1);
+    function(m_y1);
+    function(m_x2);
+    function(m_y2);
+    function(m_tx);
+    function(m_ty);
+    function(m_speed);
+    function(m_times);
+    function(m_removed);
+}
+
+int ShapeStore::size() const {
+    return static_cast<int>(m_ids.size());
+}
+
+int ShapeStore::announcedSize() const {
+    return m_announced;
+}
+
+int ShapeStore::rowOf(const QString& id) const {
+    return m_rows.value(id, -1);
+}
+
+const QString& ShapeStore::id(int row) const {
+    return m_ids[row];
+}
+
+ShapeStore::Kind ShapeStore::kind(int row) const {
+    return m_kinds[row];
+}
+
+const QString& ShapeStore::type(int row) const {
+    return kindName(m_kinds[row]);
+}
+
+QStringList ShapeStore::ids() const {
+    QStringList result;
+    result.reserve(size() - m_removedCount);
+    for (int row = 0; row < size(); ++row) {
+        if (!m_removed[row]) {
+            result.append(m_ids[row]);
+        }
+    }
+    return result;
+}
+
+QPointF ShapeStore::p1(int row) const {
+    return QPointF(m_x1[row] + m_tx[row], m_y1[row] + m_ty[row]);
+}
+
+QPointF ShapeStore::p2(int row) const {
+    return QPointF(m_x2[row] + m_tx[row], m_y2[row] + m_ty[row]);
+}
+
+QRectF ShapeStore::bounds(int row) const {
+    return QRectF(p1(row), p2(row)).normalized();
+}
+
+QPointF ShapeStore::translation(int row) const {
+    return QPointF(m_tx[row], m_ty[row]);
+}
+
+double ShapeStore::speed(int row) const {
+    return m_speed[row];
+}
+
+int ShapeStore::times(int row) const {
+    return m_times[row];
+}
+
+void ShapeStore::append(const QString& id, Kind kind, const QPointF& p1, const QPointF& p2) {
+    if (m_rows.contains(id)) {
+        return;
+    }
+    QPointF first = p1;
+    QPointF second = p2;
+    if (kind != Kind::Line) {
+        const QRectF rect = QRectF(p1, p2).normalized();
+        first = rect.topLeft();
+        second = rect.bottomRight();
+    }
+    m_rows.insert(id, size());
+    m_ids.push_back(id);
+    m_kinds.push_back(kind);
+    m_x1.push_back(first.x());
+    m_y1.push_back(first.y());
+    m_x2.push_back(second.x());
+    m_y2.push_back(second.y());
+    m_tx.push_back(0.0);
+    m_ty.push_back(0.0);
+    m_speed.push_back(0.0);
+    m_times.push_back(0);
+    m_removed.push_back(0);
+    if (m_batchDepth == 0) {
+        commit();
+    }
+}
+
+void ShapeStore::remove(const QString& id) {
+    const int row = m_rows.value(id, -1);
+    if (row < 0) {
+        return;
+    }
+    m_removed[row] = true;
+    ++m_removedCount;
+    m_rows.remove(id);
+    if (m_batchDepth == 0) {
+        commit();
+    }
+}
+
+void ShapeStore::clear() {
+    if (m_ids.empty()) {
+        return;
+    }
+    emit aboutToReset();
+    forEachColumn([](auto& column) {
+        column.clear();
+        });
+    m_rows.clear();
+    m_announced = 0;
+    m_removedCount = 0;
+    emit reset();
+}
+
+void ShapeStore::setTranslation(int row, const QPointF& translation) {
+    m_tx[row] = translation.x();
+    m_ty[row] = translation.y();
+    emit geometryChanged(row, row);
+}
+
+void ShapeStore::setProcess(int row, double speed, int times) {
+    m_speed[row] = qMax(0.0, speed);
+    m_times[row] = qMax(0, times);
+}
+
+void ShapeStore::translate(int first, int last, double dx, double dy) {
+    last = qMin(last, size() - 1);
+    if (first < 0 || first > last) {
+        return;
+    }
+    double* tx = m_tx.data();
+    double* ty = m_ty.data();
+    for (int i = first; i <= last; ++i) {
+        tx[i] += dx;
+        ty[i] += dy;
+    }
+    emit geometryChanged(first, last);
+}
+
+void ShapeStore::scale(int first, int last, double factor, const QPointF& center) {
+    last = qMin(last, size() - 1);
+    // A negative factor would mirror the stored rects and break their normalization.
+    if (first < 0 || first > last || factor <= 0.0) {
+        return;
+    }
+    // scene = local + t, so scaling about c gives local' = f * local and t' = c + f * (t - c).
+    const double cx = center.x() * (1.0 - factor);
+    const double cy = center.y() * (1.0 - factor);
+    double* x1 = m_x1.data();
+    double* y1 = m_y1.data();
+    double* x2 = m_x2.data();
+    double* y2 = m_y2.data();
+    double* tx = m_tx.data();
+    double* ty = m_ty.data();
+    for (int i = first; i <= last; ++i) {
+        x1[i] *= factor;
+        y1[i] *= factor;
+        x2[i] *= factor;
+        y2[i] *= factor;
+        tx[i] = tx[i] * factor + cx;
+        ty[i] = ty[i] * factor + cy;
+    }
+    emit geometryChanged(first, last);
+}
+
+void ShapeStore::translate(const std::vector<int>& rows, double dx, double dy) {
+    std::vector<int> sorted(rows);
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+    // One signal per contiguous run, so followers never touch the rows between scattered ones.
+    int first = -1;
+    int last = -1;
+    for (const int row : sorted) {
+        if (row < 0 || row >= size()) {
+            continue;
+        }
+        m_tx[row] += dx;
+        m_ty[row] += dy;
+        if (first < 0 || row != last + 1) {
+            if (first >= 0) {
+                emit geometryChanged(first, last);
+            }
+            first = row;
+        }
+        last = row;
+    }
+    if (first >= 0) {
+        emit geometryChanged(first, last);
+    }
+}
+
+QRectF ShapeStore::sceneBounds() const {
+    if (m_ids.empty()) {
+        return {};
+    }
+    double minX = std::numeric_limits<double>::max();
+    double minY = std::numeric_limits<double>::max();
+    double maxX = std::numeric_limits<double>::lowest();
+    double maxY = std::numeric_limits<double>::lowest();
+    const int count = size();
+    for (int i = 0; i < count; ++i) {
+        minX = std::min(minX, std::min(m_x1[i], m_x2[i]) + m_tx[i]);
+        minY = std::min(minY, std::min(m_y1[i], m_y2[i]) + m_ty[i]);
+        maxX = std::max(maxX, std::max(m_x1[i], m_x2[i]) + m_tx[i]);
+        maxY = std::max(maxY, std::max(m_y1[i], m_y2[i]) + m_ty[i]);
+    }
+    return QRectF(QPointF(minX, minY), QPointF(maxX, maxY));
+}
+
+void ShapeStore::beginBatch() {
+    ++m_batchDepth;
+}
+
+void ShapeStore::endBatch() {
+    if (m_batchDepth > 0 && --m_batchDepth == 0) {
+        commit();
+    }
+}
+
+void ShapeStore::commit() {
+    // Rows appended and removed within the batch were never announced; drop them silently.
+    compact(m_announced);
+
+    if (m_removedCount > 0) {
+        std::vector<std::pair<int, int>> ranges;
+        for (int row = 0; row < m_announced; ++row) {
+            if (!m_removed[row]) {
+                continue;
+            }
+            if (!ranges.empty() && ranges.back().second == row - 1) {
+                ranges.back().second = row;
+            }
+            else {
+                ranges.emplace_back(row, row);
+            }
+        }
+        if (static_cast<int>(ranges.size()) > MAX_REMOVE_RANGES) {
+            emit aboutToReset();
+            compact(0);
+            m_announced = size();
+            emit reset();
+            return;
+        }
+        // Back to front, so the rows of earlier ranges stay valid.
+        for (auto it = ranges.rbegin(); it != ranges.rend(); ++it) {
+            const auto [first, last] = *it;
+            emit rowsAboutToBeRemoved(first, last);
+            forEachColumn([first, last](auto& column) {
+                column.erase(column.begin() + first, column.begin() + last + 1);
+                });
+            m_announced -= last - first + 1;
+            m_removedCount -= last - first + 1;
+            emit rowsRemoved(first, last);
+        }
+        reindex(ranges.front().first);
+    }
+
+    if (size() > m_announced) {
+        const int first = m_announced;
+        m_announced = size();
+        emit rowsAppended(first, m_announced - 1);
+    }
+}
+
+void ShapeStore::compact(int from) {
+    int out = from;
+    for (int row = from; row < size(); ++row) {
+        if (m_removed[row]) {
+            --m_removedCount;
+            continue;
+        }
+        if (out != row) {
+            forEachColumn([out, row](auto& column) {
+                column[out] = std::move(column[row]);
+                });
+        }
+        ++out;
+    }
+    if (out == size()) {
+        return;
+    }
+    forEachColumn([out](auto& column) {
+        column.resize(out);
+        });
+    reindex(from);
+}
+
+void ShapeStore::reindex(int from) {
+    for (int row = from; row < size(); ++row) {
+        m_rows[m_ids[row]] = row;
+    }
+}
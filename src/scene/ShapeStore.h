@@ -0,0 +1,118 @@
+#pragma once
+
+#include <vector>
+
+#include <QHash>
+#include <QObject>
+#include <QPointF>
+#include <QRectF>
+#include <QString>
+#include <QStringList>
+
+// The drawn shapes in creation order, addressed by row and stored column by column: kind,
+// local geometry, translation and per-shape process overrides each live in their own
+// contiguous array, so job generation, export and bulk transforms walk plain arrays instead
+// of graphics items. Views and models follow the store through row-range signals. Inside a
+// batch, appends are announced as one range and removals are compacted once at the end, so
+// bulk loads and clears cost O(n) instead of O(n) per shape.
+class ShapeStore : public QObject {
+    Q_OBJECT
+public:
+    enum class Kind : quint8 {
+        Line,
+        Circle,
+        Rectangle,
+        Ellipse,
+        Rectangle3D,
+    };
+
+    // Groups every change made during its lifetime into one set of signals.
+    class Batch {
+    public:
+        explicit Batch(ShapeStore* store);
+        ~Batch();
+        Batch(const Batch&) = delete;
+        Batch& operator=(const Batch&) = delete;
+
+    private:
+        ShapeStore* m_store;
+    };
+
+    explicit ShapeStore(QObject* parent = nullptr);
+
+    static const QString& kindName(Kind kind);
+    // False for names that are not a shape kind (e.g. an empty pointer-mode name).
+    static bool kindFromName(const QString& name, Kind& kind);
+
+    int size() const;
+    // Rows already signalled through rowsAppended; size() also counts appends of the open batch.
+    int announcedSize() const;
+    // -1 if the id is not in the store (or is removed in the open batch).
+    int rowOf(const QString& id) const;
+    const QString& id(int row) const;
+    Kind kind(int row) const;
+    const QString& type(int row) const;
+    QStringList ids() const;
+
+    // Geometry is stored local to the shape plus a translation. Lines keep their two end
+    // points; every other kind keeps its normalized bounding rect as (x1, y1)-(x2, y2).
+    QPointF p1(int row) const;
+    QPointF p2(int row) const;
+    QRectF bounds(int row) const;
+    QPointF translation(int row) const;
+    // Process overrides; 0 means "use the value from the property tabs".
+    double speed(int row) const;
+    int times(int row) const;
+
+    void append(const QString& id, Kind kind, const QPointF& p1, const QPointF& p2);
+    void remove(const QString& id);
+    void clear();
+    void setTranslation(int row, const QPointF& translation);
+    void setProcess(int row, double speed, int times);
+
+    // Bulk transforms over contiguous column ranges; the inner loops are branch-free so the
+    // compiler vectorizes them.
+    void translate(int first, int last, double dx, double dy);
+    void scale(int first, int last, double factor, const QPointF& center);
+    // Same for an arbitrary set of rows, e.g. the current selection; geometryChanged is emitted
+    // once per contiguous run of them.
+    void translate(const std::vector<int>& rows, double dx, double dy);
+    // Union of the shape bounds in scene coordinates.
+    QRectF sceneBounds() const;
+
+    void beginBatch();
+    void endBatch();
+
+signals:
+    void rowsAppended(int first, int last);
+    void rowsAboutToBeRemoved(int first, int last);
+    void rowsRemoved(int first, int last);
+    void aboutToReset();
+    void reset();
+    void geometryChanged(int first, int last);
+
+private:
+    template <typename Function>
+    void forEachColumn(Function function);
+
+    void commit();
+    void compact(int from);
+    void reindex(int from);
+
+    std::vector<QString> m_ids;
+    std::vector<Kind> m_kinds;
+    std::vector<double> m_x1;
+    std::vector<double> m_y1;
+    std::vector<double> m_x2;
+    std::vector<double> m_y2;
+    std::vector<double> m_tx;
+    std::vector<double> m_ty;
+    std::vector<double> m_speed;
+    std::vector<qint32> m_times;
+    std::vector<quint8> m_removed;
+    QHash<QString, int> m_rows;
+    // Rows [0, m_announced) have been signalled; later ones are pending appends.
+    int m_announced{ 0 };
+    int m_removedCount{ 0 };
+    int m_batchDepth{ 0 };
+};
@@ -0,0 +1,263 @@
+#include "ShapeStoreBenchmark.h"
+
+#include <vector>
+
+#include <QElapsedTimer>
+#include <QGraphicsRectItem>
+#include <QGraphicsScene>
+#include <QRandomGenerator>
+
+#include "metrics/HdrHistogram.h"
+#include "scene/ShapeIndex.h"
+#include "scene/ShapeStore.h"
+
+namespace {
+    constexpr int PASSES = 10;
+    constexpr int RUBBER_BANDS = 1000;
+    constexpr double RUBBER_BAND_SIZE = 100.0;
+
+    double elapsedMs(const QElapsedTimer& timer, int passes = 1) {
+        return timer.nsecsElapsed() / 1e6 / passes;
+    }
+
+    // The same shapes for the store and the graphics-item baseline.
+    std::vector<QRectF> randomRects(int shapes) {
+        std::vector<QRectF> rects;
+        rects.reserve(shapes);
+        QRandomGenerator random(42);
+        for (int i = 0; i < shapes; ++i) {
+            const QPointF start(random.bounded(2000.0) - 1000.0, random.bounded(2000.0) - 1000.0);
+            rects.push_back(QRectF(start, QSizeF(2.0 + random.bounded(28.0), 2.0 + random.bounded(28.0))));
+        }
+        return rects;
+    }
+
+    // A mix of outlines and areas, as a drawing would have, and the points picked over it.
+    struct DrawnShape {
+        ShapeStore::Kind kind;
+        QPointF p1;
+        QPointF p2;
+    };
+
+    struct PickInput {
+        std::vector<DrawnShape> drawn;
+        std::vector<QPointF> points;
+    };
+
+    PickInput pickInput(int shapes, int picks) {
+        PickInput input;
+        input.drawn.reserve(shapes);
+        QRandomGenerator random(7);
+        for (int i = 0; i < shapes; ++i) {
+            const QPointF start(random.bounded(2000.0) - 1000.0, random.bounded(2000.0) - 1000.0);
+            const QPointF end = start + QPointF(2.0 + random.bounded(28.0), 2.0 + random.bounded(28.0));
+            const auto kind = i % 3 == 0 ? ShapeStore::Kind::Line : i % 3 == 1 ? ShapeStore::Kind::Rectangle : ShapeStore::Kind::Ellipse;
+            input.drawn.push_back({ kind, start, end });
+        }
+        input.points.reserve(picks);
+        for (int i = 0; i < picks; ++i) {
+            input.points.emplace_back(random.bounded(2000.0) - 1000.0, random.bounded(2000.0) - 1000.0);
+        }
+        return input;
+    }
+}
+
+ShapeStoreBenchmark::Result ShapeStoreBenchmark::run(int shapes) {
+    Result result;
+    result.shapes = shapes;
+
+    const std::vector<QRectF> rects = randomRects(shapes);
+    ShapeStore store;
+    QElapsedTimer timer;
+    timer.start();
+    {
+        const ShapeStore::Batch batch(&store);
+        for (int i = 0; i < shapes; ++i) {
+            store.append(QStringLiteral("rectangle%1").arg(i + 1), ShapeStore::Kind::Rectangle, rects[i].topLeft(),
+                rects[i].bottomRight());
+        }
+    }
+    result.appendMs = elapsedMs(timer);
+
+    timer.start();
+    for (int pass = 0; pass < PASSES; ++pass) {
+        store.translate(0, shapes - 1, pass % 2 ? -1.5 : 1.5, 0.5);
+    }
+    result.translateMs = elapsedMs(timer, PASSES);
+
+    timer.start();
+    for (int pass = 0; pass < PASSES; ++pass) {
+        store.scale(0, shapes - 1, pass % 2 ? 1.0 / 1.01 : 1.01, QPointF(0.0, 0.0));
+    }
+    result.scaleMs = elapsedMs(timer, PASSES);
+
+    std::vector<int> subset;
+    for (int row = 0; row < shapes; row += 10) {
+        subset.push_back(row);
+    }
+    timer.start();
+    for (int pass = 0; pass < PASSES; ++pass) {
+        store.translate(subset, 1.0, -1.0);
+    }
+    result.subsetTranslateMs = elapsedMs(timer, PASSES);
+
+    double checksum = 0.0;
+    timer.start();
+    for (int pass = 0; pass < PASSES; ++pass) {
+        for (int row = 0; row < store.size(); ++row) {
+            const QRectF bounds = store.bounds(row);
+            checksum += bounds.left() + bounds.bottom();
+        }
+    }
+    result.readMs = elapsedMs(timer, PASSES);
+
+    timer.start();
+    for (int pass = 0; pass < PASSES; ++pass) {
+        checksum += store.sceneBounds().width();
+    }
+    result.boundsMs = elapsedMs(timer, PASSES);
+
+    timer.start();
+    {
+        const ShapeStore::Batch batch(&store);
+        for (int i = 0; i < shapes; i += 2) {
+            store.remove(QStringLiteral("rectangle%1").arg(i + 1));
+        }
+    }
+    result.removeHalfMs = elapsedMs(timer);
+
+    // Keeps the read loops from being optimized away.
+    volatile double sink = checksum;
+    Q_UNUSED(sink);
+    return result;
+}
+
+ShapeStoreBenchmark::ItemsResult ShapeStoreBenchmark::runItems(int shapes) {
+    ItemsResult result;
+    result.shapes = shapes;
+
+    // The same shapes as graphics items, the way geometry was kept before the store.
+    const std::vector<QRectF> rects = randomRects(shapes);
+    QGraphicsScene scene;
+    scene.setItemIndexMethod(QGraphicsScene::NoIndex);
+    std::vector<QGraphicsItem*> items;
+    items.reserve(shapes);
+    QElapsedTimer timer;
+    timer.start();
+    for (const QRectF& rect : rects) {
+        items.push_back(scene.addRect(rect));
+    }
+    result.createMs = elapsedMs(timer);
+
+    timer.start();
+    for (int pass = 0; pass < PASSES; ++pass) {
+        const double dx = pass % 2 ? -1.5 : 1.5;
+        for (auto* item : items) {
+            item->moveBy(dx, 0.5);
+        }
+    }
+    result.translateMs = elapsedMs(timer, PASSES);
+
+    double checksum = 0.0;
+    timer.start();
+    for (int pass = 0; pass < PASSES; ++pass) {
+        for (const auto* item : items) {
+            const QRectF bounds = item->boundingRect().translated(item->pos());
+            checksum += bounds.left() + bounds.bottom();
+        }
+    }
+    result.readMs = elapsedMs(timer, PASSES);
+
+    volatile double sink = checksum;
+    Q_UNUSED(sink);
+    return result;
+}
+
+ShapeStoreBenchmark::PickResult ShapeStoreBenchmark::runPicking(int shapes, int picks) {
+    PickResult result;
+    result.shapes = shapes;
+    result.picks = picks;
+
+    const PickInput input = pickInput(shapes, picks);
+    ShapeStore store;
+    {
+        const ShapeStore::Batch batch(&store);
+        for (int i = 0; i < shapes; ++i) {
+            store.append(QStringLiteral("shape%1").arg(i + 1), input.drawn[i].kind, input.drawn[i].p1, input.drawn[i].p2);
+        }
+    }
+    QElapsedTimer timer;
+    timer.start();
+    ShapeIndex index(&store);
+    result.buildMs = elapsedMs(timer);
+    result.height = index.height();
+
+    qint64 hits = 0;
+    HdrHistogram pickNs;
+    for (const QPointF& point : input.points) {
+        timer.start();
+        hits += index.pick(point, 1.0).isEmpty() ? 0 : 1;
+        pickNs.record(timer.nsecsElapsed());
+    }
+    result.pickMeanUs = pickNs.mean() / 1000.0;
+    result.pickP99Us = pickNs.valueAtPercentile(99.0) / 1000.0;
+
+    timer.start();
+    for (int i = 0; i < RUBBER_BANDS; ++i) {
+        const QPointF& corner = input.points[i % input.points.size()];
+        hits += index.intersecting(QRectF(corner, QSizeF(RUBBER_BAND_SIZE, RUBBER_BAND_SIZE))).size();
+    }
+    result.rubberBandUs = timer.nsecsElapsed() / 1000.0 / RUBBER_BANDS;
+
+    std::vector<int> group;
+    for (int row = shapes / 2; row < shapes / 2 + shapes / 100; ++row) {
+        group.push_back(row);
+    }
+    timer.start();
+    for (int pass = 0; pass < PASSES; ++pass) {
+        store.translate(group, pass % 2 ? -5.0 : 5.0, 5.0);
+    }
+    result.moveMs = elapsedMs(timer, PASSES);
+
+    volatile qint64 sink = hits;
+    Q_UNUSED(sink);
+    return result;
+}
+
+ShapeStoreBenchmark::ScenePickResult ShapeStoreBenchmark::runScenePicking(int shapes, int picks) {
+    ScenePickResult result;
+    result.shapes = shapes;
+    result.picks = picks;
+
+    const PickInput input = pickInput(shapes, picks);
+    QGraphicsScene scene;
+    scene.setItemIndexMethod(QGraphicsScene::BspTreeIndex);
+    QElapsedTimer timer;
+    timer.start();
+    for (const DrawnShape& shape : input.drawn) {
+        if (shape.kind == ShapeStore::Kind::Line) {
+            scene.addLine(QLineF(shape.p1, shape.p2));
+        }
+        else if (shape.kind == ShapeStore::Kind::Rectangle) {
+            scene.addRect(QRectF(shape.p1, shape.p2));
+        }
+        else {
+            scene.addEllipse(QRectF(shape.p1, shape.p2));
+        }
+    }
+    qint64 hits = scene.items(QPointF()).size();
+    result.buildMs = elapsedMs(timer);
+
+    HdrHistogram pickNs;
+    for (const QPointF& point : input.points) {
+        timer.start();
+        hits += scene.items(point, Qt::IntersectsItemShape, Qt::DescendingOrder).isEmpty() ? 0 : 1;
+        pickNs.record(timer.nsecsElapsed());
+    }
+    result.pickMeanUs = pickNs.mean() / 1000.0;
+    result.pickP99Us = pickNs.valueAtPercentile(99.0) / 1000.0;
+
+    volatile qint64 sink = hits;
+    Q_UNUSED(sink);
+    return result;
+}
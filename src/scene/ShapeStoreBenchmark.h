@@ -0,0 +1,60 @@
+#pragma once
+
+#include <QtGlobal>
+
+// Batch operations on a ShapeStore of random shapes; runItems does the same work the old way
+// through QGraphicsItems in a QGraphicsScene (moveBy, boundingRect) on the same shapes. Times
+// are per pass over all shapes, averaged over several passes. runPicking does the same for
+// hit-testing through the ShapeIndex R-tree, and runScenePicking through QGraphicsScene's BSP
+// index. run and runPicking use no widgets and may be called from any thread; runItems and
+// runScenePicking must be called on the GUI thread.
+class ShapeStoreBenchmark {
+public:
+    struct Result {
+        int shapes{ 0 };
+        double appendMs{ 0.0 };
+        double translateMs{ 0.0 };
+        double scaleMs{ 0.0 };
+        // Every tenth row, through the row-list overload.
+        double subsetTranslateMs{ 0.0 };
+        // Reading scene geometry of every shape, as job generation and export do.
+        double readMs{ 0.0 };
+        double boundsMs{ 0.0 };
+        double removeHalfMs{ 0.0 };
+    };
+
+    struct ItemsResult {
+        int shapes{ 0 };
+        double createMs{ 0.0 };
+        double translateMs{ 0.0 };
+        double readMs{ 0.0 };
+    };
+
+    struct PickResult {
+        int shapes{ 0 };
+        int picks{ 0 };
+        // Packing the index over a freshly loaded store.
+        double buildMs{ 0.0 };
+        int height{ 0 };
+        double pickMeanUs{ 0.0 };
+        double pickP99Us{ 0.0 };
+        // A 100x100 rubber band, mean over many positions.
+        double rubberBandUs{ 0.0 };
+        // Translating 1% of the shapes (one contiguous group) with the index following.
+        double moveMs{ 0.0 };
+    };
+
+    struct ScenePickResult {
+        int shapes{ 0 };
+        int picks{ 0 };
+        // Adding the items and the first lookup, which builds the BSP tree.
+        double buildMs{ 0.0 };
+        double pickMeanUs{ 0.0 };
+        double pickP99Us{ 0.0 };
+    };
+
+    static Result run(int shapes);
+    static ItemsResult runItems(int shapes);
+    static PickResult runPicking(int shapes, int picks);
+    static ScenePickResult runScenePicking(int shapes, int picks);
+};
@@ -1,16 +1,19 @@
 #include "DrawingPanel.h"
 
 #include <QButtonGroup>
-#include <QGraphicsLineItem>
-#include <QGraphicsPathItem>
 #include <QGraphicsScene>
 #include <QHBoxLayout>
 #include <QLabel>
 #include <QToolButton>
 #include <QVBoxLayout>
 
+#include "scene/ShapeIndex.h"
+#include "scene/ShapeStore.h"
+
 DrawingPanel::DrawingPanel(QWidget* parent)
-    : QWidget(parent) {
+    : QWidget(parent)
+    , m_store(new ShapeStore(this))
+    , m_index(new ShapeIndex(m_store, this)) {
     setupUi();
 }
 
@@ -34,23 +37,44 @@ void DrawingPanel::setupUi() {
 
     m_view = new DrawingView(this);
     m_view->setMinimumHeight(300);
+    m_view->setShapeIndex(m_index);
     layout->addWidget(m_view, 1);
 
     connect(group, &QButtonGroup::idClicked, this, [this](int id) {
         m_view->setMode(static_cast<DrawingView::Mode>(id));
         });
     connect(m_view, &DrawingView::shapeCreated, this, [this](const QString& id, const QString& type, QGraphicsItem* item) {
-        if (item) {
+        ShapeStore::Kind kind;
+        if (item && ShapeStore::kindFromName(type, kind)) {
+            // The only time geometry is read back from an item; from here on the store owns it.
+            QPointF p1;
+            QPointF p2;
+            DrawingView::itemGeometry(item, p1, p2);
             m_items.insert(id, item);
+            m_store->append(id, kind, p1 + item->pos(), p2 + item->pos());
         }
         emit shapeCreated(id, type);
         });
     connect(m_view, &DrawingView::shapeSelected, this, &DrawingPanel::shapeSelected);
-    connect(m_view, &DrawingView::shapeMoved, this, &DrawingPanel::shapeMoved);
+    connect(m_view, &DrawingView::shapesMoved, this, [this](const QStringList& ids, const QPointF& delta) {
+        // One bulk translate; the items already sit at the new position, so the sync is a no-op.
+        std::vector<int> rows;
+        rows.reserve(ids.size());
+        for (const QString& id : ids) {
+            if (const int row = m_store->rowOf(id); row >= 0) {
+                rows.push_back(row);
+            }
+        }
+        m_store->translate(rows, delta.x(), delta.y());
+        emit shapesMoved(ids, delta);
+        });
+    connect(m_view, &DrawingView::shapesSelected, this, &DrawingPanel::shapesSelected);
     connect(m_view, &DrawingView::shapeRemoved, this, [this](const QString& id, const QString& type) {
         m_items.remove(id);
+        m_store->remove(id);
         emit shapeRemoved(id, type);
         });
+    connect(m_store, &ShapeStore::geometryChanged, this, &DrawingPanel::syncItems);
 }
 
 void DrawingPanel::addToolButton(QButtonGroup* group, QHBoxLayout* buttonsLayout, DrawingView::Mode mode, const QString& text, bool checked) {
@@ -64,55 +88,87 @@ void DrawingPanel::addToolButton(QButtonGroup* group, QHBoxLayout* buttonsLayout
 
 // 3D/model loading removed per latest requirements; DrawingPanel stays 2D.
 
+QString DrawingPanel::addShape(DrawingView::Mode mode, const QPointF& start, const QPointF& end) {
+    return m_view->addShape(mode, start, end);
+}
+
+ToolpathOverlay* DrawingPanel::toolpathOverlay() const {
+    return m_view->toolpathOverlay();
+}
+
+ShapeStore* DrawingPanel::shapeStore() const {
+    return m_store;
+}
+
+const ShapeIndex* DrawingPanel::shapeIndex() const {
+    return m_index;
+}
+
+void DrawingPanel::clearShapes() {
+    const ShapeStore::Batch batch(m_store);
+    const QStringList ids = m_store->ids();
+    for (const QString& id : ids) {
+        removeShape(id);
+    }
+}
+
 void DrawingPanel::removeShape(const QString& id) {
     auto it = m_items.find(id);
     if (it == m_items.end()) {
         return;
     }
-    auto* item = it.value();
-    m_view->scene()->removeItem(item);
-    delete item;
+    m_view->removeShape(it.value());
     m_items.erase(it);
+    m_store->remove(id);
     emit shapeRemoved(id, QString());
 }
 
 void DrawingPanel::selectShape(const QString& id) {
-    auto it = m_items.constFind(id);
-    if (it == m_items.constEnd()) {
+    selectShapes(QStringList(id), id);
+}
+
+void DrawingPanel::selectShapes(const QStringList& ids, const QString& current) {
+    m_view->scene()->clearSelection();
+    for (const QString& id : ids) {
+        if (auto* item = m_items.value(id, nullptr)) {
+            item->setSelected(true);
+        }
+    }
+    auto* currentItem = m_items.value(current, nullptr);
+    if (!currentItem) {
         return;
     }
-    auto* item = it.value();
-    m_view->scene()->clearSelection();
-    item->setSelected(true);
-    m_view->centerOn(item);
-    emit shapeSelected(id, item->data(0).toString());
+    m_view->centerOn(currentItem);
+    emit shapeSelected(current, currentItem->data(0).toString());
 }
 
 void DrawingPanel::setMode(DrawingView::Mode mode) {
     m_view->setMode(mode);
 }
 
+QStringList DrawingPanel::shapeIds() const {
+    return m_store->ids();
+}
+
 bool DrawingPanel::shapeInfo(const QString& id, ShapeInfo& info) const {
-    auto it = m_items.constFind(id);
-    if (it == m_items.constEnd()) {
+    const int row = m_store->rowOf(id);
+    if (row < 0) {
         return false;
     }
-    auto* item = it.value();
     info.id = id;
-    info.type = item->data(0).toString();
-    info.rect = item->boundingRect().translated(item->pos());
-    if (auto* line = qgraphicsitem_cast<QGraphicsLineItem*>(item)) {
-        const auto lineObj = line->line();
-        info.p1 = lineObj.p1() + line->pos();
-        info.p2 = lineObj.p2() + line->pos();
-    }
-    else if (auto* path = qgraphicsitem_cast<QGraphicsPathItem*>(item)) {
-        info.p1 = path->pos();
-        info.p2 = path->pos();
-    }
-    else {
-        info.p1 = info.rect.topLeft();
-        info.p2 = info.rect.bottomRight();
-    }
+    info.type = m_store->type(row);
+    info.p1 = m_store->p1(row);
+    info.p2 = m_store->p2(row);
+    info.rect = m_store->bounds(row);
     return true;
-}
\ No newline at end of file
+}
+
+void DrawingPanel::syncItems(int first, int last) {
+    // Items are the store's rendering: local geometry and position are copied from the columns.
+    for (int row = first; row <= last && row < m_store->size(); ++row) {
+        if (auto* item = m_items.value(m_store->id(row), nullptr)) {
+            const QPointF translation = m_store->translation(row);
+            m_view->setItemGeometry(item, m_store->p1(row) - translation, m_store->p2(row) - translation, translation);
+        }
+    }
+}
@@ -4,10 +4,13 @@
 
 #include <QGraphicsItem>
 #include <QHash>
+#include <QStringList>
 
 #include "DrawingView.h"
 
 class QButtonGroup;
+class ShapeIndex;
+class ShapeStore;
 class QToolButton;
 class QHBoxLayout;
 
@@ -15,8 +18,15 @@ class DrawingPanel : public QWidget {
     Q_OBJECT
 public:
     explicit DrawingPanel(QWidget* parent = nullptr);
+    QString addShape(DrawingView::Mode mode, const QPointF& start, const QPointF& end);
+    ToolpathOverlay* toolpathOverlay() const;
+    ShapeStore* shapeStore() const;
+    const ShapeIndex* shapeIndex() const;
+    void clearShapes();
     void removeShape(const QString& id);
     void selectShape(const QString& id);
+    // Selects all of ids in the scene and reports only current through shapeSelected.
+    void selectShapes(const QStringList& ids, const QString& current);
     void setMode(DrawingView::Mode mode);
     struct ShapeInfo {
         QString id;
@@ -26,17 +36,24 @@ public:
         QRectF rect;
     };
     bool shapeInfo(const QString& id, ShapeInfo& info) const;
+    // Shape ids in creation order.
+    QStringList shapeIds() const;
 
 signals:
     void shapeCreated(const QString& id, const QString& type);
     void shapeSelected(const QString& id, const QString& type);
-    void shapeMoved(const QString& id, const QString& type);
+    // After a drag of the selection by delta has been applied to the store.
+    void shapesMoved(const QStringList& ids, const QPointF& delta);
+    void shapesSelected(const QStringList& ids);
     void shapeRemoved(const QString& id, const QString& type);
 
 private:
     void setupUi();
+    void syncItems(int first, int last);
     void addToolButton(QButtonGroup* group, QHBoxLayout* buttonsLayout, DrawingView::Mode mode, const QString& text, bool checked = false);
 
     DrawingView* m_view{};
     QHash<QString, QGraphicsItem*> m_items;
+    ShapeStore* m_store{};
+    ShapeIndex* m_index{};
 };
\ No newline at end of file
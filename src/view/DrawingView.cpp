@@ -1,13 +1,39 @@
 #include "DrawingView.h"
 
+#include <cmath>
+#include <memory>
+
 #include <QGraphicsEllipseItem>
 #include <QGraphicsLineItem>
 #include <QGraphicsPathItem>
 #include <QGraphicsRectItem>
 #include <QGraphicsScene>
+#include <QElapsedTimer>
+#include <QRubberBand>
 #include <QWheelEvent>
+#include <QtMath>
+
+#include "ToolpathOverlay.h"
+#include "metrics/HdrHistogram.h"
+#include "scene/ShapeIndex.h"
 
 namespace {
+    constexpr double GRID_STEP = 50.0;
+    // Coarsen the grid by this factor until lines are at least GRID_MIN_PIXELS apart on screen.
+    constexpr double GRID_LOD_FACTOR = 5.0;
+    constexpr double GRID_MIN_PIXELS = 8.0;
+    // Above this many shapes, antialiasing is dropped while panning or zooming.
+    constexpr int LARGE_SCENE_ITEMS = 5000;
+    constexpr int INTERACTION_SETTLE_MS = 150;
+    // BSP index depth: enough leaves for about this many shapes each, within Qt's useful range.
+    constexpr int ITEMS_PER_BSP_LEAF = 16;
+    constexpr int MIN_BSP_DEPTH = 5;
+    constexpr int MAX_BSP_DEPTH = 14;
+    constexpr int BENCHMARK_PAN_PX = 12;
+    // Screen distances for picking thin outlines and for snapping to existing shapes.
+    constexpr double PICK_TOLERANCE_PX = 4.0;
+    constexpr double SNAP_RADIUS_PX = 8.0;
+
     QPen shapePen() {
         QPen pen(Qt::blue);
         pen.setWidth(2);
@@ -47,18 +73,128 @@ DrawingView::DrawingView(QWidget* parent)
     setDragMode(QGraphicsView::NoDrag);
     scene()->setSceneRect(-1000, -1000, 2000, 2000);
 
+    // The grid is painted in drawBackground so it never enters the BSP index, itemAt or
+    // rubber-band picks; the index depth follows the shape count (updateIndexDepth).
+    updateIndexDepth();
+    setViewportUpdateMode(QGraphicsView::SmartViewportUpdate);
+    // All shapes use cosmetic pens and set their own painter state.
+    setOptimizationFlags(QGraphicsView::DontSavePainterState | QGraphicsView::DontAdjustForAntialiasing);
+
+    m_interactionTimer.setSingleShot(true);
+    m_interactionTimer.setInterval(INTERACTION_SETTLE_MS);
+    connect(&m_interactionTimer, &QTimer::timeout, this, &DrawingView::endInteraction);
+
+    m_overlay = new ToolpathOverlay(this);
+    connect(m_overlay, &ToolpathOverlay::changed, viewport(), qOverload<>(&QWidget::update));
+}
+
+ToolpathOverlay* DrawingView::toolpathOverlay() const {
+    return m_overlay;
+}
+
+void DrawingView::setShapeIndex(const ShapeIndex* index) {
+    m_index = index;
+}
+
+void DrawingView::drawForeground(QPainter* painter, const QRectF& rect) {
+    QGraphicsView::drawForeground(painter, rect);
+    m_overlay->paint(painter, rect, viewportTransform());
+}
+
+void DrawingView::drawBackground(QPainter* painter, const QRectF& rect) {
+    QGraphicsView::drawBackground(painter, rect);
+
     // lightweight grid to mirror the web preview panel
-    const int step = 50;
+    double step = GRID_STEP;
+    const double scale = qMax(qAbs(transform().m11()), 1e-6);
+    while (step * scale < GRID_MIN_PIXELS) {
+        step *= GRID_LOD_FACTOR;
+    }
+    const QRectF bounds = sceneRect();
+    if (step != m_gridStep || bounds != m_gridSceneRect) {
+        m_gridStep = step;
+        m_gridSceneRect = bounds;
+        m_gridLines.clear();
+        for (double x = qCeil(bounds.left() / step) * step; x <= bounds.right(); x += step) {
+            m_gridLines.append(QLineF(x, bounds.top(), x, bounds.bottom()));
+        }
+        for (double y = qCeil(bounds.top() / step) * step; y <= bounds.bottom(); y += step) {
+            m_gridLines.append(QLineF(bounds.left(), y, bounds.right(), y));
+        }
+    }
+
     QPen gridPen(QColor(220, 220, 220));
     gridPen.setCosmetic(true);
-    for (int x = -1000; x <= 1000; x += step) {
-        scene()->addLine(x, -1000, x, 1000, gridPen);
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing, false);
+    painter->setPen(gridPen);
+    painter->setClipRect(rect);
+    painter->drawLines(m_gridLines);
+    painter->restore();
+}
+
+void DrawingView::panBy(const QPoint& delta) {
+    beginInteraction();
+    translate(delta.x(), delta.y());
+}
+
+void DrawingView::beginInteraction() {
+    if (m_itemIds.size() >= LARGE_SCENE_ITEMS && !m_antialiasSuspended) {
+        m_antialiasSuspended = true;
+        setRenderHint(QPainter::Antialiasing, false);
     }
-    for (int y = -1000; y <= 1000; y += step) {
-        scene()->addLine(-1000, y, 1000, y, gridPen);
+    m_interactionTimer.start();
+}
+
+void DrawingView::updateIndexDepth() {
+    // Left at 0, Qt grows the depth with log2 of the item count, about one item per leaf, so every
+    // shape that spans a few leaves is stored many times over. The depth only changes when the
+    // count doubles or halves, which is when the index is rebuilt.
+    const double leaves = qMax(1, m_itemIds.size()) / static_cast<double>(ITEMS_PER_BSP_LEAF);
+    const int depth = qBound(MIN_BSP_DEPTH, qCeil(std::log2(qMax(1.0, leaves))), MAX_BSP_DEPTH);
+    if (scene()->bspTreeDepth() != depth) {
+        scene()->setBspTreeDepth(depth);
+    }
+}
+
+void DrawingView::endInteraction() {
+    if (m_antialiasSuspended) {
+        m_antialiasSuspended = false;
+        setRenderHint(QPainter::Antialiasing, true);
     }
 }
 
+void DrawingView::startPanBenchmark(int frames) {
+    auto frameUs = std::make_shared<HdrHistogram>();
+    auto* stepper = new QTimer(this);
+    connect(stepper, &QTimer::timeout, this, [this, stepper, frameUs, frames, frame = 0]() mutable {
+        if (frame < frames) {
+            // One loop around a circle, so the view ends roughly where it started.
+            const double angle = 2.0 * M_PI * frame / qMax(1, frames);
+            panBy(QPoint(qRound(qCos(angle) * BENCHMARK_PAN_PX), qRound(qSin(angle) * BENCHMARK_PAN_PX)));
+            QElapsedTimer timer;
+            timer.start();
+            viewport()->repaint();
+            frameUs->record(timer.nsecsElapsed() / 1000);
+            ++frame;
+            return;
+        }
+        stepper->deleteLater();
+        m_interactionTimer.stop();
+        endInteraction();
+
+        PanBenchmarkResult result;
+        result.frames = static_cast<int>(frameUs->count());
+        result.items = m_itemIds.size();
+        result.meanMs = frameUs->mean() / 1000.0;
+        result.p50Ms = frameUs->valueAtPercentile(50.0) / 1000.0;
+        result.p95Ms = frameUs->valueAtPercentile(95.0) / 1000.0;
+        result.maxMs = frameUs->max() / 1000.0;
+        emit panBenchmarkFinished(result);
+        });
+    stepper->start(0);
+}
+
 QString DrawingView::currentTypeName() const {
     switch (m_mode) {
     case Mode::Line:
@@ -86,11 +222,60 @@ QString DrawingView::idForItem(QGraphicsItem* item) const {
     return m_itemIds.value(item);
 }
 
+QString DrawingView::pickAt(const QPoint& viewPos) const {
+    if (!m_index) {
+        return idForItem(itemAt(viewPos));
+    }
+    const double scale = qMax(qAbs(transform().m11()), 1e-6);
+    return m_index->pick(mapToScene(viewPos), PICK_TOLERANCE_PX / scale);
+}
+
+QPointF DrawingView::snapped(const QPointF& scenePos) const {
+    QPointF target = scenePos;
+    if (m_index) {
+        const double scale = qMax(qAbs(transform().m11()), 1e-6);
+        m_index->snap(scenePos, SNAP_RADIUS_PX / scale, target);
+    }
+    return target;
+}
+
+void DrawingView::finishRubberBand(bool extend) {
+    m_rubberBand->hide();
+    const QRectF sceneRect = mapToScene(m_rubberBand->geometry()).boundingRect();
+    QStringList ids;
+    if (m_index) {
+        ids = m_index->intersecting(sceneRect);
+    }
+    else {
+        for (auto* item : scene()->items(sceneRect)) {
+            if (m_itemIds.contains(item)) {
+                ids.append(m_itemIds.value(item));
+            }
+        }
+    }
+    if (!extend) {
+        scene()->clearSelection();
+    }
+    for (const QString& id : ids) {
+        if (auto* item = m_idItems.value(id, nullptr)) {
+            item->setSelected(true);
+        }
+    }
+    if (extend) {
+        ids.clear();
+        for (auto* item : scene()->selectedItems()) {
+            ids.append(m_itemIds.value(item));
+        }
+    }
+    emit shapesSelected(ids);
+}
+
 void DrawingView::setMode(DrawingView::Mode mode) {
     m_mode = mode;
     if (m_mode == Mode::Pointer) {
+        // Selection, dragging and the rubber band are handled here rather than by the scene.
         setCursor(Qt::ArrowCursor);
-        setDragMode(QGraphicsView::RubberBandDrag);
+        setDragMode(QGraphicsView::NoDrag);
         setInteractive(true);
     }
     else {
@@ -101,6 +286,7 @@ void DrawingView::setMode(DrawingView::Mode mode) {
 }
 
 void DrawingView::wheelEvent(QWheelEvent* event) {
+    beginInteraction();
     const double factor = event->angleDelta().y() > 0 ? 1.15 : 1.0 / 1.15;
     scale(factor, factor);
 }
@@ -115,21 +301,44 @@ void DrawingView::mousePressEvent(QMouseEvent* event) {
     }
 
     if (m_mode == Mode::Pointer && event->button() == Qt::LeftButton) {
-        auto* item = itemAt(event->pos());
-        if (item) {
-            m_pointerItem = item;
-            m_pointerStartPos = item->pos();
-            m_pointerItemId = idForItem(item);
+        const bool extend = event->modifiers() & Qt::ControlModifier;
+        const QString id = pickAt(event->pos());
+        auto* item = m_idItems.value(id, nullptr);
+        if (item && extend) {
+            item->setSelected(!item->isSelected());
+            if (item->isSelected()) {
+                emit shapeSelected(id, item->data(0).toString());
+            }
+        }
+        else if (item) {
+            // Clicking an unselected shape selects just it; clicking a selected one drags them all.
+            if (!item->isSelected()) {
+                scene()->clearSelection();
+                item->setSelected(true);
+            }
+            m_dragItems = scene()->selectedItems();
+            m_dragOffset = QPointF();
             m_lastPointerScenePos = mapToScene(event->pos());
-            emit shapeSelected(m_pointerItemId, item->data(0).toString());
             m_pointerDragging = true;
-            event->accept();
-            return;
+            emit shapeSelected(id, item->data(0).toString());
+        }
+        else {
+            if (!m_rubberBand) {
+                m_rubberBand = new QRubberBand(QRubberBand::Rectangle, viewport());
+            }
+            if (!extend) {
+                scene()->clearSelection();
+            }
+            m_rubberBandOrigin = event->pos();
+            m_rubberBand->setGeometry(QRect(m_rubberBandOrigin, QSize()));
+            m_rubberBand->show();
         }
+        event->accept();
+        return;
     }
 
     if (event->button() == Qt::LeftButton && m_mode != Mode::Pointer) {
-        m_startPos = mapToScene(event->pos());
+        m_startPos = snapped(mapToScene(event->pos()));
         beginShape(m_startPos);
         m_drawing = true;
         event->accept();
@@ -142,22 +351,34 @@ void DrawingView::mouseMoveEvent(QMouseEvent* event) {
     if (m_panning) {
         const QPoint delta = event->pos() - m_lastPanPos;
         m_lastPanPos = event->pos();
-        translate(delta.x(), delta.y());
+        panBy(delta);
         event->accept();
         return;
     }
 
     if (m_drawing && m_activeItem) {
-        updateShape(mapToScene(event->pos()));
+        updateShape(snapped(mapToScene(event->pos())));
         event->accept();
         return;
     }
 
-    if (m_mode == Mode::Pointer && m_pointerDragging && m_pointerItem) {
+    if (m_mode == Mode::Pointer && m_pointerDragging) {
         const QPointF scenePos = mapToScene(event->pos());
         const QPointF delta = scenePos - m_lastPointerScenePos;
         m_lastPointerScenePos = scenePos;
-        m_pointerItem->moveBy(delta.x(), delta.y());
+        m_dragOffset += delta;
+        if (m_dragItems.size() >= LARGE_SCENE_ITEMS) {
+            beginInteraction();
+        }
+        for (auto* item : m_dragItems) {
+            item->moveBy(delta.x(), delta.y());
+        }
+        event->accept();
+        return;
+    }
+
+    if (m_rubberBand && m_rubberBand->isVisible()) {
+        m_rubberBand->setGeometry(QRect(m_rubberBandOrigin, event->pos()).normalized());
         event->accept();
         return;
     }
@@ -174,19 +395,31 @@ void DrawingView::mouseReleaseEvent(QMouseEvent* event) {
     }
 
     if (event->button() == Qt::LeftButton && m_drawing) {
-        updateShape(mapToScene(event->pos()));
+        updateShape(snapped(mapToScene(event->pos())));
         finishShape();
         event->accept();
         return;
     }
 
     if (event->button() == Qt::LeftButton && m_mode == Mode::Pointer && m_pointerDragging) {
-        if (m_pointerItem && m_pointerItem->pos() != m_pointerStartPos) {
-            emit shapeMoved(m_pointerItemId, m_pointerItem->data(0).toString());
-        }
         m_pointerDragging = false;
-        m_pointerItem = nullptr;
-        m_pointerItemId.clear();
+        if (!m_dragOffset.isNull()) {
+            QStringList ids;
+            ids.reserve(m_dragItems.size());
+            for (auto* item : m_dragItems) {
+                ids.append(m_itemIds.value(item));
+            }
+            emit shapesMoved(ids, m_dragOffset);
+        }
+        m_dragItems.clear();
+        event->accept();
+        return;
+    }
+
+    if (event->button() == Qt::LeftButton && m_rubberBand && m_rubberBand->isVisible()) {
+        finishRubberBand(event->modifiers() & Qt::ControlModifier);
+        event->accept();
+        return;
     }
 
     QGraphicsView::mouseReleaseEvent(event);
@@ -282,14 +515,80 @@ void DrawingView::updateShape(const QPointF& scenePos) {
     }
 }
 
-void DrawingView::finishShape() {
+QString DrawingView::addShape(Mode mode, const QPointF& start, const QPointF& end) {
+    if (mode == Mode::Pointer) {
+        return QString();
+    }
+    const Mode previous = m_mode;
+    m_mode = mode;
+    m_startPos = start;
+    beginShape(start);
+    updateShape(end);
+    const QString id = finishShape();
+    m_mode = previous;
+    return id;
+}
+
+void DrawingView::removeShape(QGraphicsItem* item) {
+    m_dragItems.removeOne(item);
+    m_idItems.remove(m_itemIds.take(item));
+    scene()->removeItem(item);
+    delete item;
+    updateIndexDepth();
+}
+
+void DrawingView::itemGeometry(const QGraphicsItem* item, QPointF& p1, QPointF& p2) {
+    if (auto* line = qgraphicsitem_cast<const QGraphicsLineItem*>(item)) {
+        p1 = line->line().p1();
+        p2 = line->line().p2();
+    }
+    else if (auto* ellipse = qgraphicsitem_cast<const QGraphicsEllipseItem*>(item)) {
+        p1 = ellipse->rect().topLeft();
+        p2 = ellipse->rect().bottomRight();
+    }
+    else if (auto* rectItem = qgraphicsitem_cast<const QGraphicsRectItem*>(item)) {
+        p1 = rectItem->rect().topLeft();
+        p2 = rectItem->rect().bottomRight();
+    }
+    else if (auto* pathItem = qgraphicsitem_cast<const QGraphicsPathItem*>(item)) {
+        // buildRect3DPath starts with the base rect: elements 0 and 2 are its opposite corners.
+        const QPainterPath& path = pathItem->path();
+        if (path.elementCount() > 2) {
+            p1 = path.elementAt(0);
+            p2 = path.elementAt(2);
+        }
+    }
+}
+
+void DrawingView::setItemGeometry(QGraphicsItem* item, const QPointF& p1, const QPointF& p2, const QPointF& pos) {
+    const QRectF rect = QRectF(p1, p2).normalized();
+    if (auto* line = qgraphicsitem_cast<QGraphicsLineItem*>(item)) {
+        line->setLine(QLineF(p1, p2));
+    }
+    else if (auto* ellipse = qgraphicsitem_cast<QGraphicsEllipseItem*>(item)) {
+        ellipse->setRect(rect);
+    }
+    else if (auto* rectItem = qgraphicsitem_cast<QGraphicsRectItem*>(item)) {
+        rectItem->setRect(rect);
+    }
+    else if (auto* pathItem = qgraphicsitem_cast<QGraphicsPathItem*>(item)) {
+        pathItem->setPath(buildRect3DPath(rect.topLeft(), rect.bottomRight()));
+    }
+    item->setPos(pos);
+}
+
+QString DrawingView::finishShape() {
     m_drawing = false;
+    QString id;
     if (m_activeItem) {
         m_activeItem->setFlag(QGraphicsItem::ItemIsMovable, true);
         const QString typeName = currentTypeName();
-        const QString id = ensureId(typeName);
+        id = ensureId(typeName);
         m_itemIds.insert(m_activeItem, id);
+        m_idItems.insert(id, m_activeItem);
+        updateIndexDepth();
         emit shapeCreated(id, typeName, m_activeItem);
     }
     m_activeItem = nullptr;
+    return id;
 }
\ No newline at end of file
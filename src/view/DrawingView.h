@@ -4,7 +4,16 @@
 
 #include <QGraphicsItem>
 #include <QHash>
+#include <QLineF>
+#include <QList>
 #include <QSet>
+#include <QStringList>
+#include <QTimer>
+#include <QVector>
+
+class QRubberBand;
+class ShapeIndex;
+class ToolpathOverlay;
 
 class DrawingView : public QGraphicsView {
     Q_OBJECT
@@ -18,17 +27,46 @@ public:
         Rectangle3D,
     };
 
+    struct PanBenchmarkResult {
+        int frames{ 0 };
+        int items{ 0 };
+        double meanMs{ 0.0 };
+        double p50Ms{ 0.0 };
+        double p95Ms{ 0.0 };
+        double maxMs{ 0.0 };
+    };
+
     explicit DrawingView(QWidget* parent = nullptr);
 
     void setMode(Mode mode);
+    // Creates a shape as if it had been dragged from start to end; returns its id.
+    QString addShape(Mode mode, const QPointF& start, const QPointF& end);
+    void removeShape(QGraphicsItem* item);
+    // Local geometry of a shape item: end points for lines, corners of the base rect otherwise.
+    static void itemGeometry(const QGraphicsItem* item, QPointF& p1, QPointF& p2);
+    // Re-shapes an item to local geometry p1-p2 (as itemGeometry returns it) at pos.
+    void setItemGeometry(QGraphicsItem* item, const QPointF& p1, const QPointF& p2, const QPointF& pos);
+    ToolpathOverlay* toolpathOverlay() const;
+    // Picking, rubber-band selection and snapping go through index when one is set.
+    void setShapeIndex(const ShapeIndex* index);
+    // Pans in a loop, one step and one synchronous repaint per event-loop pass so the rest of
+    // the application stays responsive, then emits panBenchmarkFinished. The view must stay
+    // visible until then.
+    void startPanBenchmark(int frames);
 
 signals:
     void shapeCreated(const QString& id, const QString& type, QGraphicsItem* item);
     void shapeSelected(const QString& id, const QString& type);
-    void shapeMoved(const QString& id, const QString& type);
+    // One drag of the selection, by delta in scene coordinates.
+    void shapesMoved(const QStringList& ids, const QPointF& delta);
+    // A rubber-band selection finished; ids is the whole selection afterwards.
+    void shapesSelected(const QStringList& ids);
     void shapeRemoved(const QString& id, const QString& type);
+    void panBenchmarkFinished(const DrawingView::PanBenchmarkResult& result);
 
 protected:
+    void drawBackground(QPainter* painter, const QRectF& rect) override;
+    void drawForeground(QPainter* painter, const QRectF& rect) override;
     void wheelEvent(QWheelEvent* event) override;
     void mousePressEvent(QMouseEvent* event) override;
     void mouseMoveEvent(QMouseEvent* event) override;
@@ -37,10 +75,19 @@ protected:
 private:
     void beginShape(const QPointF& scenePos);
     void updateShape(const QPointF& scenePos);
-    void finishShape();
+    QString finishShape();
     QString currentTypeName() const;
     QString ensureId(const QString& type);
     QString idForItem(QGraphicsItem* item) const;
+    // Shape id under a viewport position; empty over empty space.
+    QString pickAt(const QPoint& viewPos) const;
+    QPointF snapped(const QPointF& scenePos) const;
+    void finishRubberBand(bool extend);
+    void panBy(const QPoint& delta);
+    void beginInteraction();
+    void endInteraction();
+    // Sizes the scene's BSP index to the number of shapes.
+    void updateIndexDepth();
 
     Mode m_mode{ Mode::Pointer };
     bool m_drawing{ false };
@@ -50,9 +97,19 @@ private:
     QPointF m_lastPointerScenePos;
     QPointF m_startPos;
     QGraphicsItem* m_activeItem{ nullptr };
-    QGraphicsItem* m_pointerItem{ nullptr };
-    QPointF m_pointerStartPos;
-    QString m_pointerItemId;
+    // The selection being dragged and how far it has moved so far.
+    QList<QGraphicsItem*> m_dragItems;
+    QPointF m_dragOffset;
+    QRubberBand* m_rubberBand{};
+    QPoint m_rubberBandOrigin;
     int m_nextId{ 1 };
     QHash<QGraphicsItem*, QString> m_itemIds;
+    QHash<QString, QGraphicsItem*> m_idItems;
+    const ShapeIndex* m_index{};
+    ToolpathOverlay* m_overlay{};
+    QTimer m_interactionTimer;
+    bool m_antialiasSuspended{ false };
+    QVector<QLineF> m_gridLines;
+    QRectF m_gridSceneRect;
+    double m_gridStep{ 0.0 };
 };
\ No newline at end of file
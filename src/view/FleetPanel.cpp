@@ -0,0 +1,124 @@
+#include "FleetPanel.h"
+
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QTableWidget>
+#include <QVBoxLayout>
+
+#include "grpc/FleetDispatcher.h"
+
+namespace {
+    enum Column {
+        NameColumn,
+        EndpointColumn,
+        HealthColumn,
+        StreamColumn,
+        QueueColumn,
+        PendingColumn,
+        DoneColumn,
+        FailedColumn,
+        JobsColumn,
+        BytesColumn,
+        ColumnCount
+    };
+}
+
+FleetPanel::FleetPanel(FleetDispatcher* dispatcher, QWidget* parent)
+    : QWidget(parent)
+    , m_dispatcher(dispatcher) {
+    auto* layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+
+    m_table = new QTableWidget(0, ColumnCount, this);
+    m_table->setHorizontalHeaderLabels({ tr("Controller"), tr("Endpoint"), tr("Health"), tr("Stream"), tr("Queue"),
+        tr("Pending (s)"), tr("Done"), tr("Failed"), tr("Jobs/min"), tr("Stream MB/s") });
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->verticalHeader()->setVisible(false);
+    m_table->horizontalHeader()->setStretchLastSection(true);
+    layout->addWidget(m_table, 1);
+
+    auto* buttons = new QHBoxLayout();
+    auto* addBtn = new QPushButton(tr("Add controller"), this);
+    auto* connectBtn = new QPushButton(tr("Connect"), this);
+    buttons->addWidget(addBtn);
+    buttons->addWidget(connectBtn);
+    buttons->addStretch(1);
+    layout->addLayout(buttons);
+
+    connect(addBtn, &QPushButton::clicked, this, &FleetPanel::addController);
+    connect(connectBtn, &QPushButton::clicked, this, &FleetPanel::connectSelected);
+    connect(m_dispatcher, &FleetDispatcher::controllerAdded, this, [this](int index) {
+        m_table->setRowCount(m_dispatcher->controllerCount());
+        for (int column = 0; column < ColumnCount; ++column) {
+            m_table->setItem(index, column, new QTableWidgetItem());
+        }
+        refreshRow(index);
+        });
+    connect(m_dispatcher, &FleetDispatcher::controllerUpdated, this, &FleetPanel::refreshRow);
+}
+
+void FleetPanel::addController() {
+    QDialog dialog(this);
+    dialog.setWindowTitle(tr("Add controller"));
+    auto* form = new QFormLayout(&dialog);
+    auto* name = new QLineEdit(tr("Machine %1").arg(m_dispatcher->controllerCount() + 1), &dialog);
+    auto* endpoint = new QLineEdit(QStringLiteral("grpc://localhost:50051"), &dialog);
+    auto* streamHost = new QLineEdit(&dialog);
+    streamHost->setPlaceholderText(tr("None: jobs go over gRPC"));
+    auto* streamPort = new QSpinBox(&dialog);
+    streamPort->setRange(1, 65535);
+    streamPort->setValue(7);
+    form->addRow(tr("Name"), name);
+    form->addRow(tr("gRPC endpoint"), endpoint);
+    form->addRow(tr("Stream host"), streamHost);
+    form->addRow(tr("Stream port"), streamPort);
+    auto* box = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+    form->addRow(box);
+    connect(box, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(box, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    if (dialog.exec() != QDialog::Accepted) {
+        return;
+    }
+
+    ControllerConfig config;
+    config.name = name->text();
+    config.endpoint = QUrl(endpoint->text());
+    config.streamHost = streamHost->text();
+    config.streamPort = static_cast<quint16>(streamPort->value());
+    const int index = m_dispatcher->addController(config);
+    m_table->selectRow(index);
+}
+
+void FleetPanel::connectSelected() {
+    const auto rows = m_table->selectionModel()->selectedRows();
+    for (const auto& row : rows) {
+        const QString details = m_dispatcher->connectController(row.row());
+        emit controllerConnected(row.row(), details);
+    }
+}
+
+void FleetPanel::refreshRow(int index) {
+    if (index < 0 || index >= m_table->rowCount() || !m_table->item(index, NameColumn)) {
+        return;
+    }
+    const ControllerStatus status = m_dispatcher->status(index);
+    m_table->item(index, NameColumn)->setText(status.name);
+    m_table->item(index, EndpointColumn)->setText(status.endpoint);
+    m_table->item(index, HealthColumn)->setText(status.healthy ? tr("OK") : tr("DOWN"));
+    m_table->item(index, HealthColumn)->setToolTip(status.lastError);
+    m_table->item(index, HealthColumn)->setForeground(status.healthy ? Qt::darkGreen : Qt::red);
+    m_table->item(index, StreamColumn)->setText(status.streamConnected ? tr("connected") : tr("idle"));
+    m_table->item(index, QueueColumn)->setText(QString::number(status.queueDepth));
+    m_table->item(index, PendingColumn)->setText(QString::number(status.pendingSeconds, 'f', 1));
+    m_table->item(index, DoneColumn)->setText(QString::number(status.completed));
+    m_table->item(index, FailedColumn)->setText(QString::number(status.failed));
+    m_table->item(index, JobsColumn)->setText(QString::number(status.jobsPerMinute, 'f', 1));
+    m_table->item(index, BytesColumn)->setText(QString::number(status.streamBytesPerSecond / 1e6, 'f', 2));
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <QWidget>
+
+class FleetDispatcher;
+class QTableWidget;
+
+class FleetPanel : public QWidget {
+    Q_OBJECT
+public:
+    explicit FleetPanel(FleetDispatcher* dispatcher, QWidget* parent = nullptr);
+
+signals:
+    void controllerConnected(int index, const QString& details);
+
+private slots:
+    void addController();
+    void connectSelected();
+    void refreshRow(int index);
+
+private:
+    FleetDispatcher* m_dispatcher{};
+    QTableWidget* m_table{};
+};
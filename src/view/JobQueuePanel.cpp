@@ -0,0 +1,136 @@
+#include "JobQueuePanel.h"
+
+#include <QFileInfo>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QJsonArray>
+#include <QLabel>
+#include <QPushButton>
+#include <QSignalBlocker>
+#include <QSpinBox>
+#include <QTableWidget>
+#include <QVBoxLayout>
+
+#include "daemon/StreamDaemonClient.h"
+
+namespace {
+    enum Column {
+        IdColumn,
+        JobColumn,
+        PriorityColumn,
+        StateColumn,
+        ProgressColumn,
+        ColumnCount
+    };
+}
+
+JobQueuePanel::JobQueuePanel(StreamDaemonClient* daemon, QWidget* parent)
+    : QWidget(parent)
+    , m_daemon(daemon) {
+    auto* layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+
+    m_table = new QTableWidget(0, ColumnCount, this);
+    m_table->setHorizontalHeaderLabels({ tr("Id"), tr("Job"), tr("Priority"), tr("State"), tr("Progress") });
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->verticalHeader()->setVisible(false);
+    m_table->horizontalHeader()->setStretchLastSection(true);
+    layout->addWidget(m_table, 1);
+
+    auto* buttons = new QHBoxLayout();
+    m_pause = new QPushButton(tr("Pause"), this);
+    m_pause->setCheckable(true);
+    auto* abortBtn = new QPushButton(tr("Abort job"), this);
+    auto* abortAllBtn = new QPushButton(tr("Abort all"), this);
+    auto* cancelBtn = new QPushButton(tr("Cancel selected"), this);
+    m_priority = new QSpinBox(this);
+    m_priority->setRange(-100, 100);
+    m_priority->setPrefix(tr("Priority for new jobs: "));
+    m_summary = new QLabel(this);
+    buttons->addWidget(m_pause);
+    buttons->addWidget(abortBtn);
+    buttons->addWidget(abortAllBtn);
+    buttons->addWidget(cancelBtn);
+    buttons->addWidget(m_priority);
+    buttons->addStretch(1);
+    buttons->addWidget(m_summary);
+    layout->addLayout(buttons);
+
+    connect(m_pause, &QPushButton::toggled, this, [this](bool paused) {
+        if (paused) {
+            m_daemon->pause();
+        }
+        else {
+            m_daemon->resume();
+        }
+        });
+    connect(abortBtn, &QPushButton::clicked, this, [this]() {
+        m_daemon->abort(false);
+        });
+    connect(abortAllBtn, &QPushButton::clicked, this, [this]() {
+        m_daemon->abort(true);
+        });
+    connect(cancelBtn, &QPushButton::clicked, this, &JobQueuePanel::cancelSelected);
+    connect(m_daemon, &StreamDaemonClient::statusReceived, this, &JobQueuePanel::showStatus);
+    connect(m_daemon, &StreamDaemonClient::daemonLost, this, &JobQueuePanel::reset);
+    reset();
+}
+
+int JobQueuePanel::priority() const {
+    return m_priority->value();
+}
+
+void JobQueuePanel::showStatus(const QJsonObject& status) {
+    setEnabled(true);
+    {
+        const QSignalBlocker blocker(m_pause);
+        m_pause->setChecked(status.value(QStringLiteral("paused")).toBool());
+    }
+    const QJsonArray jobs = status.value(QStringLiteral("jobs")).toArray();
+    m_table->setRowCount(static_cast<int>(jobs.size()));
+    for (int row = 0; row < jobs.size(); ++row) {
+        const QJsonObject job = jobs.at(row).toObject();
+        const qint64 records = job.value(QStringLiteral("records")).toInteger();
+        const qint64 sent = job.value(QStringLiteral("sent")).toInteger();
+        const QString path = job.value(QStringLiteral("path")).toString();
+        const int skipped = job.value(QStringLiteral("skipped")).toInt();
+        const QString state = job.value(QStringLiteral("state")).toString();
+        const QStringList cells{
+            QString::number(job.value(QStringLiteral("id")).toInt()),
+            QFileInfo(path).fileName(),
+            QString::number(job.value(QStringLiteral("priority")).toInt()),
+            skipped > 0 ? tr("%1, %2 shapes skipped").arg(state).arg(skipped) : state,
+            records > 0 ? QStringLiteral("%1 %").arg(100.0 * sent / records, 0, 'f', 1) : QString(),
+        };
+        for (int column = 0; column < ColumnCount; ++column) {
+            if (!m_table->item(row, column)) {
+                m_table->setItem(row, column, new QTableWidgetItem());
+            }
+            m_table->item(row, column)->setText(cells.at(column));
+        }
+        m_table->item(row, JobColumn)->setToolTip(path);
+        m_table->item(row, StateColumn)->setToolTip(job.value(QStringLiteral("skip_reason")).toString());
+    }
+    m_summary->setText(tr("%1 finished, %2 aborted, %3 failed")
+        .arg(status.value(QStringLiteral("jobs_finished")).toInt())
+        .arg(status.value(QStringLiteral("jobs_aborted")).toInt())
+        .arg(status.value(QStringLiteral("jobs_failed")).toInt()));
+    m_summary->setToolTip(status.value(QStringLiteral("last_error")).toString());
+}
+
+void JobQueuePanel::reset() {
+    m_table->setRowCount(0);
+    m_summary->setText(tr("Not streaming through the daemon"));
+    m_summary->setToolTip(QString());
+    const QSignalBlocker blocker(m_pause);
+    m_pause->setChecked(false);
+    setEnabled(false);
+}
+
+void JobQueuePanel::cancelSelected() {
+    const auto rows = m_table->selectionModel()->selectedRows();
+    for (const auto& row : rows) {
+        m_daemon->cancelJob(m_table->item(row.row(), IdColumn)->text().toInt());
+    }
+}
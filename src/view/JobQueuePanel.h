@@ -0,0 +1,36 @@
+#pragma once
+
+#include <QJsonObject>
+#include <QWidget>
+
+class QLabel;
+class QPushButton;
+class QSpinBox;
+class QTableWidget;
+class StreamDaemonClient;
+
+// The streaming daemon's job queue as of its last status reply, with pause, abort and cancel.
+// Disabled until the daemon answers.
+class JobQueuePanel : public QWidget {
+    Q_OBJECT
+public:
+    explicit JobQueuePanel(StreamDaemonClient* daemon, QWidget* parent = nullptr);
+
+    // Priority for scenes queued from this window; higher streams first.
+    int priority() const;
+
+public slots:
+    void showStatus(const QJsonObject& status);
+    // Back to the disconnected state, e.g. after leaving the daemon.
+    void reset();
+
+private slots:
+    void cancelSelected();
+
+private:
+    StreamDaemonClient* m_daemon{};
+    QTableWidget* m_table{};
+    QLabel* m_summary{};
+    QPushButton* m_pause{};
+    QSpinBox* m_priority{};
+};
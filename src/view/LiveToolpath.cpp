@@ -0,0 +1,148 @@
+#include "LiveToolpath.h"
+
+#include <vtkActor.h>
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataMapper.h>
+#include <vtkProperty.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderer.h>
+#include <vtkTypeInt32Array.h>
+#include <vtkUnsignedCharArray.h>
+
+#include "Processing/ThreeAxisGenerator.h"
+
+namespace {
+    // Upper bound per tick, so a backlog is worked off over several ticks instead of one long stall.
+    constexpr int MAX_POINTS_PER_TICK = 50000;
+    constexpr unsigned char LASER_ON_COLOR[3] = { 230, 40, 40 };
+    constexpr unsigned char JUMP_COLOR[3] = { 60, 140, 230 };
+}
+
+LiveToolpath::LiveToolpath(vtkRenderer* renderer, vtkRenderWindow* window, int capacity, QObject* parent)
+    : QObject(parent)
+    , m_renderer(renderer)
+    , m_window(window)
+    , m_capacity(qMax(2, capacity)) {
+    m_points = vtkSmartPointer<vtkPoints>::New();
+    m_points->SetDataTypeToFloat();
+    m_points->SetNumberOfPoints(m_capacity);
+
+    // Line cell k joins point k to k + 1; a cell is collapsed to (k, k) while k is the newest
+    // sample or k + 1 has not been written yet.
+    auto offsets = vtkSmartPointer<vtkTypeInt32Array>::New();
+    offsets->SetNumberOfValues(m_capacity + 1);
+    m_connectivity = vtkSmartPointer<vtkTypeInt32Array>::New();
+    m_connectivity->SetNumberOfValues(2 * m_capacity);
+    for (int k = 0; k < m_capacity; ++k) {
+        offsets->SetValue(k, 2 * k);
+        m_connectivity->SetValue(2 * k, k);
+        m_connectivity->SetValue(2 * k + 1, k);
+        m_points->SetPoint(k, 0.0, 0.0, 0.0);
+    }
+    offsets->SetValue(m_capacity, 2 * m_capacity);
+    m_lines = vtkSmartPointer<vtkCellArray>::New();
+    m_lines->SetData(offsets, m_connectivity);
+
+    m_colors = vtkSmartPointer<vtkUnsignedCharArray>::New();
+    m_colors->SetNumberOfComponents(3);
+    m_colors->SetNumberOfTuples(m_capacity);
+    m_colors->FillValue(0);
+
+    m_polyData = vtkSmartPointer<vtkPolyData>::New();
+    m_polyData->SetPoints(m_points);
+    m_polyData->SetLines(m_lines);
+    m_polyData->GetCellData()->SetScalars(m_colors);
+
+    auto mapper = vtkSmartPointer<vtkPolyDataMapper>::New();
+    mapper->SetInputData(m_polyData);
+    mapper->SetScalarModeToUseCellData();
+    m_actor = vtkSmartPointer<vtkActor>::New();
+    m_actor->SetMapper(mapper);
+    m_actor->GetProperty()->SetLineWidth(1.5f);
+    m_actor->PickableOff();
+
+    m_scratch.resize(MAX_POINTS_PER_TICK);
+    connect(&m_timer, &QTimer::timeout, this, &LiveToolpath::onTick);
+}
+
+LiveToolpath::~LiveToolpath() {
+    stop();
+}
+
+void LiveToolpath::start(FrameTap* tap, int renderHz) {
+    stop();
+    m_tap = tap;
+    m_tap->clear();
+    m_tap->setEnabled(true);
+    m_renderer->AddActor(m_actor);
+    m_timer.start(1000 / qMax(1, renderHz));
+}
+
+void LiveToolpath::stop() {
+    m_timer.stop();
+    if (m_tap) {
+        m_tap->setEnabled(false);
+        m_tap = nullptr;
+    }
+}
+
+void LiveToolpath::clear() {
+    for (int k = 0; k < m_capacity; ++k) {
+        m_connectivity->SetValue(2 * k + 1, k);
+    }
+    m_head = 0;
+    m_count = 0;
+    m_connectivity->Modified();
+    m_lines->Modified();
+    m_polyData->Modified();
+    m_window->Render();
+}
+
+bool LiveToolpath::isRunning() const {
+    return m_timer.isActive();
+}
+
+qint64 LiveToolpath::pointsShown() const {
+    return m_count;
+}
+
+void LiveToolpath::append(const TapPoint& point) {
+    double x = point.x;
+    double y = point.y;
+    double z = point.z;
+    ThreeAxisGenerator::invertCorrection(x, y, z);
+    const int p = m_head;
+    m_points->SetPoint(p, x, y, z);
+    // The newest sample ends the trail; the cell that used to run on into the oldest one closes.
+    m_connectivity->SetValue(2 * p + 1, p);
+    if (m_count > 0) {
+        const int previous = (p + m_capacity - 1) % m_capacity;
+        m_connectivity->SetValue(2 * previous + 1, p);
+        m_colors->SetTypedTuple(previous, point.laserOn ? LASER_ON_COLOR : JUMP_COLOR);
+    }
+    m_head = (p + 1) % m_capacity;
+    m_count = qMin<qint64>(m_count + 1, m_capacity);
+}
+
+void LiveToolpath::onTick() {
+    if (!m_tap) {
+        return;
+    }
+    const int n = m_tap->drain(m_scratch.data(), static_cast<int>(m_scratch.size()));
+    if (n == 0) {
+        return;
+    }
+    for (int i = 0; i < n; ++i) {
+        append(m_scratch[i]);
+    }
+    m_points->Modified();
+    m_connectivity->Modified();
+    m_lines->Modified();
+    m_colors->Modified();
+    m_polyData->Modified();
+    m_window->Render();
+    emit updated(n, m_tap->dropped());
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <vector>
+
+#include <QObject>
+#include <QTimer>
+
+#include <vtkSmartPointer.h>
+
+#include "Processing/FrameTap.h"
+
+class vtkActor;
+class vtkCellArray;
+class vtkPoints;
+class vtkPolyData;
+class vtkRenderWindow;
+class vtkRenderer;
+class vtkTypeInt32Array;
+class vtkUnsignedCharArray;
+
+// Live 3D trail of the frames TcpSocketWorker is streaming. Samples are pulled from a
+// FrameTap on a fixed-rate timer into a preallocated polyline ring: the newest sample
+// overwrites the oldest and only the two line cells touching it change, so memory stays
+// bounded and each tick costs one buffer update and at most one render, independent of
+// how fast frames go out.
+class LiveToolpath : public QObject {
+    Q_OBJECT
+public:
+    LiveToolpath(vtkRenderer* renderer, vtkRenderWindow* window, int capacity = 200000, QObject* parent = nullptr);
+    ~LiveToolpath() override;
+
+    // Enables the tap and adds the trail to the scene; the tap must outlive this object.
+    void start(FrameTap* tap, int renderHz = 10);
+    void stop();
+    void clear();
+    bool isRunning() const;
+    qint64 pointsShown() const;
+
+signals:
+    void updated(int newPoints, qint64 droppedTotal);
+
+private:
+    void onTick();
+    void append(const TapPoint& point);
+
+    vtkRenderer* m_renderer;
+    vtkRenderWindow* m_window;
+    vtkSmartPointer<vtkPoints> m_points;
+    vtkSmartPointer<vtkTypeInt32Array> m_connectivity;
+    vtkSmartPointer<vtkUnsignedCharArray> m_colors;
+    vtkSmartPointer<vtkCellArray> m_lines;
+    vtkSmartPointer<vtkPolyData> m_polyData;
+    vtkSmartPointer<vtkActor> m_actor;
+    FrameTap* m_tap{};
+    QTimer m_timer;
+    std::vector<TapPoint> m_scratch;
+    int m_capacity;
+    int m_head{ 0 };
+    qint64 m_count{ 0 };
+};
@@ -0,0 +1,161 @@
+#include "LogModel.h"
+
+#include <QBrush>
+#include <QColor>
+#include <QDateTime>
+
+namespace {
+    const QColor WARNING_COLOR(190, 110, 0);
+    const QColor ERROR_COLOR(200, 30, 30);
+}
+
+LogModel::LogModel(int capacity, QObject* parent)
+    : QAbstractTableModel(parent)
+    , m_capacity(qMax(1, capacity)) {
+    // A zero-interval single shot fires once the event loop has drained the events already
+    // queued, so a burst of replies becomes one row insertion instead of one per reply.
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(0);
+    connect(&m_flushTimer, &QTimer::timeout, this, &LogModel::flush);
+}
+
+void LogModel::append(const QString& text) {
+    append(Severity::Info, text);
+}
+
+void LogModel::append(Severity severity, const QString& text) {
+    m_pending.push_back({ QDateTime::currentMSecsSinceEpoch(), severity, text });
+    if (!m_flushTimer.isActive()) {
+        m_flushTimer.start();
+    }
+}
+
+void LogModel::flush() {
+    m_flushTimer.stop();
+    if (m_pending.empty()) {
+        return;
+    }
+    // Only the newest capacity entries of one pass can survive it.
+    const int pending = static_cast<int>(m_pending.size());
+    const int skipped = qMax(0, pending - m_capacity);
+    const int incoming = pending - skipped;
+    m_dropped += skipped;
+
+    const int evicted = qMax(0, m_count + incoming - m_capacity);
+    if (evicted > 0) {
+        beginRemoveRows(QModelIndex(), 0, evicted - 1);
+        m_head = (m_head + evicted) % m_capacity;
+        m_count -= evicted;
+        m_dropped += evicted;
+        endRemoveRows();
+    }
+
+    beginInsertRows(QModelIndex(), m_count, m_count + incoming - 1);
+    for (int i = skipped; i < pending; ++i) {
+        // The ring grows until it reaches capacity and is overwritten in place from then on.
+        const int slot = m_head + m_count;
+        if (slot == static_cast<int>(m_ring.size()) && slot < m_capacity) {
+            m_ring.push_back(std::move(m_pending[i]));
+        }
+        else {
+            m_ring[slot % m_capacity] = std::move(m_pending[i]);
+        }
+        ++m_count;
+    }
+    m_pending.clear();
+    endInsertRows();
+}
+
+void LogModel::clear() {
+    m_flushTimer.stop();
+    beginResetModel();
+    m_ring.clear();
+    m_ring.shrink_to_fit();
+    m_pending.clear();
+    m_head = 0;
+    m_count = 0;
+    endResetModel();
+}
+
+int LogModel::capacity() const {
+    return m_capacity;
+}
+
+qint64 LogModel::dropped() const {
+    return m_dropped;
+}
+
+QString LogModel::severityName(Severity severity) {
+    switch (severity) {
+    case Severity::Warning:
+        return tr("Warning");
+    case Severity::Error:
+        return tr("Error");
+    case Severity::Info:
+    default:
+        return tr("Info");
+    }
+}
+
+const LogModel::Entry& LogModel::entryAt(int row) const {
+    return m_ring[(m_head + row) % m_ring.size()];
+}
+
+int LogModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : m_count;
+}
+
+int LogModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant LogModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() >= m_count) {
+        return {};
+    }
+    // Text is only formatted for the rows a view actually asks for.
+    const Entry& entry = entryAt(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+        switch (index.column()) {
+        case TimeColumn:
+            return QDateTime::fromMSecsSinceEpoch(entry.timestampMs).toString(QStringLiteral("HH:mm:ss.zzz"));
+        case SeverityColumn:
+            return severityName(entry.severity);
+        case MessageColumn:
+            return entry.text;
+        default:
+            return {};
+        }
+    case Qt::ToolTipRole:
+        return index.column() == MessageColumn ? QVariant(entry.text) : QVariant();
+    case Qt::ForegroundRole:
+        if (entry.severity == Severity::Warning) {
+            return QBrush(WARNING_COLOR);
+        }
+        if (entry.severity == Severity::Error) {
+            return QBrush(ERROR_COLOR);
+        }
+        return {};
+    case SeverityRole:
+        return static_cast<int>(entry.severity);
+    default:
+        return {};
+    }
+}
+
+QVariant LogModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return {};
+    }
+    switch (section) {
+    case TimeColumn:
+        return tr("Time");
+    case SeverityColumn:
+        return tr("Severity");
+    case MessageColumn:
+        return tr("Message");
+    default:
+        return {};
+    }
+}
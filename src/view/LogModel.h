@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vector>
+
+#include <QAbstractTableModel>
+#include <QTimer>
+
+// Processing log kept in a fixed-capacity ring. append() only queues the entry; queued
+// entries are inserted in one batch per event-loop pass, and once the ring is full the
+// same batch evicts the oldest rows, so memory is bounded and the cost of an append does
+// not depend on how many entries the log already holds.
+class LogModel : public QAbstractTableModel {
+    Q_OBJECT
+public:
+    enum class Severity : quint8 {
+        Info,
+        Warning,
+        Error,
+    };
+
+    enum Column {
+        TimeColumn,
+        SeverityColumn,
+        MessageColumn,
+        ColumnCount,
+    };
+
+    // Severity as an int, for filtering.
+    static constexpr int SeverityRole = Qt::UserRole + 1;
+
+    explicit LogModel(int capacity = 100000, QObject* parent = nullptr);
+
+    void append(const QString& text);
+    void append(Severity severity, const QString& text);
+    // Inserts the queued entries now instead of on the next event-loop pass.
+    void flush();
+    void clear();
+
+    int capacity() const;
+    // Entries evicted from the ring (or from the queue, when a single pass overflows it).
+    qint64 dropped() const;
+    static QString severityName(Severity severity);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    struct Entry {
+        qint64 timestampMs{ 0 };
+        Severity severity{ Severity::Info };
+        QString text;
+    };
+
+    const Entry& entryAt(int row) const;
+
+    std::vector<Entry> m_ring;
+    std::vector<Entry> m_pending;
+    QTimer m_flushTimer;
+    int m_capacity;
+    int m_head{ 0 };
+    int m_count{ 0 };
+    qint64 m_dropped{ 0 };
+};
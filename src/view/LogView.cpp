@@ -0,0 +1,212 @@
+#include "LogView.h"
+
+#include <memory>
+
+#include <QCheckBox>
+#include <QComboBox>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QLineEdit>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QRegularExpression>
+#include <QSortFilterProxyModel>
+#include <QTableView>
+#include <QTextStream>
+#include <QTimer>
+#include <QVBoxLayout>
+
+#include "metrics/HdrHistogram.h"
+
+namespace {
+    // Entries at or above a severity whose message matches the text filter.
+    class LogFilterProxy : public QSortFilterProxyModel {
+    public:
+        using QSortFilterProxyModel::QSortFilterProxyModel;
+
+        void setMinimumSeverity(int severity) {
+            m_minimumSeverity = severity;
+            invalidateRowsFilter();
+        }
+
+        bool isFiltering() const {
+            return m_minimumSeverity > 0 || !filterRegularExpression().pattern().isEmpty();
+        }
+
+    protected:
+        bool filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const override {
+            const QModelIndex index = sourceModel()->index(sourceRow, LogModel::MessageColumn, sourceParent);
+            if (sourceModel()->data(index, LogModel::SeverityRole).toInt() < m_minimumSeverity) {
+                return false;
+            }
+            return QSortFilterProxyModel::filterAcceptsRow(sourceRow, sourceParent);
+        }
+
+    private:
+        int m_minimumSeverity{ 0 };
+    };
+
+    struct AppendBenchmarkState {
+        HdrHistogram fillNs;
+        HdrHistogram wrapNs;
+        HdrHistogram flushUs;
+        QElapsedTimer total;
+        QElapsedTimer flush;
+        qint64 done{ 0 };
+        bool flushing{ false };
+    };
+}
+
+LogView::LogView(LogModel* model, QWidget* parent)
+    : QWidget(parent)
+    , m_model(model) {
+    auto* layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+
+    auto* controls = new QHBoxLayout();
+    m_severity = new QComboBox(this);
+    m_severity->addItem(tr("All"), static_cast<int>(LogModel::Severity::Info));
+    m_severity->addItem(tr("Warnings and errors"), static_cast<int>(LogModel::Severity::Warning));
+    m_severity->addItem(tr("Errors only"), static_cast<int>(LogModel::Severity::Error));
+    m_filter = new QLineEdit(this);
+    m_filter->setPlaceholderText(tr("Filter messages"));
+    m_filter->setClearButtonEnabled(true);
+    m_follow = new QCheckBox(tr("Follow"), this);
+    m_follow->setChecked(true);
+    m_status = new QLabel(this);
+    auto* clearBtn = new QPushButton(tr("Clear"), this);
+    auto* exportBtn = new QPushButton(tr("Export ..."), this);
+    controls->addWidget(m_severity);
+    controls->addWidget(m_filter, 1);
+    controls->addWidget(m_follow);
+    controls->addWidget(m_status);
+    controls->addWidget(clearBtn);
+    controls->addWidget(exportBtn);
+    layout->addLayout(controls);
+
+    m_proxy = new LogFilterProxy(this);
+    m_proxy->setSourceModel(m_model);
+    m_proxy->setFilterKeyColumn(LogModel::MessageColumn);
+    m_proxy->setFilterCaseSensitivity(Qt::CaseInsensitive);
+
+    m_table = new QTableView(this);
+    m_table->setModel(m_model);
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->setWordWrap(false);
+    m_table->setShowGrid(false);
+    // Fixed section sizes keep the view from measuring rows or columns it never shows.
+    m_table->verticalHeader()->setVisible(false);
+    m_table->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    m_table->verticalHeader()->setDefaultSectionSize(m_table->fontMetrics().height() + 4);
+    m_table->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
+    m_table->horizontalHeader()->setStretchLastSection(true);
+    m_table->setColumnWidth(LogModel::TimeColumn, m_table->fontMetrics().horizontalAdvance(QStringLiteral("00:00:00.000")) + 16);
+    m_table->setColumnWidth(LogModel::SeverityColumn, m_table->fontMetrics().horizontalAdvance(tr("Warning")) + 16);
+    layout->addWidget(m_table, 1);
+
+    connect(m_severity, &QComboBox::currentIndexChanged, this, &LogView::applyFilter);
+    connect(m_filter, &QLineEdit::textChanged, this, &LogView::applyFilter);
+    connect(clearBtn, &QPushButton::clicked, m_model, &LogModel::clear);
+    connect(exportBtn, &QPushButton::clicked, this, &LogView::exportLog);
+    connect(m_model, &QAbstractItemModel::rowsInserted, this, &LogView::onRowsInserted);
+    connect(m_model, &QAbstractItemModel::modelReset, this, &LogView::onRowsInserted);
+}
+
+LogModel* LogView::model() const {
+    return m_model;
+}
+
+void LogView::applyFilter() {
+    auto* proxy = static_cast<LogFilterProxy*>(m_proxy);
+    proxy->setFilterRegularExpression(QRegularExpression(QRegularExpression::escape(m_filter->text()),
+        QRegularExpression::CaseInsensitiveOption));
+    proxy->setMinimumSeverity(m_severity->currentData().toInt());
+    // An unfiltered view sits on the ring directly, so evicting rows does not remap a proxy.
+    QAbstractItemModel* wanted = proxy->isFiltering() ? static_cast<QAbstractItemModel*>(proxy) : m_model;
+    if (m_table->model() != wanted) {
+        m_table->setModel(wanted);
+    }
+    onRowsInserted();
+}
+
+void LogView::onRowsInserted() {
+    m_status->setText(tr("%1 shown, %2 dropped").arg(m_table->model()->rowCount()).arg(m_model->dropped()));
+    if (m_follow->isChecked()) {
+        m_table->scrollToBottom();
+    }
+}
+
+void LogView::exportLog() {
+    const QString filePath = QFileDialog::getSaveFileName(this, tr("Export log"), QStringLiteral("processing_log.txt"),
+        tr("Text (*.txt *.log)"));
+    if (filePath.isEmpty()) {
+        return;
+    }
+    m_model->flush();
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        QMessageBox::warning(this, tr("Export log"), file.errorString());
+        return;
+    }
+    // Exports what the view shows, so a filter narrows the file too.
+    const QAbstractItemModel* source = m_table->model();
+    QTextStream out(&file);
+    const int rows = source->rowCount();
+    for (int row = 0; row < rows; ++row) {
+        out << source->index(row, LogModel::TimeColumn).data().toString() << '\t'
+            << source->index(row, LogModel::SeverityColumn).data().toString() << '\t'
+            << source->index(row, LogModel::MessageColumn).data().toString() << '\n';
+    }
+}
+
+void LogView::startAppendBenchmark(qint64 entries, int batch) {
+    batch = qMax(1, batch);
+    auto state = std::make_shared<AppendBenchmarkState>();
+    state->total.start();
+    auto* stepper = new QTimer(this);
+    connect(stepper, &QTimer::timeout, this, [this, stepper, state, entries, batch]() {
+        const QString text = QStringLiteral("[ProcessLine] Success: benchmark reply");
+        if (state->flushing) {
+            // The previous batch was flushed and the event loop has since repainted the table.
+            state->flushUs.record(state->flush.nsecsElapsed() / 1000);
+            state->flushing = false;
+        }
+        if (state->done < entries) {
+            const int count = static_cast<int>(qMin<qint64>(batch, entries - state->done));
+            HdrHistogram& appendNs = m_model->rowCount() >= m_model->capacity() ? state->wrapNs : state->fillNs;
+            QElapsedTimer timer;
+            for (int i = 0; i < count; ++i, ++state->done) {
+                const auto severity = state->done % 1000 == 0 ? LogModel::Severity::Error
+                    : state->done % 100 == 0 ? LogModel::Severity::Warning
+                    : LogModel::Severity::Info;
+                timer.start();
+                m_model->append(severity, text);
+                appendNs.record(timer.nsecsElapsed());
+            }
+            state->flush.start();
+            m_model->flush();
+            state->flushing = true;
+            return;
+        }
+        stepper->deleteLater();
+
+        AppendBenchmarkResult result;
+        result.entries = entries;
+        result.capacity = m_model->capacity();
+        result.fillP50Ns = state->fillNs.valueAtPercentile(50.0);
+        result.fillP99Ns = state->fillNs.valueAtPercentile(99.0);
+        result.wrapP50Ns = state->wrapNs.valueAtPercentile(50.0);
+        result.wrapP99Ns = state->wrapNs.valueAtPercentile(99.0);
+        result.flushP50Ms = state->flushUs.valueAtPercentile(50.0) / 1000.0;
+        result.flushP99Ms = state->flushUs.valueAtPercentile(99.0) / 1000.0;
+        result.flushMaxMs = state->flushUs.max() / 1000.0;
+        result.totalMs = state->total.nsecsElapsed() / 1e6;
+        emit appendBenchmarkFinished(result);
+        });
+    stepper->start(0);
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <QWidget>
+
+#include "view/LogModel.h"
+
+class QCheckBox;
+class QComboBox;
+class QLabel;
+class QLineEdit;
+class QSortFilterProxyModel;
+class QTableView;
+
+// Table view over a LogModel with fixed row heights, so scrolling and inserting cost the
+// same at a million rows as at ten. A severity/text filter is applied through a proxy that
+// is only put between model and view while a filter is set.
+class LogView : public QWidget {
+    Q_OBJECT
+public:
+    struct AppendBenchmarkResult {
+        qint64 entries{ 0 };
+        int capacity{ 0 };
+        // Per append(), while the ring fills and once it evicts on every batch.
+        double fillP50Ns{ 0.0 };
+        double fillP99Ns{ 0.0 };
+        double wrapP50Ns{ 0.0 };
+        double wrapP99Ns{ 0.0 };
+        // Per batch: flush plus one pass of the event loop, including the repaint.
+        double flushP50Ms{ 0.0 };
+        double flushP99Ms{ 0.0 };
+        double flushMaxMs{ 0.0 };
+        double totalMs{ 0.0 };
+    };
+
+    explicit LogView(LogModel* model, QWidget* parent = nullptr);
+
+    LogModel* model() const;
+    // Appends in batches, one batch and its flush per event-loop pass, then emits
+    // appendBenchmarkFinished; the view must stay visible until then.
+    void startAppendBenchmark(qint64 entries, int batch);
+
+signals:
+    void appendBenchmarkFinished(const LogView::AppendBenchmarkResult& result);
+
+private slots:
+    void applyFilter();
+    void exportLog();
+    void onRowsInserted();
+
+private:
+    LogModel* m_model;
+    QSortFilterProxyModel* m_proxy{};
+    QTableView* m_table{};
+    QComboBox* m_severity{};
+    QLineEdit* m_filter{};
+    QCheckBox* m_follow{};
+    QLabel* m_status{};
+};
@@ -0,0 +1,186 @@
+#include "MetricsPanel.h"
+
+#include <QCheckBox>
+#include <QComboBox>
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QSpinBox>
+#include <QTableWidget>
+#include <QTimer>
+#include <QVBoxLayout>
+
+#include "metrics/MetricsExporter.h"
+#include "metrics/MetricsRegistry.h"
+
+namespace {
+    constexpr int REFRESH_MS = 1000;
+    constexpr int DEFAULT_PORT = 9464;
+
+    QString typeLabel(MetricsRegistry::Type type) {
+        switch (type) {
+        case MetricsRegistry::Type::Counter:
+            return QObject::tr("counter");
+        case MetricsRegistry::Type::Gauge:
+            return QObject::tr("gauge");
+        case MetricsRegistry::Type::Histogram:
+            return QObject::tr("histogram");
+        }
+        return QString();
+    }
+}
+
+MetricsPanel::MetricsPanel(MetricsRegistry* registry, MetricsExporter* exporter, QWidget* parent)
+    : QWidget(parent)
+    , m_registry(registry)
+    , m_exporter(exporter) {
+    auto* layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+
+    const QStringList headers{ tr("Metric"), tr("Type"), tr("Value"), tr("Rate /s"), tr("p50"), tr("p99"), tr("Max") };
+    m_table = new QTableWidget(0, headers.size(), this);
+    m_table->setHorizontalHeaderLabels(headers);
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->verticalHeader()->setVisible(false);
+    m_table->horizontalHeader()->setStretchLastSection(true);
+    m_table->setToolTip(tr("Histogram values in microseconds; Value is the number recorded"));
+    layout->addWidget(m_table, 1);
+
+    auto* controls = new QHBoxLayout();
+    m_fileCheck = new QCheckBox(tr("Write to file"), this);
+    m_format = new QComboBox(this);
+    m_format->addItem(tr("JSON"), static_cast<int>(MetricsExporter::Format::Json));
+    m_format->addItem(tr("Prometheus text"), static_cast<int>(MetricsExporter::Format::Prometheus));
+    m_interval = new QSpinBox(this);
+    m_interval->setRange(1, 3600);
+    m_interval->setValue(10);
+    m_interval->setSuffix(tr(" s"));
+    m_httpCheck = new QCheckBox(tr("Serve on localhost"), this);
+    m_port = new QSpinBox(this);
+    m_port->setRange(1024, 65535);
+    m_port->setValue(DEFAULT_PORT);
+    m_status = new QLabel(this);
+    controls->addWidget(m_fileCheck);
+    controls->addWidget(m_format);
+    controls->addWidget(new QLabel(tr("every"), this));
+    controls->addWidget(m_interval);
+    controls->addSpacing(16);
+    controls->addWidget(m_httpCheck);
+    controls->addWidget(m_port);
+    controls->addStretch(1);
+    controls->addWidget(m_status);
+    layout->addLayout(controls);
+
+    connect(m_fileCheck, &QCheckBox::toggled, this, &MetricsPanel::setFileExport);
+    connect(m_httpCheck, &QCheckBox::toggled, this, &MetricsPanel::setHttpExport);
+    connect(m_exporter, &MetricsExporter::exportFailed, this, [this](const QString& message) {
+        m_status->setText(tr("Export failed: %1").arg(message));
+        });
+
+    m_refreshTimer = new QTimer(this);
+    m_refreshTimer->setInterval(REFRESH_MS);
+    connect(m_refreshTimer, &QTimer::timeout, this, &MetricsPanel::refresh);
+    m_refreshTimer->start();
+    updateStatus();
+}
+
+void MetricsPanel::refresh() {
+    // Rates need the previous values even while hidden, so only the table update is skipped.
+    const auto samples = m_registry->snapshot();
+    const double seconds = m_sinceRefresh.isValid() ? m_sinceRefresh.nsecsElapsed() / 1e9 : 0.0;
+    m_sinceRefresh.start();
+    QHash<QString, double> counters;
+    QStringList rates;
+    for (const auto& sample : samples) {
+        QString rate;
+        if (sample.type != MetricsRegistry::Type::Gauge) {
+            const auto last = m_lastCounters.constFind(sample.name);
+            if (seconds > 0.0 && last != m_lastCounters.constEnd()) {
+                rate = QString::number((sample.value - last.value()) / seconds, 'f', 1);
+            }
+            counters.insert(sample.name, sample.value);
+        }
+        rates.append(rate);
+    }
+    m_lastCounters.swap(counters);
+    if (!isVisible()) {
+        return;
+    }
+
+    m_table->setRowCount(static_cast<int>(samples.size()));
+    for (int row = 0; row < static_cast<int>(samples.size()); ++row) {
+        const auto& sample = samples[row];
+        const bool histogram = sample.type == MetricsRegistry::Type::Histogram;
+        const QStringList values{
+            sample.name,
+            typeLabel(sample.type),
+            QString::number(sample.value, 'g', 12),
+            rates[row],
+            histogram ? QString::number(sample.p50) : QString(),
+            histogram ? QString::number(sample.p99) : QString(),
+            histogram ? QString::number(sample.max) : QString(),
+        };
+        for (int column = 0; column < values.size(); ++column) {
+            auto* item = m_table->item(row, column);
+            if (!item) {
+                item = new QTableWidgetItem();
+                m_table->setItem(row, column, item);
+            }
+            item->setText(values[column]);
+        }
+        m_table->item(row, 0)->setToolTip(sample.help);
+    }
+}
+
+void MetricsPanel::setFileExport(bool enabled) {
+    if (!enabled) {
+        m_exporter->stopFileExport();
+        updateStatus();
+        return;
+    }
+    const auto format = static_cast<MetricsExporter::Format>(m_format->currentData().toInt());
+    const QString suggested = format == MetricsExporter::Format::Json ? QStringLiteral("metrics.json") : QStringLiteral("metrics.prom");
+    const QString path = QFileDialog::getSaveFileName(this, tr("Export metrics to"), suggested,
+        tr("Metrics (*.json *.prom *.txt)"));
+    if (path.isEmpty()) {
+        m_fileCheck->setChecked(false);
+        return;
+    }
+    QString error;
+    if (!m_exporter->exportToFile(path, format, m_interval->value() * 1000, error)) {
+        m_fileCheck->setChecked(false);
+        m_status->setText(error);
+        return;
+    }
+    updateStatus();
+}
+
+void MetricsPanel::setHttpExport(bool enabled) {
+    if (!enabled) {
+        m_exporter->stopListening();
+        updateStatus();
+        return;
+    }
+    QString error;
+    if (!m_exporter->listen(static_cast<quint16>(m_port->value()), error)) {
+        m_httpCheck->setChecked(false);
+        m_status->setText(error);
+        return;
+    }
+    updateStatus();
+}
+
+void MetricsPanel::updateStatus() {
+    m_format->setEnabled(!m_exporter->isExportingToFile());
+    m_interval->setEnabled(!m_exporter->isExportingToFile());
+    m_port->setEnabled(!m_exporter->isListening());
+    QStringList parts;
+    if (m_exporter->isExportingToFile()) {
+        parts.append(tr("writing %1").arg(m_exporter->filePath()));
+    }
+    if (m_exporter->isListening()) {
+        parts.append(tr("http://127.0.0.1:%1/metrics").arg(m_exporter->port()));
+    }
+    m_status->setText(parts.join(QStringLiteral(", ")));
+}
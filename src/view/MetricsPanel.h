@@ -0,0 +1,46 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QWidget>
+
+class MetricsExporter;
+class MetricsRegistry;
+class QCheckBox;
+class QComboBox;
+class QLabel;
+class QSpinBox;
+class QTableWidget;
+class QTimer;
+
+// Live view of the metrics registry: counters with their rate since the last refresh, gauges,
+// and histogram percentiles, plus the controls for the file and localhost exports.
+class MetricsPanel : public QWidget {
+    Q_OBJECT
+public:
+    MetricsPanel(MetricsRegistry* registry, MetricsExporter* exporter, QWidget* parent = nullptr);
+
+public slots:
+    void refresh();
+
+private slots:
+    void setFileExport(bool enabled);
+    void setHttpExport(bool enabled);
+
+private:
+    void updateStatus();
+
+    MetricsRegistry* m_registry{};
+    MetricsExporter* m_exporter{};
+    QTableWidget* m_table{};
+    QTimer* m_refreshTimer{};
+    QCheckBox* m_fileCheck{};
+    QComboBox* m_format{};
+    QSpinBox* m_interval{};
+    QCheckBox* m_httpCheck{};
+    QSpinBox* m_port{};
+    QLabel* m_status{};
+    // Counter values at the previous refresh, for the rate column.
+    QHash<QString, double> m_lastCounters;
+    QElapsedTimer m_sinceRefresh;
+};
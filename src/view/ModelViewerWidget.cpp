@@ -2,30 +2,68 @@
 
 #include <QFileDialog>
 #include <QFileInfo>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QProgressBar>
+#include <QPushButton>
 #include <QVBoxLayout>
 #include <QVTKOpenGLNativeWidget.h>
+#include <QtDebug>
+
+#include <functional>
 
 #include <vtkActor.h>
 #include <vtkAxesActor.h>
+#include <vtkCallbackCommand.h>
+#include <vtkCommand.h>
 #include <vtkConeSource.h>
 #include <vtkGenericOpenGLRenderWindow.h>
+#include <vtkLODProp3D.h>
 #include <vtkNamedColors.h>
 #include <vtkNew.h>
 #include <vtkOBJReader.h>
 #include <vtkOrientationMarkerWidget.h>
+#include <vtkPolyData.h>
 #include <vtkPolyDataAlgorithm.h>
 #include <vtkPolyDataMapper.h>
 #include <vtkProperty.h>
 #include <vtkRenderer.h>
 #include <vtkSmartPointer.h>
-#include <vtkSTLReader.h>
+
+#include "LiveToolpath.h"
+#include "mesh/FastStlReader.h"
 
 namespace {
+    constexpr int STALL_PROBE_MS = 15;
+
+    // Lives on the worker's stack for the duration of reader->Update().
+    struct ReaderProgress {
+        vtkAlgorithm* reader{};
+        std::shared_ptr<std::atomic<bool>> cancel;
+        std::function<void(double)> report;
+        double lastReported{ -1.0 };
+    };
+
+    void onReaderProgress(vtkObject* caller, unsigned long eventId, void* clientData, void* callData) {
+        Q_UNUSED(caller);
+        Q_UNUSED(eventId);
+        auto* progress = static_cast<ReaderProgress*>(clientData);
+        if (progress->cancel->load()) {
+            progress->reader->SetAbortExecute(1);
+            return;
+        }
+        const double fraction = *static_cast<double*>(callData);
+        if (fraction - progress->lastReported >= 0.01 || fraction >= 1.0) {
+            progress->lastReported = fraction;
+            progress->report(fraction);
+        }
+    }
+
     vtkSmartPointer<vtkPolyDataAlgorithm> readerForFile(const QString& filePath) {
         const QString suffix = QFileInfo(filePath).suffix().toLower();
         if (suffix == QStringLiteral("stl")) {
-            auto reader = vtkSmartPointer<vtkSTLReader>::New();
-            reader->SetFileName(filePath.toLocal8Bit().constData());
+            auto reader = vtkSmartPointer<FastStlReader>::New();
+            reader->setFileName(filePath);
             return reader;
         }
         if (suffix == QStringLiteral("obj")) {
@@ -46,10 +84,55 @@ ModelViewerWidget::ModelViewerWidget(QWidget* parent)
     m_vtkWidget = new QVTKOpenGLNativeWidget(this);
     layout->addWidget(m_vtkWidget, 1);
 
+    m_progressRow = new QWidget(this);
+    auto* progressLayout = new QHBoxLayout(m_progressRow);
+    progressLayout->setContentsMargins(4, 2, 4, 2);
+    m_progressLabel = new QLabel(m_progressRow);
+    m_progressBar = new QProgressBar(m_progressRow);
+    m_progressBar->setRange(0, 100);
+    m_cancelButton = new QPushButton(tr("Cancel"), m_progressRow);
+    progressLayout->addWidget(m_progressLabel);
+    progressLayout->addWidget(m_progressBar, 1);
+    progressLayout->addWidget(m_cancelButton);
+    m_progressRow->hide();
+    layout->addWidget(m_progressRow);
+    connect(m_cancelButton, &QPushButton::clicked, this, &ModelViewerWidget::cancelLoad);
+
+    // One reader at a time; a new load cancels the previous one.
+    m_loadPool.setMaxThreadCount(1);
+    m_lodPool.setMaxThreadCount(1);
+    m_stallProbe.setInterval(STALL_PROBE_MS);
+    connect(&m_stallProbe, &QTimer::timeout, this, &ModelViewerWidget::onStallProbe);
+
     setupRenderer();
+    m_liveToolpath = new LiveToolpath(m_renderer, m_renderWindow, 200000, this);
     showSampleModel();
 }
 
+ModelViewerWidget::~ModelViewerWidget() {
+    cancelLoad();
+    cancelLod();
+    m_loadPool.waitForDone();
+    m_lodPool.waitForDone();
+}
+
+bool ModelViewerWidget::isLoading() const {
+    return m_progressRow->isVisible();
+}
+
+LiveToolpath* ModelViewerWidget::liveToolpath() const {
+    return m_liveToolpath;
+}
+
+void ModelViewerWidget::startLiveToolpath(FrameTap* tap) {
+    m_liveToolpath->clear();
+    m_liveToolpath->start(tap);
+}
+
+void ModelViewerWidget::stopLiveToolpath() {
+    m_liveToolpath->stop();
+}
+
 void ModelViewerWidget::setupRenderer() {
     auto colors = vtkSmartPointer<vtkNamedColors>::New();
 
@@ -85,14 +168,170 @@ bool ModelViewerWidget::loadModel(const QString& filePath) {
         return false;
     }
 
-    reader->Update();
-    if (!reader->GetOutput() || reader->GetOutput()->GetNumberOfPoints() == 0) {
-        emit modelLoadFailed(filePath, tr("file geodata unavailable"));
-        return false;
+    cancelLoad();
+    const quint64 serial = ++m_loadSerial;
+    auto cancel = std::make_shared<std::atomic<bool>>(false);
+    m_cancel = cancel;
+    m_loadingPath = filePath;
+    m_progressLabel->setText(QFileInfo(filePath).fileName());
+    m_progressBar->setValue(0);
+    m_progressRow->show();
+    m_maxStallMs = 0.0;
+    m_stallClock.start();
+    m_stallProbe.start();
+
+    // Only the reader runs on the worker; the renderer and mapper stay on the GUI thread.
+    m_loadPool.start([this, serial, reader, cancel]() {
+        QElapsedTimer timer;
+        timer.start();
+        ReaderProgress progress;
+        progress.reader = reader;
+        progress.cancel = cancel;
+        progress.report = [this, serial](double fraction) {
+            QMetaObject::invokeMethod(this, [this, serial, fraction]() {
+                onLoadProgress(serial, fraction);
+                }, Qt::QueuedConnection);
+        };
+        vtkNew<vtkCallbackCommand> observer;
+        observer->SetCallback(&onReaderProgress);
+        observer->SetClientData(&progress);
+        reader->AddObserver(vtkCommand::ProgressEvent, observer);
+        reader->Update();
+
+        vtkSmartPointer<vtkPolyData> data;
+        QString error;
+        if (cancel->load()) {
+            error = tr("cancelled");
+        }
+        else if (!reader->GetOutput() || reader->GetOutput()->GetNumberOfPoints() == 0) {
+            error = tr("file geodata unavailable");
+        }
+        else {
+            // Detach the result from the reader so the pipeline can be dropped with this thread.
+            data = vtkSmartPointer<vtkPolyData>::New();
+            data->ShallowCopy(reader->GetOutput());
+        }
+        const double readMs = timer.nsecsElapsed() / 1e6;
+        QMetaObject::invokeMethod(this, [this, serial, data, error, readMs]() {
+            onLoadFinished(serial, data, error, readMs);
+            }, Qt::QueuedConnection);
+        });
+    return true;
+}
+
+void ModelViewerWidget::cancelLoad() {
+    if (m_cancel) {
+        m_cancel->store(true);
+    }
+}
+
+void ModelViewerWidget::onLoadProgress(quint64 serial, double fraction) {
+    if (serial != m_loadSerial) {
+        return;
+    }
+    m_progressBar->setValue(qRound(fraction * 100.0));
+    emit modelLoadProgress(m_loadingPath, fraction);
+}
+
+void ModelViewerWidget::onStallProbe() {
+    const double gapMs = m_stallClock.nsecsElapsed() / 1e6;
+    m_stallClock.restart();
+    m_maxStallMs = qMax(m_maxStallMs, gapMs - STALL_PROBE_MS);
+}
+
+void ModelViewerWidget::onLoadFinished(quint64 serial, vtkSmartPointer<vtkPolyData> data, const QString& error,
+    double readMs) {
+    // A newer load superseded this one; its own result will follow.
+    if (serial != m_loadSerial) {
+        return;
+    }
+    m_stallProbe.stop();
+    m_progressRow->hide();
+    m_cancel.reset();
+    const QString filePath = m_loadingPath;
+    if (!data) {
+        emit modelLoadFailed(filePath, error);
+        return;
     }
 
+    QElapsedTimer timer;
+    timer.start();
+    showPolyData(data);
+    const double displayMs = timer.nsecsElapsed() / 1e6;
+    qInfo() << "model" << filePath << "read" << readMs << "ms, display" << displayMs << "ms, max UI stall"
+            << m_maxStallMs << "ms," << data->GetNumberOfPoints() << "points";
+    emit modelLoadTimed(filePath, readMs, displayMs, m_maxStallMs, data->GetNumberOfPoints());
+    emit modelLoaded(filePath);
+    startLodBuild(filePath, data);
+}
+
+void ModelViewerWidget::cancelLod() {
+    if (m_lodCancel) {
+        m_lodCancel->store(true);
+    }
+    m_lodCancel.reset();
+    ++m_lodSerial;
+}
+
+void ModelViewerWidget::startLodBuild(const QString& filePath, vtkSmartPointer<vtkPolyData> data) {
+    cancelLod();
+    if (data->GetNumberOfPolys() < MeshLod::MIN_TRIANGLES) {
+        return;
+    }
+    const quint64 serial = m_lodSerial;
+    auto cancel = std::make_shared<std::atomic<bool>>(false);
+    m_lodCancel = cancel;
+    m_lodPath = filePath;
+    // The worker only reads the arrays it shares with the displayed mesh.
+    auto input = vtkSmartPointer<vtkPolyData>::New();
+    input->ShallowCopy(data);
+    m_lodPool.start([this, serial, filePath, input, cancel]() {
+        QElapsedTimer timer;
+        timer.start();
+        const MeshLod::Result result = MeshLod::build(filePath, input, *cancel);
+        const double buildMs = timer.nsecsElapsed() / 1e6;
+        QMetaObject::invokeMethod(this, [this, serial, result, buildMs]() {
+            onLodBuilt(serial, result, buildMs);
+            }, Qt::QueuedConnection);
+        });
+}
+
+void ModelViewerWidget::onLodBuilt(quint64 serial, const MeshLod::Result& result, double buildMs) {
+    if (serial != m_lodSerial) {
+        return;
+    }
+    m_lodCancel.reset();
+    if (!result.error.isEmpty()) {
+        emit modelLodFailed(m_lodPath, result.error);
+    }
+    auto* actor = vtkActor::SafeDownCast(m_modelActor);
+    if (result.levels.empty() || !actor) {
+        return;
+    }
+
+    // The interactor lowers the allocated render time while the user drags and restores it
+    // on release, so automatic selection shows a coarse level in motion and full detail at rest.
+    auto lod = vtkSmartPointer<vtkLODProp3D>::New();
+    lod->AutomaticLODSelectionOn();
+    lod->AddLOD(actor->GetMapper(), actor->GetProperty(), 0.0);
+    QList<qint64> levelTriangles;
+    for (const auto& level : result.levels) {
+        auto mapper = vtkSmartPointer<vtkPolyDataMapper>::New();
+        mapper->SetInputData(level);
+        lod->AddLOD(mapper, actor->GetProperty(), 0.0);
+        levelTriangles.append(level->GetNumberOfPolys());
+    }
+
+    m_renderer->RemoveActor(m_modelActor);
+    m_modelActor = lod;
+    m_renderer->AddActor(lod);
+    m_renderWindow->Render();
+    emit modelLodReady(m_lodPath, levelTriangles, result.fromCache, buildMs);
+}
+
+void ModelViewerWidget::showPolyData(vtkSmartPointer<vtkPolyData> data) {
     auto mapper = vtkSmartPointer<vtkPolyDataMapper>::New();
-    mapper->SetInputConnection(reader->GetOutputPort());
+    mapper->SetInputData(data);
 
     auto colors = vtkSmartPointer<vtkNamedColors>::New();
     auto actor = vtkSmartPointer<vtkActor>::New();
@@ -104,12 +343,10 @@ bool ModelViewerWidget::loadModel(const QString& filePath) {
     m_renderer->AddActor(actor);
     m_renderer->ResetCamera();
     m_renderWindow->Render();
-
-    emit modelLoaded(filePath);
-    return true;
 }
 
 void ModelViewerWidget::showSampleModel() {
+    cancelLod();
     auto cone = vtkSmartPointer<vtkConeSource>::New();
     cone->SetHeight(30.0);
     cone->SetRadius(10.0);
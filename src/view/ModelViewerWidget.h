@@ -1,34 +1,92 @@
 #pragma once
 
+#include <atomic>
+#include <memory>
+
+#include <QElapsedTimer>
+#include <QThreadPool>
+#include <QTimer>
 #include <QWidget>
 
 #include <vtkSmartPointer.h>
 
+#include "mesh/MeshLod.h"
+
+class FrameTap;
+class LiveToolpath;
+class QLabel;
+class QProgressBar;
+class QPushButton;
 class QVTKOpenGLNativeWidget;
 class vtkGenericOpenGLRenderWindow;
 class vtkRenderer;
-class vtkActor;
+class vtkProp3D;
+class vtkPolyData;
 
 class ModelViewerWidget : public QWidget {
     Q_OBJECT
 public:
     explicit ModelViewerWidget(QWidget* parent = nullptr);
+    ~ModelViewerWidget() override;
+
+    bool isLoading() const;
+    LiveToolpath* liveToolpath() const;
 
 public slots:
     void loadModelFromDialog();
+    // Reads the file on a worker thread; returns false only when the format is unsupported.
     bool loadModel(const QString& filePath);
+    void cancelLoad();
     void showSampleModel();
+    // Shows the frames going out through tap as a live trail on top of the model.
+    void startLiveToolpath(FrameTap* tap);
+    void stopLiveToolpath();
 
 signals:
     void modelLoaded(const QString& filePath);
     void modelLoadFailed(const QString& filePath, const QString& reason);
+    void modelLoadProgress(const QString& filePath, double fraction);
+    // maxStallMs is the longest the GUI event loop went unserviced while the file was read.
+    void modelLoadTimed(const QString& filePath, double readMs, double displayMs, double maxStallMs, qint64 points);
+    // Interaction switched to the decimated levels (triangle counts, finest first).
+    void modelLodReady(const QString& filePath, const QList<qint64>& levelTriangles, bool fromCache, double buildMs);
+    // Building or caching the levels went wrong; modelLodReady still follows if levels were built.
+    void modelLodFailed(const QString& filePath, const QString& reason);
 
 private:
     void setupRenderer();
     void resetScene();
+    void showPolyData(vtkSmartPointer<vtkPolyData> data);
+    void onLoadProgress(quint64 serial, double fraction);
+    void onLoadFinished(quint64 serial, vtkSmartPointer<vtkPolyData> data, const QString& error, double readMs);
+    void onStallProbe();
+    void startLodBuild(const QString& filePath, vtkSmartPointer<vtkPolyData> data);
+    void onLodBuilt(quint64 serial, const MeshLod::Result& result, double buildMs);
+    void cancelLod();
 
     QVTKOpenGLNativeWidget* m_vtkWidget{};
     vtkSmartPointer<vtkGenericOpenGLRenderWindow> m_renderWindow;
     vtkSmartPointer<vtkRenderer> m_renderer;
-    vtkSmartPointer<vtkActor> m_modelActor;
-};
\ No newline at end of file
+    vtkSmartPointer<vtkProp3D> m_modelActor;
+
+    LiveToolpath* m_liveToolpath{};
+
+    QWidget* m_progressRow{};
+    QProgressBar* m_progressBar{};
+    QLabel* m_progressLabel{};
+    QPushButton* m_cancelButton{};
+
+    QThreadPool m_loadPool;
+    std::shared_ptr<std::atomic<bool>> m_cancel;
+    quint64 m_loadSerial{ 0 };
+    QString m_loadingPath;
+    QTimer m_stallProbe;
+    QElapsedTimer m_stallClock;
+    double m_maxStallMs{ 0.0 };
+
+    // Decimation runs apart from loading so a new file never waits behind it.
+    QThreadPool m_lodPool;
+    std::shared_ptr<std::atomic<bool>> m_lodCancel;
+    quint64 m_lodSerial{ 0 };
+    QString m_lodPath;
+};
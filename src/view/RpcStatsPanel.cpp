@@ -0,0 +1,131 @@
+#include "RpcStatsPanel.h"
+
+#include <QFile>
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QTableWidget>
+#include <QTimer>
+#include <QVBoxLayout>
+
+#include "grpc/RpcStats.h"
+
+namespace {
+    constexpr int REFRESH_MS = 1000;
+
+    QString formatMs(qint64 us) {
+        return QString::number(us / 1000.0, 'f', 3);
+    }
+
+    bool writeFile(const QString& filePath, const QByteArray& data) {
+        QFile file(filePath);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            return false;
+        }
+        return file.write(data) == data.size();
+    }
+}
+
+RpcStatsPanel::RpcStatsPanel(RpcStats* stats, QWidget* parent)
+    : QWidget(parent)
+    , m_stats(stats) {
+    auto* layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+
+    const QStringList headers{ tr("Operation"), tr("Calls"), tr("Errors"), tr("Queue p50"), tr("Serialize p50"),
+        tr("Network p50"), tr("Server p50"), tr("Total p50"), tr("Total p90"), tr("Total p99"), tr("Total max"),
+        tr("Request B"), tr("Reply B") };
+    m_table = new QTableWidget(0, headers.size(), this);
+    m_table->setHorizontalHeaderLabels(headers);
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->verticalHeader()->setVisible(false);
+    m_table->horizontalHeader()->setStretchLastSection(true);
+    m_table->setToolTip(tr("Latencies in milliseconds"));
+    layout->addWidget(m_table, 1);
+
+    auto* controls = new QHBoxLayout();
+    auto* threshold = new QSpinBox(this);
+    threshold->setRange(0, 600000);
+    threshold->setSuffix(tr(" ms"));
+    threshold->setSpecialValueText(tr("off"));
+    threshold->setValue(static_cast<int>(m_stats->slowThresholdUs() / 1000));
+    auto* resetBtn = new QPushButton(tr("Reset"), this);
+    auto* csvBtn = new QPushButton(tr("Export CSV"), this);
+    auto* jsonBtn = new QPushButton(tr("Export JSON"), this);
+    controls->addWidget(new QLabel(tr("Slow request threshold"), this));
+    controls->addWidget(threshold);
+    controls->addStretch(1);
+    controls->addWidget(resetBtn);
+    controls->addWidget(csvBtn);
+    controls->addWidget(jsonBtn);
+    layout->addLayout(controls);
+
+    connect(threshold, &QSpinBox::valueChanged, this, [this](int ms) {
+        m_stats->setSlowThresholdUs(qint64(ms) * 1000);
+        });
+    connect(resetBtn, &QPushButton::clicked, this, [this]() {
+        m_stats->reset();
+        refresh();
+        });
+    connect(csvBtn, &QPushButton::clicked, this, &RpcStatsPanel::exportCsv);
+    connect(jsonBtn, &QPushButton::clicked, this, &RpcStatsPanel::exportJson);
+
+    m_refreshTimer = new QTimer(this);
+    m_refreshTimer->setInterval(REFRESH_MS);
+    connect(m_refreshTimer, &QTimer::timeout, this, &RpcStatsPanel::refresh);
+    m_refreshTimer->start();
+}
+
+void RpcStatsPanel::refresh() {
+    // Only repaint when the dock is actually on screen.
+    if (!isVisible()) {
+        return;
+    }
+    const auto summaries = m_stats->summaries();
+    m_table->setRowCount(summaries.size());
+    for (int row = 0; row < summaries.size(); ++row) {
+        const auto& summary = summaries[row];
+        const QStringList values{
+            summary.operation,
+            QString::number(summary.calls),
+            QString::number(summary.errors),
+            formatMs(summary.queueWait.p50),
+            formatMs(summary.serialize.p50),
+            formatMs(summary.network.p50),
+            summary.server.count > 0 ? formatMs(summary.server.p50) : QStringLiteral("-"),
+            formatMs(summary.total.p50),
+            formatMs(summary.total.p90),
+            formatMs(summary.total.p99),
+            formatMs(summary.total.max),
+            QString::number(summary.requestBytes),
+            QString::number(summary.replyBytes),
+        };
+        for (int column = 0; column < values.size(); ++column) {
+            auto* item = m_table->item(row, column);
+            if (!item) {
+                item = new QTableWidgetItem();
+                m_table->setItem(row, column, item);
+            }
+            item->setText(values[column]);
+        }
+    }
+}
+
+void RpcStatsPanel::exportCsv() {
+    const QString filePath = QFileDialog::getSaveFileName(this, tr("Export RPC timings"), QStringLiteral("rpc_timings.csv"),
+        tr("CSV (*.csv)"));
+    if (!filePath.isEmpty()) {
+        writeFile(filePath, m_stats->toCsv().toUtf8());
+    }
+}
+
+void RpcStatsPanel::exportJson() {
+    const QString filePath = QFileDialog::getSaveFileName(this, tr("Export RPC timings"), QStringLiteral("rpc_timings.json"),
+        tr("JSON (*.json)"));
+    if (!filePath.isEmpty()) {
+        writeFile(filePath, m_stats->toJson());
+    }
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <QWidget>
+
+class QTableWidget;
+class QTimer;
+class RpcStats;
+
+class RpcStatsPanel : public QWidget {
+    Q_OBJECT
+public:
+    explicit RpcStatsPanel(RpcStats* stats, QWidget* parent = nullptr);
+
+public slots:
+    void refresh();
+
+private slots:
+    void exportCsv();
+    void exportJson();
+
+private:
+    RpcStats* m_stats{};
+    QTableWidget* m_table{};
+    QTimer* m_refreshTimer{};
+};
@@ -0,0 +1,156 @@
+#include "ShapeTreeModel.h"
+
+#include "scene/ShapeStore.h"
+
+namespace {
+    constexpr int FETCH_CHUNK = 2000;
+    // internalId of the scene node and of its shape rows.
+    constexpr quintptr SCENE_NODE = 1;
+    constexpr quintptr SHAPE_NODE = 2;
+}
+
+ShapeTreeModel::ShapeTreeModel(ShapeStore* store, QObject* parent)
+    : QAbstractItemModel(parent)
+    , m_store(store) {
+    m_fetched = qMin(m_store->announcedSize(), FETCH_CHUNK);
+    connect(m_store, &ShapeStore::rowsAppended, this, &ShapeTreeModel::onRowsAppended);
+    connect(m_store, &ShapeStore::rowsAboutToBeRemoved, this, &ShapeTreeModel::onRowsAboutToBeRemoved);
+    connect(m_store, &ShapeStore::rowsRemoved, this, &ShapeTreeModel::onRowsRemoved);
+    connect(m_store, &ShapeStore::aboutToReset, this, &ShapeTreeModel::beginResetModel);
+    connect(m_store, &ShapeStore::reset, this, &ShapeTreeModel::onReset);
+}
+
+QModelIndex ShapeTreeModel::sceneIndex() const {
+    return createIndex(0, 0, SCENE_NODE);
+}
+
+QModelIndex ShapeTreeModel::indexForId(const QString& id) {
+    const int row = m_store->rowOf(id);
+    if (row < 0 || row >= m_store->announcedSize()) {
+        return {};
+    }
+    ensureFetched(row);
+    return createIndex(row, 0, SHAPE_NODE);
+}
+
+void ShapeTreeModel::ensureFetched(int row) {
+    if (row >= m_fetched) {
+        fetchTo(row + 1);
+    }
+}
+
+bool ShapeTreeModel::isShape(const QModelIndex& index) const {
+    return index.isValid() && index.internalId() == SHAPE_NODE;
+}
+
+QModelIndex ShapeTreeModel::index(int row, int column, const QModelIndex& parent) const {
+    if (column != 0 || row < 0) {
+        return {};
+    }
+    if (!parent.isValid()) {
+        return row == 0 ? sceneIndex() : QModelIndex();
+    }
+    if (parent.internalId() == SCENE_NODE && row < m_fetched) {
+        return createIndex(row, 0, SHAPE_NODE);
+    }
+    return {};
+}
+
+QModelIndex ShapeTreeModel::parent(const QModelIndex& child) const {
+    return isShape(child) ? sceneIndex() : QModelIndex();
+}
+
+int ShapeTreeModel::rowCount(const QModelIndex& parent) const {
+    if (!parent.isValid()) {
+        return 1;
+    }
+    return parent.internalId() == SCENE_NODE ? m_fetched : 0;
+}
+
+int ShapeTreeModel::columnCount(const QModelIndex& parent) const {
+    Q_UNUSED(parent);
+    return 1;
+}
+
+bool ShapeTreeModel::hasChildren(const QModelIndex& parent) const {
+    if (!parent.isValid()) {
+        return true;
+    }
+    return parent.internalId() == SCENE_NODE && m_store->announcedSize() > 0;
+}
+
+bool ShapeTreeModel::canFetchMore(const QModelIndex& parent) const {
+    return parent.isValid() && parent.internalId() == SCENE_NODE && m_fetched < m_store->announcedSize();
+}
+
+void ShapeTreeModel::fetchMore(const QModelIndex& parent) {
+    if (canFetchMore(parent)) {
+        fetchTo(qMin(m_store->announcedSize(), m_fetched + FETCH_CHUNK));
+    }
+}
+
+void ShapeTreeModel::fetchTo(int rows) {
+    rows = qMin(rows, m_store->announcedSize());
+    if (rows <= m_fetched) {
+        return;
+    }
+    beginInsertRows(sceneIndex(), m_fetched, rows - 1);
+    m_fetched = rows;
+    endInsertRows();
+}
+
+QVariant ShapeTreeModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid()) {
+        return {};
+    }
+    if (index.internalId() == SCENE_NODE) {
+        return role == Qt::DisplayRole ? QVariant(QStringLiteral("SCENE")) : QVariant();
+    }
+    switch (role) {
+    case Qt::DisplayRole:
+    case IdRole:
+        return m_store->id(index.row());
+    case Qt::ToolTipRole:
+    case TypeRole:
+        return m_store->type(index.row());
+    default:
+        return {};
+    }
+}
+
+QVariant ShapeTreeModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (section == 0 && orientation == Qt::Horizontal && role == Qt::DisplayRole) {
+        return QStringLiteral("Objects");
+    }
+    return {};
+}
+
+void ShapeTreeModel::onRowsAppended(int first, int last) {
+    // Only follow the store while the view has everything; otherwise fetchMore picks the rows up.
+    if (first == m_fetched) {
+        fetchTo(qMin(last + 1, first + FETCH_CHUNK));
+    }
+}
+
+void ShapeTreeModel::onRowsAboutToBeRemoved(int first, int last) {
+    if (first >= m_fetched) {
+        return;
+    }
+    last = qMin(last, m_fetched - 1);
+    beginRemoveRows(sceneIndex(), first, last);
+    m_removing = last - first + 1;
+}
+
+void ShapeTreeModel::onRowsRemoved() {
+    if (m_removing == 0) {
+        return;
+    }
+    m_fetched -= m_removing;
+    m_removing = 0;
+    endRemoveRows();
+}
+
+void ShapeTreeModel::onReset() {
+    m_fetched = qMin(m_store->announcedSize(), FETCH_CHUNK);
+    endResetModel();
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <QAbstractItemModel>
+
+class ShapeStore;
+
+// Project tree over a ShapeStore: one "SCENE" node whose children are the shapes. Children
+// are handed to the view in chunks through fetchMore, so a freshly loaded layout of 100k
+// shapes costs one chunk of rows until the user scrolls, and store batches arrive as one
+// insert or remove per range.
+class ShapeTreeModel : public QAbstractItemModel {
+    Q_OBJECT
+public:
+    static constexpr int IdRole = Qt::UserRole;
+    static constexpr int TypeRole = Qt::UserRole + 1;
+
+    explicit ShapeTreeModel(ShapeStore* store, QObject* parent = nullptr);
+
+    QModelIndex sceneIndex() const;
+    // Fetches up to the shape's row first if the view has not reached it yet.
+    QModelIndex indexForId(const QString& id);
+    // Hands the view every shape row up to and including row, e.g. before selecting a range.
+    void ensureFetched(int row);
+    bool isShape(const QModelIndex& index) const;
+
+    QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex& child) const override;
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    bool hasChildren(const QModelIndex& parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    void fetchTo(int rows);
+    void onRowsAppended(int first, int last);
+    void onRowsAboutToBeRemoved(int first, int last);
+    void onRowsRemoved();
+    void onReset();
+
+    ShapeStore* m_store;
+    // Shape rows the view has been given; the rest wait for fetchMore.
+    int m_fetched{ 0 };
+    int m_removing{ 0 };
+};
@@ -0,0 +1,330 @@
+#include "ToolpathOverlay.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <QElapsedTimer>
+#include <QPainter>
+#include <QThread>
+#include <QtMath>
+
+namespace {
+    constexpr int TILE_PX = 256;
+    // Zoom levels are half powers of two, so a cached tile is never scaled by more than ~1.19x.
+    constexpr double LEVELS_PER_OCTAVE = 2.0;
+    constexpr int TILE_CACHE_KB = 64 * 1024;
+    const QColor LASER_ON_COLOR(220, 40, 40);
+    const QColor JUMP_COLOR(40, 140, 220, 140);
+
+    // Collapses consecutive samples that fall into the same pixel column into one vertical
+    // min/max span, keeping the line that leaves the column, so output size tracks the tile
+    // width rather than the sample count.
+    class ColumnDecimator {
+    public:
+        ColumnDecimator(QVector<QLineF>& onLines, QVector<QLineF>& jumpLines)
+            : m_onLines(onLines)
+            , m_jumpLines(jumpLines) {
+        }
+
+        void add(double px, double py, bool laserOn) {
+            const qint64 column = static_cast<qint64>(std::floor(px));
+            if (m_hasRun && column == m_column && laserOn == m_runOn) {
+                m_minY = qMin(m_minY, py);
+                m_maxY = qMax(m_maxY, py);
+                m_lastX = px;
+                m_lastY = py;
+                return;
+            }
+            if (m_hasRun) {
+                flushSpan();
+                (laserOn ? m_onLines : m_jumpLines).append(QLineF(m_lastX, m_lastY, px, py));
+            }
+            m_hasRun = true;
+            m_column = column;
+            m_runOn = laserOn;
+            m_minY = m_maxY = m_lastY = py;
+            m_lastX = px;
+        }
+
+        void finish() {
+            if (m_hasRun) {
+                flushSpan();
+            }
+            m_hasRun = false;
+        }
+
+    private:
+        void flushSpan() {
+            if (m_maxY > m_minY) {
+                (m_runOn ? m_onLines : m_jumpLines).append(QLineF(m_column + 0.5, m_minY, m_column + 0.5, m_maxY));
+            }
+        }
+
+        QVector<QLineF>& m_onLines;
+        QVector<QLineF>& m_jumpLines;
+        bool m_hasRun{ false };
+        bool m_runOn{ false };
+        qint64 m_column{ 0 };
+        double m_minY{ 0.0 };
+        double m_maxY{ 0.0 };
+        double m_lastX{ 0.0 };
+        double m_lastY{ 0.0 };
+    };
+}
+
+bool ToolpathOverlay::TileKey::operator==(const TileKey& other) const {
+    return level == other.level && tx == other.tx && ty == other.ty;
+}
+
+size_t qHash(const ToolpathOverlay::TileKey& key, size_t seed) {
+    return qHashMulti(seed, key.level, key.tx, key.ty);
+}
+
+ToolpathOverlay::ToolpathOverlay(QObject* parent)
+    : QObject(parent) {
+    // Leave a core for the GUI thread.
+    m_pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 1));
+    m_tiles.setMaxCost(TILE_CACHE_KB);
+}
+
+ToolpathOverlay::~ToolpathOverlay() {
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+void ToolpathOverlay::setEnabled(bool enabled) {
+    if (m_enabled == enabled) {
+        return;
+    }
+    m_enabled = enabled;
+    emit changed();
+}
+
+bool ToolpathOverlay::isEnabled() const {
+    return m_enabled;
+}
+
+void ToolpathOverlay::setShapePath(const QString& id, Generator generator) {
+    const quint64 serial = m_nextSerial++;
+    m_pathSerials.insert(id, serial);
+    m_pool.start([this, id, serial, generator = std::move(generator)]() {
+        QElapsedTimer timer;
+        timer.start();
+        ToolpathRecorder recorder;
+        generator(recorder);
+        std::shared_ptr<const ToolpathSamples> samples = recorder.take();
+        const double elapsedMs = timer.nsecsElapsed() / 1e6;
+        QMetaObject::invokeMethod(this, [this, id, serial, samples, elapsedMs]() {
+            onPathGenerated(id, serial, samples, elapsedMs);
+            }, Qt::QueuedConnection);
+        });
+}
+
+bool ToolpathOverlay::translateShape(const QString& id, const QPointF& delta) {
+    const auto path = m_paths.value(id);
+    if (!path || m_shownSerials.value(id) != m_pathSerials.value(id)) {
+        return false;
+    }
+    const quint64 serial = m_nextSerial++;
+    m_pathSerials.insert(id, serial);
+    m_pool.start([this, id, serial, path, delta]() {
+        QElapsedTimer timer;
+        timer.start();
+        auto moved = std::make_shared<ToolpathSamples>(*path);
+        const float dx = static_cast<float>(delta.x());
+        const float dy = static_cast<float>(delta.y());
+        for (float& x : moved->x) {
+            x += dx;
+        }
+        for (float& y : moved->y) {
+            y += dy;
+        }
+        for (auto& chunk : moved->chunks) {
+            chunk.bounds.translate(delta);
+        }
+        moved->bounds.translate(delta);
+        std::shared_ptr<const ToolpathSamples> samples = std::move(moved);
+        const double elapsedMs = timer.nsecsElapsed() / 1e6;
+        QMetaObject::invokeMethod(this, [this, id, serial, samples, elapsedMs]() {
+            onPathGenerated(id, serial, samples, elapsedMs);
+            }, Qt::QueuedConnection);
+        });
+    return true;
+}
+
+void ToolpathOverlay::removeShape(const QString& id) {
+    m_pathSerials.remove(id);
+    m_shownSerials.remove(id);
+    const auto old = m_paths.take(id);
+    if (old) {
+        invalidate(old->bounds);
+        emit changed();
+    }
+}
+
+void ToolpathOverlay::clear() {
+    m_pool.clear();
+    m_pathSerials.clear();
+    m_shownSerials.clear();
+    m_paths.clear();
+    m_tiles.clear();
+    m_pendingTiles.clear();
+    emit changed();
+}
+
+qint64 ToolpathOverlay::sampleCount() const {
+    qint64 total = 0;
+    for (const auto& path : m_paths) {
+        total += path->size();
+    }
+    return total;
+}
+
+void ToolpathOverlay::onPathGenerated(const QString& id, quint64 serial, std::shared_ptr<const ToolpathSamples> samples,
+    double elapsedMs) {
+    // A newer request for the same shape (or its removal) supersedes this result.
+    if (m_pathSerials.value(id) != serial) {
+        return;
+    }
+    QRectF dirty = samples->bounds;
+    if (const auto old = m_paths.value(id)) {
+        dirty = dirty.united(old->bounds);
+    }
+    m_paths.insert(id, samples);
+    m_shownSerials.insert(id, serial);
+    invalidate(dirty);
+    emit pathReady(id, samples->size(), elapsedMs);
+    emit changed();
+}
+
+double ToolpathOverlay::levelScale(int level) {
+    return std::pow(2.0, level / LEVELS_PER_OCTAVE);
+}
+
+QRectF ToolpathOverlay::tileRect(const TileKey& key) {
+    const double size = TILE_PX / levelScale(key.level);
+    return QRectF(key.tx * size, key.ty * size, size, size);
+}
+
+void ToolpathOverlay::invalidate(const QRectF& sceneRect) {
+    if (sceneRect.isEmpty()) {
+        return;
+    }
+    const auto cached = m_tiles.keys();
+    for (const auto& key : cached) {
+        if (tileRect(key).intersects(sceneRect)) {
+            m_tiles.remove(key);
+        }
+    }
+    // In-flight renders of these tiles are stale; dropping the entry makes their result ignored.
+    for (auto it = m_pendingTiles.begin(); it != m_pendingTiles.end();) {
+        if (tileRect(it.key()).intersects(sceneRect)) {
+            it = m_pendingTiles.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+void ToolpathOverlay::paint(QPainter* painter, const QRectF& exposed, const QTransform& viewportTransform) {
+    if (!m_enabled || m_paths.isEmpty()) {
+        return;
+    }
+    const double scale = qMax(qAbs(viewportTransform.m11()), 1e-9);
+    const int level = qRound(std::log2(scale) * LEVELS_PER_OCTAVE);
+    const double tileSize = TILE_PX / levelScale(level);
+    const int left = static_cast<int>(std::floor(exposed.left() / tileSize));
+    const int right = static_cast<int>(std::floor(exposed.right() / tileSize));
+    const int top = static_cast<int>(std::floor(exposed.top() / tileSize));
+    const int bottom = static_cast<int>(std::floor(exposed.bottom() / tileSize));
+
+    painter->save();
+    painter->setWorldTransform(viewportTransform);
+    painter->setRenderHint(QPainter::SmoothPixmapTransform, true);
+    for (int ty = top; ty <= bottom; ++ty) {
+        for (int tx = left; tx <= right; ++tx) {
+            const TileKey key{ level, tx, ty };
+            if (const QImage* image = m_tiles.object(key)) {
+                if (!image->isNull()) {
+                    painter->drawImage(tileRect(key), *image);
+                }
+            }
+            else {
+                requestTile(key);
+            }
+        }
+    }
+    painter->restore();
+}
+
+void ToolpathOverlay::requestTile(const TileKey& key) {
+    if (m_pendingTiles.contains(key)) {
+        return;
+    }
+    const QRectF rect = tileRect(key);
+    PathList paths;
+    for (const auto& path : m_paths) {
+        if (path->bounds.intersects(rect)) {
+            paths.push_back(path);
+        }
+    }
+    if (paths.empty()) {
+        // Remember empty tiles too, so they are not looked at again until something changes.
+        m_tiles.insert(key, new QImage(), 1);
+        return;
+    }
+    const quint64 serial = m_nextSerial++;
+    m_pendingTiles.insert(key, serial);
+    m_pool.start([this, key, serial, paths = std::move(paths)]() {
+        const QImage image = renderTile(key, paths);
+        QMetaObject::invokeMethod(this, [this, key, serial, image]() {
+            onTileRendered(key, serial, image);
+            }, Qt::QueuedConnection);
+        });
+}
+
+void ToolpathOverlay::onTileRendered(const TileKey& key, quint64 serial, const QImage& image) {
+    const auto it = m_pendingTiles.constFind(key);
+    if (it == m_pendingTiles.constEnd() || it.value() != serial) {
+        return;
+    }
+    m_pendingTiles.erase(it);
+    m_tiles.insert(key, new QImage(image), qMax<qsizetype>(1, image.sizeInBytes() / 1024));
+    emit changed();
+}
+
+QImage ToolpathOverlay::renderTile(const TileKey& key, const PathList& paths) {
+    const QRectF rect = tileRect(key);
+    const double scale = levelScale(key.level);
+    // One pixel of margin so lines crossing the tile edge are drawn on both sides.
+    const QRectF cull = rect.adjusted(-1.0 / scale, -1.0 / scale, 1.0 / scale, 1.0 / scale);
+
+    QVector<QLineF> onLines;
+    QVector<QLineF> jumpLines;
+    ColumnDecimator decimator(onLines, jumpLines);
+    for (const auto& path : paths) {
+        for (const auto& chunk : path->chunks) {
+            if (!chunk.bounds.intersects(cull)) {
+                decimator.finish();
+                continue;
+            }
+            for (int i = chunk.begin; i < chunk.end; ++i) {
+                decimator.add((path->x[i] - rect.left()) * scale, (path->y[i] - rect.top()) * scale,
+                    path->laserOn[i] != 0);
+            }
+        }
+        decimator.finish();
+    }
+
+    QImage image(TILE_PX, TILE_PX, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing, true);
+    painter.setClipRect(QRect(0, 0, TILE_PX, TILE_PX));
+    painter.setPen(QPen(JUMP_COLOR, 1.0));
+    painter.drawLines(jumpLines);
+    painter.setPen(QPen(LASER_ON_COLOR, 1.0));
+    painter.drawLines(onLines);
+    return image;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+
+#include <QCache>
+#include <QHash>
+#include <QImage>
+#include <QObject>
+#include <QRectF>
+#include <QThreadPool>
+#include <QTransform>
+
+#include "Processing/ToolpathRecorder.h"
+
+class QPainter;
+class SampleSink;
+
+// Draws the samples the generator actually produces (laser on, jumps) on top of the drawn
+// shapes. Paths are generated per shape on a private thread pool and rasterised into 256 px
+// tiles with per-pixel-column min/max decimation, so millions of samples never reach
+// QPainter and the GUI thread only blits cached tiles. Changing one shape re-renders only
+// the tiles its old and new bounds touch.
+class ToolpathOverlay : public QObject {
+    Q_OBJECT
+public:
+    using Generator = std::function<void(SampleSink&)>;
+
+    explicit ToolpathOverlay(QObject* parent = nullptr);
+    ~ToolpathOverlay() override;
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const;
+
+    // Replaces the path of one shape; the generator runs on the overlay's thread pool.
+    void setShapePath(const QString& id, Generator generator);
+    // Moves the shown path of a shape by delta instead of generating it again. Returns false,
+    // and does nothing, when the shape has no path yet or a newer one is still being generated.
+    bool translateShape(const QString& id, const QPointF& delta);
+    void removeShape(const QString& id);
+    void clear();
+    qint64 sampleCount() const;
+
+    // Blits cached tiles covering the exposed scene rect and queues the missing ones.
+    void paint(QPainter* painter, const QRectF& exposed, const QTransform& viewportTransform);
+
+signals:
+    void changed();
+    void pathReady(const QString& id, int samples, double elapsedMs);
+
+private:
+    struct TileKey {
+        int level;
+        int tx;
+        int ty;
+        bool operator==(const TileKey& other) const;
+    };
+    friend size_t qHash(const TileKey& key, size_t seed);
+
+    using PathList = std::vector<std::shared_ptr<const ToolpathSamples>>;
+
+    static double levelScale(int level);
+    static QRectF tileRect(const TileKey& key);
+    static QImage renderTile(const TileKey& key, const PathList& paths);
+
+    void requestTile(const TileKey& key);
+    void onTileRendered(const TileKey& key, quint64 serial, const QImage& image);
+    void onPathGenerated(const QString& id, quint64 serial, std::shared_ptr<const ToolpathSamples> samples, double elapsedMs);
+    void invalidate(const QRectF& sceneRect);
+
+    QThreadPool m_pool;
+    bool m_enabled{ false };
+    QHash<QString, std::shared_ptr<const ToolpathSamples>> m_paths;
+    QHash<QString, quint64> m_pathSerials;
+    // Serial of the path in m_paths, to tell whether it is still the latest one requested.
+    QHash<QString, quint64> m_shownSerials;
+    QCache<TileKey, QImage> m_tiles;
+    QHash<TileKey, quint64> m_pendingTiles;
+    quint64 m_nextSerial{ 1 };
+};
@@ -0,0 +1,21 @@
+#include <QtTest>
+
+#include "grpc/FleetBenchmark.h"
+
+// Jobs dispatched across local ControllerSimulators through a real FleetDispatcher.
+class TestFleetDispatcher : public QObject {
+    Q_OBJECT
+private slots:
+    void dispatchesAcrossSimulators();
+};
+
+void TestFleetDispatcher::dispatchesAcrossSimulators() {
+    const auto result = FleetBenchmark::run(3, 12, 2);
+    QVERIFY2(result.error.isEmpty(), qPrintable(result.error));
+    QVERIFY(result.spread());
+    QVERIFY(result.allCompleted());
+    QVERIFY(result.framesMatch());
+}
+
+QTEST_GUILESS_MAIN(TestFleetDispatcher)
+#include "tst_fleetdispatcher.moc"
@@ -0,0 +1,100 @@
+#include <cstring>
+
+#include <QtTest>
+
+#include "Processing/JobCompiler.h"
+#include "Processing/JobCompilerBenchmark.h"
+
+namespace {
+    void addLine(SceneData& scene, double x, double y) {
+        auto* line = scene.add_shapes()->mutable_line();
+        line->set_speed(1000.0);
+        line->set_times(1);
+        line->set_x1(x);
+        line->set_y1(y);
+        line->set_z1(4.5);
+        line->set_x2(x + 2.0);
+        line->set_y2(y + 1.0);
+        line->set_z2(4.5);
+    }
+
+    bool sameRecords(const std::vector<jobfile::FrameRecord>& a, const std::vector<jobfile::FrameRecord>& b) {
+        return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(jobfile::FrameRecord)) == 0;
+    }
+}
+
+class TestJobCompiler : public QObject {
+    Q_OBJECT
+private slots:
+    void unchangedShapesComeFromTheCache();
+    void outputDoesNotDependOnThreads();
+    void unsupportedShapesAreSkipped();
+    void cacheHoldsOnlyTheLastScene();
+    void incrementalPassesMatchFreshCompiles();
+};
+
+void TestJobCompiler::unchangedShapesComeFromTheCache() {
+    SceneData scene;
+    for (int i = 0; i < 20; ++i) {
+        addLine(scene, -10.0 + i, -5.0);
+    }
+    JobCompiler compiler;
+    const auto first = compiler.compile(scene);
+    QCOMPARE(first.compiled, 20);
+    QVERIFY(first.records > 0);
+
+    const auto second = compiler.compile(scene);
+    QCOMPARE(second.compiled, 0);
+    QCOMPARE(second.reoffset, 0);
+    QCOMPARE(second.cached, 20);
+    QVERIFY(sameRecords(first.merged(), second.merged()));
+}
+
+void TestJobCompiler::outputDoesNotDependOnThreads() {
+    SceneData scene;
+    for (int i = 0; i < 200; ++i) {
+        addLine(scene, -10.0 + i * 0.1, -10.0 + i * 0.05);
+    }
+    JobCompiler single;
+    JobCompiler parallel;
+    QVERIFY(sameRecords(single.compile(scene, 1).merged(), parallel.compile(scene, 4).merged()));
+}
+
+void TestJobCompiler::unsupportedShapesAreSkipped() {
+    SceneData scene;
+    addLine(scene, 0.0, 0.0);
+    scene.add_shapes()->mutable_ellipse()->set_a_max(4.0);
+    JobCompiler compiler;
+    const auto result = compiler.compile(scene);
+    QCOMPARE(result.skipped, 1);
+    QVERIFY(!result.shapes[1]->skipReason.isEmpty());
+    QVERIFY(result.shapes[1]->records.empty());
+    QVERIFY(result.shapes[0]->skipReason.isEmpty());
+}
+
+void TestJobCompiler::cacheHoldsOnlyTheLastScene() {
+    SceneData scene;
+    for (int i = 0; i < 10; ++i) {
+        addLine(scene, 0.0, 0.0);
+        scene.mutable_shapes(i)->mutable_line()->set_speed(100.0 + i);
+    }
+    JobCompiler compiler;
+    compiler.compile(scene);
+    QCOMPARE(compiler.cacheSize(), 10);
+    scene.mutable_shapes()->DeleteSubrange(3, 7);
+    compiler.compile(scene);
+    QCOMPARE(compiler.cacheSize(), 3);
+    compiler.clearCache();
+    QCOMPARE(compiler.cacheSize(), 0);
+}
+
+void TestJobCompiler::incrementalPassesMatchFreshCompiles() {
+    const auto result = JobCompilerBenchmark::run(300);
+    QVERIFY2(result.failures.isEmpty(), qPrintable(result.failures.join(QStringLiteral("; "))));
+    QCOMPARE(result.moved, 3);
+    QCOMPARE(result.moveGenerated + result.moveReoffset, result.moved);
+    QCOMPARE(result.editGenerated, 1);
+}
+
+QTEST_GUILESS_MAIN(TestJobCompiler)
+#include "tst_jobcompiler.moc"
@@ -0,0 +1,56 @@
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include "Processing/JobFile.h"
+#include "Processing/JobFileBenchmark.h"
+
+class TestJobFile : public QObject {
+    Q_OBJECT
+private slots:
+    void roundTripsEveryField();
+    void rejectsOtherFiles();
+    void rejectsTruncatedFiles();
+};
+
+void TestJobFile::roundTripsEveryField() {
+    const auto result = JobFileBenchmark::run(4000, 1000);
+    QVERIFY2(result.error.isEmpty(), qPrintable(result.error));
+    QCOMPARE(result.mismatches, 0);
+    QVERIFY(result.settingsMatch);
+    QVERIFY(result.segmentsMatch);
+}
+
+void TestJobFile::rejectsOtherFiles() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("job.json"));
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("{\"shapes\": []}");
+    file.close();
+
+    QVERIFY(!JobFile::isJobFile(path));
+    QString error;
+    QVERIFY(!JobFile::open(path, error));
+    QVERIFY(!error.isEmpty());
+}
+
+void TestJobFile::rejectsTruncatedFiles() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("job.faxj"));
+    JobData job;
+    job.mutable_scene()->add_shapes()->mutable_line()->set_x2(10.0);
+    QString error;
+    QVERIFY2(JobFile::save(path, job, nullptr, 0, error), qPrintable(error));
+    QVERIFY(JobFile::open(path, error));
+
+    QFile file(path);
+    QVERIFY(file.resize(file.size() - 8));
+    QVERIFY(!JobFile::open(path, error));
+    QVERIFY(!error.isEmpty());
+}
+
+QTEST_GUILESS_MAIN(TestJobFile)
+#include "tst_jobfile.moc"
@@ -0,0 +1,68 @@
+#include <QtTest>
+
+#include "view/LogModel.h"
+
+namespace {
+    QString message(const LogModel& model, int row) {
+        return model.data(model.index(row, LogModel::MessageColumn)).toString();
+    }
+
+    void appendNumbered(LogModel& model, int from, int to) {
+        for (int i = from; i < to; ++i) {
+            model.append(QString::number(i));
+        }
+    }
+}
+
+class TestLogModel : public QObject {
+    Q_OBJECT
+private slots:
+    void appendWaitsForTheEventLoop();
+    void ringEvictsTheOldest();
+    void onePassKeepsOnlyTheNewest();
+    void severityIsExposed();
+};
+
+void TestLogModel::appendWaitsForTheEventLoop() {
+    LogModel model(10);
+    appendNumbered(model, 0, 3);
+    QCOMPARE(model.rowCount(), 0);
+    QTRY_COMPARE(model.rowCount(), 3);
+    QCOMPARE(message(model, 2), QStringLiteral("2"));
+}
+
+void TestLogModel::ringEvictsTheOldest() {
+    LogModel model(5);
+    appendNumbered(model, 0, 3);
+    model.flush();
+    appendNumbered(model, 3, 8);
+    model.flush();
+    QCOMPARE(model.rowCount(), 5);
+    QCOMPARE(model.dropped(), 3);
+    for (int row = 0; row < 5; ++row) {
+        QCOMPARE(message(model, row), QString::number(row + 3));
+    }
+}
+
+void TestLogModel::onePassKeepsOnlyTheNewest() {
+    LogModel model(4);
+    appendNumbered(model, 0, 10);
+    model.flush();
+    QCOMPARE(model.rowCount(), 4);
+    QCOMPARE(model.dropped(), 6);
+    QCOMPARE(message(model, 0), QStringLiteral("6"));
+    QCOMPARE(message(model, 3), QStringLiteral("9"));
+}
+
+void TestLogModel::severityIsExposed() {
+    LogModel model(4);
+    model.append(LogModel::Severity::Warning, QStringLiteral("careful"));
+    model.flush();
+    const QModelIndex index = model.index(0, LogModel::MessageColumn);
+    QCOMPARE(model.data(index, LogModel::SeverityRole).toInt(), static_cast<int>(LogModel::Severity::Warning));
+    QCOMPARE(model.data(model.index(0, LogModel::SeverityColumn)).toString(),
+        LogModel::severityName(LogModel::Severity::Warning));
+}
+
+QTEST_GUILESS_MAIN(TestLogModel)
+#include "tst_logmodel.moc"
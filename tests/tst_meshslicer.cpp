@@ -0,0 +1,27 @@
+#include <QtTest>
+
+#include "mesh/SliceBenchmark.h"
+
+// Slices solids whose cross-sections are known in closed form; SliceBenchmark holds the checks
+// so the Diagnostics menu can run them on the full-size sphere too.
+class TestMeshSlicer : public QObject {
+    Q_OBJECT
+private slots:
+    void analyticSolids();
+    void tessellatedSphere();
+};
+
+void TestMeshSlicer::analyticSolids() {
+    const QStringList failures = SliceBenchmark::verifyAnalyticSolids();
+    QVERIFY2(failures.isEmpty(), qPrintable(failures.join(QLatin1Char('\n'))));
+}
+
+void TestMeshSlicer::tessellatedSphere() {
+    const auto result = SliceBenchmark::run(20000, 100);
+    QVERIFY2(result.failures.isEmpty(), qPrintable(result.failures.join(QLatin1Char('\n'))));
+    QCOMPARE(result.layers, 100);
+    QVERIFY(result.segments > 0);
+}
+
+QTEST_GUILESS_MAIN(TestMeshSlicer)
+#include "tst_meshslicer.moc"
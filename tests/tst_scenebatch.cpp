@@ -0,0 +1,71 @@
+#include <memory>
+
+#include <QtTest>
+
+#include "grpc/SceneBatch.h"
+#include "grpc/SceneBatchBenchmark.h"
+#include "metrics/AllocationCounter.h"
+
+class TestSceneBatch : public QObject {
+    Q_OBJECT
+private slots:
+    void finalizeMarksOnlyTheLastShape();
+    void mergeCopiesIntoTheArena();
+    void countsOnlyThisThread();
+    void handsEveryShapeToTheWorker();
+};
+
+void TestSceneBatch::finalizeMarksOnlyTheLastShape() {
+    SceneBatch batch;
+    batch.addLine()->set_x2(1.0);
+    batch.addCircle()->set_angle(360.0);
+    batch.addRectangle()->set_x1(2.0);
+    batch.finalize();
+    QCOMPARE(batch.shapeCount(), 3);
+    QVERIFY(!batch.scene().shapes(0).line().islast());
+    QVERIFY(!batch.scene().shapes(1).circle().islast());
+    QVERIFY(batch.scene().shapes(2).rectangle().islast());
+}
+
+void TestSceneBatch::mergeCopiesIntoTheArena() {
+    SceneData scene;
+    scene.add_shapes()->mutable_ellipse()->set_a_max(4.0);
+    SceneBatch batch;
+    batch.mergeFrom(scene);
+    QCOMPARE(batch.shapeCount(), 1);
+    QCOMPARE(batch.scene().shapes(0).ellipse().a_max(), 4.0);
+    QVERIFY(batch.arenaBytesUsed() > 0);
+}
+
+void TestSceneBatch::countsOnlyThisThread() {
+    // Read everything before comparing; failure messages allocate too.
+    qint64 outer = 0;
+    qint64 outerBytes = 0;
+    qint64 inner = 0;
+    {
+        AllocationCounter counter;
+        auto line = std::make_unique<LineData>();
+        {
+            AllocationCounter nested;
+            auto circle = std::make_unique<CircleData>();
+            inner = nested.allocations();
+        }
+        outer = counter.allocations();
+        outerBytes = counter.bytes();
+    }
+    QCOMPARE(inner, 1);
+    QCOMPARE(outer, 1);
+    QVERIFY(outerBytes >= static_cast<qint64>(sizeof(LineData)));
+}
+
+void TestSceneBatch::handsEveryShapeToTheWorker() {
+    const auto result = SceneBatchBenchmark::run(2000);
+    QCOMPARE(result.heapReceived, result.shapes);
+    QCOMPARE(result.arenaReceived, result.shapes);
+    // Per shape: the message, its queued copy and the call event, against a handful of blocks.
+    QVERIFY(result.heapAllocations >= 2 * result.shapes);
+    QVERIFY(result.arenaAllocations < result.heapAllocations / 100);
+}
+
+QTEST_GUILESS_MAIN(TestSceneBatch)
+#include "tst_scenebatch.moc"
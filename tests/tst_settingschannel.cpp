@@ -0,0 +1,74 @@
+#include <QtTest>
+
+#include "grpc/SettingsChannel.h"
+#include "grpc/SettingsChannelBenchmark.h"
+
+namespace {
+    DelayData delay(int laserOn) {
+        DelayData request;
+        request.set_laser_on_delay(laserOn);
+        return request;
+    }
+
+    FreqData freq(int value) {
+        FreqData request;
+        request.set_freq(value);
+        return request;
+    }
+}
+
+class TestSettingsChannel : public QObject {
+    Q_OBJECT
+private slots:
+    void coalescesUntilSealed();
+    void sealingStartsANewBatch();
+    void takenBatchIsNotMergedInto();
+    void boundedThroughTheClient();
+};
+
+void TestSettingsChannel::coalescesUntilSealed() {
+    SettingsChannel channel;
+    QVERIFY(channel.offerDelay(delay(10)));
+    QVERIFY(!channel.offerDelay(delay(20)));
+    QVERIFY(!channel.offerFreq(freq(30)));
+    QVERIFY(!channel.offerFreq(freq(40)));
+    QCOMPARE(channel.pendingBatches(), 1);
+    QCOMPARE(channel.coalescedUpdates(), 2);
+
+    const auto batch = channel.takeBatch();
+    QVERIFY(batch.delay && batch.freq);
+    QCOMPARE(batch.delay->laser_on_delay(), 20);
+    QCOMPARE(batch.freq->freq(), 40);
+    QCOMPARE(channel.pendingBatches(), 0);
+}
+
+void TestSettingsChannel::sealingStartsANewBatch() {
+    SettingsChannel channel;
+    QVERIFY(channel.offerDelay(delay(1)));
+    channel.sealBatch();
+    QVERIFY(channel.offerDelay(delay(2)));
+    QCOMPARE(channel.pendingBatches(), 2);
+    QCOMPARE(channel.takeBatch().delay->laser_on_delay(), 1);
+    QCOMPARE(channel.takeBatch().delay->laser_on_delay(), 2);
+    QVERIFY(!channel.takeBatch().delay);
+}
+
+void TestSettingsChannel::takenBatchIsNotMergedInto() {
+    SettingsChannel channel;
+    QVERIFY(channel.offerFreq(freq(5)));
+    channel.takeBatch();
+    // The worker is applying the last batch; a new update needs a flush of its own.
+    QVERIFY(channel.offerFreq(freq(6)));
+    QCOMPARE(channel.takeBatch().freq->freq(), 6);
+}
+
+void TestSettingsChannel::boundedThroughTheClient() {
+    const auto result = SettingsChannelBenchmark::run(100, 20);
+    QVERIFY(result.drained);
+    QCOMPARE(result.violations, 0);
+    QCOMPARE(result.updates, 2000);
+    QVERIFY(result.coalesced > 0);
+}
+
+QTEST_GUILESS_MAIN(TestSettingsChannel)
+#include "tst_settingschannel.moc"
@@ -0,0 +1,173 @@
+#include <vector>
+
+#include <QtTest>
+
+#include "Processing/SampleSink.h"
+#include "Processing/ShapeGenerator.h"
+#include "Processing/ThreeAxisGenerator.h"
+
+namespace {
+    struct Record {
+        bool jump;
+        quint16 x;
+        quint16 y;
+        quint16 z;
+
+        bool operator==(const Record& other) const {
+            return jump == other.jump && x == other.x && y == other.y && z == other.z;
+        }
+    };
+
+    class RecordingSink : public SampleSink {
+    public:
+        void addProcessData(quint16 X, quint16 Y, quint16 Z, quint16, quint16) override {
+            records.push_back({ false, X, Y, Z });
+        }
+
+        void addProcessJumpData(quint16 X, quint16 Y, quint16 Z, quint16, quint16) override {
+            records.push_back({ true, X, Y, Z });
+        }
+
+        void addProcessBegin() override {
+            ++begins;
+        }
+
+        void addProcessEnd() override {
+            ++ends;
+        }
+
+        std::vector<Record> records;
+        int begins{ 0 };
+        int ends{ 0 };
+    };
+
+    CircleData fullCircle() {
+        CircleData circle;
+        circle.set_x1(10.0);
+        circle.set_y1(10.0);
+        circle.set_x2(15.0);
+        circle.set_y2(10.0);
+        circle.set_angle(360.0);
+        circle.set_z_start(1.0);
+        circle.set_z_end(1.0);
+        circle.set_speed(500.0);
+        circle.set_times(1);
+        return circle;
+    }
+
+    RectangleData flatRectangle() {
+        RectangleData rect;
+        rect.set_x0(0.0);
+        rect.set_y0(0.0);
+        rect.set_x1(20.0);
+        rect.set_y1(10.0);
+        rect.set_feedspacing_y(0.5);
+        rect.set_z_start(2.0);
+        rect.set_z_end(2.0);
+        rect.set_speed(800.0);
+        rect.set_times(1);
+        return rect;
+    }
+}
+
+class TestShapeGenerator : public QObject {
+    Q_OBJECT
+private slots:
+    void lineRejectsRotaryAxes();
+    void circleRules();
+    void rectangleRules();
+    void ellipseIsNeverLocal();
+    void unsupportedShapeWritesNothing();
+    void generateRepeatsEveryPass();
+};
+
+void TestShapeGenerator::lineRejectsRotaryAxes() {
+    LineData line;
+    line.set_x2(10.0);
+    QVERIFY(ShapeGenerator::unsupported(line).isEmpty());
+    line.set_b2(5.0);
+    QVERIFY(!ShapeGenerator::unsupported(line).isEmpty());
+}
+
+void TestShapeGenerator::circleRules() {
+    QVERIFY(ShapeGenerator::unsupported(fullCircle()).isEmpty());
+
+    CircleData arc = fullCircle();
+    arc.set_angle(180.0);
+    QVERIFY(!ShapeGenerator::unsupported(arc).isEmpty());
+
+    CircleData filled = fullCircle();
+    filled.set_filled(true);
+    QVERIFY(!ShapeGenerator::unsupported(filled).isEmpty());
+
+    CircleData layered = fullCircle();
+    layered.set_z_end(3.0);
+    QVERIFY(!ShapeGenerator::unsupported(layered).isEmpty());
+
+    CircleData repaired = fullCircle();
+    repaired.set_times_repair(1);
+    QVERIFY(!ShapeGenerator::unsupported(repaired).isEmpty());
+}
+
+void TestShapeGenerator::rectangleRules() {
+    QVERIFY(ShapeGenerator::unsupported(flatRectangle()).isEmpty());
+
+    // The X step the generator derives from the Y spacing is accepted, any other is not.
+    RectangleData derived = flatRectangle();
+    derived.set_feedspacing_x(1.0);
+    QVERIFY(ShapeGenerator::unsupported(derived).isEmpty());
+    RectangleData other = flatRectangle();
+    other.set_feedspacing_x(0.3);
+    QVERIFY(!ShapeGenerator::unsupported(other).isEmpty());
+
+    RectangleData noSpacing = flatRectangle();
+    noSpacing.set_feedspacing_y(0.0);
+    QVERIFY(!ShapeGenerator::unsupported(noSpacing).isEmpty());
+
+    RectangleData tapered = flatRectangle();
+    tapered.set_taper_a_max(2.0);
+    QVERIFY(!ShapeGenerator::unsupported(tapered).isEmpty());
+
+    RectangleData layered = flatRectangle();
+    layered.set_z_end(4.0);
+    QVERIFY(!ShapeGenerator::unsupported(layered).isEmpty());
+}
+
+void TestShapeGenerator::ellipseIsNeverLocal() {
+    EllipseData ellipse;
+    ellipse.set_a_max(5.0);
+    ellipse.set_b_max(3.0);
+    QVERIFY(!ShapeGenerator::unsupported(ellipse).isEmpty());
+    QVERIFY(!ShapeGenerator::unsupported(SceneShape()).isEmpty());
+}
+
+void TestShapeGenerator::unsupportedShapeWritesNothing() {
+    SceneShape shape;
+    *shape.mutable_circle() = fullCircle();
+    shape.mutable_circle()->set_angle(90.0);
+    RecordingSink sink;
+    QVERIFY(!ShapeGenerator::generate(sink, shape));
+    QVERIFY(sink.records.empty());
+    QCOMPARE(sink.begins, 0);
+}
+
+void TestShapeGenerator::generateRepeatsEveryPass() {
+    SceneShape shape;
+    *shape.mutable_rectangle() = flatRectangle();
+    shape.mutable_rectangle()->set_times(2);
+    RecordingSink generated;
+    QVERIFY(ShapeGenerator::generate(generated, shape));
+
+    const RectangleData& rect = shape.rectangle();
+    RecordingSink direct;
+    for (int pass = 0; pass < 2; ++pass) {
+        ThreeAxisGenerator::generateRectangle(direct, rect.x0(), rect.y0(), rect.z_start(), rect.x1(), rect.y1(),
+            rect.z_end(), rect.speed(), rect.feedspacing_y());
+    }
+    QVERIFY(!generated.records.empty());
+    QCOMPARE(generated.begins, direct.begins);
+    QVERIFY(generated.records == direct.records);
+}
+
+QTEST_GUILESS_MAIN(TestShapeGenerator)
+#include "tst_shapegenerator.moc"
@@ -0,0 +1,193 @@
+#include <algorithm>
+#include <cmath>
+
+#include <QtTest>
+
+#include "scene/RTree.h"
+#include "scene/ShapeIndex.h"
+#include "scene/ShapeStore.h"
+
+namespace {
+    // Above the index's rebuild threshold, so whole-store transforms re-pack the tree.
+    constexpr int SHAPES = 5000;
+    constexpr int QUERIES = 500;
+
+    QPointF randomPoint(QRandomGenerator& random) {
+        return QPointF(random.bounded(2000.0) - 1000.0, random.bounded(2000.0) - 1000.0);
+    }
+
+    void appendRandom(ShapeStore& store, QRandomGenerator& random, int first, int count) {
+        const ShapeStore::Batch batch(&store);
+        for (int i = first; i < first + count; ++i) {
+            const QPointF start = randomPoint(random);
+            const QPointF end = start + QPointF(2.0 + random.bounded(28.0), 2.0 + random.bounded(28.0));
+            const auto kind = i % 3 == 0 ? ShapeStore::Kind::Line : i % 3 == 1 ? ShapeStore::Kind::Rectangle : ShapeStore::Kind::Ellipse;
+            store.append(QStringLiteral("shape%1").arg(i), kind, start, end);
+        }
+    }
+
+    bool boundsIntersect(const QRectF& a, const QRectF& b) {
+        return a.left() <= b.right() && b.left() <= a.right() && a.top() <= b.bottom() && b.top() <= a.bottom();
+    }
+
+    QStringList bruteIntersecting(const ShapeStore& store, const QRectF& rect) {
+        QStringList ids;
+        for (int row = 0; row < store.size(); ++row) {
+            if (boundsIntersect(store.bounds(row), rect)) {
+                ids.append(store.id(row));
+            }
+        }
+        ids.sort();
+        return ids;
+    }
+
+    // The pick rules written out over every row, topmost first.
+    QString brutePick(const ShapeStore& store, const QPointF& pos, double tolerance) {
+        for (int row = store.size() - 1; row >= 0; --row) {
+            const QRectF bounds = store.bounds(row);
+            bool hit = false;
+            if (store.kind(row) == ShapeStore::Kind::Line) {
+                const QPointF a = store.p1(row);
+                const QPointF ab = store.p2(row) - a;
+                const double t = std::clamp(QPointF::dotProduct(pos - a, ab) / QPointF::dotProduct(ab, ab), 0.0, 1.0);
+                const QPointF d = pos - (a + ab * t);
+                hit = std::hypot(d.x(), d.y()) <= tolerance;
+            }
+            else if (store.kind(row) == ShapeStore::Kind::Ellipse) {
+                const double dx = (pos.x() - bounds.center().x()) / (bounds.width() / 2.0 + tolerance);
+                const double dy = (pos.y() - bounds.center().y()) / (bounds.height() / 2.0 + tolerance);
+                hit = dx * dx + dy * dy <= 1.0;
+            }
+            else {
+                hit = boundsIntersect(bounds, QRectF(pos - QPointF(tolerance, tolerance), pos + QPointF(tolerance, tolerance)));
+            }
+            if (hit) {
+                return store.id(row);
+            }
+        }
+        return QString();
+    }
+}
+
+class TestShapeIndex : public QObject {
+    Q_OBJECT
+private slots:
+    void rtreeQueriesMatchBruteForce();
+    void intersectingMatchesBruteForce();
+    void pickReturnsTheTopmostHit();
+    void followsStoreChanges();
+
+private:
+    void compareWithBruteForce(const ShapeStore& store, const ShapeIndex& index, quint32 seed);
+};
+
+void TestShapeIndex::compareWithBruteForce(const ShapeStore& store, const ShapeIndex& index, quint32 seed) {
+    QCOMPARE(index.size(), static_cast<qint64>(store.size()));
+    QRandomGenerator random(seed);
+    for (int i = 0; i < QUERIES; ++i) {
+        const QRectF band(randomPoint(random), QSizeF(random.bounded(100.0), random.bounded(100.0)));
+        QStringList ids = index.intersecting(band);
+        ids.sort();
+        QCOMPARE(ids, bruteIntersecting(store, band));
+
+        const QPointF point = randomPoint(random);
+        QCOMPARE(index.pick(point, 1.0), brutePick(store, point, 1.0));
+    }
+}
+
+void TestShapeIndex::rtreeQueriesMatchBruteForce() {
+    std::vector<RTree::Entry> entries;
+    QRandomGenerator random(3);
+    for (quint32 key = 0; key < 2000; ++key) {
+        const QPointF start = randomPoint(random);
+        entries.push_back({ key, { start.x(), start.y(), start.x() + random.bounded(30.0), start.y() + random.bounded(30.0) } });
+    }
+    // Half packed, half inserted one by one, then every third entry removed again.
+    RTree tree;
+    tree.bulkLoad(std::vector<RTree::Entry>(entries.begin(), entries.begin() + 1000));
+    for (auto it = entries.begin() + 1000; it != entries.end(); ++it) {
+        tree.insert(it->key, it->box);
+    }
+    std::vector<RTree::Entry> kept;
+    for (const RTree::Entry& entry : entries) {
+        if (entry.key % 3 == 0) {
+            QVERIFY(tree.remove(entry.key, entry.box));
+        }
+        else {
+            kept.push_back(entry);
+        }
+    }
+    QVERIFY(!tree.remove(0, entries[0].box));
+    QCOMPARE(tree.size(), static_cast<qint64>(kept.size()));
+
+    for (int i = 0; i < QUERIES; ++i) {
+        const QPointF corner = randomPoint(random);
+        const RTree::Box probe{ corner.x(), corner.y(), corner.x() + 100.0, corner.y() + 100.0 };
+        std::vector<quint32> found;
+        tree.query(probe, [&](quint32 key, const RTree::Box&) {
+            found.push_back(key);
+            return true;
+            });
+        std::vector<quint32> expected;
+        for (const RTree::Entry& entry : kept) {
+            if (entry.box.intersects(probe)) {
+                expected.push_back(entry.key);
+            }
+        }
+        std::sort(found.begin(), found.end());
+        QCOMPARE(found, expected);
+    }
+}
+
+void TestShapeIndex::intersectingMatchesBruteForce() {
+    ShapeStore store;
+    QRandomGenerator random(7);
+    appendRandom(store, random, 0, SHAPES);
+    const ShapeIndex index(&store);
+    compareWithBruteForce(store, index, 11);
+}
+
+void TestShapeIndex::pickReturnsTheTopmostHit() {
+    ShapeStore store;
+    store.append(QStringLiteral("below"), ShapeStore::Kind::Rectangle, QPointF(0.0, 0.0), QPointF(10.0, 10.0));
+    store.append(QStringLiteral("above"), ShapeStore::Kind::Ellipse, QPointF(0.0, 0.0), QPointF(10.0, 10.0));
+    store.append(QStringLiteral("line"), ShapeStore::Kind::Line, QPointF(20.0, 0.0), QPointF(30.0, 0.0));
+    const ShapeIndex index(&store);
+    QCOMPARE(index.pick(QPointF(5.0, 5.0), 0.5), QStringLiteral("above"));
+    // Inside the rectangle's corner but outside the ellipse.
+    QCOMPARE(index.pick(QPointF(0.5, 0.5), 0.5), QStringLiteral("below"));
+    QCOMPARE(index.pick(QPointF(25.0, 0.8), 1.0), QStringLiteral("line"));
+    QCOMPARE(index.pick(QPointF(25.0, 1.5), 1.0), QString());
+}
+
+void TestShapeIndex::followsStoreChanges() {
+    ShapeStore store;
+    QRandomGenerator random(5);
+    appendRandom(store, random, 0, SHAPES);
+    const ShapeIndex index(&store);
+
+    // Whole-store move: re-packed.
+    store.translate(0, store.size() - 1, 15.0, -15.0);
+    compareWithBruteForce(store, index, 21);
+
+    // A small scattered move and a few appends: entry by entry.
+    std::vector<int> rows;
+    for (int row = 0; row < store.size(); row += 97) {
+        rows.push_back(row);
+    }
+    store.translate(rows, -40.0, 25.0);
+    appendRandom(store, random, SHAPES, 20);
+    compareWithBruteForce(store, index, 22);
+
+    // Few enough separate ranges to be removed entry by entry rather than by a reset.
+    {
+        const ShapeStore::Batch batch(&store);
+        for (int i = 0; i < SHAPES; i += 499) {
+            store.remove(QStringLiteral("shape%1").arg(i));
+        }
+    }
+    compareWithBruteForce(store, index, 23);
+}
+
+QTEST_GUILESS_MAIN(TestShapeIndex)
+#include "tst_shapeindex.moc"
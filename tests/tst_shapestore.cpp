@@ -0,0 +1,110 @@
+#include <QtTest>
+
+#include "scene/ShapeStore.h"
+
+namespace {
+    QString shapeId(int i) {
+        return QStringLiteral("shape%1").arg(i);
+    }
+
+    void appendSquares(ShapeStore& store, int count) {
+        const ShapeStore::Batch batch(&store);
+        for (int i = 0; i < count; ++i) {
+            store.append(shapeId(i), ShapeStore::Kind::Rectangle, QPointF(i * 10.0, 0.0), QPointF(i * 10.0 + 5.0, 5.0));
+        }
+    }
+}
+
+class TestShapeStore : public QObject {
+    Q_OBJECT
+private slots:
+    void appendNormalizesAllButLines();
+    void translateAndScaleMoveSceneGeometry();
+    void batchAnnouncesOneRange();
+    void batchRemovalCompactsAndReindexes();
+    void subsetTranslateSignalsPerRun();
+};
+
+void TestShapeStore::appendNormalizesAllButLines() {
+    ShapeStore store;
+    store.append(QStringLiteral("line1"), ShapeStore::Kind::Line, QPointF(5.0, 5.0), QPointF(1.0, 2.0));
+    store.append(QStringLiteral("rectangle1"), ShapeStore::Kind::Rectangle, QPointF(5.0, 5.0), QPointF(1.0, 2.0));
+    store.append(QStringLiteral("line1"), ShapeStore::Kind::Line, QPointF(), QPointF());
+    QCOMPARE(store.size(), 2);
+    QCOMPARE(store.p1(0), QPointF(5.0, 5.0));
+    QCOMPARE(store.p1(1), QPointF(1.0, 2.0));
+    QCOMPARE(store.p2(1), QPointF(5.0, 5.0));
+    QCOMPARE(store.type(1), QStringLiteral("Rectangle"));
+}
+
+void TestShapeStore::translateAndScaleMoveSceneGeometry() {
+    ShapeStore store;
+    appendSquares(store, 3);
+    store.translate(1, 2, 1.0, -1.0);
+    QCOMPARE(store.bounds(0), QRectF(0.0, 0.0, 5.0, 5.0));
+    QCOMPARE(store.bounds(1), QRectF(11.0, -1.0, 5.0, 5.0));
+    QCOMPARE(store.translation(2), QPointF(1.0, -1.0));
+
+    store.scale(0, 2, 2.0, QPointF(0.0, 0.0));
+    QCOMPARE(store.bounds(1), QRectF(22.0, -2.0, 10.0, 10.0));
+    QCOMPARE(store.sceneBounds(), QRectF(QPointF(0.0, -2.0), QPointF(52.0, 10.0)));
+
+    // A mirroring factor is refused rather than breaking the normalized rects.
+    store.scale(0, 2, -1.0, QPointF(0.0, 0.0));
+    QCOMPARE(store.bounds(1), QRectF(22.0, -2.0, 10.0, 10.0));
+}
+
+void TestShapeStore::batchAnnouncesOneRange() {
+    ShapeStore store;
+    QSignalSpy appended(&store, &ShapeStore::rowsAppended);
+    {
+        const ShapeStore::Batch batch(&store);
+        for (int i = 0; i < 100; ++i) {
+            store.append(shapeId(i), ShapeStore::Kind::Line, QPointF(), QPointF(1.0, 1.0));
+        }
+        QCOMPARE(store.size(), 100);
+        QCOMPARE(store.announcedSize(), 0);
+        // Appended and removed inside the batch: never announced at all.
+        store.remove(shapeId(99));
+    }
+    QCOMPARE(appended.count(), 1);
+    QCOMPARE(appended.at(0).at(0).toInt(), 0);
+    QCOMPARE(appended.at(0).at(1).toInt(), 98);
+    QCOMPARE(store.announcedSize(), 99);
+}
+
+void TestShapeStore::batchRemovalCompactsAndReindexes() {
+    ShapeStore store;
+    appendSquares(store, 10);
+    QSignalSpy removed(&store, &ShapeStore::rowsRemoved);
+    {
+        const ShapeStore::Batch batch(&store);
+        store.remove(shapeId(2));
+        store.remove(shapeId(3));
+        store.remove(shapeId(7));
+        QCOMPARE(store.rowOf(shapeId(3)), -1);
+    }
+    QCOMPARE(removed.count(), 2);
+    QCOMPARE(store.size(), 7);
+    QCOMPARE(store.ids(), QStringList({ shapeId(0), shapeId(1), shapeId(4), shapeId(5), shapeId(6), shapeId(8), shapeId(9) }));
+    QCOMPARE(store.rowOf(shapeId(4)), 2);
+    QCOMPARE(store.rowOf(shapeId(9)), 6);
+    QCOMPARE(store.bounds(store.rowOf(shapeId(8))), QRectF(80.0, 0.0, 5.0, 5.0));
+}
+
+void TestShapeStore::subsetTranslateSignalsPerRun() {
+    ShapeStore store;
+    appendSquares(store, 10);
+    QSignalSpy changed(&store, &ShapeStore::geometryChanged);
+    store.translate(std::vector<int>{ 7, 1, 2, 3, 3, 42 }, 0.0, 2.0);
+    QCOMPARE(changed.count(), 2);
+    QCOMPARE(changed.at(0).at(0).toInt(), 1);
+    QCOMPARE(changed.at(0).at(1).toInt(), 3);
+    QCOMPARE(changed.at(1).at(0).toInt(), 7);
+    // Each row moves once, however often it is listed.
+    QCOMPARE(store.translation(3), QPointF(0.0, 2.0));
+    QCOMPARE(store.translation(4), QPointF(0.0, 0.0));
+}
+
+QTEST_GUILESS_MAIN(TestShapeStore)
+#include "tst_shapestore.moc"
@@ -0,0 +1,40 @@
+#include <QtTest>
+
+#include "Processing/StopLatencyBenchmark.h"
+
+class TestStopLatency : public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void bothStopsGoQuiet();
+    void interruptCutsTheFrame();
+    void interruptReportsTheExactResumePosition();
+
+private:
+    StopLatencyBenchmark::Result m_result;
+};
+
+void TestStopLatency::initTestCase() {
+    // Both runs stream to a ControllerSimulator on a loopback port; they take a few seconds.
+    m_result = StopLatencyBenchmark::run();
+    QVERIFY2(m_result.error.isEmpty(), qPrintable(m_result.error));
+}
+
+void TestStopLatency::bothStopsGoQuiet() {
+    QVERIFY(m_result.stopQuietMs >= 0.0);
+    QVERIFY(m_result.interruptQuietMs >= 0.0);
+}
+
+void TestStopLatency::interruptCutsTheFrame() {
+    QVERIFY(m_result.cut);
+    QVERIFY(m_result.framesDropped >= 0);
+}
+
+void TestStopLatency::interruptReportsTheExactResumePosition() {
+    QVERIFY(m_result.resumePosition >= 0);
+    QCOMPARE(m_result.resumePosition, m_result.recordsExecuted);
+    QVERIFY(m_result.resumeExact());
+}
+
+QTEST_GUILESS_MAIN(TestStopLatency)
+#include "tst_stoplatency.moc"
@@ -0,0 +1,42 @@
+#include <QtTest>
+
+#include "Processing/ThreeAxisGenerator.h"
+
+// The overlay and the live toolpath map device counts back to workpiece coordinates with
+// invertCorrection, so it has to undo applyCorrection everywhere on the field.
+class TestThreeAxisGenerator : public QObject {
+    Q_OBJECT
+private slots:
+    void invertUndoesCorrection_data();
+    void invertUndoesCorrection();
+};
+
+void TestThreeAxisGenerator::invertUndoesCorrection_data() {
+    QTest::addColumn<double>("x");
+    QTest::addColumn<double>("y");
+    QTest::addColumn<double>("z");
+    for (const double x : { -40.0, -5.5, 0.0, 12.25, 40.0 }) {
+        for (const double y : { -40.0, 0.0, 33.3 }) {
+            for (const double z : { -2.0, 0.0, 1.5, 8.0 }) {
+                QTest::addRow("%g,%g,%g", x, y, z) << x << y << z;
+            }
+        }
+    }
+}
+
+void TestThreeAxisGenerator::invertUndoesCorrection() {
+    QFETCH(double, x);
+    QFETCH(double, y);
+    QFETCH(double, z);
+    double cx = x;
+    double cy = y;
+    double cz = z;
+    ThreeAxisGenerator::applyCorrection(cx, cy, cz);
+    ThreeAxisGenerator::invertCorrection(cx, cy, cz);
+    QVERIFY(qAbs(cx - x) < 1e-9);
+    QVERIFY(qAbs(cy - y) < 1e-9);
+    QVERIFY(qAbs(cz - z) < 1e-9);
+}
+
+QTEST_GUILESS_MAIN(TestThreeAxisGenerator)
+#include "tst_threeaxisgenerator.moc"
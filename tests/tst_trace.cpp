@@ -0,0 +1,105 @@
+#include <thread>
+#include <vector>
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QtTest>
+
+#include "metrics/Trace.h"
+#include "metrics/TraceBenchmark.h"
+
+namespace {
+    // More than one buffer chunk per thread.
+    constexpr int EVENTS_PER_THREAD = 5000;
+    constexpr int THREADS = 4;
+
+    void recordScopes(int count) {
+        for (int i = 0; i < count; ++i) {
+            trace::Scope scope("test", "scope");
+        }
+    }
+}
+
+class TestTrace : public QObject {
+    Q_OBJECT
+private slots:
+    void cleanup();
+    void scopesRecordOnlyWhileEnabled();
+    void startDiscardsThePreviousTrace();
+    void countsEveryThread();
+    void writesChromeTraceJson();
+    void overheadBenchmarkLeavesTracingOff();
+};
+
+void TestTrace::cleanup() {
+    trace::stop();
+}
+
+void TestTrace::scopesRecordOnlyWhileEnabled() {
+    trace::start();
+    QVERIFY(trace::isEnabled());
+    recordScopes(3);
+    trace::stop();
+    recordScopes(3);
+    QCOMPARE(trace::stats().events, 3);
+}
+
+void TestTrace::startDiscardsThePreviousTrace() {
+    trace::start();
+    recordScopes(10);
+    trace::start();
+    QCOMPARE(trace::stats().events, 0);
+    recordScopes(2);
+    QCOMPARE(trace::stats().events, 2);
+}
+
+void TestTrace::countsEveryThread() {
+    trace::start();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < THREADS; ++i) {
+        threads.emplace_back(recordScopes, EVENTS_PER_THREAD);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const auto stats = trace::stats();
+    QCOMPARE(stats.threads, THREADS);
+    QCOMPARE(stats.events, static_cast<qint64>(THREADS) * EVENTS_PER_THREAD);
+    QCOMPARE(stats.dropped, 0);
+}
+
+void TestTrace::writesChromeTraceJson() {
+    trace::start();
+    trace::setThreadName(QStringLiteral("test \"main\""));
+    {
+        trace::Scope scope("rpc", trace::intern(QStringLiteral("Process\\Line")));
+    }
+    trace::stop();
+
+    QJsonParseError error;
+    const QJsonDocument document = QJsonDocument::fromJson(trace::toJson(), &error);
+    QCOMPARE(error.error, QJsonParseError::NoError);
+    const QJsonArray events = document.object().value(QStringLiteral("traceEvents")).toArray();
+    QCOMPARE(events.size(), 2);
+    const QJsonObject thread = events.at(0).toObject();
+    QCOMPARE(thread.value(QStringLiteral("ph")).toString(), QStringLiteral("M"));
+    QCOMPARE(thread.value(QStringLiteral("args")).toObject().value(QStringLiteral("name")).toString(), QStringLiteral("test \"main\""));
+    const QJsonObject event = events.at(1).toObject();
+    QCOMPARE(event.value(QStringLiteral("ph")).toString(), QStringLiteral("X"));
+    QCOMPARE(event.value(QStringLiteral("name")).toString(), QStringLiteral("Process\\Line"));
+    QCOMPARE(event.value(QStringLiteral("cat")).toString(), QStringLiteral("rpc"));
+    QVERIFY(event.value(QStringLiteral("dur")).toDouble() >= 0.0);
+}
+
+void TestTrace::overheadBenchmarkLeavesTracingOff() {
+    const auto result = TraceBenchmark::run(1);
+    QVERIFY(!trace::isEnabled());
+    QVERIFY(result.samples > 0);
+    // At least one event per generated rectangle and line.
+    QVERIFY(result.eventsPerRound >= 5050);
+    QVERIFY(result.nsPerEvent > 0.0);
+}
+
+QTEST_GUILESS_MAIN(TestTrace)
+#include "tst_trace.moc"